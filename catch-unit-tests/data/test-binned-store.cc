@@ -0,0 +1,89 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "catch/include/catch.hpp"
+
+#include "learning/forests/mart.h"
+#include "metric/ir/ndcg.h"
+#include "data/dataset.h"
+#include "data/binned_column_store.h"
+#include <random>
+
+TEST_CASE( "Testing Out-of-core Mart", "[data][binned][mart]" ) {
+  const size_t nqueries = 50;
+  const size_t nresults = 40;
+  const size_t nfeatures = 8;
+
+  auto make_dataset = [&]() {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+    auto dataset = std::make_shared<quickrank::data::Dataset>(
+        nqueries * nresults, nfeatures);
+    for (size_t q = 0; q < nqueries; ++q)
+      for (size_t r = 0; r < nresults; ++r) {
+        std::vector<quickrank::Feature> features(nfeatures);
+        for (auto &f: features)
+          f = uniform(rng);
+        dataset->addInstance(q, (quickrank::Label) (int) (features[0] * 4.0f),
+                             features);
+      }
+    return dataset;
+  };
+  auto dataset = make_dataset();
+
+  auto metric = std::shared_ptr<quickrank::metric::ir::Metric>(
+      new quickrank::metric::ir::Ndcg(10));
+
+  quickrank::learning::forests::Mart in_memory(20, 0.1, 32, 8, 1, 1.0f, 1.0f,
+                                               0, 0);
+  quickrank::learning::forests::Mart out_of_core(20, 0.1, 32, 8, 1, 1.0f, 1.0f,
+                                                 0, 0);
+  // small shards to exercise query-aligned sharding
+  out_of_core.set_out_of_core(".", 300);
+
+  in_memory.learn(dataset, nullptr, metric, 0, "");
+  out_of_core.learn(dataset, nullptr, metric, 0, "");
+
+  std::vector<quickrank::Score> in_memory_scores(dataset->num_instances());
+  std::vector<quickrank::Score> out_of_core_scores(dataset->num_instances());
+  in_memory.score_dataset(dataset, &in_memory_scores[0]);
+  out_of_core.score_dataset(dataset, &out_of_core_scores[0]);
+
+  for (size_t i = 0; i < dataset->num_instances(); ++i)
+    REQUIRE( in_memory_scores[i] == out_of_core_scores[i] );
+
+  // the training features can be freed once binned, labels and queries
+  // are kept
+  auto released = make_dataset();
+  quickrank::learning::forests::Mart releasing(20, 0.1, 32, 8, 1, 1.0f, 1.0f,
+                                               0, 0);
+  releasing.set_out_of_core(".", 300);
+  releasing.set_release_training_features(true);
+  releasing.learn(released, nullptr, metric, 0, "");
+  REQUIRE( released->release_features() == 0 );
+  REQUIRE( released->num_queries() == nqueries );
+  for (size_t i = 0; i < dataset->num_instances(); ++i)
+    REQUIRE( released->getLabel(i) == dataset->getLabel(i) );
+
+  std::vector<quickrank::Score> releasing_scores(dataset->num_instances());
+  releasing.score_dataset(dataset, &releasing_scores[0]);
+  REQUIRE( releasing_scores == out_of_core_scores );
+}
@@ -0,0 +1,74 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "catch/include/catch.hpp"
+
+#include "data/dataset.h"
+#include "utils/halffloat.h"
+#include <random>
+
+TEST_CASE( "Testing 16 bits Dataset", "[data][half]" ) {
+  const size_t nfeatures = 4;
+
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<float> uniform(-10.0f, 10.0f);
+
+  for (auto storage: {quickrank::data::Dataset::FLOAT16,
+                      quickrank::data::Dataset::BFLOAT16}) {
+    auto narrow = [storage](float v) {
+      return storage == quickrank::data::Dataset::FLOAT16
+             ? half_to_float(float_to_half(v))
+             : bfloat16_to_float(float_to_bfloat16(v));
+    };
+
+    quickrank::data::Dataset dataset(100, nfeatures, storage);
+    std::vector<std::vector<quickrank::Feature>> instances;
+    for (size_t i = 0; i < 100; ++i) {
+      std::vector<quickrank::Feature> features(nfeatures);
+      for (auto &f: features)
+        f = uniform(rng);
+      dataset.addInstance(i / 10, 0, features);
+      instances.push_back(features);
+    }
+
+    REQUIRE( !dataset.has_float_features() );
+    std::vector<quickrank::Feature> row(nfeatures);
+    for (size_t i = 0; i < 100; ++i) {
+      dataset.fill_row(i, row.data());
+      for (size_t f = 0; f < nfeatures; ++f) {
+        REQUIRE( row[f] == narrow(instances[i][f]) );
+        REQUIRE( dataset.value(i, f) == row[f] );
+      }
+    }
+
+    // a float value takes the same branch as its rounding
+    for (size_t k = 0; k < 10000; ++k) {
+      const float threshold = uniform(rng);
+      const float split = dataset.split_threshold(threshold);
+      REQUIRE( narrow(split) <= threshold );
+      for (size_t j = 0; j < 10; ++j) {
+        const float x = uniform(rng) / 100.0f + threshold;
+        REQUIRE( (x <= split) == (narrow(x) <= narrow(split)) );
+        REQUIRE( (narrow(x) <= threshold) == (narrow(x) <= split) );
+      }
+    }
+  }
+}
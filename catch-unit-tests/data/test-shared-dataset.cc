@@ -0,0 +1,98 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "catch/include/catch.hpp"
+
+#include "data/dataset.h"
+#include <random>
+#include <string>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+TEST_CASE( "Testing shared memory Dataset", "[data][shared]" ) {
+  const size_t nfeatures = 5;
+  const std::string name = "/quickrank-test-" + std::to_string(getpid());
+
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+
+  for (auto storage: {quickrank::data::Dataset::FLOAT32,
+                      quickrank::data::Dataset::FLOAT16,
+                      quickrank::data::Dataset::SPARSE}) {
+    auto dataset = std::make_shared<quickrank::data::Dataset>(
+        100, nfeatures, storage);
+    std::vector<std::vector<quickrank::Feature>> instances;
+    for (size_t i = 0; i < 100; ++i) {
+      std::vector<quickrank::Feature> features(nfeatures);
+      for (auto &f: features)
+        f = uniform(rng) < 0.5f ? 0.0f : uniform(rng);
+      dataset->addInstance(i / 10, i % 3, features);
+      instances.push_back(features);
+    }
+    dataset->set_feature_ids({2, 3, 5, 7, 11});
+
+    REQUIRE( quickrank::data::Dataset::attach_shared(name, "key") == nullptr );
+    REQUIRE( dataset->publish_shared(name, "key") );
+    REQUIRE( !dataset->publish_shared(name, "key") );
+    auto shared = quickrank::data::Dataset::attach_shared(name, "key");
+    REQUIRE( shared );
+    REQUIRE( dataset->is_shared() );
+    REQUIRE( shared->is_shared() );
+
+    for (auto d: {dataset, shared}) {
+      REQUIRE( d->storage() == storage );
+      REQUIRE( d->num_instances() == 100 );
+      REQUIRE( d->num_queries() == 10 );
+      REQUIRE( d->offset(3) == 30 );
+      REQUIRE( d->feature_id(4) == 11 );
+      for (size_t i = 0; i < 100; ++i) {
+        REQUIRE( d->getLabel(i) == i % 3 );
+        for (size_t f = 0; f < nfeatures; ++f)
+          REQUIRE( d->value(i, f) == shared->value(i, f) );
+      }
+    }
+    for (size_t i = 0; i < 100; ++i)
+      for (size_t f = 0; f < nfeatures; ++f)
+        if (storage != quickrank::data::Dataset::FLOAT16)
+          REQUIRE( shared->value(i, f) == instances[i][f] );
+
+    // shared features can be read in place, but not written
+    if (storage == quickrank::data::Dataset::FLOAT32) {
+      REQUIRE( *shared->at(42, 3) == instances[42][3] );
+      pid_t pid = fork();
+      if (pid == 0) {
+        *shared->mutable_at(42, 3) = 1.0f;
+        _exit(EXIT_SUCCESS);
+      }
+      int status = 0;
+      waitpid(pid, &status, 0);
+      REQUIRE( WIFEXITED(status) );
+      REQUIRE( WEXITSTATUS(status) == EXIT_FAILURE );
+    }
+
+    // the segment is removed by the last dataset using it
+    dataset.reset();
+    REQUIRE( quickrank::data::Dataset::attach_shared(name, "key") );
+    shared.reset();
+    REQUIRE( quickrank::data::Dataset::attach_shared(name, "key") == nullptr );
+  }
+}
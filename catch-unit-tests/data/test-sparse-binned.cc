@@ -0,0 +1,144 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "catch/include/catch.hpp"
+
+#include "learning/forests/mart.h"
+#include "metric/ir/ndcg.h"
+#include "data/dataset.h"
+#include "data/sparse_binned_features.h"
+#include <cfloat>
+#include <random>
+
+TEST_CASE( "Testing Sparse Binned Features", "[data][binned][sparse]" ) {
+  const size_t nqueries = 50;
+  const size_t nresults = 40;
+  const size_t nfeatures = 16;
+
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+  auto dense = std::make_shared<quickrank::data::Dataset>(
+      nqueries * nresults, nfeatures);
+  auto sparse = std::make_shared<quickrank::data::Dataset>(
+      nqueries * nresults, nfeatures, quickrank::data::Dataset::SPARSE);
+  auto released = std::make_shared<quickrank::data::Dataset>(
+      nqueries * nresults, nfeatures, quickrank::data::Dataset::SPARSE);
+  for (size_t q = 0; q < nqueries; ++q)
+    for (size_t r = 0; r < nresults; ++r) {
+      // about 70% of zeros, the last feature is always zero
+      std::vector<quickrank::Feature> features(nfeatures);
+      for (size_t f = 0; f + 1 < nfeatures; ++f)
+        features[f] = uniform(rng) > 0.4f ? uniform(rng) : 0.0f;
+      const quickrank::Label label = features[0] > 0.0f ? 1 : 0;
+      dense->addInstance(q, label, features);
+      sparse->addInstance(q, label, features);
+      released->addInstance(q, label, features);
+    }
+
+  REQUIRE( sparse->is_sparse() );
+  REQUIRE( sparse->num_nonzeros() < dense->num_instances() * nfeatures / 2 );
+
+  // four bins per feature: zero falls in the second one
+  std::vector<float> t = {-0.5f, 0.0f, 0.5f, FLT_MAX};
+  std::vector<float *> thresholds(nfeatures, t.data());
+  std::vector<size_t> thresholds_size(nfeatures, t.size());
+
+  quickrank::data::SparseBinnedFeatures binned(sparse);
+  binned.discretize(thresholds.data(), thresholds_size.data());
+
+  std::vector<double> labels(dense->num_instances());
+  std::vector<size_t> sampleids;
+  for (size_t i = 0; i < dense->num_instances(); ++i) {
+    labels[i] = uniform(rng);
+    if (i % 3)
+      sampleids.push_back(i);
+  }
+
+  for (size_t nsampleids: {sampleids.size(), (size_t) 10}) {
+    std::vector<double> sums(nfeatures * t.size(), 0.0);
+    std::vector<size_t> counts(nfeatures * t.size(), 0);
+    std::vector<double *> sumlbl(nfeatures);
+    std::vector<size_t *> count(nfeatures);
+    for (size_t f = 0; f < nfeatures; ++f) {
+      sumlbl[f] = &sums[f * t.size()];
+      count[f] = &counts[f * t.size()];
+    }
+    binned.histogram(sampleids.data(), nsampleids, labels.data(),
+                     sumlbl.data(), count.data());
+
+    for (size_t f = 0; f < nfeatures; ++f) {
+      for (size_t b = 0; b < t.size(); ++b) {
+        double expected_sum = 0.0;
+        size_t expected_count = 0;
+        for (size_t i = 0; i < nsampleids; ++i) {
+          const size_t s = sampleids[i];
+          const size_t bin = std::lower_bound(t.begin(), t.end(),
+                                              *dense->at(s, f)) - t.begin();
+          REQUIRE( binned.bin(0, s, f) == bin );
+          if (bin == b) {
+            expected_sum += labels[s];
+            ++expected_count;
+          }
+        }
+        REQUIRE( count[f][b] == expected_count );
+        REQUIRE( sumlbl[f][b] == Approx(expected_sum) );
+      }
+    }
+  }
+
+  std::vector<size_t> lsamples(sampleids.size()), rsamples(sampleids.size());
+  size_t lsize, rsize;
+  binned.partition(3, 1, sampleids.data(), sampleids.size(),
+                   lsamples.data(), lsize, rsamples.data(), rsize);
+  REQUIRE( lsize + rsize == sampleids.size() );
+  for (size_t i = 0; i < lsize; ++i)
+    REQUIRE( *dense->at(lsamples[i], 3) <= 0.0f );
+  for (size_t i = 0; i < rsize; ++i)
+    REQUIRE( *dense->at(rsamples[i], 3) > 0.0f );
+
+  // a model scores sparse and dense datasets alike
+  auto metric = std::shared_ptr<quickrank::metric::ir::Metric>(
+      new quickrank::metric::ir::Ndcg(10));
+  quickrank::learning::forests::Mart mart(10, 0.1, 0, 8, 1, 1.0f, 1.0f,
+                                          0, 0);
+  mart.learn(sparse, nullptr, metric, 0, "");
+
+  std::vector<quickrank::Score> dense_scores(dense->num_instances());
+  std::vector<quickrank::Score> sparse_scores(sparse->num_instances());
+  mart.score_dataset(dense, &dense_scores[0]);
+  mart.score_dataset(sparse, &sparse_scores[0]);
+  for (size_t i = 0; i < dense->num_instances(); ++i)
+    REQUIRE( dense_scores[i] == sparse_scores[i] );
+  REQUIRE( metric->evaluate_dataset(sparse, &sparse_scores[0]) > 0.9 );
+
+  // the non-zero values can be freed once binned, their positions index
+  // the bins during the training
+  quickrank::learning::forests::Mart releasing(10, 0.1, 0, 8, 1, 1.0f, 1.0f,
+                                               0, 0);
+  releasing.set_release_training_features(true);
+  releasing.learn(released, nullptr, metric, 0, "");
+  REQUIRE( released->release_features() == 0 );
+  REQUIRE( released->num_nonzeros() == sparse->num_nonzeros() );
+
+  std::vector<quickrank::Score> releasing_scores(dense->num_instances());
+  releasing.score_dataset(dense, &releasing_scores[0]);
+  REQUIRE( releasing_scores == dense_scores );
+}
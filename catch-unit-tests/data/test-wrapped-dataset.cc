@@ -0,0 +1,98 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "catch/include/catch.hpp"
+
+#include "data/dataset.h"
+#include "data/vertical_dataset.h"
+#include "learning/forests/rankboost.h"
+#include "metric/ir/ndcg.h"
+#include <cstdlib>
+#include <vector>
+
+TEST_CASE( "Testing datasets wrapping external buffers", "[data][wrap]" ) {
+  const size_t n = 10, m = 3, nq = 3;
+  const std::vector<size_t> offsets = {0, 4, 5, 10};
+  std::vector<quickrank::Label> labels(n);
+  std::vector<quickrank::Feature> rows(n * m);
+  quickrank::Feature *columns =
+      (quickrank::Feature *) malloc(n * m * sizeof(quickrank::Feature));
+  for (size_t i = 0; i < n; ++i) {
+    labels[i] = i % 3;
+    for (size_t f = 0; f < m; ++f)
+      rows[i * m + f] = columns[f * n + i] = i * 10.0f + f;
+  }
+
+  auto row_major = quickrank::data::Dataset::wrap(
+      n, m, nq, offsets.data(), labels.data(), rows.data());
+  // the column-major buffer is adopted
+  auto column_major = quickrank::data::Dataset::wrap(
+      n, m, nq, offsets.data(), labels.data(), columns,
+      quickrank::data::Dataset::COLUMNS, std::shared_ptr<void>(columns, free));
+
+  // buffers are used in place
+  REQUIRE( row_major->at(0, 0) == rows.data() );
+  REQUIRE( column_major->column(0) == columns );
+  REQUIRE( row_major->has_float_features() );
+  REQUIRE( column_major->is_column_major() );
+
+  std::vector<quickrank::Feature> row(m);
+  for (auto dataset: {row_major, column_major}) {
+    REQUIRE( dataset->num_instances() == n );
+    REQUIRE( dataset->num_queries() == nq );
+    REQUIRE( dataset->getQueryResults(2)->num_results() == 5 );
+    for (size_t i = 0; i < n; ++i) {
+      REQUIRE( dataset->getLabel(i) == labels[i] );
+      dataset->fill_row(i, row.data());
+      for (size_t f = 0; f < m; ++f) {
+        REQUIRE( row[f] == i * 10.0f + f );
+        REQUIRE( dataset->value(i, f) == i * 10.0f + f );
+      }
+    }
+  }
+
+  // column-major features are not transposed
+  quickrank::data::VerticalDataset vertical(column_major);
+  REQUIRE( vertical.at(0, 0) == columns );
+  REQUIRE( *vertical.at(7, 2) == 72.0f );
+
+  // learners accessing the features in place work on a float copy
+  REQUIRE( quickrank::data::Dataset::with_float_rows(row_major) == row_major );
+  auto widened = quickrank::data::Dataset::with_float_rows(column_major);
+  REQUIRE( widened->has_float_features() );
+  REQUIRE( widened->num_queries() == nq );
+  for (size_t i = 0; i < n; ++i) {
+    REQUIRE( widened->getLabel(i) == labels[i] );
+    for (size_t f = 0; f < m; ++f)
+      REQUIRE( *widened->at(i, f) == i * 10.0f + f );
+  }
+
+  auto metric = std::shared_ptr<quickrank::metric::ir::Metric>(
+      new quickrank::metric::ir::Ndcg(10));
+  quickrank::learning::forests::Rankboost on_rows(5);
+  quickrank::learning::forests::Rankboost on_columns(5);
+  on_rows.learn(row_major, nullptr, metric, 0, "");
+  on_columns.learn(column_major, nullptr, metric, 0, "");
+  std::vector<quickrank::Score> row_scores(n), column_scores(n);
+  on_rows.score_dataset(row_major, row_scores.data());
+  on_columns.score_dataset(column_major, column_scores.data());
+  REQUIRE( row_scores == column_scores );
+}
@@ -0,0 +1,122 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "catch/include/catch.hpp"
+
+#include "io/generate_conditional_operators.h"
+#include "learning/forests/mart.h"
+#include <cstdlib>
+#include <dlfcn.h>
+#include <fstream>
+#include <random>
+#include <unistd.h>
+
+namespace {
+
+// appends a random tree of the given max depth
+void append_random_split(pugi::xml_node parent, const std::string &pos,
+                         size_t depth, std::mt19937 &generator) {
+  std::uniform_real_distribution<double> distribution(-1, 1);
+  pugi::xml_node split = parent.append_child("split");
+  if (!pos.empty())
+    split.append_attribute("pos") = pos.c_str();
+  if (depth == 0 || generator() % 4 == 0) {
+    split.append_child("output").text() = distribution(generator);
+    return;
+  }
+  split.append_child("feature").text() = (size_t) (generator() % 10 + 1);
+  split.append_child("threshold").text() = (float) distribution(generator);
+  append_random_split(split, "left", depth - 1, generator);
+  append_random_split(split, "right", depth - 1, generator);
+}
+
+}  // namespace
+
+TEST_CASE( "Testing code generation", "[io][codegen]" ) {
+  // the generated code is compiled with the system compiler
+  if (std::system("c++ --version > /dev/null 2>&1") != 0)
+    return;
+
+  char directory[] = "/tmp/quickrank-test-XXXXXX";
+  REQUIRE( mkdtemp(directory) != nullptr );
+  const std::string path(directory);
+
+  std::mt19937 generator(3);
+  std::shared_ptr<quickrank::learning::LTR_Algorithm> mart(
+      new quickrank::learning::forests::Mart(30, 0.1, 0, 10, 1, 1.0f, 1.0f,
+                                             100, 0.0f));
+  std::unique_ptr<pugi::xml_document> model(mart->get_xml_model());
+  model->child("ranker").remove_child("ensemble");
+  pugi::xml_node ensemble = model->child("ranker").append_child("ensemble");
+  for (size_t t = 0; t < 30; ++t) {
+    pugi::xml_node tree = ensemble.append_child("tree");
+    tree.append_attribute("id") = t + 1;
+    tree.append_attribute("weight") = 0.1;
+    append_random_split(tree, "", 6, generator);
+  }
+  REQUIRE( model->save_file((path + "/model.xml").c_str()) );
+  quickrank::learning::forests::Mart ranker(*model);
+
+  const size_t num_docs = 200;
+  const size_t num_features = 10;
+  std::vector<quickrank::Feature> features(num_docs * num_features);
+  std::uniform_real_distribution<float> distribution(-1, 1);
+  for (auto &f: features)
+    f = distribution(generator);
+
+  // the C++ entry point is called through a C wrapper
+  std::ofstream wrapper(path + "/wrapper.cc");
+  wrapper << "#include <cstddef>\n"
+          << "void ranker_batch(const float *, size_t, size_t, double *);\n"
+          << "extern \"C\" void wrapper(const float *v, size_t n, size_t f,"
+          << " double *s) { ranker_batch(v, n, f, s); }\n";
+  wrapper.close();
+
+  quickrank::io::GenOpCond code_generator;
+  for (const std::string style: {"ternary", "ifelse", "array"}) {
+    const std::string code = path + "/" + style + ".cc";
+    const std::string library = path + "/" + style + ".so";
+    // 30 trees in 5 block files
+    code_generator.generate_conditional_operators_code(path + "/model.xml",
+                                                       code, style, 7);
+    REQUIRE( access((path + "/" + style + "_block4.cc").c_str(), R_OK) == 0 );
+    REQUIRE( access((path + "/" + style + "_bench.cc").c_str(), R_OK) == 0 );
+    const std::string command = "c++ -O1 -shared -fPIC -o " + library + " "
+        + code + " " + path + "/" + style + "_block*.cc " + path
+        + "/wrapper.cc";
+    REQUIRE( std::system(command.c_str()) == 0 );
+
+    void *handle = dlopen(library.c_str(), RTLD_NOW | RTLD_LOCAL);
+    REQUIRE( handle != nullptr );
+    typedef void (*batch_function)(const float *, size_t, size_t, double *);
+    batch_function ranker_batch = (batch_function) dlsym(handle, "wrapper");
+    REQUIRE( ranker_batch != nullptr );
+
+    std::vector<double> scores(num_docs, -1.0);
+    ranker_batch(features.data(), num_docs, num_features, scores.data());
+    for (size_t i = 0; i < num_docs; ++i)
+      REQUIRE( scores[i] == Approx(
+          ranker.score_document(features.data() + i * num_features)) );
+    dlclose(handle);
+  }
+
+  std::system(("rm -rf " + path).c_str());
+}
@@ -0,0 +1,88 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "catch/include/catch.hpp"
+
+#include "io/block_reader.h"
+#include "io/svml.h"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#ifdef QUICKRANK_HAS_ZLIB
+#include <zlib.h>
+#endif
+
+TEST_CASE( "Testing compressed SVML input", "[io][compressed]" ) {
+  std::stringstream content;
+  content << "# comment line" << std::endl;
+  for (size_t i = 0; i < 500; ++i) {
+    content << i % 5 << " qid:" << i / 20 + 1;
+    for (size_t f = 1; f <= 10; f += 1 + i % 3)
+      content << " " << f << ":" << 0.5f * (i + f);
+    content << " # doc " << i << std::endl;
+  }
+  content << "3 qid:99 4:1.5";  // last line with no new line
+  const std::string text = content.str();
+
+  const std::string plain = "quickrank-test-input.txt";
+  std::ofstream(plain) << text;
+
+  // blocks split lines at arbitrary positions
+  for (size_t block_size: {1, 7, 1 << 20}) {
+    quickrank::io::BlockReader reader(plain, block_size, 2);
+    REQUIRE( reader.compression() == quickrank::io::BlockReader::NONE );
+    std::vector<char> block;
+    std::string read;
+    while (reader.next(block))
+      read.append(block.begin(), block.end());
+    REQUIRE( read == text );
+    REQUIRE( reader.bytes_read() == text.size() );
+  }
+
+  quickrank::io::Svml svml;
+  auto dataset = svml.read_horizontal(plain);
+  REQUIRE( dataset->num_instances() == 501 );
+  REQUIRE( dataset->num_queries() == 26 );
+  REQUIRE( dataset->num_features() == 10 );
+  REQUIRE( *dataset->at(500, 3) == 1.5f );
+
+#ifdef QUICKRANK_HAS_ZLIB
+  const std::string compressed = "quickrank-test-input.txt.gz";
+  gzFile gz = gzopen(compressed.c_str(), "wb");
+  gzwrite(gz, text.data(), text.size());
+  gzclose(gz);
+
+  auto gz_dataset = svml.read_horizontal(compressed);
+  REQUIRE( gz_dataset->num_instances() == dataset->num_instances() );
+  REQUIRE( gz_dataset->num_queries() == dataset->num_queries() );
+  REQUIRE( gz_dataset->num_features() == dataset->num_features() );
+  for (size_t i = 0; i < dataset->num_instances(); ++i) {
+    REQUIRE( gz_dataset->getLabel(i) == dataset->getLabel(i) );
+    for (size_t f = 0; f < dataset->num_features(); ++f)
+      REQUIRE( *gz_dataset->at(i, f) == *dataset->at(i, f) );
+  }
+  std::remove(compressed.c_str());
+#endif
+
+  std::remove(plain.c_str());
+}
@@ -0,0 +1,147 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "catch/include/catch.hpp"
+
+#include "io/binary_dataset.h"
+#include "io/svml.h"
+#include "utils/dtoa.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+// returns true if reading the given binary dataset exits with an error
+bool rejects(const std::vector<char> &bytes) {
+  const std::string file = "quickrank-test-partial-invalid.bin";
+  std::ofstream(file, std::ios::binary).write(bytes.data(), bytes.size());
+  pid_t pid = fork();
+  if (pid == 0) {
+    quickrank::io::BinaryDataset binary;
+    binary.read_horizontal(file);
+    _exit(EXIT_SUCCESS);
+  }
+  int status = 0;
+  waitpid(pid, &status, 0);
+  std::remove(file.c_str());
+  return WIFEXITED(status) && WEXITSTATUS(status) == EXIT_FAILURE;
+}
+
+}  // namespace
+
+TEST_CASE( "Testing shortest round-trip formatting", "[io][dtoa]" ) {
+  char buffer[TO_CHARS_MAX_LENGTH + 1];
+
+  buffer[float_to_chars(buffer, 0.1f)] = '\0';
+  REQUIRE( std::string(buffer) == "0.1" );
+  buffer[float_to_chars(buffer, -2.0f)] = '\0';
+  REQUIRE( std::string(buffer) == "-2" );
+  buffer[double_to_chars(buffer, 1e300)] = '\0';
+  REQUIRE( std::string(buffer) == "1e+300" );
+
+  std::mt19937 generator(7);
+  for (size_t i = 0; i < 100000; ++i) {
+    uint32_t bits = generator();
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    if (value != value)
+      continue;  // nan
+    buffer[float_to_chars(buffer, value)] = '\0';
+    REQUIRE( strtof(buffer, NULL) == value );
+
+    double d = value * 1e-3 / (i + 1);
+    buffer[double_to_chars(buffer, d)] = '\0';
+    REQUIRE( strtod(buffer, NULL) == d );
+  }
+}
+
+TEST_CASE( "Testing partial scores writers", "[io][writer]" ) {
+  const size_t num_features = 7;
+  auto dataset = std::make_shared<quickrank::data::Dataset>(300,
+                                                            num_features);
+  std::mt19937 generator(11);
+  std::uniform_real_distribution<float> distribution(-1, 1);
+  for (size_t i = 0; i < 300; ++i) {
+    std::vector<quickrank::Feature> features(num_features);
+    for (auto &f: features)
+      f = distribution(generator) / (1 + i);
+    dataset->addInstance(i / 13, i % 5, features);
+  }
+
+  const std::string svml_file = "quickrank-test-partial.txt";
+  const std::string binary_file = "quickrank-test-partial.bin";
+  quickrank::io::Svml svml;
+  svml.write(dataset, svml_file);
+  quickrank::io::BinaryDataset::write(dataset, binary_file);
+
+  REQUIRE( !quickrank::io::BinaryDataset::is_binary(svml_file) );
+  REQUIRE( quickrank::io::BinaryDataset::is_binary(binary_file) );
+
+  quickrank::io::BinaryDataset binary;
+  auto from_svml = svml.read_horizontal(svml_file);
+  auto from_binary = binary.read_horizontal(binary_file);
+  for (auto read: {from_svml.get(), from_binary.get()}) {
+    REQUIRE( read->num_instances() == dataset->num_instances() );
+    REQUIRE( read->num_queries() == dataset->num_queries() );
+    REQUIRE( read->num_features() == num_features );
+    for (size_t q = 0; q <= dataset->num_queries(); ++q)
+      REQUIRE( read->offset(q) == dataset->offset(q) );
+    for (size_t i = 0; i < dataset->num_instances(); ++i) {
+      REQUIRE( read->getLabel(i) == dataset->getLabel(i) );
+      for (size_t f = 0; f < num_features; ++f)
+        REQUIRE( *read->at(i, f) == *dataset->at(i, f) );
+    }
+  }
+
+  // feature selection, also of features missing in the file
+  binary.set_feature_ids({2, 5, 9});
+  auto selected = binary.read_horizontal(binary_file);
+  REQUIRE( selected->num_features() == 3 );
+  for (size_t i = 0; i < dataset->num_instances(); ++i) {
+    REQUIRE( *selected->at(i, 0) == *dataset->at(i, 1) );
+    REQUIRE( *selected->at(i, 1) == *dataset->at(i, 4) );
+    REQUIRE( *selected->at(i, 2) == 0.0f );
+  }
+
+  // query offsets must be non-decreasing, from 0 to the number of instances
+  std::ifstream in(binary_file, std::ios::binary);
+  const std::vector<char> bytes((std::istreambuf_iterator<char>(in)),
+                                std::istreambuf_iterator<char>());
+  const size_t offsets = 4 * sizeof(uint64_t);
+  auto corrupted = [&](size_t q, uint64_t value) {
+    std::vector<char> copy(bytes);
+    std::memcpy(&copy[offsets + q * sizeof(uint64_t)], &value, sizeof(value));
+    return copy;
+  };
+  REQUIRE( !rejects(bytes) );
+  REQUIRE( rejects(corrupted(0, 1)) );
+  REQUIRE( rejects(corrupted(5, 1000)) );
+  REQUIRE( rejects(corrupted(dataset->num_queries(), 299)) );
+
+  std::remove(svml_file.c_str());
+  std::remove(binary_file.c_str());
+}
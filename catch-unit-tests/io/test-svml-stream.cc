@@ -0,0 +1,142 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "catch/include/catch.hpp"
+
+#include "io/svml.h"
+#include "io/svml_stream.h"
+#include "learning/forests/mart.h"
+#include "metric/ir/ndcg.h"
+#include <cstdio>
+#include <fstream>
+#include <random>
+
+TEST_CASE( "Testing Svml streaming in chunks of queries", "[io][stream]" ) {
+  const size_t num_features = 5;
+  auto dataset = std::make_shared<quickrank::data::Dataset>(500,
+                                                            num_features);
+  std::mt19937 generator(13);
+  std::uniform_real_distribution<float> distribution(0, 1);
+  size_t qid = 0;
+  for (size_t i = 0; i < 500; ++i) {
+    if (generator() % 9 == 0)
+      qid++;
+    std::vector<quickrank::Feature> features(num_features);
+    for (auto &f: features)
+      f = distribution(generator);
+    dataset->addInstance(qid, i % 3, features);
+  }
+
+  const std::string svml_file = "quickrank-test-stream.txt";
+  quickrank::io::Svml svml;
+  svml.write(dataset, svml_file);
+
+  for (size_t chunk_size: {1, 20, 1000}) {
+    quickrank::io::SvmlStream stream(svml_file, chunk_size);
+    size_t num_queries = 0, num_instances = 0, num_chunks = 0;
+    while (std::shared_ptr<quickrank::data::Dataset> chunk = stream.next()) {
+      // chunks are made of whole queries, and they are large enough
+      REQUIRE( chunk->num_features() == num_features );
+      REQUIRE( chunk->offset(chunk->num_queries() - 1) < chunk_size );
+      for (size_t i = 0; i < chunk->num_instances(); ++i) {
+        REQUIRE( chunk->getLabel(i) == dataset->getLabel(num_instances + i) );
+        for (size_t f = 0; f < num_features; ++f)
+          REQUIRE( chunk->at(i, f)[0] ==
+              dataset->at(num_instances + i, f)[0] );
+      }
+      for (size_t q = 0; q < chunk->num_queries(); ++q)
+        REQUIRE( chunk->offset(q) + num_instances ==
+            dataset->offset(num_queries + q) );
+      num_queries += chunk->num_queries();
+      num_instances += chunk->num_instances();
+      num_chunks++;
+    }
+    REQUIRE( num_queries == dataset->num_queries() );
+    REQUIRE( num_instances == dataset->num_instances() );
+    if (chunk_size == 1)
+      REQUIRE( num_chunks == dataset->num_queries() );
+    if (chunk_size == 1000)
+      REQUIRE( num_chunks == 1 );
+  }
+
+  std::remove(svml_file.c_str());
+}
+
+TEST_CASE( "Testing Svml streaming of features missing from the first chunks",
+           "[io][stream]" ) {
+  // the model splits on the last feature, too
+  const size_t num_features = 10;
+  auto training = std::make_shared<quickrank::data::Dataset>(400,
+                                                             num_features);
+  std::mt19937 generator(7);
+  std::uniform_real_distribution<float> distribution(0, 1);
+  for (size_t i = 0; i < 400; ++i) {
+    std::vector<quickrank::Feature> features(num_features);
+    for (auto &f: features)
+      f = distribution(generator);
+    training->addInstance(i / 20, features[0] + features[9] > 1.0f,
+                          features);
+  }
+  auto metric = std::shared_ptr<quickrank::metric::ir::Metric>(
+      new quickrank::metric::ir::Ndcg(10));
+  quickrank::learning::forests::Mart mart(20, 0.1, 0, 8, 1, 1.0f, 1.0f,
+                                          0, 0);
+  mart.learn(training, nullptr, metric, 0, "");
+  REQUIRE( mart.num_features() == num_features );
+
+  // sparse lines: the first queries have only the first two features
+  const std::string svml_file = "quickrank-test-stream-sparse.txt";
+  {
+    std::ofstream out(svml_file);
+    for (size_t i = 0; i < 100; ++i) {
+      const size_t width = i < 30 ? 2 : num_features;
+      out << i % 3 << " qid:" << i / 10;
+      for (size_t f = 0; f < width; ++f)
+        if (generator() % 2)
+          out << " " << f + 1 << ":" << distribution(generator);
+      out << std::endl;
+    }
+  }
+  quickrank::io::Svml svml;
+  std::shared_ptr<quickrank::data::Dataset> dataset =
+      svml.read_horizontal(svml_file);
+  std::vector<quickrank::Score> expected(dataset->num_instances());
+  mart.score_dataset(dataset, &expected[0]);
+
+  // chunks are as wide as the documents read by the model
+  for (auto storage: {quickrank::data::Dataset::FLOAT32,
+                      quickrank::data::Dataset::SPARSE}) {
+    quickrank::io::SvmlStream stream(svml_file, 1, std::vector<size_t>(),
+                                     storage, mart.num_features());
+    size_t num_instances = 0;
+    while (std::shared_ptr<quickrank::data::Dataset> chunk = stream.next()) {
+      REQUIRE( chunk->num_features() >= mart.num_features() );
+      std::vector<quickrank::Score> scores(chunk->num_instances());
+      mart.score_dataset(chunk, &scores[0]);
+      for (size_t i = 0; i < chunk->num_instances(); ++i)
+        REQUIRE( scores[i] == expected[num_instances + i] );
+      num_instances += chunk->num_instances();
+    }
+    REQUIRE( num_instances == dataset->num_instances() );
+  }
+
+  std::remove(svml_file.c_str());
+}
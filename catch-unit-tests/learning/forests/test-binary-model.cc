@@ -0,0 +1,157 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "catch/include/catch.hpp"
+
+#include "learning/forests/mapped_ensemble.h"
+#include "learning/forests/mart.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+// appends a random tree of the given depth
+void append_random_split(pugi::xml_node parent, const std::string &pos,
+                         size_t depth, std::mt19937 &generator) {
+  std::uniform_real_distribution<double> distribution(-1, 1);
+  pugi::xml_node split = parent.append_child("split");
+  if (!pos.empty())
+    split.append_attribute("pos") = pos.c_str();
+  if (depth == 0 || generator() % 5 == 0) {
+    split.append_child("output").text() = distribution(generator);
+    return;
+  }
+  split.append_child("feature").text() = (size_t) (generator() % 10 + 1);
+  split.append_child("threshold").text() = (float) distribution(generator);
+  append_random_split(split, "left", depth - 1, generator);
+  append_random_split(split, "right", depth - 1, generator);
+}
+
+std::string to_string(const pugi::xml_document &doc) {
+  std::ostringstream xml;
+  doc.save(xml, "\t", pugi::format_default | pugi::format_no_declaration);
+  return xml.str();
+}
+
+// returns true if loading the given binary model exits with an error
+bool rejects(const std::vector<char> &bytes) {
+  const std::string file = "quickrank-test-model-invalid.bin";
+  std::ofstream(file, std::ios::binary).write(bytes.data(), bytes.size());
+  pid_t pid = fork();
+  if (pid == 0) {
+    quickrank::learning::forests::MappedEnsemble ranker(file);
+    _exit(EXIT_SUCCESS);
+  }
+  int status = 0;
+  waitpid(pid, &status, 0);
+  std::remove(file.c_str());
+  return WIFEXITED(status) && WEXITSTATUS(status) == EXIT_FAILURE;
+}
+
+}  // namespace
+
+TEST_CASE( "Testing binary models", "[learning][forests][binary]" ) {
+  std::mt19937 generator(17);
+
+  // the info of an untrained mart, with a random ensemble
+  std::shared_ptr<quickrank::learning::LTR_Algorithm> mart(
+      new quickrank::learning::forests::Mart(21, 0.1, 0, 10, 1, 1.0f, 1.0f,
+                                             100, 0.0f));
+  std::unique_ptr<pugi::xml_document> model(mart->get_xml_model());
+  model->child("ranker").remove_child("ensemble");
+  pugi::xml_node ensemble = model->child("ranker").append_child("ensemble");
+  for (size_t t = 0; t < 20; ++t) {
+    pugi::xml_node tree = ensemble.append_child("tree");
+    tree.append_attribute("id") = t + 1;
+    tree.append_attribute("weight") = 0.1 * (t + 1);
+    append_random_split(tree, "", 6, generator);
+  }
+  // a tree made of a single leaf
+  pugi::xml_node tree = ensemble.append_child("tree");
+  tree.append_attribute("id") = 21;
+  tree.append_attribute("weight") = 1.0;
+  tree.append_child("split").append_child("output").text() = 0.5;
+
+  const std::string binary_file = "quickrank-test-model.bin";
+  quickrank::learning::forests::MappedEnsemble::write(*model, binary_file);
+  REQUIRE( quickrank::learning::forests::MappedEnsemble::is_binary(
+      binary_file) );
+
+  std::shared_ptr<quickrank::learning::LTR_Algorithm> xml_ranker(
+      new quickrank::learning::forests::Mart(*model));
+  quickrank::learning::forests::MappedEnsemble binary_ranker(binary_file);
+  REQUIRE( binary_ranker.name() == "MART" );
+  REQUIRE( binary_ranker.num_trees() == 21 );
+  REQUIRE( binary_ranker.num_features() == xml_ranker->num_features() );
+
+  std::uniform_real_distribution<float> distribution(-1, 1);
+  for (size_t i = 0; i < 1000; ++i) {
+    std::vector<quickrank::Feature> document(10);
+    for (auto &f: document)
+      f = distribution(generator);
+    REQUIRE( binary_ranker.score_document(document.data()) ==
+        Approx(xml_ranker->score_document(document.data())) );
+    REQUIRE( *binary_ranker.partial_scores_document(document.data()) ==
+        *xml_ranker->partial_scores_document(document.data()) );
+  }
+
+  // the binary model is converted back to the same XML model
+  std::unique_ptr<pugi::xml_document> xml_model(xml_ranker->get_xml_model());
+  std::unique_ptr<pugi::xml_document> binary_model(
+      binary_ranker.get_xml_model());
+  REQUIRE( to_string(*binary_model) == to_string(*xml_model) );
+
+  // references out of the nodes or the leaves, cycles and features not in
+  // the header are rejected when the model is loaded
+  std::ifstream in(binary_file, std::ios::binary);
+  const std::vector<char> bytes((std::istreambuf_iterator<char>(in)),
+                                std::istreambuf_iterator<char>());
+  uint64_t header[6];
+  std::memcpy(header, bytes.data(), sizeof(header));
+  const size_t num_trees = header[1], num_nodes = header[2];
+  const size_t roots = sizeof(header) + (header[5] + 7) / 8 * 8
+      + num_trees * sizeof(double);
+  const size_t nodes = roots + (num_trees * sizeof(uint32_t) + 7) / 8 * 8;
+  auto corrupted = [&](size_t offset, uint32_t value) {
+    std::vector<char> copy(bytes);
+    std::memcpy(&copy[offset], &value, sizeof(value));
+    return copy;
+  };
+  typedef quickrank::learning::forests::MappedEnsemble::Node Node;
+  REQUIRE( !rejects(bytes) );
+  REQUIRE( rejects(corrupted(nodes + offsetof(Node, left), num_nodes)) );
+  REQUIRE( rejects(corrupted(nodes + offsetof(Node, right), 0)) );
+  REQUIRE( rejects(corrupted(nodes + offsetof(Node, left),
+                             quickrank::learning::forests::MappedEnsemble::LEAF
+                                 | 0x7FFFFFFF)) );
+  REQUIRE( rejects(corrupted(nodes + offsetof(Node, feature), 1000)) );
+  REQUIRE( rejects(corrupted(roots, num_nodes)) );
+  // the number of leaves in the header, made larger than the file
+  REQUIRE( rejects(corrupted(3 * sizeof(uint64_t) + 4, 1)) );
+
+  std::remove(binary_file.c_str());
+}
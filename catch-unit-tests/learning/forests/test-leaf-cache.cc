@@ -0,0 +1,95 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "catch/include/catch.hpp"
+
+#include "learning/forests/leaf_cache.h"
+#include <deque>
+#include <random>
+
+namespace {
+
+// creates a random tree of the given depth on 10 features
+RTNode *random_tree(std::deque<RTNode> &nodes, unsigned int depth,
+                    std::mt19937 &generator) {
+  std::uniform_real_distribution<float> distribution(-1, 1);
+  if (depth == 0) {
+    nodes.emplace_back((double) distribution(generator));
+    return &nodes.back();
+  }
+  const size_t feature = generator() % 10;
+  const float threshold = distribution(generator);
+  RTNode *left = random_tree(nodes, depth - 1, generator);
+  RTNode *right = random_tree(nodes, depth - 1, generator);
+  nodes.emplace_back(threshold, feature, feature + 1, left, right);
+  return &nodes.back();
+}
+
+}  // namespace
+
+TEST_CASE( "Testing LeafCache", "[learning][forests][dart]" ) {
+  std::mt19937 generator(7);
+  std::deque<RTNode> nodes;
+  // the deepest tree has more than 256 leaves
+  std::vector<RTNode *> roots;
+  for (unsigned int depth: {0, 3, 9, 5})
+    roots.push_back(random_tree(nodes, depth, generator));
+
+  const size_t num_docs = 1000;
+  const size_t num_features = 10;
+  std::vector<quickrank::Feature> features(num_docs * num_features);
+  std::uniform_real_distribution<float> distribution(-1, 1);
+  for (auto &f: features)
+    f = distribution(generator);
+
+  // room for one tree in memory
+  for (bool spill: {false, true}) {
+    quickrank::learning::forests::LeafCache cache(num_docs, spill);
+    std::vector<quickrank::Score> expected(num_docs, 0.0);
+    std::vector<quickrank::Score> scores(num_docs, 0.0);
+    for (int round = 0; round < 2; ++round) {
+      for (size_t t = 0; t < roots.size(); ++t) {
+        cache.add_scores(t, roots[t], 0.5, features.data(), num_docs,
+                         num_features, 1, scores.data());
+        for (size_t i = 0; i < num_docs; ++i)
+          expected[i] += 0.5 * roots[t]->score_instance(
+              features.data() + i * num_features, 1);
+      }
+      for (size_t i = 0; i < num_docs; ++i)
+        REQUIRE( scores[i] == expected[i] );
+    }
+    REQUIRE( cache.memory_bytes() == num_docs );
+    REQUIRE( cache.spilled_bytes() == (spill ? 4 * num_docs : 0) );
+
+    // trees 2 and 3 move to indices 0 and 1
+    cache.filter_out_zero_weighted_trees({0.0, 0.0, 1.0, 1.0});
+    REQUIRE( cache.memory_bytes() == 0 );
+    for (size_t t = 0; t < 2; ++t)
+      cache.add_scores(t, roots[t + 2], -0.5, features.data(), num_docs,
+                       num_features, 1, scores.data());
+    for (size_t i = 0; i < num_docs; ++i) {
+      const quickrank::Feature *d = features.data() + i * num_features;
+      REQUIRE( scores[i] == Approx(expected[i]
+                                   - 0.5 * roots[2]->score_instance(d, 1)
+                                   - 0.5 * roots[3]->score_instance(d, 1)) );
+    }
+  }
+}
@@ -0,0 +1,112 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "catch/include/catch.hpp"
+
+#include "learning/forests/mart.h"
+#include "learning/forests/randomforest.h"
+#include "metric/ir/ndcg.h"
+#include "data/dataset.h"
+#include <algorithm>
+#include <random>
+#include <set>
+
+namespace {
+
+// exposes the bags drawn by a random forest
+class BaggingForest: public quickrank::learning::forests::RandomForest {
+ public:
+  BaggingForest(bool bootstrap)
+      : RandomForest(10, 1.0, 0, 10, 1, 1.0f, 1.0f, 0, 0.0f, bootstrap) {
+  }
+
+  using RandomForest::draw_bag;
+};
+
+}  // namespace
+
+TEST_CASE( "Testing RandomForest bags", "[learning][forests][randomforest]" ) {
+  const size_t nsamples = 1000;
+  const size_t nbag = 600;
+  for (bool bootstrap: {false, true}) {
+    BaggingForest forest(bootstrap);
+    auto bag = forest.draw_bag(3, 42, nsamples, nbag);
+
+    // bags only depend on the seed and the tree
+    REQUIRE( bag == forest.draw_bag(3, 42, nsamples, nbag) );
+    REQUIRE( bag != forest.draw_bag(4, 42, nsamples, nbag) );
+    REQUIRE( bag != forest.draw_bag(3, 43, nsamples, nbag) );
+
+    REQUIRE( bag.size() == nbag );
+    REQUIRE( std::is_sorted(bag.begin(), bag.end()) );
+    REQUIRE( bag.back() < nsamples );
+    // samples are repeated only with replacement
+    const size_t distinct = std::set<size_t>(bag.begin(), bag.end()).size();
+    if (bootstrap)
+      REQUIRE( distinct < nbag );
+    else
+      REQUIRE( distinct == nbag );
+  }
+
+  // without replacement, a bag as large as the training set is all of it
+  auto full_bag = BaggingForest(false).draw_bag(0, 42, nsamples, nsamples);
+  for (size_t i = 0; i < nsamples; ++i)
+    REQUIRE( full_bag[i] == i );
+}
+
+TEST_CASE( "Testing RandomForest full bag",
+           "[learning][forests][randomforest]" ) {
+  const size_t nqueries = 10;
+  const size_t nresults = 20;
+  const size_t nfeatures = 4;
+
+  std::mt19937 rng(5);
+  std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+  auto dataset = std::make_shared<quickrank::data::Dataset>(
+      nqueries * nresults, nfeatures);
+  for (size_t q = 0; q < nqueries; ++q) {
+    for (size_t r = 0; r < nresults; ++r) {
+      std::vector<quickrank::Feature> features;
+      for (size_t f = 0; f < nfeatures; ++f)
+        features.push_back(uniform(rng));
+      dataset->addInstance(q, (quickrank::Label) (int) (features[0] * 5), features);
+    }
+  }
+
+  auto metric = std::shared_ptr<quickrank::metric::ir::Metric>(
+      new quickrank::metric::ir::Ndcg(10));
+
+  // a tree grown on the shared histogram of all the samples is the first
+  // tree of a MART, fitted on the labels
+  quickrank::learning::forests::RandomForest forest(1, 1.0, 0, 10, 1, 1.0f,
+                                                    1.0f, 0, 0.0f, false);
+  quickrank::learning::forests::Mart mart(1, 1.0, 0, 10, 1, 1.0f, 1.0f, 0,
+                                          0.0f);
+  forest.learn(dataset, nullptr, metric, 0, "");
+  mart.learn(dataset, nullptr, metric, 0, "");
+
+  std::vector<quickrank::Score> forest_scores(dataset->num_instances());
+  std::vector<quickrank::Score> mart_scores(dataset->num_instances());
+  forest.score_dataset(dataset, forest_scores.data());
+  mart.score_dataset(dataset, mart_scores.data());
+  REQUIRE( forest_scores == mart_scores );
+  REQUIRE( metric->evaluate_dataset(dataset, forest_scores.data()) > 0.9 );
+}
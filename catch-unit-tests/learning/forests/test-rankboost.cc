@@ -31,6 +31,7 @@
 #include "io/svml.h"
 #include <cmath>
 #include <iomanip>
+#include <random>
 
 TEST_CASE( "Testing RankBoost", "[learning][forests][rankboost]" ) {
 
@@ -130,3 +131,45 @@ TEST_CASE( "Testing RankBoost", "[learning][forests][rankboost]" ) {
   REQUIRE( validation_score >= 0.4208);
   REQUIRE( test_score >= 0.3108);
 }
+
+TEST_CASE( "Testing RankBoost preference pairs",
+           "[learning][forests][rankboost]" ) {
+  const size_t nqueries = 20;
+  const size_t nresults = 30;
+  const size_t nfeatures = 5;
+
+  // the same queries, with results in increasing and decreasing label order
+  std::mt19937 rng(3);
+  std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+  auto increasing = std::make_shared<quickrank::data::Dataset>(
+      nqueries * nresults, nfeatures);
+  auto decreasing = std::make_shared<quickrank::data::Dataset>(
+      nqueries * nresults, nfeatures);
+  for (size_t q = 0; q < nqueries; ++q) {
+    std::vector<std::vector<quickrank::Feature>> results(nresults);
+    for (size_t r = 0; r < nresults; ++r) {
+      for (size_t f = 0; f < nfeatures; ++f)
+        results[r].push_back(uniform(rng) + (f == 0 ? 0.05f * r : 0.0f));
+      increasing->addInstance(q, (quickrank::Label) r, results[r]);
+    }
+    for (size_t r = nresults; r-- > 0; )
+      decreasing->addInstance(q, (quickrank::Label) r, results[r]);
+  }
+
+  auto metric = std::shared_ptr<quickrank::metric::ir::Metric>(
+      new quickrank::metric::ir::Ndcg(10));
+
+  // all the preference pairs are used, whatever the order of the results
+  quickrank::learning::forests::Rankboost on_increasing(10);
+  quickrank::learning::forests::Rankboost on_decreasing(10);
+  on_increasing.learn(increasing, nullptr, metric, 0, "");
+  on_decreasing.learn(decreasing, nullptr, metric, 0, "");
+
+  std::vector<quickrank::Score> scores(increasing->num_instances());
+  on_increasing.score_dataset(increasing, &scores[0]);
+  quickrank::MetricScore score = metric->evaluate_dataset(increasing,
+                                                          &scores[0]);
+  on_decreasing.score_dataset(increasing, &scores[0]);
+  REQUIRE( metric->evaluate_dataset(increasing, &scores[0]) == score );
+  REQUIRE( score > 0.5 );
+}
@@ -30,6 +30,7 @@
 #include "io/svml.h"
 #include <cmath>
 #include <iomanip>
+#include <random>
 
 TEST_CASE( "Testing LineSearch", "[linear][learning][linesearch]" ) {
 
@@ -132,3 +133,29 @@ TEST_CASE( "Testing LineSearch", "[linear][learning][linesearch]" ) {
   REQUIRE( validation_score >= 0.2307);
   REQUIRE( test_score >= 0.2484);
 }
+
+TEST_CASE( "Testing LineSearch feature ids",
+           "[linear][learning][linesearch]" ) {
+  // a dataset holding only the features 2, 5 and 9
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+  auto dataset = std::make_shared<quickrank::data::Dataset>(100, 3);
+  for (size_t q = 0; q < 10; ++q)
+    for (size_t r = 0; r < 10; ++r)
+      dataset->addInstance(q, (quickrank::Label) (r % 3),
+                           {uniform(rng), uniform(rng), uniform(rng)});
+  dataset->set_feature_ids({2, 5, 9});
+
+  auto metric = std::shared_ptr<quickrank::metric::ir::Metric>(
+      new quickrank::metric::ir::Ndcg(10));
+  quickrank::learning::linear::LineSearch line_search(5, 1.0, 0.9, 2, 2,
+                                                      false);
+  line_search.learn(dataset, nullptr, metric, 0, "");
+
+  // the model refers to the original feature ids
+  std::unique_ptr<pugi::xml_document> model(line_search.get_xml_model());
+  std::vector<unsigned int> indices;
+  for (const auto &tree: model->child("ranker").child("ensemble").children())
+    indices.push_back(tree.child("index").text().as_uint());
+  REQUIRE( indices == std::vector<unsigned int>({2, 5, 9}) );
+}
@@ -0,0 +1,158 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "catch/include/catch.hpp"
+
+#include "learning/forests/obliviousmart.h"
+#include "metric/ir/ndcg.h"
+#include "data/dataset.h"
+#include <map>
+#include <random>
+
+namespace {
+
+// checks every oblivious tree grown by the ranker against a brute-force
+// visit of the samples it is fitted on
+class CheckedObliviousMart: public quickrank::learning::forests::ObliviousMart {
+ public:
+  CheckedObliviousMart(size_t treedepth, size_t minleafsupport,
+                       const std::vector<quickrank::Feature> &rows,
+                       size_t nfeatures)
+      : ObliviousMart(3, 0.1, 32, treedepth, minleafsupport, 1.0f, 1.0f, 0,
+                      0.0f), rows_(rows), nfeatures_(nfeatures) {
+  }
+
+  // depth of the trees grown
+  std::vector<size_t> depths;
+
+ protected:
+  virtual std::unique_ptr<RegressionTree> fit_regressor_on_gradient(
+      std::shared_ptr<quickrank::data::VerticalDataset> training_dataset,
+      size_t *sampleids) {
+    auto tree = ObliviousMart::fit_regressor_on_gradient(training_dataset,
+                                                         sampleids);
+    const size_t nsampleids =
+        hist_->count[0][hist_->thresholds_size[0] - 1];
+
+    // the nodes of every level share the same split
+    std::vector<const RTNode *> level(1, tree->get_proot());
+    while (!level[0]->is_leaf()) {
+      std::vector<const RTNode *> next;
+      for (const RTNode *node: level) {
+        REQUIRE( !node->is_leaf() );
+        REQUIRE( node->get_feature_idx() == level[0]->get_feature_idx() );
+        REQUIRE( node->threshold == level[0]->threshold );
+        next.push_back(node->left);
+        next.push_back(node->right);
+      }
+      level.swap(next);
+    }
+    for (const RTNode *node: level)
+      REQUIRE( node->is_leaf() );
+    size_t depth = 0;
+    while ((size_t(1) << depth) < level.size())
+      ++depth;
+    depths.push_back(depth);
+
+    // every leaf holds the mean pseudo-response of its samples
+    std::map<const RTNode *, std::pair<double, size_t>> leaves;
+    for (size_t i = 0; i < nsampleids; ++i) {
+      const size_t k = sampleids[i];
+      const RTNode *node = tree->get_proot();
+      while (!node->is_leaf())
+        node = rows_[k * nfeatures_ + node->get_feature_idx()]
+            <= node->threshold ? node->left : node->right;
+      leaves[node].first += pseudoresponses_[k];
+      leaves[node].second++;
+    }
+    REQUIRE( leaves.size() == level.size() );
+    for (const auto &leaf: leaves) {
+      REQUIRE( leaf.second.second >= minleafsupport_ );
+      REQUIRE( leaf.first->avglabel ==
+          Approx(leaf.second.first / leaf.second.second) );
+    }
+    return tree;
+  }
+
+ private:
+  const std::vector<quickrank::Feature> &rows_;
+  const size_t nfeatures_;
+};
+
+}  // namespace
+
+TEST_CASE( "Testing ObliviousRT", "[learning][tree][oblivious]" ) {
+  const size_t nqueries = 128;
+  const size_t nresults = 32;
+  const size_t ninstances = nqueries * nresults;
+  // a feature for every bit of the instance id, and labels summing the bits:
+  // the best split of a level is on an unused bit, which splits all the
+  // leaves in halves; a few uniform features fill many bins
+  const size_t nbits = 12;
+  const size_t nfeatures = nbits + 4;
+
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+  std::vector<quickrank::Feature> rows(ninstances * nfeatures);
+  std::vector<quickrank::Feature> columns(ninstances * nfeatures);
+  std::vector<quickrank::Label> labels(ninstances);
+  for (size_t i = 0; i < ninstances; ++i) {
+    for (size_t f = 0; f < nfeatures; ++f)
+      rows[i * nfeatures + f] = f < nbits ? (i >> f) & 1 : uniform(rng);
+    labels[i] = (quickrank::Label) __builtin_popcount(i);
+    for (size_t f = 0; f < nfeatures; ++f)
+      columns[f * ninstances + i] = rows[i * nfeatures + f];
+  }
+  std::vector<size_t> offsets(nqueries + 1);
+  for (size_t q = 0; q <= nqueries; ++q)
+    offsets[q] = q * nresults;
+
+  auto metric = std::shared_ptr<quickrank::metric::ir::Metric>(
+      new quickrank::metric::ir::Ndcg(10));
+
+  // byte leaf ids, two bytes leaf ids, and a level stopped by the leaf size
+  struct Config {
+    size_t treedepth, minleafsupport, depth;
+  };
+  for (const Config &config: {Config{6, 1, 6}, Config{10, 1, 10},
+                              Config{10, ninstances / 8, 3}}) {
+    // in memory by row, in place by column and binned out-of-core
+    for (size_t training = 0; training < 3; ++training) {
+      auto dataset = training == 1 ?
+          quickrank::data::Dataset::wrap(ninstances, nfeatures, nqueries,
+                                         offsets.data(), labels.data(),
+                                         columns.data(),
+                                         quickrank::data::Dataset::COLUMNS) :
+          quickrank::data::Dataset::wrap(ninstances, nfeatures, nqueries,
+                                         offsets.data(), labels.data(),
+                                         rows.data());
+      CheckedObliviousMart ranker(config.treedepth, config.minleafsupport,
+                                  rows, nfeatures);
+      if (training == 2)
+        ranker.set_out_of_core(".", 1000);
+      ranker.learn(dataset, nullptr, metric, 0, "");
+
+      REQUIRE( ranker.depths.size() == 3 );
+      for (size_t depth: ranker.depths)
+        REQUIRE( depth == config.depth );
+    }
+  }
+}
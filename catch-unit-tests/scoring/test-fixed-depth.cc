@@ -0,0 +1,121 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "catch/include/catch.hpp"
+
+#include "scoring/fixed_depth.h"
+#include "scoring/fixed_depth_tree.h"
+#include "scoring/tree_visit.h"
+#include <deque>
+#include <random>
+
+namespace {
+
+// creates a random tree of the given depth, oblivious (with the splits of
+// the given levels) or with leaves at random depths
+RTNode *random_tree(std::deque<RTNode> &nodes, unsigned int depth,
+                    std::mt19937 &generator,
+                    const std::vector<size_t> &level_features = {},
+                    const std::vector<float> &level_thresholds = {}) {
+  std::uniform_real_distribution<float> distribution(-1, 1);
+  const bool oblivious = !level_features.empty();
+  const size_t level = level_features.size() - depth;
+  if (depth == 0 || (!oblivious && generator() % 5 == 0)) {
+    nodes.emplace_back((double) distribution(generator));
+    return &nodes.back();
+  }
+  const size_t feature =
+      oblivious ? level_features[level] : generator() % 10;
+  const float threshold =
+      oblivious ? level_thresholds[level] : distribution(generator);
+  RTNode *left = random_tree(nodes, depth - 1, generator, level_features,
+                             level_thresholds);
+  RTNode *right = random_tree(nodes, depth - 1, generator, level_features,
+                              level_thresholds);
+  nodes.emplace_back(threshold, feature, feature + 1, left, right);
+  return &nodes.back();
+}
+
+RTNode *random_oblivious_tree(std::deque<RTNode> &nodes, unsigned int depth,
+                              std::mt19937 &generator) {
+  std::uniform_real_distribution<float> distribution(-1, 1);
+  std::vector<size_t> features;
+  std::vector<float> thresholds;
+  for (unsigned int l = 0; l < depth; ++l) {
+    features.push_back(generator() % 10);
+    thresholds.push_back(distribution(generator));
+  }
+  return random_tree(nodes, depth, generator, features, thresholds);
+}
+
+}  // namespace
+
+TEST_CASE( "Testing unrolled evaluators", "[scoring][unrolled]" ) {
+  // complete tree of depth 2: v[0] <= 0, then v[1] <= 1 or v[2] <= 2
+  const uint32_t features[] = {0, 1, 2};
+  const float thresholds[] = {0.0f, 1.0f, 2.0f};
+  const float v[] = {0.5f, 3.0f, 1.5f};
+  REQUIRE( quickrank::scoring::complete_tree_leaf<2>(features, thresholds, v)
+               == 2 );
+  REQUIRE( quickrank::scoring::oblivious_tree_leaf<2>(features, thresholds, v)
+               == 3 );
+  REQUIRE( quickrank::scoring::oblivious_tree_leaf<0>(features, thresholds, v)
+               == 0 );
+}
+
+TEST_CASE( "Testing unrolled engine", "[scoring][unrolled]" ) {
+  std::mt19937 generator(11);
+  std::deque<RTNode> nodes;
+
+  quickrank::scoring::FixedDepth engine;
+  quickrank::scoring::TreeVisit visit;
+  size_t num_oblivious = 0;
+  for (unsigned int depth = 0; depth <= 10; ++depth) {
+    for (bool oblivious: {true, false}) {
+      RTNode *root = oblivious ?
+                     random_oblivious_tree(nodes, depth, generator) :
+                     random_tree(nodes, depth, generator);
+      REQUIRE( engine.add_tree(root, 0.5 + depth) );
+      REQUIRE( visit.add_tree(root, 0.5 + depth) );
+      num_oblivious += oblivious;
+    }
+  }
+  REQUIRE( engine.num_trees() == 22 );
+  // random trees of depth 0 and 1 are oblivious too
+  REQUIRE( engine.num_oblivious_trees() >= num_oblivious );
+
+  // too deep
+  quickrank::scoring::FixedDepth deep_engine;
+  REQUIRE( !deep_engine.add_tree(random_oblivious_tree(nodes, 11, generator),
+                                 1.0) );
+
+  const size_t num_docs = 333;
+  const size_t num_features = 10;
+  std::vector<quickrank::Feature> features(num_docs * num_features);
+  std::uniform_real_distribution<float> distribution(-1, 1);
+  for (auto &f: features)
+    f = distribution(generator);
+  std::vector<quickrank::Score> scores(num_docs, 1.0), expected(num_docs, 1.0);
+  engine.add_scores(features.data(), num_docs, num_features, scores.data());
+  visit.add_scores(features.data(), num_docs, num_features, expected.data());
+  for (size_t i = 0; i < num_docs; ++i)
+    REQUIRE( scores[i] == expected[i] );
+}
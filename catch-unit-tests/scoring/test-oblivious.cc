@@ -0,0 +1,112 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "catch/include/catch.hpp"
+
+#include "scoring/oblivious.h"
+#include "scoring/tree_visit.h"
+#include <cmath>
+#include <deque>
+#include <limits>
+#include <random>
+
+namespace {
+
+// creates an oblivious tree with the splits of the given levels
+RTNode *oblivious_tree(std::deque<RTNode> &nodes,
+                       const std::vector<size_t> &features,
+                       const std::vector<float> &thresholds, size_t level,
+                       std::mt19937 &generator) {
+  std::uniform_real_distribution<float> distribution(-1, 1);
+  if (level == features.size()) {
+    nodes.emplace_back((double) distribution(generator));
+    return &nodes.back();
+  }
+  RTNode *left = oblivious_tree(nodes, features, thresholds, level + 1,
+                                generator);
+  RTNode *right = oblivious_tree(nodes, features, thresholds, level + 1,
+                                 generator);
+  nodes.emplace_back(thresholds[level], features[level],
+                     features[level] + 1, left, right);
+  return &nodes.back();
+}
+
+RTNode *random_oblivious_tree(std::deque<RTNode> &nodes, unsigned int depth,
+                              std::mt19937 &generator) {
+  std::uniform_real_distribution<float> distribution(-1, 1);
+  std::vector<size_t> features;
+  std::vector<float> thresholds;
+  for (unsigned int l = 0; l < depth; ++l) {
+    features.push_back(generator() % 10);
+    thresholds.push_back(distribution(generator));
+  }
+  return oblivious_tree(nodes, features, thresholds, 0, generator);
+}
+
+}  // namespace
+
+TEST_CASE( "Testing oblivious engine", "[scoring][oblivious]" ) {
+  std::mt19937 generator(13);
+  std::deque<RTNode> nodes;
+
+  quickrank::scoring::ObliviousScorer engine;
+  quickrank::scoring::TreeVisit visit;
+  for (unsigned int depth = 0; depth <= 12; ++depth) {
+    RTNode *root = random_oblivious_tree(nodes, depth, generator);
+    REQUIRE( engine.add_tree(root, 0.5 + depth) );
+    REQUIRE( visit.add_tree(root, 0.5 + depth) );
+  }
+  REQUIRE( engine.num_trees() == 13 );
+
+  // too deep, or not oblivious
+  REQUIRE( !engine.add_tree(random_oblivious_tree(nodes, 17, generator),
+                            1.0) );
+  std::vector<size_t> features = {1, 2};
+  std::vector<float> thresholds = {0.0f, 0.5f};
+  RTNode *root = oblivious_tree(nodes, features, thresholds, 0, generator);
+  root->right->threshold = 0.25f;
+  REQUIRE( !engine.add_tree(root, 1.0) );
+  REQUIRE( engine.num_trees() == 13 );
+
+  // a tail shorter than a vector of documents, and some missing values
+  const size_t num_docs = 333;
+  const size_t num_features = 10;
+  std::vector<quickrank::Feature> docs(num_docs * num_features);
+  std::uniform_real_distribution<float> distribution(-1, 1);
+  for (auto &f: docs)
+    f = generator() % 50 ? distribution(generator) :
+        std::numeric_limits<float>::quiet_NaN();
+  std::vector<quickrank::Score> scores(num_docs, 1.0), expected(num_docs, 1.0);
+  engine.add_scores(docs.data(), num_docs, num_features, scores.data());
+  visit.add_scores(docs.data(), num_docs, num_features, expected.data());
+  for (size_t i = 0; i < num_docs; ++i)
+    REQUIRE( scores[i] == expected[i] );
+
+  // documents stored by column
+  std::vector<quickrank::Feature> columns(num_docs * num_features);
+  for (size_t i = 0; i < num_docs; ++i)
+    for (size_t f = 0; f < num_features; ++f)
+      columns[f * num_docs + i] = docs[i * num_features + f];
+  std::fill(scores.begin(), scores.end(), 1.0);
+  engine.add_column_scores(columns.data(), num_docs, num_docs, scores.data());
+  for (size_t i = 0; i < num_docs; ++i)
+    REQUIRE( scores[i] == expected[i] );
+}
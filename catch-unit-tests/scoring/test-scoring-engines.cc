@@ -0,0 +1,171 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "catch/include/catch.hpp"
+
+#include "learning/forests/mart.h"
+#include "scoring/native_scorer.h"
+#include "scoring/oblivious.h"
+#include "scoring/scoring_engine_factory.h"
+#include "scoring/vpred.h"
+#include <cstdlib>
+#include <random>
+#include <unistd.h>
+
+namespace {
+
+// appends a random tree of the given max depth
+void append_random_split(pugi::xml_node parent, const std::string &pos,
+                         size_t depth, std::mt19937 &generator) {
+  std::uniform_real_distribution<double> distribution(-1, 1);
+  pugi::xml_node split = parent.append_child("split");
+  if (!pos.empty())
+    split.append_attribute("pos") = pos.c_str();
+  if (depth == 0 || generator() % 4 == 0) {
+    split.append_child("output").text() = distribution(generator);
+    return;
+  }
+  split.append_child("feature").text() = (size_t) (generator() % 10 + 1);
+  split.append_child("threshold").text() = (float) distribution(generator);
+  append_random_split(split, "left", depth - 1, generator);
+  append_random_split(split, "right", depth - 1, generator);
+}
+
+// returns a Mart model of random trees
+std::shared_ptr<quickrank::learning::LTR_Algorithm> random_model(
+    size_t num_trees, std::mt19937 &generator) {
+  std::shared_ptr<quickrank::learning::LTR_Algorithm> mart(
+      new quickrank::learning::forests::Mart(num_trees, 0.1, 0, 10, 1, 1.0f,
+                                             1.0f, 100, 0.0f));
+  std::unique_ptr<pugi::xml_document> model(mart->get_xml_model());
+  model->child("ranker").remove_child("ensemble");
+  pugi::xml_node ensemble = model->child("ranker").append_child("ensemble");
+  for (size_t t = 0; t < num_trees; ++t) {
+    pugi::xml_node tree = ensemble.append_child("tree");
+    tree.append_attribute("id") = t + 1;
+    tree.append_attribute("weight") = 0.1;
+    append_random_split(tree, "", 8, generator);
+  }
+  return std::shared_ptr<quickrank::learning::LTR_Algorithm>(
+      new quickrank::learning::forests::Mart(*model));
+}
+
+}  // namespace
+
+TEST_CASE( "Testing scoring engines", "[scoring][engines]" ) {
+  std::mt19937 generator(5);
+
+  auto ranker = random_model(30, generator);
+
+  const size_t num_docs = 501;
+  const size_t num_features = 10;
+  std::vector<quickrank::Feature> features(num_docs * num_features);
+  std::uniform_real_distribution<float> distribution(-1, 1);
+  for (auto &f: features)
+    f = distribution(generator);
+  std::vector<quickrank::Label> labels(num_docs, 0.0f);
+  std::vector<size_t> offsets = {0, num_docs};
+  auto dataset = quickrank::data::Dataset::wrap(num_docs, num_features, 1,
+                                                offsets.data(), labels.data(),
+                                                features.data());
+
+  REQUIRE( !quickrank::scoring::scoring_engine_factory("unknown") );
+
+  // every engine, and the one chosen by calibration on synthetic and on
+  // sample documents, gives the scores of the document by document visit
+  std::vector<std::string> engines =
+      quickrank::scoring::scoring_engine_names();
+  for (const auto &name: engines)
+    REQUIRE( quickrank::scoring::scoring_engine_factory(name) != nullptr );
+  engines.push_back("AUTO");
+  for (const auto &name: engines) {
+    // only oblivious trees can be scored by OBLIVIOUS
+    if (name == quickrank::scoring::ObliviousScorer::NAME_) {
+      REQUIRE( !ranker->set_scoring_engine(name) );
+      continue;
+    }
+    REQUIRE( ranker->set_scoring_engine(name) );
+    std::vector<quickrank::Score> scores(num_docs, -1.0);
+    ranker->score_dataset(dataset, scores.data());
+    for (size_t i = 0; i < num_docs; ++i)
+      REQUIRE( scores[i] ==
+          ranker->score_document(features.data() + i * num_features) );
+  }
+  // calibration logs the timings without changing the format of std::cout
+  const std::streamsize precision = std::cout.precision();
+  REQUIRE( ranker->set_scoring_engine("auto", dataset) );
+  REQUIRE( std::cout.precision() == precision );
+  std::vector<quickrank::Score> scores(num_docs, -1.0);
+  ranker->score_dataset(dataset, scores.data());
+  for (size_t i = 0; i < num_docs; ++i)
+    REQUIRE( scores[i] ==
+        ranker->score_document(features.data() + i * num_features) );
+}
+
+TEST_CASE( "Testing native scorer", "[scoring][engines][native]" ) {
+  // the model is compiled with the system compiler
+  if (std::system("cc --version > /dev/null 2>&1") != 0)
+    return;
+
+  char cache[] = "/tmp/quickrank-test-XXXXXX";
+  REQUIRE( mkdtemp(cache) != nullptr );
+  quickrank::scoring::NativeScorer::set_cache_directory(cache);
+
+  std::mt19937 generator(7);
+  auto ranker = random_model(40, generator);
+
+  const size_t num_docs = 301;
+  const size_t num_features = 10;
+  std::vector<quickrank::Feature> features(num_docs * num_features);
+  std::uniform_real_distribution<float> distribution(-1, 1);
+  for (auto &f: features)
+    f = distribution(generator);
+  std::vector<quickrank::Label> labels(num_docs, 0.0f);
+  std::vector<size_t> offsets = {0, num_docs};
+  auto dataset = quickrank::data::Dataset::wrap(num_docs, num_features, 1,
+                                                offsets.data(), labels.data(),
+                                                features.data());
+
+  std::vector<quickrank::Score> expected(num_docs, -1.0);
+  ranker->set_scoring_engine(quickrank::scoring::VPred::NAME_);
+  ranker->score_dataset(dataset, expected.data());
+
+  // the first scoring compiles the model, the second one loads it from cache
+  for (size_t round = 0; round < 2; ++round) {
+    ranker->set_scoring_engine(quickrank::scoring::NativeScorer::NAME_);
+    std::vector<quickrank::Score> scores(num_docs, -1.0);
+    ranker->score_dataset(dataset, scores.data());
+    for (size_t i = 0; i < num_docs; ++i)
+      REQUIRE( scores[i] == Approx(expected[i]) );
+  }
+
+  // a model which cannot be compiled leaves no files behind
+  auto other = random_model(5, generator);
+  quickrank::scoring::NativeScorer::set_compiler("false");
+  REQUIRE( !other->set_scoring_engine(
+      quickrank::scoring::NativeScorer::NAME_) );
+  quickrank::scoring::NativeScorer::set_compiler("cc -O2 -march=native");
+  const std::string count = std::string("test $(ls ") + cache
+      + " | wc -l) -eq 1";
+  REQUIRE( std::system(count.c_str()) == 0 );
+
+  std::system((std::string("rm -rf ") + cache).c_str());
+}
@@ -0,0 +1,123 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "catch/include/catch.hpp"
+
+#include "learning/forests/mart.h"
+#include "learning/tree/rtnode_arena.h"
+#include "scoring/vpred.h"
+#include <cmath>
+#include <random>
+
+namespace {
+
+// appends a random (unbalanced) tree of the given max depth
+void append_random_split(pugi::xml_node parent, const std::string &pos,
+                         size_t depth, std::mt19937 &generator) {
+  std::uniform_real_distribution<double> distribution(-1, 1);
+  pugi::xml_node split = parent.append_child("split");
+  if (!pos.empty())
+    split.append_attribute("pos") = pos.c_str();
+  if (depth == 0 || generator() % 4 == 0) {
+    split.append_child("output").text() = distribution(generator);
+    return;
+  }
+  split.append_child("feature").text() = (size_t) (generator() % 10 + 1);
+  split.append_child("threshold").text() = (float) distribution(generator);
+  append_random_split(split, "left", depth - 1, generator);
+  append_random_split(split, "right", depth - 1, generator);
+}
+
+}  // namespace
+
+TEST_CASE( "Testing VPred scoring", "[scoring][vpred]" ) {
+  std::mt19937 generator(11);
+
+  std::shared_ptr<quickrank::learning::LTR_Algorithm> mart(
+      new quickrank::learning::forests::Mart(40, 0.1, 0, 10, 1, 1.0f, 1.0f,
+                                             100, 0.0f));
+  std::unique_ptr<pugi::xml_document> model(mart->get_xml_model());
+  model->child("ranker").remove_child("ensemble");
+  pugi::xml_node ensemble = model->child("ranker").append_child("ensemble");
+  for (size_t t = 0; t < 40; ++t) {
+    pugi::xml_node tree = ensemble.append_child("tree");
+    tree.append_attribute("id") = t + 1;
+    tree.append_attribute("weight") = 0.1 * (t + 1);
+    if (t == 7)
+      tree.append_child("split").append_child("output").text() = 0.25;
+    else
+      append_random_split(tree, "", t % 12 + 1, generator);
+  }
+  std::shared_ptr<quickrank::learning::LTR_Algorithm> ranker(
+      new quickrank::learning::forests::Mart(*model));
+
+  // a number of documents which is not a multiple of the SIMD width
+  const size_t num_docs = 1003;
+  const size_t num_features = 10;
+  std::vector<quickrank::Feature> features(num_docs * num_features);
+  std::uniform_real_distribution<float> distribution(-1, 1);
+  for (auto &f: features)
+    f = distribution(generator);
+  // missing values go right, as in the visit of the trees
+  for (size_t i = 0; i < features.size(); i += 97)
+    features[i] = std::nanf("");
+  std::vector<quickrank::Label> labels(num_docs, 0.0f);
+  std::vector<size_t> offsets = {0, num_docs};
+  auto dataset = quickrank::data::Dataset::wrap(num_docs, num_features, 1,
+                                                offsets.data(), labels.data(),
+                                                features.data());
+
+  std::vector<quickrank::Score> scores(num_docs, -1.0);
+  ranker->score_dataset(dataset, scores.data());
+  for (size_t i = 0; i < num_docs; ++i)
+    REQUIRE( scores[i] ==
+        ranker->score_document(features.data() + i * num_features) );
+
+  // scores are added to the given ones
+  quickrank::scoring::VPred empty;
+  REQUIRE( empty.num_trees() == 0 );
+  std::vector<quickrank::Score> updated(num_docs, 1.0);
+  empty.add_scores(features.data(), num_docs, num_features, updated.data());
+  for (size_t i = 0; i < num_docs; ++i)
+    REQUIRE( updated[i] == 1.0 );
+
+  // a small cache splits both trees and documents in many tiles, a cache
+  // larger than the whole model and data scores them in a single tile
+  RTNodeArena nodes;
+  quickrank::scoring::VPred flat, tiled;
+  flat.set_cache_size(size_t(1) << 40);
+  tiled.set_cache_size(2048);
+  for (auto tree: ensemble.children("tree")) {
+    RTNode *root = RTNode::parse_xml(tree.child("split"), nodes);
+    flat.add_tree(root, tree.attribute("weight").as_double());
+    tiled.add_tree(root, tree.attribute("weight").as_double());
+  }
+  REQUIRE( tiled.num_trees() == 40 );
+  std::vector<quickrank::Score> flat_scores(num_docs, 1.0);
+  flat.add_scores(features.data(), num_docs, num_features,
+                  flat_scores.data());
+  std::fill(updated.begin(), updated.end(), 1.0);
+  tiled.add_scores(features.data(), num_docs, num_features, updated.data());
+  for (size_t i = 0; i < num_docs; ++i) {
+    REQUIRE( flat_scores[i] == Approx(scores[i] + 1.0) );
+    REQUIRE( updated[i] == flat_scores[i] );
+  }
+}
@@ -0,0 +1,69 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "catch/include/catch.hpp"
+
+#include "utils/dtoa.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+TEST_CASE( "Testing fast decimal parsing", "[utils][dtoa]" ) {
+  const char *numbers[] = {"0", "-0", "1", "-2.5", "0.1", "1e5", "1E-5",
+                           "  3.25", "+7", "0.14054054054054055",
+                           "0.603959978", "1e+300", "-1e-320", "nan", "inf",
+                           "12345678901234567890123", "0.000000000000000000001",
+                           "9007199254740993", "1.7976931348623157e308",
+                           "2.2250738585072014e-308", "abc", "", ".5", "5.",
+                           "1e", "0x10"};
+  for (const char *number: numbers) {
+    double expected = strtod(number, NULL);
+    double value = chars_to_double(number);
+    if (expected != expected) {
+      REQUIRE( value != value );
+    } else {
+      REQUIRE( value == expected );
+      REQUIRE( std::signbit(value) == std::signbit(expected) );
+    }
+  }
+
+  std::mt19937_64 generator(5);
+  char buffer[64];
+  for (size_t i = 0; i < 1000000; ++i) {
+    uint64_t bits = generator();
+    double d;
+    std::memcpy(&d, &bits, sizeof(d));
+    if (d != d)
+      continue;  // nan
+
+    // numbers as written in XML models, and random decimal strings
+    snprintf(buffer, sizeof(buffer), "%.17g", d);
+    REQUIRE( chars_to_double(buffer) == strtod(buffer, NULL) );
+    snprintf(buffer, sizeof(buffer), "%.9g", (float) (d * 1e-300));
+    REQUIRE( chars_to_float(buffer) == (float) strtod(buffer, NULL) );
+    snprintf(buffer, sizeof(buffer), "%llu.%llue%d",
+             (unsigned long long) (generator() % 10000000000ull),
+             (unsigned long long) (generator() % 1000000000ull),
+             (int) (generator() % 40) - 20);
+    REQUIRE( chars_to_double(buffer) == strtod(buffer, NULL) );
+  }
+}
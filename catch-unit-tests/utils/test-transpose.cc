@@ -0,0 +1,43 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "catch/include/catch.hpp"
+
+#include "utils/transpose.h"
+#include <vector>
+
+TEST_CASE( "Testing matrix transposition", "[utils][transpose]" ) {
+  // tiles and blocks do not divide the sizes
+  for (auto size: std::vector<std::pair<size_t, size_t>>{
+      {1, 1}, {1, 9}, {9, 1}, {3, 5}, {67, 131}, {130, 130}, {1000, 7}}) {
+    const size_t n = size.first, m = size.second;
+    std::vector<float> input(n * m);
+    for (size_t i = 0; i < input.size(); ++i)
+      input[i] = i;
+
+    std::vector<float> output(n * m, -1.0f);
+    transpose(output.data(), input.data(), n, m);
+
+    for (size_t r = 0; r < n; ++r)
+      for (size_t c = 0; c < m; ++c)
+        REQUIRE( output[c * n + r] == input[r * m + c] );
+  }
+}
@@ -0,0 +1,151 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "types.h"
+#include "data/binned_features.h"
+#include "data/dataset.h"
+
+namespace quickrank {
+namespace data {
+
+/**
+ * This class implements an out-of-core store of discretized features.
+ *
+ * The training instances are split into shards of consecutive queries. Each
+ * shard is a memory-mapped file holding, for every feature, the column of bin
+ * ids of the documents in the shard (i.e., the index of the first threshold
+ * greater than or equal to the feature value). Bin ids are stored on 1, 2 or
+ * 4 bytes depending on the largest number of thresholds.
+ *
+ * Shard files are unlinked as soon as they are mapped, so that the kernel is
+ * free to page them out and the disk space is released when the store is
+ * destroyed. Without a directory, shards are anonymous (in-memory) mappings.
+ * Histogram construction streams the shards in order, thus it
+ * requires sample ids sorted in ascending order.
+ */
+class BinnedColumnStore : public BinnedFeatures {
+ public:
+
+  /// Discretizes the given dataset and writes it into memory-mapped shards.
+  ///
+  /// \param directory The directory where shard files are created (empty
+  ///     for an in-memory store).
+  /// \param dataset The horizontal dataset to be discretized.
+  /// \param shard_size The minimum number of instances per shard (shards are
+  ///     aligned to query boundaries).
+  /// \param thresholds The thresholds of every feature (last one is FLT_MAX).
+  /// \param thresholds_size The number of thresholds of every feature.
+  BinnedColumnStore(const std::string &directory,
+                    std::shared_ptr<Dataset> dataset,
+                    size_t shard_size,
+                    float **thresholds,
+                    size_t *thresholds_size);
+  virtual ~BinnedColumnStore();
+
+  /// Avoid inefficient copy constructor
+  BinnedColumnStore(const BinnedColumnStore &other) = delete;
+  /// Avoid inefficient copy assignment
+  BinnedColumnStore &operator=(const BinnedColumnStore &) = delete;
+
+  /// Accumulates the (non cumulative) label sums and counts of every bin of
+  /// every feature, streaming the shards in order.
+  virtual void histogram(const size_t *sampleids, size_t nsampleids,
+                         const double *labels,
+                         double **sumlbl, size_t **count) const;
+
+  virtual void partition(size_t feature_id, size_t bin,
+                         const size_t *sampleids, size_t nsampleids,
+                         size_t *lsamples, size_t &lsize,
+                         size_t *rsamples, size_t &rsize) const;
+
+  virtual size_t bin(size_t shard, size_t document_id,
+                     size_t feature_id) const {
+    const size_t i = document_id - shard_offsets_[shard]
+        + feature_id * shard_length(shard);
+    switch (bin_width_) {
+      case 1:
+        return ((const uint8_t *) shards_[shard])[i];
+      case 2:
+        return ((const uint16_t *) shards_[shard])[i];
+      default:
+        return ((const uint32_t *) shards_[shard])[i];
+    }
+  }
+
+  /// Hints the kernel that the given shard is going to be read soon.
+  virtual void prefetch(size_t shard) const;
+
+  virtual size_t num_shards() const {
+    return shards_.size();
+  }
+  virtual size_t shard_begin(size_t shard) const {
+    return shard_offsets_[shard];
+  }
+  virtual size_t shard_end(size_t shard) const {
+    return shard_offsets_[shard + 1];
+  }
+
+ private:
+
+  size_t bin_width_;
+
+  std::string directory_;
+  std::vector<size_t> shard_offsets_;
+  std::vector<void *> shards_;
+  std::vector<size_t> shard_bytes_;
+
+  double building_time_ = 0.0;
+
+  size_t shard_length(size_t shard) const {
+    return shard_offsets_[shard + 1] - shard_offsets_[shard];
+  }
+
+  void fill_shard(size_t shard, std::shared_ptr<Dataset> dataset);
+
+  template<typename BinType>
+  void fill_shard(size_t shard, std::shared_ptr<Dataset> dataset);
+
+  template<typename BinType>
+  void histogram(const size_t *sampleids, size_t nsampleids,
+                 const double *labels,
+                 double **sumlbl, size_t **count) const;
+
+  template<typename BinType>
+  void partition(size_t feature_id, size_t bin,
+                 const size_t *sampleids, size_t nsampleids,
+                 size_t *lsamples, size_t &lsize,
+                 size_t *rsamples, size_t &rsize) const;
+
+  /// Prints the store statistics
+  virtual std::ostream &put(std::ostream &os) const;
+
+};
+
+}  // namespace data
+}  // namespace quickrank
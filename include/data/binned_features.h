@@ -0,0 +1,128 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+
+namespace quickrank {
+namespace data {
+
+/**
+ * This class is the interface of discretized training features, used by the
+ * tree learners in place of the sorted index arrays built from a
+ * \a VerticalDataset.
+ *
+ * Every feature value is replaced by its bin id, i.e., the index of the first
+ * threshold greater than or equal to the value. Documents are organized in
+ * consecutive shards, which should be visited in order.
+ */
+class BinnedFeatures {
+ public:
+  BinnedFeatures(size_t num_features, size_t num_instances)
+      : num_features_(num_features),
+        num_instances_(num_instances) {
+  }
+  virtual ~BinnedFeatures() {
+  }
+
+  /// Accumulates the (non cumulative) label sums and counts of every bin of
+  /// every feature.
+  ///
+  /// \param sampleids The samples to be considered, sorted in ascending order.
+  /// \param nsampleids The number of samples.
+  /// \param labels The labels to be accumulated.
+  /// \param sumlbl The [nfeatures] x [thresholds_size] label sums.
+  /// \param count The [nfeatures] x [thresholds_size] counts.
+  virtual void histogram(const size_t *sampleids, size_t nsampleids,
+                         const double *labels,
+                         double **sumlbl, size_t **count) const = 0;
+
+  /// Splits the given (sorted) samples on the given feature and bin, i.e.,
+  /// samples with bin id lower or equal than \a bin go to the left. The
+  /// relative order of the samples is preserved.
+  virtual void partition(size_t feature_id, size_t bin,
+                         const size_t *sampleids, size_t nsampleids,
+                         size_t *lsamples, size_t &lsize,
+                         size_t *rsamples, size_t &rsize) const = 0;
+
+  /// Returns the bin id of a given document in a given shard.
+  ///
+  /// \param shard The shard including the document.
+  /// \param document_id The document of interest (global id).
+  /// \param feature_id The feature of interest.
+  virtual size_t bin(size_t shard, size_t document_id,
+                     size_t feature_id) const = 0;
+
+  /// Returns the bin id corresponding to a threshold of a given feature.
+  size_t threshold_bin(size_t feature_id, float threshold) const {
+    const float *t = thresholds_[feature_id];
+    return std::lower_bound(t, t + thresholds_size_[feature_id], threshold)
+        - t;
+  }
+
+  /// Hints that the given shard is going to be read soon.
+  virtual void prefetch(size_t shard) const {
+  }
+
+  /// Returns the number of shards.
+  virtual size_t num_shards() const {
+    return 1;
+  }
+  /// Returns the first document of the given shard.
+  virtual size_t shard_begin(size_t shard) const {
+    return 0;
+  }
+  /// Returns the document following the last one of the given shard.
+  virtual size_t shard_end(size_t shard) const {
+    return num_instances_;
+  }
+  /// Returns the number of features.
+  size_t num_features() const {
+    return num_features_;
+  }
+  /// Returns the number of documents.
+  size_t num_instances() const {
+    return num_instances_;
+  }
+
+ protected:
+  size_t num_features_;
+  size_t num_instances_;
+
+  float **thresholds_ = NULL;
+  size_t *thresholds_size_ = NULL;
+
+  /// The output stream operator.
+  /// Prints the binned features statistics
+  friend std::ostream &operator<<(std::ostream &os,
+                                  const BinnedFeatures &me) {
+    return me.put(os);
+  }
+
+  /// Prints the binned features statistics
+  virtual std::ostream &put(std::ostream &os) const = 0;
+};
+
+}  // namespace data
+}  // namespace quickrank
@@ -21,8 +21,10 @@
  */
 #pragma once
 
+#include <cstdint>
 #include <iostream>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "types.h"
@@ -41,15 +43,54 @@ namespace data {
  * access the internal representation through the function \a at()
  * to support fast access and custom high performance implementations.
  * Internal representation is horizontal (instances x features).
+ *
+ * A sparse Dataset stores instead only the non-zero features of every
+ * document in compressed sparse rows (CSR), so that memory scales with the
+ * number of non-zeros. Sparse rows are accessed through \a nonzero_columns()
+ * and \a nonzero_values(), or copied into a dense vector with
+ * \a fill_row(): \a at() is not available for sparse datasets.
+ *
+ * Dense features can also be stored in 16 bits (IEEE half precision or
+ * bfloat16), halving the memory footprint. They are widened to float by
+ * \a fill_row() and \a value(), while \a at() is not available.
+ *
+ * A Dataset can also be built on buffers already filled by the caller with
+ * \a wrap(), which neither copies nor frees them (unless adopted). Features
+ * can be stored row by row (FLOAT32), or feature by feature (COLUMNS): the
+ * latter are widened into rows by \a fill_row() as 16 bits features, and
+ * they are used in place (not transposed) by VerticalDataset.
+ *
+ * A loaded Dataset can be published in a named POSIX shared memory segment
+ * with \a publish_shared(), so that other processes on the same machine can
+ * attach to it read-only with \a attach_shared() instead of loading their
+ * own copy. The segment is reference counted and it is removed when the
+ * last Dataset using it is destroyed. Features of shared datasets are
+ * read-only, i.e., they can be read through \a at() but not written through
+ * \a mutable_at(). Processes terminating abnormally (e.g., killed) do not
+ * release their references, thus their segments are never removed and they
+ * remain in /dev/shm, where they can be attached again, until removed by
+ * hand.
  */
 class Dataset {
  public:
 
+  /// Storage formats of the features.
+  enum Storage {
+    FLOAT32,  ///< dense, float
+    FLOAT16,  ///< dense, IEEE half precision
+    BFLOAT16,  ///< dense, bfloat16
+    SPARSE,  ///< non-zeros only (CSR), float
+    COLUMNS  ///< dense, float, column-major (see \a wrap())
+  };
+
   /// Allocates an empty Dataset of given size in horizontal format.
   ///
   /// \param n_instances The number of training instances (lines) in the dataset.
   /// \param n_features The number of features.
-  Dataset(size_t n_instances, size_t n_features);
+  /// \param storage The storage format of the features.
+  /// \param n_nonzeros The expected number of non-zeros of a sparse dataset.
+  Dataset(size_t n_instances, size_t n_features, Storage storage = FLOAT32,
+          size_t n_nonzeros = 0);
   virtual ~Dataset();
 
   /// Avoid inefficient copy constructor
@@ -57,12 +98,50 @@ class Dataset {
   /// Avoid inefficient copy assignment
   Dataset &operator=(const Dataset &) = delete;
 
+  /// Creates a Dataset on the label and feature buffers of the caller,
+  /// without copying them. The buffers are shared with the caller (changes
+  /// made through \a mutable_at() are visible to both), and they must
+  /// outlive the Dataset unless they are adopted through \a owner (e.g.,
+  /// std::shared_ptr<void>(buffer, free)). Query offsets are small enough to
+  /// be copied.
+  ///
+  /// \param n_instances The number of instances.
+  /// \param n_features The number of features.
+  /// \param n_queries The number of queries.
+  /// \param offsets The offset of the first instance of every query, followed
+  ///     by \a n_instances (\a n_queries + 1 elements).
+  /// \param labels The labels of the instances.
+  /// \param features The features of the instances, row by row (FLOAT32) or
+  ///     feature by feature (COLUMNS).
+  /// \param storage The layout of the features (FLOAT32 or COLUMNS).
+  /// \param owner Keeps alive the buffers while the Dataset is in use (NULL
+  ///     if they are owned by the caller).
+  static std::shared_ptr<Dataset> wrap(size_t n_instances, size_t n_features,
+                                       size_t n_queries, const size_t *offsets,
+                                       Label *labels, Feature *features,
+                                       Storage storage = FLOAT32,
+                                       std::shared_ptr<void> owner = nullptr);
+
   /// Returns a pointer to a specific data item.
   ///
   /// \param document_id The document of interest.
   /// \param feature_id The feature of interest.
   /// \returns A reference to the requested feature value of the given document id.
-  quickrank::Feature *at(size_t document_id, size_t feature_id) {
+  /// \warning Available only for FLOAT32 datasets, exits on other storages
+  ///     (see \a with_float_rows()).
+  const quickrank::Feature *at(size_t document_id, size_t feature_id) const {
+    if (!has_float_features())
+      features_access_error();
+    return data_ + document_id * num_features_ + feature_id;
+  }
+
+  /// Returns a writable pointer to a specific data item.
+  ///
+  /// \warning Available only for FLOAT32 datasets not stored in a shared
+  ///     memory segment, which is read-only, exits otherwise.
+  quickrank::Feature *mutable_at(size_t document_id, size_t feature_id) {
+    if (!has_float_features() || segment_)
+      features_access_error();
     return data_ + document_id * num_features_ + feature_id;
   }
 
@@ -96,10 +175,137 @@ class Dataset {
   void addInstance(QueryID q_id, Label i_label,
                    std::vector<Feature> i_features);
 
+  /// Add a new training instance given its non-zero features.
+  ///
+  /// \param q_id The query ID.
+  /// \param i_label The relevance label of the result.
+  /// \param i_columns The columns of the non-zero features (increasing).
+  /// \param i_values The values of the non-zero features.
+  void addInstance(QueryID q_id, Label i_label,
+                   const std::vector<uint32_t> &i_columns,
+                   const std::vector<Feature> &i_values);
+
+  /// Returns the given dataset if its features are stored as a dense float
+  /// matrix, otherwise a FLOAT32 copy of it, for the algorithms accessing
+  /// the features in place through \a at().
+  static std::shared_ptr<Dataset> with_float_rows(
+      std::shared_ptr<Dataset> dataset);
+
+  /// Returns the storage format of the features.
+  Storage storage() const {
+    return storage_;
+  }
+  /// Returns true if only non-zero features are stored (CSR format).
+  bool is_sparse() const {
+    return storage_ == SPARSE;
+  }
+  /// Returns true if features are stored as a dense float matrix, i.e., they
+  /// can be accessed in place through \a at().
+  bool has_float_features() const {
+    return storage_ == FLOAT32 && !features_released_;
+  }
+  /// Returns true if features are stored feature by feature (COLUMNS).
+  bool is_column_major() const {
+    return storage_ == COLUMNS;
+  }
+  /// Returns the values of a feature of all the documents.
+  /// \warning Available only for COLUMNS datasets.
+  quickrank::Feature *column(size_t feature_id) {
+    return data_ + feature_id * num_instances_;
+  }
+
+  /// Returns the value of a specific data item, in any storage format.
+  Feature value(size_t document_id, size_t feature_id) const;
+
+  /// Returns the threshold to be used in place of \a threshold by a split
+  /// learnt on this dataset: the largest float whose rounding to the storage
+  /// format is not greater than the stored rounding of \a threshold. Splits
+  /// on the stored (rounded) features do not change, and float features not
+  /// rounded at all take the same branch as their rounding.
+  Feature split_threshold(Feature threshold) const;
+
+  /// Returns the name of the storage format.
+  static const char *storage_name(Storage storage);
+
+  /// Copies the dataset into a new POSIX shared memory segment, which is
+  /// then used in place of the private copy.
+  ///
+  /// \param name The name of the segment (e.g., "/quickrank-train").
+  /// \param key A description of the content of the dataset (e.g., source
+  ///     file and storage), checked by the processes attaching to it.
+  /// \returns False if a segment with the given name already exists.
+  bool publish_shared(const std::string &name, const std::string &key);
+
+  /// Attaches read-only to a dataset published in a POSIX shared memory
+  /// segment by \a publish_shared(), waiting for the publisher to complete.
+  ///
+  /// \param name The name of the segment.
+  /// \param key The expected description of the content of the dataset.
+  /// \returns The shared dataset, or NULL if the segment does not exist.
+  static std::shared_ptr<Dataset> attach_shared(const std::string &name,
+                                                const std::string &key);
+
+  /// Returns true if the dataset is stored in a shared memory segment.
+  bool is_shared() const {
+    return segment_ != NULL;
+  }
+
+  /// Returns the number of non-zero features of a sparse dataset.
+  size_t num_nonzeros() const {
+    return num_nonzeros_;
+  }
+  /// Returns the number of non-zero features of a document (sparse only).
+  size_t num_nonzeros(size_t document_id) const {
+    return row_offsets_data_[document_id + 1] - row_offsets_data_[document_id];
+  }
+  /// Returns the offset of the first non-zero feature of a document in the
+  /// arrays returned by \a nonzero_columns() and \a nonzero_values()
+  /// called with no arguments (sparse only).
+  size_t nonzero_offset(size_t document_id) const {
+    return row_offsets_data_[document_id];
+  }
+  /// Returns the columns of the non-zero features of a document, in
+  /// increasing order (sparse only).
+  const uint32_t *nonzero_columns(size_t document_id = 0) const {
+    return columns_data_ + row_offsets_data_[document_id];
+  }
+  /// Returns the values of the non-zero features of a document (sparse only).
+  const Feature *nonzero_values(size_t document_id = 0) const {
+    return values_data_ + row_offsets_data_[document_id];
+  }
+
+  /// Copies (and widens) the features of a document into a dense vector of
+  /// \a num_features() elements. For sparse datasets only the non-zero
+  /// features are written, thus the vector must be zero-filled, and it can
+  /// be reset later with \a clear_row().
+  void fill_row(size_t document_id, Feature *row) const;
+
+  /// Resets to zero the features of a document previously copied into a
+  /// dense vector with \a fill_row() (dense rows are simply overwritten by
+  /// the next call to \a fill_row(), so they are left untouched).
+  void clear_row(size_t document_id, Feature *row) const;
+
   /// Returns the number of features used to represent a document.
   size_t num_features() const {
     return num_features_;
   }
+
+  /// Sets the original ids of the features stored in the dataset columns,
+  /// when only a subset of the features has been loaded.
+  ///
+  /// \param feature_ids The (1-based) feature id of every column.
+  void set_feature_ids(const std::vector<size_t> &feature_ids) {
+    feature_ids_ = feature_ids;
+  }
+  /// Returns the original ids of the features stored in the dataset columns
+  /// (empty if all the features have been loaded).
+  const std::vector<size_t> &feature_ids() const {
+    return feature_ids_;
+  }
+  /// Returns the original (1-based) id of the feature in the given column.
+  size_t feature_id(size_t column) const {
+    return feature_ids_.empty() ? column + 1 : feature_ids_[column];
+  }
   /// Returns the number of queries in the dataset.
   size_t num_queries() const {
     return num_queries_;
@@ -109,6 +315,15 @@ class Dataset {
     return num_instances_;
   }
 
+  /// Frees the features of the dataset, keeping labels and queries, for
+  /// the algorithms which no longer need them (e.g., once binned). Features
+  /// cannot be accessed anymore, while sparse datasets keep the positions of
+  /// their non-zeros (see \a nonzero_columns()).
+  ///
+  /// \returns The number of bytes freed, 0 if the features are not owned by
+  ///     the dataset (external buffers or shared memory segment).
+  size_t release_features();
+
   // - support normalization
   // - support discretisation, or simply provide discr.ed thresholds
   // - support horiz. and vert. sampling
@@ -122,10 +337,60 @@ class Dataset {
   quickrank::Feature *data_ = NULL;
   quickrank::Label *labels_ = NULL;
   std::vector<size_t> offsets_;
+  std::vector<size_t> feature_ids_;
 
   size_t last_instance_id_;
   size_t max_instances_;
 
+  Storage storage_ = FLOAT32;
+  // 16 bits features (used only by FLOAT16 and BFLOAT16 datasets)
+  uint16_t *data16_ = NULL;
+
+  // compressed sparse rows (used only by sparse datasets), filled while
+  // loading and accessed through the pointers below, which refer either to
+  // these vectors or to the shared memory segment
+  std::vector<size_t> row_offsets_;
+  std::vector<uint32_t> columns_;
+  std::vector<Feature> values_;
+  const size_t *row_offsets_data_ = NULL;
+  const uint32_t *columns_data_ = NULL;
+  const Feature *values_data_ = NULL;
+  size_t num_nonzeros_ = 0;
+
+  // buffers of the caller not to be freed (see wrap()), and their owner
+  bool external_ = false;
+  std::shared_ptr<void> external_owner_;
+
+  // shared memory segment storing the dataset (NULL if not shared)
+  void *segment_ = NULL;
+  size_t segment_bytes_ = 0;
+  std::string segment_name_;
+  bool segment_publisher_ = false;
+
+  /// Allocates an empty Dataset whose arrays are later pointed to a shared
+  /// memory segment by \a attach_shared() or to external buffers by \a
+  /// wrap().
+  Dataset() = default;
+
+  /// Updates the pointers to the compressed sparse rows after they have
+  /// been extended.
+  void update_sparse_pointers();
+
+  /// Points the arrays of the dataset to the given shared memory segment.
+  void map_segment(void *segment);
+
+  // true once the features have been freed by release_features()
+  bool features_released_ = false;
+
+  /// Stores the label and updates the query offsets of a new instance,
+  /// whose features have been already stored.
+  void add_label(QueryID q_id, Label i_label);
+
+  /// Reports an access to released features, an access through \a at()
+  /// to features not stored as a dense float matrix, or a write access to
+  /// the read-only features of a shared dataset, and exits.
+  [[noreturn]] void features_access_error() const;
+
   /// The output stream operator.
   /// Prints the data reading time stats
   friend std::ostream &operator<<(std::ostream &os, const Dataset &me) {
@@ -0,0 +1,123 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "types.h"
+#include "data/binned_features.h"
+#include "data/dataset.h"
+
+namespace quickrank {
+namespace data {
+
+/**
+ * This class implements the discretized features of a sparse dataset.
+ *
+ * Only the bin ids of the non-zero features are stored, both by column (CSC),
+ * to build histograms, and by row (aligned with the CSR arrays of the
+ * dataset), to partition samples. Zeros are implicit: every feature has a
+ * default bin, i.e., the bin of the zero value, whose label sum and count
+ * are obtained by difference from the totals of the node.
+ *
+ * The features are discretized in two steps: the non-zero values of every
+ * column are first exposed through \a column_values(), so that thresholds can
+ * be computed, and then replaced by bin ids by \a discretize().
+ */
+class SparseBinnedFeatures : public BinnedFeatures {
+ public:
+
+  /// Builds the column-wise copy of the non-zero features of a dataset.
+  ///
+  /// \param dataset The sparse dataset to be discretized.
+  SparseBinnedFeatures(std::shared_ptr<Dataset> dataset);
+  virtual ~SparseBinnedFeatures() {
+  }
+
+  /// Avoid inefficient copy constructor
+  SparseBinnedFeatures(const SparseBinnedFeatures &other) = delete;
+  /// Avoid inefficient copy assignment
+  SparseBinnedFeatures &operator=(const SparseBinnedFeatures &) = delete;
+
+  /// Returns the number of non-zero values of a given feature.
+  size_t column_size(size_t feature_id) const {
+    return column_offsets_[feature_id + 1] - column_offsets_[feature_id];
+  }
+  /// Returns the non-zero values of a given feature (before discretize()).
+  const Feature *column_values(size_t feature_id) const {
+    return column_values_.data() + column_offsets_[feature_id];
+  }
+
+  /// Replaces the feature values with their bin ids.
+  ///
+  /// \param thresholds The thresholds of every feature (last one is FLT_MAX).
+  /// \param thresholds_size The number of thresholds of every feature.
+  void discretize(float **thresholds, size_t *thresholds_size);
+
+  virtual void histogram(const size_t *sampleids, size_t nsampleids,
+                         const double *labels,
+                         double **sumlbl, size_t **count) const;
+
+  virtual void partition(size_t feature_id, size_t bin,
+                         const size_t *sampleids, size_t nsampleids,
+                         size_t *lsamples, size_t &lsize,
+                         size_t *rsamples, size_t &rsize) const;
+
+  virtual size_t bin(size_t shard, size_t document_id,
+                     size_t feature_id) const {
+    const uint32_t *begin = dataset_->nonzero_columns(document_id);
+    const uint32_t *end = begin + dataset_->num_nonzeros(document_id);
+    const uint32_t *c = std::lower_bound(begin, end, feature_id);
+    if (c == end || *c != feature_id)
+      return default_bins_[feature_id];
+    return row_bins_[c - dataset_->nonzero_columns()];
+  }
+
+ private:
+
+  std::shared_ptr<Dataset> dataset_;
+
+  // non-zero features by column
+  std::vector<size_t> column_offsets_;
+  std::vector<uint32_t> column_rows_;
+  std::vector<Feature> column_values_;
+  std::vector<uint32_t> column_bins_;
+
+  // non-zero features by row (aligned with the dataset)
+  std::vector<uint32_t> row_bins_;
+
+  // bin of the zero value of every feature
+  std::vector<uint32_t> default_bins_;
+
+  double building_time_ = 0.0;
+
+  /// Prints the binned features statistics
+  virtual std::ostream &put(std::ostream &os) const;
+
+};
+
+}  // namespace data
+}  // namespace quickrank
@@ -47,9 +47,13 @@ class VerticalDataset {
  public:
 
   /// Allocates a vertical dataset by copying and transposing an horizontal one.
+  /// The features of column-major datasets are used in place.
   ///
   /// \param h_dataset The horizontal dataset.
-  VerticalDataset(std::shared_ptr<Dataset> h_dataset);
+  /// \param copy_features If false only labels and query offsets are copied,
+  ///     and \a at() must not be used (e.g., in out-of-core training).
+  VerticalDataset(std::shared_ptr<Dataset> h_dataset,
+                  bool copy_features = true);
   virtual ~VerticalDataset();
 
   /// Avoid inefficient copy constructor
@@ -90,6 +94,10 @@ class VerticalDataset {
   unsigned int num_features() const {
     return num_features_;
   }
+  /// Returns the original (1-based) id of the feature in the given column.
+  size_t feature_id(size_t column) const {
+    return feature_ids_.empty() ? column + 1 : feature_ids_[column];
+  }
   /// Returns the number of queries in the dataset.
   unsigned int num_queries() const {
     return num_queries_;
@@ -108,6 +116,10 @@ class VerticalDataset {
   quickrank::Feature *data_ = NULL;
   quickrank::Label *labels_ = NULL;
   std::vector<size_t> offsets_;
+  std::vector<size_t> feature_ids_;
+  // column-major dataset whose features are used in place (NULL if they
+  // have been copied)
+  std::shared_ptr<Dataset> columns_dataset_;
 
   /// The output stream operator.
   /// Prints the data reading time stats
@@ -21,7 +21,9 @@
  */
 #pragma once
 
+#include <future>
 #include <memory>
+#include <sstream>
 
 #include "metric/ir/metric.h"
 #include "learning/ltr_algorithm.h"
@@ -87,6 +89,8 @@ class Driver {
   /// \param output_filename Model output file.
   /// If empty, no output file is written.
   /// \param npartialsave Allows to save a partial model every given number of iterations.
+  /// \param binary_partial If True the partial scores datasets are written
+  /// in binary format instead of SVML.
   static void optimization_phase(
       std::shared_ptr<quickrank::optimization::Optimization> opt_algorithm,
       std::shared_ptr<learning::LTR_Algorithm> ranking_algo,
@@ -97,7 +101,8 @@ class Driver {
       std::string validation_partial_filename,
       const std::string output_filename,
       const std::string opt_algo_model_filename,
-      const size_t npartialsave);
+      const size_t npartialsave,
+      const bool binary_partial = false);
 
   /// Runs the learned or loaded model on the test data
   /// and then measures \a test_metric on the test data.
@@ -110,16 +115,70 @@ class Driver {
   /// If set save the scores computed for the test set.
   /// \param verbose If True saves an SVML-like file with the score of each ranker in the ensemble.
   /// NB. Works only for ensembles.
+  /// \param binary_partial If True the detailed scores are written in binary
+  /// format instead of SVML.
   static void testing_phase(
       std::shared_ptr<learning::LTR_Algorithm> algo,
       std::shared_ptr<metric::ir::Metric> test_metric,
       std::shared_ptr<quickrank::data::Dataset> test_dataset,
       const std::string scores_filename,
-      const bool detailed_testing);
+      const bool detailed_testing,
+      const bool binary_partial = false);
+
+  /// Runs the learned or loaded model on a SVML test file read in chunks of
+  /// whole queries, so that the test dataset is never loaded in memory.
+  /// Reading, scoring and writing the scores are pipelined.
+  ///
+  /// \param algo The L-T-R algorithm to be tested.
+  /// \param test_metric The metric measured on the test data.
+  /// \param test_filename The test dataset.
+  /// \param scores_filename The output scores file.
+  /// If set save the scores computed for the test set.
+  /// \param feature_ids The selected features (empty for all).
+  /// \param storage The storage format of the chunks.
+  /// \param chunk_size The min number of instances of a chunk.
+  static void streaming_testing_phase(
+      std::shared_ptr<learning::LTR_Algorithm> algo,
+      std::shared_ptr<metric::ir::Metric> test_metric,
+      const std::string test_filename,
+      const std::string scores_filename,
+      const std::vector<size_t> &feature_ids,
+      data::Dataset::Storage storage,
+      const size_t chunk_size);
+
+  /// Writes a partial scores dataset in SVML or binary format.
+  static void write_partial_scores(
+      std::shared_ptr<quickrank::data::Dataset> dataset,
+      const std::string filename,
+      const bool binary);
 
   static std::shared_ptr<quickrank::data::Dataset> load_dataset(
       const std::string dataset_filename,
-      const std::string dataset_label);
+      const std::string dataset_label,
+      const std::vector<size_t> &feature_ids = std::vector<size_t>(),
+      data::Dataset::Storage storage = data::Dataset::FLOAT32,
+      const std::string &shared_name = std::string(),
+      std::ostream &report = std::cout);
+
+  /// A dataset being loaded in background and the report of its loading.
+  struct BackgroundLoad {
+    std::shared_future<std::shared_ptr<data::Dataset>> dataset;
+    std::shared_ptr<std::stringstream> report;
+  };
+
+  /// Starts loading a dataset in background (see \a load_dataset()).
+  static BackgroundLoad load_dataset_async(
+      const std::string dataset_filename,
+      const std::string dataset_label,
+      const std::vector<size_t> &feature_ids,
+      data::Dataset::Storage storage,
+      const std::string &shared_name);
+
+  /// Waits for a dataset loaded in background, and prints the report of its
+  /// loading the first time.
+  ///
+  /// \returns The dataset, or NULL if no dataset is being loaded.
+  static std::shared_ptr<data::Dataset> wait_dataset(BackgroundLoad &load);
 };
 
 }  // namespace driver
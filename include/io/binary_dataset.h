@@ -0,0 +1,104 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "data/dataset.h"
+
+namespace quickrank {
+namespace io {
+
+/**
+ * This class implements IO on binary dataset files.
+ *
+ * Binary files are a compact alternative to SVML files for large dense
+ * datasets, e.g., the partial scores of the trees of an ensemble, which
+ * are written and read back without formatting or parsing the features.
+ * Values are stored in the native byte order as follows:
+ * \verbatim
+ <file> .=. <header> <offsets> <labels> <features>
+ <header> .=. "QRBINDS1" <num_instances> <num_features> <num_queries> (uint64)
+ <offsets> .=. offset of the first instance of every query, and num_instances (uint64)
+ <labels> .=. label of every instance (float)
+ <features> .=. features of every instance, row by row (float)
+ \endverbatim
+
+ As for SVML files, a subset of the features can be selected with \a
+ set_feature_ids(), and the storage format of the datasets being read is
+ chosen with \a set_storage().
+ */
+class BinaryDataset {
+ public:
+  BinaryDataset() {
+  }
+
+  virtual ~BinaryDataset() {
+  }
+
+  /// Checks whether a file is a binary dataset file.
+  /// \param file the input filename.
+  static bool is_binary(const std::string &file);
+
+  /// Reads the input dataset and returns in horizontal format.
+  /// \param file the input filename.
+  /// \return The dataset in horizontal format.
+  std::unique_ptr<data::Dataset> read_horizontal(const std::string &file);
+
+  /// Restricts the features being read to the given ones (see \a
+  /// Svml::set_feature_ids()).
+  void set_feature_ids(const std::vector<size_t> &feature_ids) {
+    feature_ids_ = feature_ids;
+  }
+
+  /// Sets the storage format of the datasets being read.
+  void set_storage(data::Dataset::Storage storage) {
+    storage_ = storage;
+  }
+
+  /// Writes the dataset to an output file.
+  /// \param dataset the dataset.
+  /// \param file the output filename.
+  static void write(std::shared_ptr<data::Dataset> dataset,
+                    const std::string &file);
+
+ private:
+  double reading_time_ = 0.0;
+  long file_size_ = 0;
+
+  std::vector<size_t> feature_ids_;
+  data::Dataset::Storage storage_ = data::Dataset::FLOAT32;
+
+  /// The output stream operator.
+  /// Prints the data reading time stats.
+  friend std::ostream &operator<<(std::ostream &os, const BinaryDataset &me) {
+    return me.put(os);
+  }
+
+  /// Prints the data reading time stats
+  virtual std::ostream &put(std::ostream &os) const;
+};
+
+}  // namespace io
+}  // namespace quickrank
@@ -0,0 +1,125 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#pragma once
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace quickrank {
+namespace io {
+
+/**
+ * This class reads a (possibly compressed) file in blocks of bytes.
+ *
+ * A producer thread reads and decompresses the file, and it feeds the
+ * blocks to the consumer through a bounded queue, so that reading and
+ * decompression overlap the processing of the blocks. Compression is
+ * detected from the content of the file: gzip files are supported when
+ * QuickRank is built with zlib (QUICKRANK_HAS_ZLIB), and zstd files when it
+ * is built with libzstd (QUICKRANK_HAS_ZSTD).
+ */
+class BlockReader {
+ public:
+  /// Compression formats of the input file.
+  enum Compression {
+    NONE,
+    GZIP,
+    ZSTD
+  };
+
+  /// Opens a file and starts reading it.
+  ///
+  /// \param filename The input filename.
+  /// \param block_size The size of the blocks in bytes.
+  /// \param queue_size The max number of blocks read ahead.
+  BlockReader(const std::string &filename, size_t block_size = 4 << 20,
+              size_t queue_size = 4);
+  virtual ~BlockReader();
+
+  /// Avoid copy constructor
+  BlockReader(const BlockReader &other) = delete;
+  /// Avoid copy assignment
+  BlockReader &operator=(const BlockReader &) = delete;
+
+  /// Returns the next block of the (decompressed) file, waiting for the
+  /// producer if needed. The buffer previously stored in \a block is
+  /// recycled by the producer.
+  ///
+  /// \param block The next block.
+  /// \returns False if the end of file has been reached.
+  bool next(std::vector<char> &block);
+
+  /// Returns the compression format of the file.
+  Compression compression() const {
+    return compression_;
+  }
+
+  /// Returns the name of the compression format.
+  static const char *compression_name(Compression compression);
+
+  /// Returns the size of the file.
+  size_t file_size() const {
+    return file_size_;
+  }
+
+  /// Returns the number of (decompressed) bytes returned so far.
+  size_t bytes_read() const {
+    return bytes_read_;
+  }
+
+ private:
+  std::string filename_;
+  Compression compression_ = NONE;
+  size_t file_size_ = 0;
+  size_t bytes_read_ = 0;
+  size_t block_size_;
+  size_t queue_size_;
+
+  // blocks read ahead and buffers to be reused, guarded by mutex_
+  std::deque<std::vector<char>> blocks_;
+  std::vector<std::vector<char>> buffers_;
+  bool eof_ = false;
+  bool closed_ = false;
+  std::mutex mutex_;
+  std::condition_variable not_empty_;
+  std::condition_variable not_full_;
+
+  std::thread producer_;
+
+  /// Reads the file and pushes its blocks into the queue.
+  void produce(FILE *file);
+
+  /// Returns an empty buffer for the next block, or false if the reader
+  /// has been closed.
+  bool get_buffer(std::vector<char> &buffer);
+
+  /// Pushes a block into the queue, waiting for room if needed.
+  void push(std::vector<char> &block);
+};
+
+}  // namespace io
+}  // namespace quickrank
@@ -33,6 +33,7 @@
 #include <utils/strutils.h>
 
 #include "pugixml/src/pugixml.hpp"
+#include "io/generate_tree_blocks.h"
 
 namespace quickrank {
 namespace io {
@@ -49,12 +50,22 @@ class GenOpCond {
   ~GenOpCond() {}
 
   /// Generates the C++ implementation of the model scoring function.
-  /// This applies to tree forests and generates a cascade of conditional operators.
+  /// This applies to tree forests and generates a function for every tree,
+  /// written in the given style:
+  /// - "ternary": a cascade of conditional operators,
+  /// - "ifelse": nested if-else statements,
+  /// - "array": a loop visiting static arrays of nodes.
+  /// The trees are split in block source files (see GenTreeBlocks).
   ///
   /// \param model_filename Previously saved xml ranker model.
   /// \param code_filename Output source code file name.
+  /// \param style Code emission style.
+  /// \param trees_per_file Max number of trees of a block source file.
   void
-  generate_conditional_operators_code(const std::string, const std::string);
+  generate_conditional_operators_code(const std::string, const std::string,
+                                      const std::string style = "ternary",
+                                      size_t trees_per_file =
+                                      GenTreeBlocks::DEFAULT_TREES_PER_FILE);
 };
 
 }  // namespace io
@@ -34,6 +34,7 @@
 #include <utils/strutils.h>
 
 #include "pugixml/src/pugixml.hpp"
+#include "io/generate_tree_blocks.h"
 
 namespace quickrank {
 namespace io {
@@ -47,11 +48,18 @@ class GenOblivious {
  public:
 
   /// Generates the C++ implementation of the model scoring function.
-  /// This applies to forests of oblivious trees.
+  /// This applies to forests of oblivious trees: the function of every tree
+  /// finds its exit leaf with the evaluator of oblivious trees of its depth
+  /// used by the UNROLLED scoring engine (see scoring/fixed_depth_tree.h),
+  /// so the generated code must be compiled with QuickRank headers.
+  /// The trees are split in block source files (see GenTreeBlocks).
   ///
   /// \param model_filename Previously saved XML ranker model.
   /// \param code_filename Output source code file name.
-  void generate_oblivious_code(const std::string, const std::string);
+  /// \param trees_per_file Max number of trees of a block source file.
+  void generate_oblivious_code(const std::string, const std::string,
+                               size_t trees_per_file =
+                               GenTreeBlocks::DEFAULT_TREES_PER_FILE);
 
  private:
   void model_tree_get_leaves(pugi::xml_node &, std::vector<std::string> &);
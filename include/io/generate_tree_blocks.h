@@ -0,0 +1,76 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#pragma once
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "pugixml/src/pugixml.hpp"
+
+namespace quickrank {
+namespace io {
+
+/**
+ * This class writes the code generated for a tree ensemble in several
+ * translation units, so that large models can be compiled.
+ *
+ * Every tree is translated into a function by a tree writer. The functions
+ * of a block of trees are written to a source file together with a function
+ * adding their weighted outputs to the scores of a batch of documents. The
+ * main source file defines the ranker(float *v) and ranker_batch() entry
+ * points, and a benchmark harness times ranker_batch() on random documents.
+ */
+class GenTreeBlocks {
+ public:
+  /// Writes to \a os the definition of the static function \a name,
+  /// returning the output of \a tree for the features \a v.
+  typedef std::function<void(const pugi::xml_node &tree,
+                             const std::string &name,
+                             std::ostream &os)> TreeWriter;
+
+  /// \param trees_per_file Max number of trees of a block source file.
+  explicit GenTreeBlocks(size_t trees_per_file);
+
+  /// Writes the code of the trees of \a ensemble. The block files and the
+  /// benchmark harness are named after \a code_filename, e.g.,
+  /// model_block0.cc, model_block1.cc ... and model_bench.cc for model.cc.
+  ///
+  /// \param headers QuickRank headers included by the block files.
+  void write(const pugi::xml_node &ensemble,
+             const std::string &code_filename,
+             TreeWriter tree_writer,
+             const std::vector<std::string> &headers = {}) const;
+
+  /// Returns the C++ literal of a value of a model, e.g., a threshold, a
+  /// leaf output or a tree weight, which is parsed back to the same value.
+  static std::string literal(const char *value, bool single_precision);
+
+  static const size_t DEFAULT_TREES_PER_FILE = 1000;
+
+ private:
+  size_t trees_per_file_;
+};
+
+}  // namespace io
+}  // namespace quickrank
@@ -21,9 +21,12 @@
  */
 #pragma once
 
+#include <functional>
 #include <string>
+#include <vector>
 
 #include "data/dataset.h"
+#include "io/block_reader.h"
 
 namespace quickrank {
 namespace io {
@@ -41,7 +44,12 @@ namespace io {
  <info> .=. <string>
  \endverbatim
 
- \todo TODO: handle feature filtering
+ A subset of the features can be selected with \a set_feature_ids(): the
+ other features are skipped while parsing and never stored in the dataset.
+ The storage format of the datasets being read (e.g., sparse or 16 bits
+ features) is chosen with \a set_storage().
+
+ Files compressed with gzip or zstd are decompressed while being read.
  */
 class Svml {
  public:
@@ -60,6 +68,41 @@ class Svml {
   virtual std::unique_ptr<data::Dataset> read_horizontal(
       const std::string &file);
 
+  /// Receives a chunk of the dataset, and returns false to stop reading.
+  typedef std::function<bool(std::unique_ptr<data::Dataset>)> ChunkConsumer;
+
+  /// Reads the input dataset in chunks of whole queries in horizontal
+  /// format, so that only a chunk is kept in memory. Every chunk has at
+  /// least as many features as the previous ones, i.e., the max feature id
+  /// read so far (unless features are selected), and at least \a
+  /// min_features.
+  /// \param file the input filename.
+  /// \param chunk_size The min number of instances of a chunk (but the
+  ///     last one).
+  /// \param consume The function receiving the chunks, in order.
+  /// \param min_features The min number of features of a chunk, e.g., the
+  ///     number of features read by the model scoring the chunks.
+  void read_chunks(const std::string &file, size_t chunk_size,
+                   ChunkConsumer consume, size_t min_features = 0);
+
+  /// Restricts the features being read to the given ones. The i-th column
+  /// of the datasets read afterwards stores the i-th selected feature.
+  /// \param feature_ids The selected feature ids (1-based, sorted). An
+  ///     empty vector selects all the features.
+  void set_feature_ids(const std::vector<size_t> &feature_ids);
+
+  /// Sets the storage format of the datasets being read.
+  void set_storage(data::Dataset::Storage storage) {
+    storage_ = storage;
+  }
+
+  /// Reads a features file, i.e., a list of feature ids or ranges of ids
+  /// (e.g., "1 5 10-20") separated by blanks, commas or new lines. Lines
+  /// starting with '#' are comments.
+  /// \param file the features filename.
+  /// \return The sorted list of selected feature ids.
+  static std::vector<size_t> read_feature_ids(const std::string &file);
+
   /// Write the dataset to an output file.
   /// \param file the output filename.
   /// \return The svml dataset in horizontal format.
@@ -71,6 +114,38 @@ class Svml {
   double reading_time_ = 0.0;
   double processing_time_ = 0.0;
   long file_size_ = 0;
+  long uncompressed_size_ = 0;
+  BlockReader::Compression compression_ = BlockReader::NONE;
+
+  std::vector<size_t> feature_ids_;
+  // maps a feature id to its column + 1 (0 if the feature is not selected)
+  std::vector<size_t> feature_columns_;
+  data::Dataset::Storage storage_ = data::Dataset::FLOAT32;
+
+  struct ParsedLine;
+
+  /// Parses a line of the file.
+  ///
+  /// \param line The null-terminated line (modified while parsing).
+  /// \param parsed The parsed instance (not valid for empty and comment
+  ///     lines).
+  /// \return The max feature id in the line (0 if features are selected).
+  size_t parse_line(char *line, ParsedLine &parsed) const;
+
+  /// Parses in parallel the lines of the blocks of a file.
+  ///
+  /// \param reader The reader of the file.
+  /// \param maxfid Updated with the max feature id.
+  /// \param consume The function receiving the lines parsed from every
+  ///     block, and returning false to stop reading.
+  /// \return False if reading has been stopped.
+  bool parse_blocks(BlockReader &reader, size_t &maxfid,
+                    std::function<bool(std::vector<ParsedLine> &)> consume)
+      const;
+
+  /// Sorts by column the non-zero features of an instance.
+  static void sort_sparse_instance(std::vector<uint32_t> &columns,
+                                   std::vector<Feature> &values);
 
   /// The output stream operator.
   /// Prints the data reading time stats.
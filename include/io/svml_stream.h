@@ -0,0 +1,97 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "data/dataset.h"
+#include "io/svml.h"
+
+namespace quickrank {
+namespace io {
+
+/**
+ * This class reads a (possibly compressed) Svml file in chunks of whole
+ * queries.
+ *
+ * A producer thread reads and parses the file, and it feeds the chunks to
+ * the consumer through a bounded queue, so that reading and parsing overlap
+ * the processing of the chunks, and memory is bounded by the chunk size.
+ */
+class SvmlStream {
+ public:
+  /// Opens a file and starts reading it.
+  ///
+  /// \param filename The input filename.
+  /// \param chunk_size The min number of instances of a chunk (see \a
+  ///     Svml::read_chunks()).
+  /// \param feature_ids The selected feature ids (see \a
+  ///     Svml::set_feature_ids()).
+  /// \param storage The storage format of the chunks.
+  /// \param min_features The min number of features of the chunks (see \a
+  ///     Svml::read_chunks()).
+  /// \param queue_size The max number of chunks read ahead.
+  SvmlStream(const std::string &filename, size_t chunk_size,
+             const std::vector<size_t> &feature_ids = std::vector<size_t>(),
+             data::Dataset::Storage storage = data::Dataset::FLOAT32,
+             size_t min_features = 0, size_t queue_size = 2);
+  virtual ~SvmlStream();
+
+  /// Avoid copy constructor
+  SvmlStream(const SvmlStream &other) = delete;
+  /// Avoid copy assignment
+  SvmlStream &operator=(const SvmlStream &) = delete;
+
+  /// Returns the next chunk of the file, waiting for the producer if
+  /// needed.
+  ///
+  /// \returns The next chunk, or NULL if the end of file has been reached.
+  std::unique_ptr<data::Dataset> next();
+
+ private:
+  Svml reader_;
+  size_t queue_size_;
+
+  // chunks read ahead, guarded by mutex_
+  std::deque<std::unique_ptr<data::Dataset>> chunks_;
+  bool eof_ = false;
+  bool closed_ = false;
+  std::mutex mutex_;
+  std::condition_variable not_empty_;
+  std::condition_variable not_full_;
+
+  std::thread producer_;
+
+  /// Pushes a chunk into the queue, waiting for room if needed.
+  ///
+  /// \returns False if the stream has been closed.
+  bool push(std::unique_ptr<data::Dataset> chunk);
+};
+
+}  // namespace io
+}  // namespace quickrank
@@ -0,0 +1,110 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#pragma once
+
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "utils/dtoa.h"
+
+namespace quickrank {
+namespace io {
+
+/**
+ * This class writes large text files made of independent lines (e.g.,
+ * scores or datasets).
+ *
+ * Lines are formatted in parallel batches by OpenMP threads, and every
+ * batch is written (in order) by a background thread while the next one
+ * is being formatted. Numbers are formatted with the shortest decimal
+ * representation that is read back as the same value.
+ */
+class TextWriter {
+ public:
+  /// Formats the i-th line into the given string (cleared and without the
+  /// trailing new line).
+  typedef std::function<void(size_t, std::string &)> LineFormatter;
+
+  /// Opens (and truncates) the output file.
+  ///
+  /// \param filename The output filename.
+  /// \param batch_size The approx. size in bytes of the batches of lines.
+  TextWriter(const std::string &filename, size_t batch_size = 16 << 20);
+
+  /// Waits for the pending writes and closes the file.
+  virtual ~TextWriter();
+
+  /// Avoid copy constructor
+  TextWriter(const TextWriter &other) = delete;
+  /// Avoid copy assignment
+  TextWriter &operator=(const TextWriter &) = delete;
+
+  /// Writes \a num_lines lines formatted by \a format.
+  void write_lines(size_t num_lines, LineFormatter format);
+
+  /// Appends the shortest round-trip representation of a float.
+  static void append(std::string &line, float value) {
+    char buffer[TO_CHARS_MAX_LENGTH];
+    line.append(buffer, float_to_chars(buffer, value));
+  }
+
+  /// Appends the shortest round-trip representation of a double.
+  static void append(std::string &line, double value) {
+    char buffer[TO_CHARS_MAX_LENGTH];
+    line.append(buffer, double_to_chars(buffer, value));
+  }
+
+  /// Appends an unsigned integer.
+  static void append(std::string &line, size_t value) {
+    char buffer[24];
+    char *end = buffer + sizeof(buffer);
+    char *begin = end;
+    do {
+      *--begin = (char) ('0' + value % 10);
+      value /= 10;
+    } while (value);
+    line.append(begin, end);
+  }
+
+ private:
+  std::string filename_;
+  FILE *file_;
+  size_t batch_size_;
+
+  // the lines being formatted and the lines being written
+  std::vector<std::string> lines_;
+  std::vector<std::string> pending_lines_;
+  size_t num_pending_lines_ = 0;
+  std::thread write_thread_;
+
+  /// Waits for the batch being written in background.
+  void wait_pending();
+
+  /// Writes the pending batch.
+  void write_pending();
+};
+
+}  // namespace io
+}  // namespace quickrank
@@ -21,10 +21,14 @@
  */
 #pragma once
 
+#include <map>
+#include <memory>
+
 #include "types.h"
 #include "learning/forests/lambdamart.h"
 #include "learning/tree/rt.h"
 #include "learning/tree/ensemble.h"
+#include "learning/forests/leaf_cache.h"
 #include "learning/meta/meta_cleaver.h"
 
 namespace quickrank {
@@ -57,6 +61,9 @@ class Dart: public LambdaMart {
   /// \param normalize_type Normalization strategy to adopt
   /// \param rate_drop Probability to dropout a single tree
   /// \param skip_drop Probability to skip the dropout phase
+  /// \param leaf_cache_mb Memory (in MB) caching the leaves reached by the
+  ///        documents of every dataset, 0 to visit dropped trees every time
+  /// \param leaf_cache_spill Spill the leaves exceeding the memory to disk
   Dart(size_t ntrees, double shrinkage, size_t nthresholds,
        size_t ntreeleaves, size_t minleafsupport,
        float subsample, float max_features,
@@ -64,7 +71,8 @@ class Dart: public LambdaMart {
        SamplingType sample_type, NormalizationType normalize_type,
        AdaptiveType adaptive_rate,
        double rate_drop, double skip_drop, bool keep_drop,
-       bool best_on_train, double random_keep, double drop_on_best)
+       bool best_on_train, double random_keep, double drop_on_best,
+       size_t leaf_cache_mb = 1024, bool leaf_cache_spill = false)
       : LambdaMart(ntrees, shrinkage, nthresholds, ntreeleaves,
              minleafsupport, subsample, max_features, valid_iterations,
              collapse_leaves_factor),
@@ -76,7 +84,9 @@ class Dart: public LambdaMart {
         keep_drop(keep_drop),
         best_on_train(best_on_train),
         random_keep(random_keep),
-        drop_on_best(drop_on_best) {}
+        drop_on_best(drop_on_best),
+        leaf_cache_mb_(leaf_cache_mb),
+        leaf_cache_spill_(leaf_cache_spill) {}
 
   /// Generates a LTR_Algorithm instance from a previously saved XML model.
   Dart(const pugi::xml_document &model);
@@ -192,6 +202,11 @@ class Dart: public LambdaMart {
   double random_keep;
   bool drop_on_best;
   quickrank::Score* scores_contribution_ = NULL;
+  size_t leaf_cache_mb_ = 1024;
+  bool leaf_cache_spill_ = false;
+  /// Leaves of the trees reached by the documents of every dataset scored
+  /// by update_modelscores during training.
+  std::map<const void *, std::unique_ptr<LeafCache>> leaf_caches_;
 
   /// Prepares private data structurs befor training takes place.
   virtual void init(std::shared_ptr<data::VerticalDataset> training_dataset);
@@ -217,6 +232,9 @@ class Dart: public LambdaMart {
                               std::vector<int> dropped_trees,
                               std::shared_ptr<RegressionTree> tree);
 
+  /// Returns the leaf cache of a dataset, NULL if caching is disabled.
+  LeafCache *leaf_cache(const void *dataset);
+
   int binary_search(std::vector<double>& array, double elem);
 
   virtual void filter_out_zero_weighted_contributions(
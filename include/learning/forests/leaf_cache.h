@@ -0,0 +1,135 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "types.h"
+#include "learning/tree/rtnode.h"
+
+namespace quickrank {
+namespace learning {
+namespace forests {
+
+/// This class caches the leaf reached by every document of a dataset in
+/// every tree of an ensemble, so that adding or removing the contribution of
+/// a tree to the scores of the dataset (as Dart does at every dropout) is a
+/// lookup of the leaf outputs rather than a visit of the tree.
+///
+/// Leaves are cached the first time a tree scores the dataset, with one byte
+/// per document (two for trees with more than 256 leaves, trees with more
+/// than 65536 leaves are not cached). Once the memory budget is used up, the
+/// leaves of new trees are either spilled to a temporary file or not cached,
+/// in which case the tree is visited as usual.
+class LeafCache {
+
+ public:
+  /// Creates an empty cache.
+  ///
+  /// \param max_bytes The memory budget of the leaves.
+  /// \param spill Whether to spill the leaves exceeding the budget to disk.
+  LeafCache(size_t max_bytes, bool spill)
+      : max_bytes_(max_bytes), spill_(spill) {
+  }
+
+  ~LeafCache();
+
+  /// Avoid copy constructor
+  LeafCache(const LeafCache &other) = delete;
+  /// Avoid copy assignment
+  LeafCache &operator=(const LeafCache &) = delete;
+
+  /// Adds the weighted outputs of a tree to the scores of the documents.
+  ///
+  /// \param t The index of the tree in the ensemble.
+  /// \param root The root of the tree.
+  /// \param weight The weight of the tree (negative to remove the outputs).
+  /// \param d The features of the first document.
+  /// \param num_docs The number of documents.
+  /// \param doc_offset The distance between the features of two documents.
+  /// \param fx_offset The distance between two features of a document.
+  /// \param scores The scores of the documents.
+  void add_scores(size_t t, const RTNode *root, double weight,
+                  const quickrank::Feature *d, size_t num_docs,
+                  size_t doc_offset, size_t fx_offset,
+                  quickrank::Score *scores);
+
+  /// Forgets the trees with zero weight, whose indices shift as in
+  /// Ensemble::filter_out_zero_weighted_trees.
+  void filter_out_zero_weighted_trees(const std::vector<double> &weights);
+
+  /// Returns the bytes of the leaves cached in memory.
+  size_t memory_bytes() const {
+    return memory_bytes_;
+  }
+
+  /// Returns the bytes of the leaves spilled to disk.
+  size_t spilled_bytes() const {
+    return spilled_bytes_;
+  }
+
+ private:
+  // node of the flattened tree, leaves are children with negative index
+  struct Node {
+    uint32_t feature;
+    float threshold;
+    int32_t left;
+    int32_t right;
+  };
+
+  struct Entry {
+    const RTNode *root = nullptr;
+    std::vector<quickrank::Score> outputs;
+    // leaf ids, one or two bytes per document
+    std::vector<uint8_t> leaves;
+    size_t width = 0;
+    // position of the spilled leaves, -1 if in memory
+    long file_offset = -1;
+  };
+
+  size_t max_bytes_;
+  bool spill_;
+  size_t memory_bytes_ = 0;
+  size_t spilled_bytes_ = 0;
+
+  std::vector<Entry> entries_;
+  std::FILE *file_ = nullptr;
+  // buffer of the leaves read back from disk
+  std::vector<uint8_t> buffer_;
+
+  /// Numbers the leaves of a tree and returns its root in the flattened tree.
+  int32_t flatten(const RTNode *node, std::vector<Node> &nodes,
+                  std::vector<quickrank::Score> &outputs) const;
+
+  /// Caches the leaves of a tree, returns false if the tree is not cached.
+  bool cache_leaves(Entry &entry, const quickrank::Feature *d,
+                    size_t num_docs, size_t doc_offset, size_t fx_offset);
+
+  /// Returns the leaves of a cached tree, reading them back if spilled.
+  const uint8_t *leaves(const Entry &entry, size_t num_docs);
+};
+
+}  // namespace forests
+}  // namespace learning
+}  // namespace quickrank
@@ -0,0 +1,177 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "learning/ltr_algorithm.h"
+#include "pugixml/src/pugixml.hpp"
+
+namespace quickrank {
+namespace learning {
+namespace forests {
+
+/**
+ * This class scores documents with a tree ensemble stored in a binary model
+ * file, which is mapped in memory and used as it is.
+ *
+ * Binary models are a compact alternative to XML models for large ensembles:
+ * loading them requires neither parsing nor allocating the trees, and the
+ * processes scoring with the same model share the pages of the file. They
+ * are converted from the XML models of the tree ensembles (MART, LAMBDAMART,
+ * DART, ...), where every tree is a weighted regression tree, and back to
+ * XML by \a get_xml_model(). Values are stored in the native byte order as
+ * follows:
+ * \verbatim
+ <file> .=. <header> <info> <weights> <roots> <nodes> <leaves>
+ <header> .=. "QRBINMD1" <num_trees> <num_nodes> <num_leaves> <num_features> <info_size> (uint64)
+ <info> .=. XML of the ranker elements but the ensemble, padded to 8 bytes
+ <weights> .=. weight of every tree (double)
+ <roots> .=. reference to the root of every tree (uint32), padded to 8 bytes
+ <nodes> .=. <feature> (uint32) <threshold> (float) <left> <right> (uint32)
+ <leaves> .=. output of every leaf (double)
+ \endverbatim
+
+ Nodes and leaves are stored tree by tree in pre-order. References to
+ leaves have the highest bit set, and the other bits give the index of the
+ leaf, while references to internal nodes give the index of the node.
+ Features are 0-based column indices (feature ids minus one), lower than
+ num_features. References and features are validated when the model is
+ loaded.
+ */
+class MappedEnsemble: public LTR_Algorithm {
+
+ public:
+  /// Maps a binary model file in memory.
+  ///
+  /// \param model_filename The binary model file.
+  MappedEnsemble(const std::string &model_filename);
+
+  virtual ~MappedEnsemble();
+
+  /// Returns the name of the ranker the model was learnt by.
+  virtual std::string name() const {
+    return type_;
+  }
+
+  /// Binary models can not be trained: this exits with an error.
+  virtual void learn(std::shared_ptr<data::Dataset> training_dataset,
+                     std::shared_ptr<data::Dataset> validation_dataset,
+                     std::shared_ptr<metric::ir::Metric> training_metric,
+                     size_t partial_save,
+                     const std::string model_filename);
+
+  /// Returns the score by the current ranker
+  ///
+  /// \param d Document to be scored.
+  virtual Score score_document(const Feature *d) const {
+    double sum = 0.0;
+    for (size_t t = 0; t < num_trees_; ++t)
+      sum += leaves_[leaf_index(t, d)] * weights_[t];
+    return sum;
+  }
+
+  /// Returns the partial scores of a given document, tree by tree.
+  virtual std::shared_ptr<std::vector<Score>> partial_scores_document(
+      const Feature *d, bool ignore_weights = false) const;
+
+  /// Returns the weights of the trees.
+  virtual std::vector<double> get_weights() const {
+    return std::vector<double>(weights_, weights_ + num_trees_);
+  }
+
+  /// Returns the XML model the binary model was converted from.
+  virtual pugi::xml_document *get_xml_model() const;
+
+  /// Checks whether a file is a binary model file.
+  /// \param file the input filename.
+  static bool is_binary(const std::string &file);
+
+  /// Converts a XML model of a tree ensemble to a binary model file.
+  /// \param model The XML model.
+  /// \param file the output filename.
+  static void write(const pugi::xml_document &model, const std::string &file);
+
+  /// Bit marking references to leaves.
+  static const uint32_t LEAF = 0x80000000u;
+
+  /// A node of the flat trees.
+  struct Node {
+    uint32_t feature;
+    float threshold;
+    uint32_t left;
+    uint32_t right;
+  };
+
+  size_t num_trees() const {
+    return num_trees_;
+  }
+
+  /// Returns the number of features read by the trees.
+  virtual size_t num_features() const {
+    return num_features_;
+  }
+
+  /// Returns the index of the leaf reached by a document in a tree.
+  ///
+  /// \param tree The tree.
+  /// \param d Document to be scored.
+  size_t leaf_index(size_t tree, const Feature *d) const {
+    uint32_t ref = roots_[tree];
+    while (!(ref & LEAF)) {
+      const Node &node = nodes_[ref];
+      ref = d[node.feature] <= node.threshold ? node.left : node.right;
+    }
+    return ref & ~LEAF;
+  }
+
+ private:
+  std::string filename_;
+  std::string type_;
+  void *mapping_ = nullptr;
+  size_t mapping_size_ = 0;
+
+  size_t num_trees_ = 0;
+  size_t num_nodes_ = 0;
+  size_t num_leaves_ = 0;
+  size_t num_features_ = 0;
+  const char *info_ = nullptr;
+  size_t info_size_ = 0;
+  const double *weights_ = nullptr;
+  const uint32_t *roots_ = nullptr;
+  const Node *nodes_ = nullptr;
+  const double *leaves_ = nullptr;
+
+  /// Appends the XML model of a subtree.
+  void append_xml_split(pugi::xml_node parent, uint32_t ref,
+                        const std::string &pos) const;
+
+  /// Prints the description of Algorithm, including its parameters
+  virtual std::ostream &put(std::ostream &os) const;
+};
+
+}  // namespace forests
+}  // namespace learning
+}  // namespace quickrank
@@ -21,8 +21,12 @@
  */
 #pragma once
 
+#include <chrono>
+
 #include "types.h"
 #include "learning/ltr_algorithm.h"
+#include "data/binned_column_store.h"
+#include "data/sparse_binned_features.h"
 #include "learning/tree/rt.h"
 #include "learning/tree/ensemble.h"
 #include "learning/meta/meta_cleaver.h"
@@ -73,6 +77,28 @@ class Mart: public LTR_Algorithm {
                      size_t partial_save,
                      const std::string output_basename);
 
+  /// Validation datasets still being loaded are waited for after the
+  /// training dataset has been initialized.
+  virtual bool set_pending_validation(
+      std::shared_future<std::shared_ptr<data::Dataset>> validation_dataset) {
+    pending_validation_ = validation_dataset;
+    return true;
+  }
+
+  /// Scores a dataset, several documents at once when features are stored
+  /// as a dense float matrix.
+  ///
+  /// \param dataset The dataset to be scored.
+  /// \param scores The vector where scores are stored.
+  virtual void score_dataset(std::shared_ptr<data::Dataset> dataset,
+                             Score *scores) const;
+
+  /// Sets the engine used by \a score_dataset(), or chooses the fastest one
+  /// for the model if \a name is "AUTO".
+  virtual bool set_scoring_engine(const std::string &name,
+                                  std::shared_ptr<data::Dataset> sample =
+                                      nullptr);
+
   /// Returns the score by the current ranker
   ///
   /// \param d Document to be scored.
@@ -80,6 +106,11 @@ class Mart: public LTR_Algorithm {
     return ensemble_model_.score_instance(d, 1);
   }
 
+  /// Returns the number of features read by the trees.
+  virtual size_t num_features() const {
+    return ensemble_model_.num_features();
+  }
+
   /// Returns the partial scores of a given document, tree.
   /// \param d is a pointer to the document to be evaluated
   /// \param next_fx_offset The offset to the next feature in the data representation.
@@ -110,6 +141,22 @@ class Mart: public LTR_Algorithm {
     return ensemble_model_.get_weights();
   }
 
+  /// Enables out-of-core training: discretized features are stored in
+  /// memory-mapped shard files instead of in-memory index arrays.
+  ///
+  /// \param directory The directory where shard files are created.
+  /// \param shard_size The minimum number of instances per shard.
+  void set_out_of_core(const std::string &directory, size_t shard_size) {
+    out_of_core_directory_ = directory;
+    shard_size_ = shard_size;
+  }
+
+  /// Binned (out-of-core, sparse and 16 bits) training frees the training
+  /// features once they have been binned, if allowed.
+  virtual void set_release_training_features(bool release) {
+    release_training_features_ = release;
+  }
+
   static const std::string NAME_;
 
  protected:
@@ -117,6 +164,59 @@ class Mart: public LTR_Algorithm {
   /// Prepares private data structures before training takes place.
   virtual void init(std::shared_ptr<data::VerticalDataset> training_dataset);
   
+  /// Prepares thresholds and the store of discretized features, which is
+  /// out-of-core if a directory is set, in memory otherwise (e.g., for 16 bits
+  /// features). Must be called before init().
+  virtual void init_out_of_core(std::shared_ptr<data::Dataset> training_dataset);
+
+  /// Prepares thresholds and the discretized non-zero features of a sparse
+  /// training dataset. Must be called before init().
+  virtual void init_sparse(std::shared_ptr<data::Dataset> training_dataset);
+
+  /// Returns the given validation dataset if any, otherwise waits for the
+  /// pending one set by \a set_pending_validation() (if any).
+  std::shared_ptr<data::Dataset> wait_validation(
+      std::shared_ptr<data::Dataset> validation_dataset);
+
+  /// Prepares the training and validation data (waiting for the pending
+  /// validation dataset), evaluates the already trained model if any and
+  /// prints the header of the training log.
+  ///
+  /// \returns The training dataset in vertical format.
+  std::shared_ptr<data::VerticalDataset> init_learning(
+      std::shared_ptr<data::Dataset> training_dataset,
+      std::shared_ptr<data::Dataset> &validation_dataset,
+      metric::ir::Metric *scorer);
+
+  /// Returns true if no improvement was observed on the validation data
+  /// for too many trees before the \a m-th one.
+  bool stop_early(size_t m, bool validation) const;
+
+  /// Adds the \a m-th tree to the ensemble, updates and logs the metric on
+  /// the training and validation data and saves the partial model.
+  void add_tree(RegressionTree *tree, size_t m,
+                std::shared_ptr<data::VerticalDataset> training_dataset,
+                std::shared_ptr<data::Dataset> validation_dataset,
+                metric::ir::Metric *scorer, size_t partial_save,
+                const std::string &output_basename);
+
+  /// Rolls back to the best model observed on the validation data, clears
+  /// the training data structures and prints the training summary.
+  ///
+  /// \param nsamples_per_tree Number of samples every tree is fitted on.
+  /// \param details Appended to the description of the training throughput.
+  void finish_learning(
+      std::shared_ptr<data::Dataset> training_dataset, bool validation,
+      metric::ir::Metric *scorer,
+      std::chrono::high_resolution_clock::time_point chrono_train_start,
+      size_t ntrees_start, size_t nsamples_per_tree,
+      const std::string &details = "");
+
+  /// Computes the thresholds of a feature given its values sorted by \a idx.
+  void compute_thresholds(const Feature *features, const size_t *idx,
+                          size_t nentries, float *&thresholds,
+                          size_t &thresholds_size) const;
+
   /// De-allocates private data structure after training has taken place.
   virtual void clear(size_t num_features);
 
@@ -145,6 +245,8 @@ class Mart: public LTR_Algorithm {
                                   Score *scores, RegressionTree *tree);
   virtual void update_modelscores(std::shared_ptr<data::VerticalDataset> dataset,
                                   Score *scores, RegressionTree *tree);
+  virtual void update_modelscores(std::shared_ptr<data::BinnedFeatures> store,
+                                  Score *scores, RegressionTree *tree);
 
   virtual pugi::xml_document *get_xml_model() const;
 
@@ -186,6 +288,17 @@ class Mart: public LTR_Algorithm {
   size_t sortedsize_ = 0;
   RTRootHistogram *hist_ = NULL;
 
+  // out-of-core training (disabled if the directory is empty)
+  std::string out_of_core_directory_;
+  size_t shard_size_ = 0;
+  // discretized features of out-of-core or sparse training
+  std::shared_ptr<data::BinnedFeatures> store_;
+  // training features may be freed once binned
+  bool release_training_features_ = false;
+
+  // validation dataset being loaded while the training is initialized
+  std::shared_future<std::shared_ptr<data::Dataset>> pending_validation_;
+
  private:
   /// The output stream operator.
   friend std::ostream &operator<<(std::ostream &os, const Mart &a) {
@@ -25,6 +25,7 @@
 #include "learning/forests/lambdamart.h"
 #include "learning/tree/ot.h"
 #include "learning/tree/ensemble.h"
+#include "scoring/oblivious.h"
 
 namespace quickrank {
 namespace learning {
@@ -49,6 +50,8 @@ class ObliviousLambdaMart: public LambdaMart {
                    minleafsupport, subsample, max_features,
                    esr, collapse_leaves_factor),
         treedepth_(treedepth) {
+    ensemble_model_.set_default_scoring_engine(
+        scoring::ObliviousScorer::NAME_);
   }
 
   ObliviousLambdaMart(const pugi::xml_document &model);
@@ -75,6 +78,19 @@ class ObliviousLambdaMart: public LambdaMart {
       std::shared_ptr<data::VerticalDataset> training_dataset,
       size_t *sampleids);
 
+  using LambdaMart::update_modelscores;
+
+  /// Updates scores with the last learnt tree, by means of the oblivious
+  /// scorer.
+  ///
+  /// \param dataset Dataset to be scored.
+  /// \param scores Scores vector to be updated.
+  /// \param tree Last regression tree leartn.
+  virtual void update_modelscores(std::shared_ptr<data::Dataset> dataset,
+                                  Score *scores, RegressionTree *tree);
+  virtual void update_modelscores(std::shared_ptr<data::VerticalDataset> dataset,
+                                  Score *scores, RegressionTree *tree);
+
   size_t treedepth_;  //>0
 
  private:
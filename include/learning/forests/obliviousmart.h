@@ -25,6 +25,7 @@
 #include "learning/forests/mart.h"
 #include "learning/tree/ot.h"
 #include "learning/tree/ensemble.h"
+#include "scoring/oblivious.h"
 
 namespace quickrank {
 namespace learning {
@@ -47,6 +48,8 @@ class ObliviousMart: public Mart {
       : Mart(ntrees, shrinkage, nthresholds, 1 << treedepth, minleafsupport,
              subsample, max_features, esr, collapse_leaves_factor),
              treedepth_(treedepth) {
+    ensemble_model_.set_default_scoring_engine(
+        scoring::ObliviousScorer::NAME_);
   }
 
   ObliviousMart(const pugi::xml_document &model);
@@ -71,6 +74,19 @@ class ObliviousMart: public Mart {
       std::shared_ptr<data::VerticalDataset> training_dataset,
       size_t *sampleids);
 
+  using Mart::update_modelscores;
+
+  /// Updates scores with the last learnt tree, by means of the oblivious
+  /// scorer.
+  ///
+  /// \param dataset Dataset to be scored.
+  /// \param scores Scores vector to be updated.
+  /// \param tree Last regression tree leartn.
+  virtual void update_modelscores(std::shared_ptr<data::Dataset> dataset,
+                                  Score *scores, RegressionTree *tree);
+  virtual void update_modelscores(std::shared_ptr<data::VerticalDataset> dataset,
+                                  Score *scores, RegressionTree *tree);
+
   virtual pugi::xml_document *get_xml_model() const;
 
   size_t treedepth_;  //>0
@@ -21,6 +21,8 @@
  */
 #pragma once
 
+#include <vector>
+
 #include "types.h"
 #include "learning/forests/mart.h"
 #include "learning/tree/rt.h"
@@ -30,6 +32,14 @@ namespace quickrank {
 namespace learning {
 namespace forests {
 
+/// Random forest of regression trees fitted on the labels.
+///
+/// Trees are independent, so several of them are grown at once, one per
+/// thread, each on its own bag of samples of the shared (read-only)
+/// discretized features. Bags are drawn with replacement (bootstrap, the
+/// default) or without (subsample, required by binned training), and a
+/// tree whose bag is the whole training set uses the root histogram shared
+/// by all the trees.
 class RandomForest: public Mart {
  public:
   /// Initializes a new RandomForest instance with the given learning
@@ -42,20 +52,33 @@ class RandomForest: public Mart {
   /// \param minleafsupport Minimum number of instances in each leaf.
   /// \param esr Early stopping if no improvement after \esr iterations
   /// on the validation set.
+  /// \param bootstrap If true, the samples of every tree are drawn with
+  /// replacement (as many as the training instances times \a subsample).
+  /// Without bootstrap, the samples or the features must be sampled for
+  /// the trees to differ.
   RandomForest(size_t ntrees, double shrinkage, size_t nthresholds,
                size_t ntreeleaves, size_t minleafsupport, float subsample,
-               float max_features, size_t esr, float collapse_leaves_factor)
+               float max_features, size_t esr, float collapse_leaves_factor,
+               bool bootstrap = true)
       : Mart(ntrees, shrinkage, nthresholds, ntreeleaves, minleafsupport,
-             subsample, max_features, esr, collapse_leaves_factor) {
+             subsample, max_features, esr, collapse_leaves_factor),
+        bootstrap_(bootstrap) {
   }
 
   /// Generates a LTR_Algorithm instance from a previously saved XML model.
-  RandomForest(const pugi::xml_document &model) : Mart(model) {
-  }
+  RandomForest(const pugi::xml_document &model);
 
   virtual ~RandomForest() {
   }
 
+  /// Start the learning process, growing concurrently as many trees as
+  /// threads.
+  virtual void learn(std::shared_ptr<data::Dataset> training_dataset,
+                     std::shared_ptr<data::Dataset> validation_dataset,
+                     std::shared_ptr<metric::ir::Metric> training_metric,
+                     size_t partial_save,
+                     const std::string output_basename);
+
   /// Returns the name of the ranker.
   virtual std::string name() const {
     return NAME_;
@@ -67,13 +90,27 @@ class RandomForest: public Mart {
   /// Prepares private data structurs befor training takes place.
   virtual void init(std::shared_ptr<data::VerticalDataset> training_dataset);
 
-  /// Computes pseudo responses.
+  /// Computes pseudo responses, i.e., the labels, which do not change among
+  /// iterations.
   ///
   /// \param training_dataset The training data.
   /// \param metric The metric to be optimized.
   virtual void compute_pseudoresponses(
       std::shared_ptr<data::VerticalDataset> training_dataset,
-      metric::ir::Metric *metric);
+      metric::ir::Metric *metric,
+      bool *sample_presence);
+
+  virtual pugi::xml_document *get_xml_model() const;
+
+  /// Prints the description of Algorithm, including its parameters.
+  virtual std::ostream &put(std::ostream &os) const;
+
+  bool bootstrap_ = true;
+
+  /// Draws the (sorted) samples of the given tree out of \a nsamples
+  /// training instances, with a generator seeded by \a seed and the tree.
+  std::vector<size_t> draw_bag(size_t tree, size_t seed, size_t nsamples,
+                               size_t nbag) const;
 };
 
 }  // namespace forests
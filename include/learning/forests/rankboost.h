@@ -23,7 +23,9 @@
  */
 #pragma once
 
+#include <cstdint>
 #include <memory>
+#include <vector>
 
 #include "data/dataset.h"
 #include "metric/ir/metric.h"
@@ -89,6 +91,12 @@ class WeakRanker {
 /// Freund, Y., Iyer, R., Schapire, R. E., & Singer, Y. (2003).
 /// An efficient boosting algorithm for combining preferences.
 /// The Journal of machine learning research, 4, 933-969.
+///
+/// Only the weights of the preference pairs are stored: the documents of
+/// every query are sorted by decreasing label, so that the documents less
+/// relevant than a given one are a suffix of its query, and the weights of
+/// its pairs are contiguous. Weak rankers are searched with a prefix sum of
+/// the potentials over the documents sorted by every feature.
 class Rankboost: public LTR_Algorithm {
  public:
   Rankboost(size_t max_wr);
@@ -126,6 +134,9 @@ class Rankboost: public LTR_Algorithm {
   /// Returns the score of a given document.
   virtual Score score_document(const Feature *d) const;
 
+  /// Returns the number of features read by the weak rankers.
+  virtual size_t num_features() const;
+
   /// Returns the partial scores of a given document, tree.
   /// \param d is a pointer to the document to be evaluated
   virtual std::shared_ptr<std::vector<Score>> partial_scores_document(
@@ -139,11 +150,18 @@ class Rankboost: public LTR_Algorithm {
   virtual std::vector<double> get_weights() const;
 
  private:
-  float ***D = NULL;
-  float **PI = NULL;
-  Feature **THETA = NULL;
-  unsigned int *n_theta = NULL;
-  unsigned int ***SDF = NULL;
+  // document pair weights, for every document (in the order of
+  // ranked_docs) the pairs with the less relevant documents of its query
+  std::vector<float> D;
+  // offset in D of the pairs of every query
+  std::vector<size_t> pair_offsets;
+  // potential of every document
+  std::vector<float> PI;
+  // documents of every query sorted by decreasing label
+  std::vector<uint32_t> ranked_docs;
+  // documents sorted by decreasing value of every feature, and the values
+  std::vector<uint32_t> sorted_docs;
+  std::vector<Feature> sorted_values;
   Score *training_scores = NULL;
   Score *validation_scores = NULL;
   size_t T;
@@ -151,6 +169,8 @@ class Rankboost: public LTR_Algorithm {
   bool go_parallel;
   char const *omp_schedule;
   WeakRanker **weak_rankers = NULL;
+  // original ids of the training features (empty if all were loaded)
+  std::vector<size_t> feature_ids;
   float *alphas = NULL;
   float best_r = 0.0;
   float max_alpha = 0.0;
@@ -71,6 +71,11 @@ class CoordinateAscent: public LTR_Algorithm {
   /// Returns the score of a given document.
   virtual Score score_document(const Feature *d) const;
 
+  /// Returns the number of weights, one per feature.
+  virtual size_t num_features() const {
+    return best_weights_.size();
+  }
+
   /// Return the xml model representing the current object
   virtual pugi::xml_document *get_xml_model() const;
 
@@ -83,6 +88,8 @@ class CoordinateAscent: public LTR_Algorithm {
 
  private:
   std::vector<double> best_weights_;
+  // original ids of the training features (empty if all were loaded)
+  std::vector<size_t> feature_ids_;
 
   unsigned int num_samples_;
   double window_size_;
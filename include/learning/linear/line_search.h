@@ -82,6 +82,11 @@ class LineSearch: public LTR_Algorithm {
   /// Returns the score of a given document.
   virtual Score score_document(const Feature *d) const;
 
+  /// Returns the number of weights, one per feature.
+  virtual size_t num_features() const {
+    return best_weights_.size();
+  }
+
   /// Returns the learned weights
   virtual std::vector<double> get_weights() const {
     return best_weights_;
@@ -102,6 +107,8 @@ class LineSearch: public LTR_Algorithm {
   unsigned int train_only_last_;
 
   std::vector<double> best_weights_;
+  // original ids of the training features (empty if all were loaded)
+  std::vector<size_t> feature_ids_;
 
   /// The output stream operator.
   friend std::ostream &operator<<(std::ostream &os, const LineSearch &a) {
@@ -111,7 +118,7 @@ class LineSearch: public LTR_Algorithm {
   /// Prints the description of Algorithm, including its parameters
   virtual std::ostream &put(std::ostream &os) const;
 
-  virtual void preCompute(Feature *training_dataset,
+  virtual void preCompute(const Feature *training_dataset,
                           unsigned int num_samples,
                           unsigned int num_features,
                           Score *pre_sum,
@@ -119,7 +126,7 @@ class LineSearch: public LTR_Algorithm {
                           Score *training_score,
                           unsigned int feature_exclude);
 
-  virtual void score(Feature *dataset, unsigned int num_samples,
+  virtual void score(const Feature *dataset, unsigned int num_samples,
                      unsigned int num_features, double *weights, Score *scores);
 };
 
@@ -21,6 +21,7 @@
  */
 #pragma once
 
+#include <future>
 #include <memory>
 
 #include "data/dataset.h"
@@ -63,6 +64,24 @@ class LTR_Algorithm {
                      size_t partial_save,
                      const std::string model_filename) = 0;
 
+  /// Lets the algorithm free the features of the training dataset during
+  /// learn() as soon as it no longer needs them, when they are not used
+  /// after the training. Ignored by the algorithms always needing them.
+  virtual void set_release_training_features(bool release) {
+  }
+
+  /// Sets a validation dataset still being loaded, to be used by the next
+  /// call to \a learn() with no validation dataset.
+  ///
+  /// \param validation_dataset The validation dataset being loaded.
+  /// \returns True if the algorithm waits for the dataset once the
+  ///     initialization of the training is completed, false if the dataset is
+  ///     needed when learning starts (i.e., it must be passed to learn()).
+  virtual bool set_pending_validation(
+      std::shared_future<std::shared_ptr<data::Dataset>> validation_dataset) {
+    return false;
+  }
+
   /// Given and input \a dateset, the current ranker generates
   /// scores for each instance and store the in the \a scores vector.
   ///
@@ -73,11 +92,33 @@ class LTR_Algorithm {
   virtual void score_dataset(std::shared_ptr<data::Dataset> dataset,
                              Score *scores) const;
 
+  /// Sets the engine used by \a score_dataset(), or chooses the fastest one
+  /// for the model if \a name is "AUTO".
+  ///
+  /// Default implementation will do nothing (models with a single way of
+  /// scoring documents).
+  ///
+  /// \param name The name of the engine, or "AUTO".
+  /// \param sample Documents used to time the engines (if NULL or not
+  ///     stored as a dense float matrix, synthetic documents are used).
+  /// \returns False if the engine is not available for the model.
+  virtual bool set_scoring_engine(const std::string &name,
+                                  std::shared_ptr<data::Dataset> sample =
+                                      nullptr) {
+    return true;
+  }
+
   /// Returns the score of a given document.
   /// \param d is a pointer to the document to be evaluated
   /// \note   Each algorithm has a different implementation.
   virtual Score score_document(const Feature *d) const = 0;
 
+  /// Returns the number of features read by \a score_document(), i.e., the
+  /// min number of features of the documents being scored (0 if unknown).
+  virtual size_t num_features() const {
+    return 0;
+  }
+
   /// Returns the partial score of a given document, tree by tree.
   /// \param d is a pointer to the document to be evaluated
   /// \param next_fx_offset The offset to the next feature in the data representation.
@@ -23,14 +23,20 @@
 
 #include "paramsmap/paramsmap.h"
 #include "learning/ltr_algorithm.h"
+#include "data/dataset.h"
 
 #include <memory>
 
 namespace quickrank {
 namespace learning {
 
+/// Creates the LtR algorithm set by the options, or loads its model.
+///
+/// \param storage The storage format of the features of the training
+///     dataset, as parsed from the options.
 std::shared_ptr<quickrank::learning::LTR_Algorithm> ltr_algorithm_factory(
-    ParamsMap &pmap);
+    ParamsMap &pmap,
+    data::Dataset::Storage storage = data::Dataset::FLOAT32);
 
 }
 }
@@ -81,6 +81,10 @@ class MetaCleaver: public LTR_Algorithm {
     return ltr_algo_->score_document(d);
   }
 
+  virtual size_t num_features() const {
+    return ltr_algo_->num_features();
+  }
+
   /// Returns the partial scores of a given document, tree.
   /// \param d is a pointer to the document to be evaluated
   /// \param next_fx_offset The offset to the next feature in the data representation.
@@ -21,7 +21,15 @@
  */
 #pragma once
 
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
 #include "learning/tree/rt.h"
+#include "learning/tree/rtnode_arena.h"
+#include "scoring/scoring_engine.h"
+#include "scoring/vpred.h"
 #include "types.h"
 #include "pugixml/src/pugixml.hpp"
 
@@ -39,7 +47,9 @@ class Ensemble {
   Ensemble& operator=(Ensemble&& other);
 
   void set_capacity(const size_t n);
-  void push(RTNode *root, const double weight, const float maxlabel);
+  /// Adds a tree to the ensemble, which takes the ownership of its nodes.
+  void push(RTNode *root, std::unique_ptr<RTNodeArena> nodes,
+            const double weight, const float maxlabel);
   void pop();
 
   size_t get_size() const {
@@ -50,9 +60,49 @@ class Ensemble {
     return size > 0;
   }
 
+  /// Returns the number of features read by the trees, i.e., the max
+  /// feature index of their splits plus one (0 if there are no splits).
+  size_t num_features() const;
+
   virtual quickrank::Score score_instance(const quickrank::Feature *d,
                                           const size_t offset = 1) const;
 
+  /// Sets the engine used by \a score_instances().
+  ///
+  /// With "AUTO", every available engine scores a sample of documents (or
+  /// synthetic documents, if no sample is given) and the fastest one is
+  /// chosen. The choice is logged, and kept when trees change.
+  ///
+  /// \param name The name of the engine, or "AUTO".
+  /// \param sample The features of the sample documents, stored by row.
+  /// \param num_docs The number of sample documents.
+  /// \param num_features The number of features of each sample document.
+  /// \returns False if the engine is unknown or cannot score the trees, in
+  ///     which case the current engine is kept.
+  bool set_scoring_engine(const std::string &name,
+                          const quickrank::Feature *sample = nullptr,
+                          size_t num_docs = 0, size_t num_features = 0);
+
+  /// Sets the engine used by \a score_instances() until another one is
+  /// chosen, without logging it (e.g., the natural engine of a model).
+  /// VPRED is used if the engine cannot score the trees.
+  void set_default_scoring_engine(const std::string &name);
+
+  /// Returns the name of the engine used by \a score_instances().
+  std::string get_scoring_engine() const {
+    return engine_name_;
+  }
+
+  /// Scores a batch of documents stored by row, several at once.
+  ///
+  /// \param d The features of the documents.
+  /// \param num_docs The number of documents.
+  /// \param num_features The number of features of each document.
+  /// \param scores The vector where scores are stored.
+  virtual void score_instances(const quickrank::Feature *d, size_t num_docs,
+                               size_t num_features,
+                               quickrank::Score *scores) const;
+
   virtual std::shared_ptr<std::vector<quickrank::Score>>
       partial_scores_instance(const quickrank::Feature *d,
                               bool ignore_weights = false,
@@ -81,18 +131,16 @@ class Ensemble {
 
   struct weighted_tree {
 
-    weighted_tree(RTNode *root, double weight, float maxlabel)
+    weighted_tree(RTNode *root, RTNodeArena *nodes, double weight,
+                  float maxlabel)
         : root(root),
+          nodes(nodes),
           weight(weight),
           maxlabel(maxlabel) { }
 
-    weighted_tree(const weighted_tree& source) {
-      weight = source.weight;
-      maxlabel = source.maxlabel;
-      root = new RTNode(*(source.root));
-    }
-
     RTNode* root = nullptr;
+    // storage of the nodes of the tree, owned by the ensemble
+    RTNodeArena* nodes = nullptr;
     double weight = 0.0;
     float maxlabel = 0.0f;
   };
@@ -101,5 +149,26 @@ class Ensemble {
   size_t capacity = 0;
   weighted_tree* arr = nullptr;
 
+  // engine used for batch scoring, built on first use and dropped whenever
+  // trees or weights change
+  std::string engine_name_ = quickrank::scoring::VPred::NAME_;
+  // max number of documents, max number of runs and time after which no
+  // more runs are done when engines are calibrated
+  static const size_t CALIBRATION_DOCS = 256;
+  static const size_t CALIBRATION_RUNS = 3;
+  static const double CALIBRATION_SECONDS;
+  mutable std::shared_ptr<const quickrank::scoring::ScoringEngine> engine_;
+  mutable std::mutex engine_mutex_;
+
   void reset_state();
+
+  /// Creates the given engine filled with the trees of the ensemble, or
+  /// nullptr if the engine is unknown or cannot score some of the trees.
+  std::shared_ptr<quickrank::scoring::ScoringEngine> build_engine(
+      const std::string &name) const;
+
+  /// Generates documents whose features fall on both sides of the
+  /// thresholds of the ensemble, so that they reach random leaves.
+  std::vector<quickrank::Feature> synthetic_documents(
+      size_t num_docs, size_t &num_features) const;
 };
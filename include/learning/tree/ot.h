@@ -23,9 +23,20 @@
 
 #include <cfloat>
 #include <cmath>
+#include <cstdint>
+#include <vector>
 
 #include "learning/tree/rt.h"
 
+/// Oblivious regression tree, i.e., a tree whose nodes of a level share the
+/// same split.
+///
+/// Since every level has a single split, no per-node state is kept while
+/// growing the tree: every training sample stores the index of the leaf it
+/// falls in (a byte per sample up to depth 8), which gains a bit with a
+/// single pass over the samples when a level is split, and the histograms
+/// of all the leaves of a level are stored together as a single
+/// (leaf x feature x bin) matrix.
 class ObliviousRT: public RegressionTree {
  public:
 
@@ -41,11 +52,57 @@ class ObliviousRT: public RegressionTree {
   void fit(RTNodeHistogram *hist,
            size_t *sampleids);
 
+  /// Sets the output of every leaf to the mean pseudo-response of the
+  /// samples ending in it, and returns the max output.
+  double update_output(double const *pseudoresponses);
+
+  /// Sets the output of every leaf to the ratio of the sums of the
+  /// pseudo-responses and of the weights of the samples ending in it, and
+  /// returns the max output.
+  double update_output(double const *pseudoresponses,
+                       double const *cachedweights);
+
  protected:
   const size_t treedepth = 0;
 
  private:
-  void fill(double **sumvar, const size_t nfeaturesamples,
-            RTNodeHistogram const *hist);
+  /// Histograms of the leaves of a level: cumulative label sums and counts
+  /// of every bin of every feature, a row per leaf. When a level is split,
+  /// the row of a leaf becomes the one of its right child and the rows of
+  /// the left children are appended, so \a rows maps leaf indices to rows.
+  struct LevelHistogram {
+    std::vector<double> sumlbl;
+    std::vector<size_t> count;
+    std::vector<size_t> rows;
+  };
+
+  // samples of the tree and the leaf of each of them (indexed by sample id,
+  // in the array matching the depth of the tree)
+  const size_t *sampleids_ = nullptr;
+  size_t nsampleids_ = 0;
+  std::vector<uint8_t> leaf_ids_;
+  std::vector<uint16_t> wide_leaf_ids_;
+  // the leaves, in order of leaf index
+  std::vector<RTNode *> leaf_nodes_;
+
+  // offset of the bins of every feature in a row of a level histogram
+  std::vector<size_t> bin_offsets_;
+
+  template<typename LeafId>
+  void fit_levels(RTNodeHistogram *hist, std::vector<LeafId> &leaf_ids);
+
+  /// Computes the histograms of the left children of the \a nparents
+  /// leaves of \a level, whose samples have just been split, and turns the
+  /// histograms of the parents into the ones of the right children.
+  template<typename LeafId>
+  void split_histogram(RTNodeHistogram const *hist, size_t nparents,
+                       const std::vector<LeafId> &leaf_ids,
+                       LevelHistogram &level) const;
+
+  template<typename LeafId>
+  double set_outputs(const std::vector<LeafId> &leaf_ids,
+                     double const *numerators,
+                     double const *denominators);
+
   const double invalid = -DBL_MAX;
 };
@@ -25,22 +25,54 @@
 #include <cmath>
 #include <cstring>
 
+#include <deque>
+#include <memory>
+#include <vector>
+
 #include "utils/maxheap.h"
 #include "data/vertical_dataset.h"
 #include "learning/tree/rtnode.h"
+#include "learning/tree/rtnode_arena.h"
 #include "learning/tree/rtnode_histogram.h"
 
+/// The state of a node of a tree being grown, kept aside of the node.
+class RTNodeTraining {
+ public:
+  RTNode *node = nullptr;
+  RTNodeTraining *left = nullptr;
+  RTNodeTraining *right = nullptr;
+  size_t *sampleids = nullptr;
+  size_t nsampleids = 0;
+  double deviance = 0.0;
+  RTNodeHistogram *hist = nullptr;
+
+  // leaf of the samples of a histogram
+  RTNodeTraining(RTNode *node, size_t *sampleids, RTNodeHistogram *hist)
+      : node(node), sampleids(sampleids), hist(hist) {
+    size_t last_threshold = hist->thresholds_size[0] - 1;
+    nsampleids = hist->count[0][last_threshold];
+    double sumlabel = hist->sumlbl[0][last_threshold];
+    node->avglabel = nsampleids ? sumlabel / (double) nsampleids : 0.0;
+    deviance = hist->squares_sum_ - pow(sumlabel, 2) / nsampleids;
+  }
+
+  // leaf with no histogram
+  RTNodeTraining(RTNode *node, size_t *sampleids, size_t nsampleids)
+      : node(node), sampleids(sampleids), nsampleids(nsampleids) {
+  }
+};
+
 class RTNodeEnriched {
  public:
-  RTNode* node = nullptr;
-  RTNode* parent = nullptr;
+  RTNodeTraining* node = nullptr;
+  RTNodeTraining* parent = nullptr;
   size_t depth;
 
-  RTNodeEnriched(RTNode* node, RTNode* parent, size_t depth) :
+  RTNodeEnriched(RTNodeTraining* node, RTNodeTraining* parent, size_t depth) :
       node(node), parent(parent), depth(depth) {};
 };
 
-typedef MaxHeap<RTNode *> rt_maxheap;
+typedef MaxHeap<RTNodeTraining *> rt_maxheap;
 typedef MaxHeap<RTNodeEnriched *> rt_maxheap_enriched;
 
 class RegressionTree {
@@ -52,12 +84,28 @@ class RegressionTree {
   const size_t minls;
   quickrank::data::VerticalDataset *training_dataset = NULL;
   double *training_labels = NULL;
-  RTNode **leaves = NULL;
-  size_t nleaves = 0;
+  std::vector<RTNodeTraining *> leaves;
   RTNode *root = NULL;
+  RTNodeTraining *training_root = NULL;
   // see collapse_leaves_ in mart
   float collapse_leaves_factor;
 
+  // nodes of the tree, until they are released to an ensemble
+  std::unique_ptr<RTNodeArena> nodes;
+  // training state of the nodes, discarded with the tree
+  std::deque<RTNodeTraining> training_nodes;
+
+  /// Creates a new node, and its training state.
+  template<typename... Args>
+  RTNodeTraining *create_node(double prediction, Args &&... args) {
+    training_nodes.emplace_back(nodes->create(prediction),
+                                std::forward<Args>(args)...);
+    return &training_nodes.back();
+  }
+
+  /// Saves the leaves of the subtree in \a leaves.
+  void save_leaves(RTNodeTraining *node);
+
  public:
   RegressionTree(size_t nrequiredleaves, quickrank::data::VerticalDataset *dps,
                  double *labels, size_t minls, float collapse_leaves_factor)
@@ -82,12 +130,19 @@ class RegressionTree {
     return root;
   }
 
+  /// Releases the nodes of the tree, e.g., to be added to an ensemble
+  /// (see \a Ensemble::push()).
+  std::unique_ptr<RTNodeArena> release_nodes() {
+    return std::move(nodes);
+  }
+
  private:
   //if require_devianceltparent is true the node is split if minvar is lt the current node deviance (require_devianceltparent=false in RankLib)
-  bool split(RTNode *node, const float max_features,
+  bool split(RTNodeTraining *node, const float max_features,
              const bool require_devianceltparent);
 
-  size_t inline tree_heap_nodes(rt_maxheap_enriched& heap, RTNode* node,
+  size_t inline tree_heap_nodes(rt_maxheap_enriched& heap,
+                                RTNodeTraining* node,
                                 size_t depth, double max_deviance);
 
 };
\ No newline at end of file
@@ -24,7 +24,6 @@
 #include <string>
 #include <cmath>
 
-#include "learning/tree/rtnode_histogram.h"
 #include "types.h"
 #include "pugixml/src/pugixml.hpp"
 
@@ -34,17 +33,20 @@
 
 static const size_t uint_max = (size_t) -1;
 
+class RTNodeArena;
+
+/// A node of a regression tree.
+///
+/// Nodes are stored by the \a RTNodeArena of their tree, which releases them
+/// all at once, and they hold only the model: the state needed to grow a
+/// tree is kept aside by the learner (see \a RTNodeTraining).
 class RTNode {
 
  public:
-  size_t *sampleids = NULL;
-  size_t nsampleids = 0;
   float threshold = 0.0f;
-  double deviance = 0.0;
   double avglabel = 0.0;
   RTNode *left = NULL;
   RTNode *right = NULL;
-  RTNodeHistogram *hist = NULL;
 
  private:
   size_t featureidx = uint_max;  //refer the index in the feature matrix
@@ -59,22 +61,6 @@ class RTNode {
   // new leaf
   RTNode(double prediction) {
     avglabel = prediction;
-    /*
-     featureidx  = uint_max;
-     featureid  = uint_max;
-     sampleids = NULL;
-     nsampleids = 0;
-     deviance = -1;
-     hist = NULL;
-     left = NULL;
-     right = NULL;
-     */
-  }
-
-  RTNode(size_t *new_sampleids, size_t new_nsampleids, double prediction) {
-    sampleids = new_sampleids;
-    nsampleids = new_nsampleids;
-    avglabel = prediction;
   }
 
   // new node
@@ -85,48 +71,18 @@ class RTNode {
     featureid = new_featureid;
     left = new_left;
     right = new_right;
-    /*
-     sampleids = NULL;
-     nsampleids = 0;
-     deviance = -1;
-     hist = NULL;
-     avglabel = 0.0;
-     */
   }
 
-  RTNode(size_t *sampleids, RTNodeHistogram *hist) {
-
-    size_t last_threshold = hist->thresholds_size[0] - 1;
-
-    this->hist = hist;
-    this->sampleids = sampleids;
-    nsampleids = hist->count[0][last_threshold];
-    double sumlabel = hist->sumlbl[0][last_threshold];
-    avglabel = nsampleids ? sumlabel / (double) nsampleids : 0.0;
-    deviance = hist->squares_sum_ - pow(sumlabel, 2) / nsampleids;
-  }
-
-  ~RTNode() {
-    if (left)
-      delete left;
-    if (right)
-      delete right;
-//    if (sampleids != NULL)
-//      delete[] sampleids;
-  }
   void set_feature(size_t fidx, size_t fid) {
     featureidx = fidx, featureid = fid;
   }
   size_t get_feature_id() {
     return featureid;
   }
-  size_t get_feature_idx() {
+  size_t get_feature_idx() const {
     return featureidx;
   }
 
-  void save_leaves(RTNode **&leaves, size_t &nleaves,
-                   size_t &capacity);
-
   bool is_leaf() const {
     return featureidx == uint_max;
   }
@@ -164,5 +120,14 @@ class RTNode {
   pugi::xml_node append_xml_model(pugi::xml_node parent,
                                   const std::string &pos = "") const;
 
-  static RTNode *parse_xml(const pugi::xml_node &split_xml);
+  /// Parses a XML subtree.
+  ///
+  /// \param split_xml The XML subtree.
+  /// \param nodes The arena storing the nodes of the tree.
+  /// \returns The root of the subtree.
+  static RTNode *parse_xml(const pugi::xml_node &split_xml,
+                           RTNodeArena &nodes);
+
+  /// Returns the number of nodes of a XML subtree.
+  static size_t count_xml_nodes(const pugi::xml_node &split_xml);
 };
@@ -0,0 +1,84 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "learning/tree/rtnode.h"
+
+/// This class stores the nodes of a tree.
+///
+/// Nodes are allocated in blocks, the first one sized as requested (e.g.,
+/// with the number of nodes of the tree when it is known), the others of
+/// growing size. They are never released one by one, but all together with
+/// the arena, so that memory and teardown time of a tree depend only on its
+/// number of nodes.
+class RTNodeArena {
+
+  static_assert(std::is_trivially_destructible<RTNode>::value,
+                "nodes are released without being destroyed");
+
+ public:
+  /// Creates an empty arena.
+  ///
+  /// \param capacity The number of nodes of the first block.
+  explicit RTNodeArena(size_t capacity = 0) : first_capacity_(capacity) {
+  }
+
+  ~RTNodeArena();
+
+  /// Avoid copy constructor
+  RTNodeArena(const RTNodeArena &other) = delete;
+  /// Avoid copy assignment
+  RTNodeArena &operator=(const RTNodeArena &) = delete;
+
+  /// Creates a new node owned by the arena.
+  template<typename... Args>
+  RTNode *create(Args &&... args) {
+    if (used_ == block_capacity_)
+      add_block();
+    ++size_;
+    return new(block_ + used_++) RTNode(std::forward<Args>(args)...);
+  }
+
+  /// Returns the number of nodes created.
+  size_t size() const {
+    return size_;
+  }
+
+ private:
+  // min number of nodes of a block
+  static const size_t MIN_BLOCK_NODES = 16;
+
+  std::vector<RTNode *> blocks_;
+  RTNode *block_ = nullptr;
+  size_t first_capacity_ = 0;
+  size_t block_capacity_ = 0;
+  size_t used_ = 0;
+  size_t size_ = 0;
+
+  void add_block();
+};
@@ -22,12 +22,15 @@
 #pragma once
 
 #include "data/vertical_dataset.h"
+#include "data/binned_features.h"
 
 class RTNodeHistogram {
  public:
   float **thresholds = NULL;      // [nfeatures] x [thresholds_size[i]]
   size_t *thresholds_size = NULL; // [nfeatures]
   size_t **stmap = NULL;          // [nfeatures] x [nthresholds]
+  // out-of-core replacement of stmap (NULL when training in memory)
+  const quickrank::data::BinnedFeatures *store = NULL;
   const size_t nfeatures = 0;
   double **sumlbl = NULL;         // [nfeatures] x [nthresholds]
   size_t **count = NULL;          // [nfeatures] x [nthresholds]
@@ -69,5 +72,11 @@ class RTRootHistogram: public RTNodeHistogram {
                   float **thresholds,
                   size_t *thresholds_size);
 
+  /// Root histogram over binned features (out-of-core or sparse), counts are
+  /// computed by the first call to update().
+  RTRootHistogram(const quickrank::data::BinnedFeatures *store,
+                  float **thresholds,
+                  size_t *thresholds_size);
+
   ~RTRootHistogram();
 };
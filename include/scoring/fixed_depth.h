@@ -0,0 +1,119 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "scoring/scoring_engine.h"
+
+namespace quickrank {
+namespace scoring {
+
+namespace fixed_depth {
+
+/// Returns the depth of the tree rooted at \a node.
+unsigned int tree_depth(const RTNode *node);
+
+/// Appends the feature and the threshold of every level and the leaves of
+/// an oblivious tree of depth \a depth.
+///
+/// \returns False if the nodes of some level do not share their split or
+/// the tree is not full (the vectors are then partially filled).
+bool read_oblivious_tree(const RTNode *root, unsigned int depth,
+                         std::vector<uint32_t> &features,
+                         std::vector<float> &thresholds,
+                         std::vector<double> &leaves);
+
+}  // namespace fixed_depth
+
+/// This class scores documents with ensembles of trees of limited depth by
+/// means of evaluators specialized at compile time for every depth.
+///
+/// Every tree is stored as a complete tree of its depth, leaves shallower
+/// than the others being replicated, or as an oblivious tree, i.e., a
+/// feature and a threshold per level, when all the nodes of a level share
+/// them. The leaf of a document is then found with an unrolled, branch-free
+/// visit (see fixed_depth_tree.h), whose instantiation is chosen for every
+/// tree when the tree is added. Trees deeper than MAX_DEPTH are not
+/// supported.
+class FixedDepth : public ScoringEngine {
+
+ public:
+  virtual std::string name() const {
+    return NAME_;
+  }
+
+  virtual bool add_tree(const RTNode *root, double weight);
+
+  virtual size_t num_trees() const {
+    return weights_.size();
+  }
+
+  virtual void add_scores(const quickrank::Feature *d, size_t num_docs,
+                          size_t num_features,
+                          quickrank::Score *scores) const;
+
+  /// Returns the number of trees stored as oblivious trees.
+  size_t num_oblivious_trees() const {
+    return num_oblivious_;
+  }
+
+  static const unsigned int MAX_DEPTH = 10;
+
+  static const std::string NAME_;
+
+ private:
+  // adds the scores of a tree to a batch of documents
+  typedef void (*tree_scorer)(const FixedDepth &engine, size_t tree,
+                              const quickrank::Feature *d, size_t num_docs,
+                              size_t num_features, quickrank::Score *scores);
+
+  // number of documents moved down a tree before the next one
+  static const size_t BATCH_DOCS = 128;
+
+  // nodes (or levels) and leaves of all the trees
+  std::vector<uint32_t> features_;
+  std::vector<float> thresholds_;
+  std::vector<double> leaves_;
+
+  // per tree info
+  std::vector<size_t> node_offsets_;
+  std::vector<size_t> leaf_offsets_;
+  std::vector<double> weights_;
+  std::vector<tree_scorer> scorers_;
+  size_t num_oblivious_ = 0;
+
+  template<unsigned int DEPTH, bool OBLIVIOUS>
+  static void add_tree_scores(const FixedDepth &engine, size_t tree,
+                              const quickrank::Feature *d, size_t num_docs,
+                              size_t num_features, quickrank::Score *scores);
+
+  /// Stores \a node at position \a index of a complete tree with \a levels
+  /// levels below the node.
+  void add_complete_node(const RTNode *node, size_t index, unsigned int levels,
+                         size_t node_offset, size_t leaf_offset,
+                         size_t num_nodes);
+};
+
+}  // namespace scoring
+}  // namespace quickrank
@@ -0,0 +1,98 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// This header has no other dependency, as it is also included by the code
+// generated for oblivious trees.
+
+namespace quickrank {
+namespace scoring {
+
+namespace fixed_depth {
+
+// visit of the remaining LEVELS levels of a tree, unrolled at compile time
+template<unsigned int LEVELS>
+struct Visit {
+  // complete trees: nodes are stored breadth first, the children of node
+  // i being 2i+1 and 2i+2
+  static size_t complete(size_t node, const uint32_t *features,
+                         const float *thresholds, const float *v) {
+    return Visit<LEVELS - 1>::complete(
+        2 * node + 1 + !(v[features[node]] <= thresholds[node]),
+        features, thresholds, v);
+  }
+
+  // oblivious trees: a feature and a threshold per level, every level adding
+  // a bit to the index of the leaf
+  static size_t oblivious(size_t leaf, const uint32_t *features,
+                          const float *thresholds, const float *v) {
+    return Visit<LEVELS - 1>::oblivious(
+        2 * leaf + !(v[*features] <= *thresholds),
+        features + 1, thresholds + 1, v);
+  }
+};
+
+template<>
+struct Visit<0> {
+  static size_t complete(size_t node, const uint32_t *, const float *,
+                         const float *) {
+    return node;
+  }
+
+  static size_t oblivious(size_t leaf, const uint32_t *, const float *,
+                          const float *) {
+    return leaf;
+  }
+};
+
+}  // namespace fixed_depth
+
+/// Returns the index of the leaf of a complete tree of \a DEPTH levels
+/// reached by the features \a v, with exactly \a DEPTH branch-free steps.
+///
+/// \param features The features of the 2^DEPTH-1 nodes, breadth first.
+/// \param thresholds The thresholds of the nodes: documents whose feature is
+/// less than or equal to the threshold go to the left child.
+template<unsigned int DEPTH>
+inline size_t complete_tree_leaf(const uint32_t *features,
+                                 const float *thresholds, const float *v) {
+  return fixed_depth::Visit<DEPTH>::complete(0, features, thresholds, v)
+      - ((size_t(1) << DEPTH) - 1);
+}
+
+/// Returns the index of the leaf of an oblivious tree of \a DEPTH levels
+/// reached by the features \a v, the first level giving the most significant
+/// bit.
+///
+/// \param features The feature of every level.
+/// \param thresholds The threshold of every level.
+template<unsigned int DEPTH>
+inline size_t oblivious_tree_leaf(const uint32_t *features,
+                                  const float *thresholds, const float *v) {
+  return fixed_depth::Visit<DEPTH>::oblivious(0, features, thresholds, v);
+}
+
+}  // namespace scoring
+}  // namespace quickrank
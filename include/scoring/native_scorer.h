@@ -0,0 +1,111 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "scoring/scoring_engine.h"
+
+namespace quickrank {
+namespace scoring {
+
+/// This class scores documents with a native version of the ensemble.
+///
+/// C code is generated for the trees, a source file for every block of
+/// trees so that large models are compiled in parallel, and compiled with
+/// the system compiler into a shared object which is loaded with dlopen.
+/// Shared objects are cached in a directory, keyed by the hash of the
+/// generated code, so that a model is compiled only once. Code is generated
+/// and compiled when the engine is prepared, which fails if the compiler
+/// or the cache directory are not usable.
+class NativeScorer : public ScoringEngine {
+
+ public:
+  NativeScorer() {
+  }
+
+  virtual ~NativeScorer();
+
+  /// Avoid copy constructor
+  NativeScorer(const NativeScorer &other) = delete;
+  /// Avoid copy assignment
+  NativeScorer &operator=(const NativeScorer &) = delete;
+
+  virtual std::string name() const {
+    return NAME_;
+  }
+
+  virtual bool add_tree(const RTNode *root, double weight);
+
+  virtual size_t num_trees() const {
+    return roots_.size();
+  }
+
+  virtual bool prepare();
+
+  virtual void add_scores(const quickrank::Feature *d, size_t num_docs,
+                          size_t num_features,
+                          quickrank::Score *scores) const;
+
+  /// Sets the directory where compiled models are cached (by default
+  /// $HOME/.cache/quickrank, or /tmp/quickrank-cache-<uid> without a home,
+  /// which must be a directory accessible only to the user).
+  static void set_cache_directory(const std::string &directory) {
+    cache_directory_ = directory;
+  }
+
+  /// Sets the command compiling the generated C code (by default
+  /// "cc -O2 -march=native"), to which PIC and output flags are appended.
+  static void set_compiler(const std::string &compiler) {
+    compiler_ = compiler;
+  }
+
+  static const std::string NAME_;
+
+ private:
+  // signature of the entry point of the compiled model
+  typedef void (*score_function)(const float *, size_t, size_t, double *);
+
+  // max number of nodes of the trees of a source file
+  static const size_t BLOCK_NODES = 16384;
+  // number of documents scored by a call to the compiled model
+  static const size_t BATCH_DOCS = 64;
+
+  static std::string cache_directory_;
+  static std::string compiler_;
+
+  std::vector<const RTNode *> roots_;
+  std::vector<double> weights_;
+
+  void *library_ = nullptr;
+  score_function score_ = nullptr;
+
+  /// Returns the source files of the model, the main one being the last.
+  std::vector<std::string> generate_sources() const;
+
+  /// Compiles the model, unless it is cached, and loads it.
+  void load();
+};
+
+}  // namespace scoring
+}  // namespace quickrank
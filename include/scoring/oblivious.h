@@ -0,0 +1,105 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "scoring/scoring_engine.h"
+
+namespace quickrank {
+namespace scoring {
+
+/// This class scores documents with ensembles of oblivious trees, i.e.,
+/// trees whose nodes of a level share the same split.
+///
+/// A tree is stored as a feature and a threshold per level and a table of
+/// leaves: every level adds a bit to the index of the leaf of a document, so
+/// that no node is visited. Documents are transposed by tiles into feature
+/// columns, and the leaf indices of 16 (AVX-512) or 8 (AVX2) documents are
+/// computed at once with a vector comparison per level. Trees which are not
+/// oblivious, or deeper than MAX_DEPTH, are not supported.
+class ObliviousScorer : public ScoringEngine {
+
+ public:
+  virtual std::string name() const {
+    return NAME_;
+  }
+
+  virtual bool add_tree(const RTNode *root, double weight);
+
+  virtual size_t num_trees() const {
+    return weights_.size();
+  }
+
+  virtual void add_scores(const quickrank::Feature *d, size_t num_docs,
+                          size_t num_features,
+                          quickrank::Score *scores) const;
+
+  /// Adds the score of the ensemble to the scores of documents stored by
+  /// column (e.g., a VerticalDataset).
+  ///
+  /// \param d The features of the documents, feature f of document i being
+  /// d[f * stride + i].
+  /// \param num_docs The number of documents.
+  /// \param stride The distance between the columns of two features.
+  /// \param scores The scores to be updated.
+  void add_column_scores(const quickrank::Feature *d, size_t num_docs,
+                         size_t stride, quickrank::Score *scores) const;
+
+  /// Returns the number of documents scored at once.
+  static size_t width();
+
+  static const unsigned int MAX_DEPTH = 16;
+
+  static const std::string NAME_;
+
+ private:
+  // number of documents transposed and moved through all the trees before
+  // the next ones
+  static const size_t TILE_DOCS = 256;
+
+  // levels and leaves of all the trees
+  std::vector<uint32_t> features_;
+  std::vector<float> thresholds_;
+  std::vector<double> leaves_;
+
+  // per tree info
+  std::vector<size_t> level_offsets_;
+  std::vector<size_t> leaf_offsets_;
+  std::vector<unsigned int> depths_;
+  std::vector<double> weights_;
+
+  // features used by some tree, the only ones transposed, and the column
+  // of the feature of every level in a transposed tile
+  std::vector<uint32_t> used_features_;
+  std::vector<uint32_t> columns_;
+
+  /// Adds the scores of all the trees to a tile of documents stored by
+  /// column, \a columns giving the column of every level.
+  void add_tile_scores(const quickrank::Feature *d, size_t num_docs,
+                       size_t stride, const uint32_t *columns,
+                       quickrank::Score *scores) const;
+};
+
+}  // namespace scoring
+}  // namespace quickrank
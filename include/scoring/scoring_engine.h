@@ -0,0 +1,76 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#pragma once
+
+#include <string>
+
+#include "types.h"
+#include "learning/tree/rtnode.h"
+
+namespace quickrank {
+namespace scoring {
+
+/// This class is the interface of the engines scoring batches of documents
+/// with an ensemble of trees.
+///
+/// Engines are filled with the trees of the ensemble, in order, and then
+/// used to score any number of batches. Every engine sums the trees in
+/// order, so that all of them return the same scores.
+class ScoringEngine {
+
+ public:
+  virtual ~ScoringEngine() {
+  }
+
+  /// Returns the name of the engine.
+  virtual std::string name() const = 0;
+
+  /// Appends a tree to the ensemble.
+  ///
+  /// \param root The root of the tree.
+  /// \param weight The weight of the tree.
+  /// \returns False if the engine cannot score the tree.
+  virtual bool add_tree(const RTNode *root, double weight) = 0;
+
+  /// Returns the number of trees.
+  virtual size_t num_trees() const = 0;
+
+  /// Prepares the engine to score, once all the trees have been added.
+  ///
+  /// \returns False if the engine cannot score the ensemble.
+  virtual bool prepare() {
+    return true;
+  }
+
+  /// Adds the score of the ensemble to the scores of the given documents.
+  ///
+  /// \param d The features of the documents, stored by row.
+  /// \param num_docs The number of documents.
+  /// \param num_features The number of features of each document.
+  /// \param scores The scores to be updated.
+  virtual void add_scores(const quickrank::Feature *d, size_t num_docs,
+                          size_t num_features,
+                          quickrank::Score *scores) const = 0;
+};
+
+}  // namespace scoring
+}  // namespace quickrank
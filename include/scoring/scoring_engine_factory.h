@@ -0,0 +1,45 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "scoring/scoring_engine.h"
+
+namespace quickrank {
+namespace scoring {
+
+/// Returns the names of the scoring engines timed by the automatic choice,
+/// in order of preference when they are equally fast. NATIVE is available
+/// too, but it is used only if requested, since it compiles the model.
+std::vector<std::string> scoring_engine_names();
+
+/// Creates an empty scoring engine.
+///
+/// \param name The name of the engine (case insensitive).
+/// \returns The engine, or nullptr if the name is unknown.
+std::shared_ptr<ScoringEngine> scoring_engine_factory(std::string name);
+
+}  // namespace scoring
+}  // namespace quickrank
@@ -0,0 +1,58 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#pragma once
+
+#include <vector>
+
+#include "scoring/scoring_engine.h"
+
+namespace quickrank {
+namespace scoring {
+
+/// This class scores documents one by one, following the pointers of the
+/// nodes of each tree from the root to the leaf reached by the document.
+class TreeVisit : public ScoringEngine {
+
+ public:
+  virtual std::string name() const {
+    return NAME_;
+  }
+
+  virtual bool add_tree(const RTNode *root, double weight);
+
+  virtual size_t num_trees() const {
+    return roots_.size();
+  }
+
+  virtual void add_scores(const quickrank::Feature *d, size_t num_docs,
+                          size_t num_features,
+                          quickrank::Score *scores) const;
+
+  static const std::string NAME_;
+
+ private:
+  std::vector<const RTNode *> roots_;
+  std::vector<double> weights_;
+};
+
+}  // namespace scoring
+}  // namespace quickrank
@@ -0,0 +1,110 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "scoring/scoring_engine.h"
+
+namespace quickrank {
+namespace scoring {
+
+/// This class scores documents with an ensemble of trees by means of a
+/// predicated (branch-free) traversal.
+///
+/// Nodes of all the trees are stored in flat arrays, leaves pointing to
+/// themselves, so that the leaf reached by a document is found after exactly
+/// as many steps as the depth of the tree, whatever the path. The visit is
+/// thus independent of the data and several documents are moved down a tree
+/// at once with vector gathers: 16 documents with AVX-512, 8 with AVX2.
+///
+/// Large ensembles are scored by tiles: trees are split into blocks that
+/// fit half of the L2 cache, and a tile of documents filling the other half
+/// is pushed through a block of trees before moving to the next one, so
+/// that the model is not streamed from memory for every document.
+class VPred : public ScoringEngine {
+
+ public:
+  virtual std::string name() const {
+    return NAME_;
+  }
+
+  virtual bool add_tree(const RTNode *root, double weight);
+
+  virtual size_t num_trees() const {
+    return roots_.size();
+  }
+
+  virtual void add_scores(const quickrank::Feature *d, size_t num_docs,
+                          size_t num_features,
+                          quickrank::Score *scores) const;
+
+  /// Sets the size of the cache tiles are fitted to.
+  ///
+  /// \param bytes The size of the cache, 0 means the L2 cache of the CPU.
+  void set_cache_size(size_t bytes) {
+    cache_size_ = bytes;
+  }
+
+  /// Returns the number of documents scored at once.
+  static size_t width();
+
+  static const std::string NAME_;
+
+ private:
+  // node arrays (leaves have feature 0 and both children set to themselves)
+  std::vector<int32_t> features_;
+  std::vector<quickrank::Feature> thresholds_;
+  std::vector<int32_t> children_;  // left and right child of each node
+  std::vector<double> values_;  // leaf outputs
+
+  // per tree info
+  std::vector<int32_t> roots_;
+  std::vector<uint32_t> depths_;
+  std::vector<double> weights_;
+
+  // cache size used if the L2 size of the CPU is not known
+  static const size_t DEFAULT_CACHE_SIZE = 256 * 1024;
+  // bytes taken by a node in the arrays above
+  static const size_t NODE_BYTES = 3 * sizeof(int32_t) + sizeof(float)
+      + sizeof(double);
+
+  size_t cache_size_ = 0;
+
+  /// Returns the size of the cache tiles are fitted to.
+  size_t cache_size() const;
+
+  /// Adds the scores of a range of trees to a block of \a width() documents.
+  void add_block_scores(const quickrank::Feature *block, size_t num_features,
+                        size_t first_tree, size_t last_tree,
+                        quickrank::Score *scores) const;
+
+  /// Adds the scores of a range of trees document by document (e.g., to the
+  /// tail of a tile).
+  void add_scores_scalar(const quickrank::Feature *d, size_t num_docs,
+                         size_t num_features, size_t first_tree,
+                         size_t last_tree, quickrank::Score *scores) const;
+};
+
+}  // namespace scoring
+}  // namespace quickrank
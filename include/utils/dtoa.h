@@ -0,0 +1,70 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#pragma once
+
+#include <cstddef>
+
+/*! \file dtoa.h
+ * \brief shortest decimal representation of floating point numbers, and
+ * fast parsing of decimal numbers
+ */
+
+/*! max number of chars written by \a float_to_chars and \a double_to_chars
+ */
+const size_t TO_CHARS_MAX_LENGTH = 32;
+
+/*! write the shortest decimal representation of a float that is read back
+ *  (e.g., by strtof or scanf) as the same float, using the Grisu2 algorithm
+ *  (fixed notation for exponents in [-4, 15), scientific otherwise)
+ *  @param buffer output buffer of at least TO_CHARS_MAX_LENGTH chars (no null
+ *         terminator is written)
+ *  @param value float value
+ *  @return number of chars written
+ */
+size_t float_to_chars(char *buffer, float value);
+
+/*! write the shortest decimal representation of a double that is read back
+ *  (e.g., by strtod) as the same double, using the Grisu2 algorithm
+ *  @param buffer output buffer of at least TO_CHARS_MAX_LENGTH chars (no null
+ *         terminator is written)
+ *  @param value double value
+ *  @return number of chars written
+ */
+size_t double_to_chars(char *buffer, double value);
+
+/*! parse a decimal number as strtod does, i.e., the result is the double
+ *  nearest to the decimal value. Numbers with up to 19 significant digits
+ *  and decimal exponents in [-19, 19] (as those written by quickrank) are
+ *  converted exactly with 128 bits integers, the others by strtod
+ *  @param str null terminated string, leading spaces are skipped
+ *  @return the parsed value (0 if \a str is not a number)
+ */
+double chars_to_double(const char *str);
+
+/*! parse a decimal number as a float, by rounding the result of \a
+ *  chars_to_double (as pugixml does for XML values)
+ *  @param str null terminated string, leading spaces are skipped
+ *  @return the parsed value (0 if \a str is not a number)
+ */
+inline float chars_to_float(const char *str) {
+  return (float) chars_to_double(str);
+}
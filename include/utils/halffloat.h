@@ -0,0 +1,137 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+/*! convert a float to IEEE half precision, rounding to nearest even
+ *  @param value float value
+ *  @return half precision bits (overflows to infinity)
+ */
+inline uint16_t float_to_half(float value) {
+  uint32_t x;
+  std::memcpy(&x, &value, sizeof(x));
+  const uint32_t sign = x & 0x80000000u;
+  x ^= sign;
+
+  uint16_t h;
+  if (x >= 0x47800000u) {
+    // inf or nan (values greater or equal than 2^16)
+    h = x > 0x7f800000u ? 0x7e00 : 0x7c00;
+  } else if (x < 0x38800000u) {
+    // subnormal or zero: the addition aligns and rounds the mantissa
+    const uint32_t magic_bits = 0x3f000000u;  // 0.5
+    float magic, f;
+    std::memcpy(&magic, &magic_bits, sizeof(magic));
+    std::memcpy(&f, &x, sizeof(f));
+    f += magic;
+    std::memcpy(&x, &f, sizeof(x));
+    h = (uint16_t) (x - magic_bits);
+  } else {
+    // normal: rebias the exponent and round to nearest even
+    const uint32_t mantissa_odd = (x >> 13) & 1;
+    x += 0xc8000fffu + mantissa_odd;
+    h = (uint16_t) (x >> 13);
+  }
+  return h | (uint16_t) (sign >> 16);
+}
+
+/*! convert IEEE half precision to float (exact)
+ *  @param h half precision bits
+ *  @return float value
+ */
+inline float half_to_float(uint16_t h) {
+  uint32_t x = (uint32_t) (h & 0x7fff) << 13;
+  const uint32_t exponent = x & 0x0f800000u;
+  x += 0x38000000u;
+  if (exponent == 0x0f800000u) {
+    // inf or nan
+    x += 0x38000000u;
+  } else if (exponent == 0) {
+    // subnormal or zero: renormalize
+    const uint32_t magic_bits = 0x38800000u;  // 2^-14
+    float magic, f;
+    x += 0x00800000u;
+    std::memcpy(&magic, &magic_bits, sizeof(magic));
+    std::memcpy(&f, &x, sizeof(f));
+    f -= magic;
+    std::memcpy(&x, &f, sizeof(x));
+  }
+  x |= (uint32_t) (h & 0x8000) << 16;
+  float value;
+  std::memcpy(&value, &x, sizeof(value));
+  return value;
+}
+
+/*! convert a float to bfloat16, rounding to nearest even
+ *  @param value float value
+ *  @return bfloat16 bits
+ */
+inline uint16_t float_to_bfloat16(float value) {
+  uint32_t x;
+  std::memcpy(&x, &value, sizeof(x));
+  if ((x & 0x7fffffffu) > 0x7f800000u)
+    return (uint16_t) ((x >> 16) | 0x0040);  // quiet nan
+  x += 0x7fffu + ((x >> 16) & 1);
+  return (uint16_t) (x >> 16);
+}
+
+/*! convert bfloat16 to float (exact)
+ *  @param b bfloat16 bits
+ *  @return float value
+ */
+inline float bfloat16_to_float(uint16_t b) {
+  const uint32_t x = (uint32_t) b << 16;
+  float value;
+  std::memcpy(&value, &x, sizeof(value));
+  return value;
+}
+
+/*! widen an array of half precision values (vectorized when F16C is available)
+ *  @param output float array
+ *  @param input half precision array
+ *  @param n number of values
+ */
+void half_to_float(float *output, const uint16_t *input, const size_t n);
+
+/*! narrow an array of float values to half precision
+ *  @param output half precision array
+ *  @param input float array
+ *  @param n number of values
+ */
+void float_to_half(uint16_t *output, const float *input, const size_t n);
+
+/*! widen an array of bfloat16 values
+ *  @param output float array
+ *  @param input bfloat16 array
+ *  @param n number of values
+ */
+void bfloat16_to_float(float *output, const uint16_t *input, const size_t n);
+
+/*! narrow an array of float values to bfloat16
+ *  @param output bfloat16 array
+ *  @param input float array
+ *  @param n number of values
+ */
+void float_to_bfloat16(uint16_t *output, const float *input, const size_t n);
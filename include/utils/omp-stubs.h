@@ -22,5 +22,6 @@
 #pragma once
 
 const int omp_get_num_procs();
+const int omp_get_max_threads();
 const int omp_get_thread_num();
 const double omp_get_wtime();
\ No newline at end of file
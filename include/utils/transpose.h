@@ -23,12 +23,21 @@
 
 #include <stdlib.h>
 
-/*! traspose \a input float matrix made up of \a n rows and \a m columns block by block
- *  @param input matrix to transpose
- *  @param output trasposed matrix
+/*! \file transpose.h
+ * \brief conversion of row-major matrices into column-major ones (and vice
+ * versa), e.g., horizontal datasets into vertical ones
+ */
+
+/*! transpose \a input float matrix made up of \a n rows and \a m columns into
+ *  \a output. The matrix is split in tiles fitting the L1 cache, which are
+ *  transposed in parallel by blocks of 4x4 elements (with SSE instructions).
+ *  Output tiles are statically assigned to threads, thus the pages of a newly
+ *  allocated output are first touched (and placed on the NUMA node of) the
+ *  threads that then process them with a static schedule.
+ *  @param output transposed matrix (\a m rows of \a n elements)
+ *  @param input matrix to transpose (\a n rows of \a m elements)
  *  @param n number of rows of input matrix
  *  @param m number of columns of input matrix
  */
-void transpose(float **output, float **input, const size_t n,
+void transpose(float *output, const float *input, const size_t n,
                const size_t m);
-
@@ -0,0 +1,287 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "data/binned_column_store.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace quickrank {
+namespace data {
+
+BinnedColumnStore::BinnedColumnStore(const std::string &directory,
+                                     std::shared_ptr<Dataset> dataset,
+                                     size_t shard_size,
+                                     float **thresholds,
+                                     size_t *thresholds_size)
+    : BinnedFeatures(dataset->num_features(), dataset->num_instances()),
+      directory_(directory) {
+
+  thresholds_ = thresholds;
+  thresholds_size_ = thresholds_size;
+
+  auto chrono_start = std::chrono::high_resolution_clock::now();
+
+  size_t max_thresholds = 0;
+  for (size_t f = 0; f < num_features_; ++f)
+    max_thresholds = std::max(max_thresholds, thresholds_size_[f]);
+  if (max_thresholds <= UINT8_MAX + 1)
+    bin_width_ = sizeof(uint8_t);
+  else if (max_thresholds <= UINT16_MAX + 1)
+    bin_width_ = sizeof(uint16_t);
+  else
+    bin_width_ = sizeof(uint32_t);
+
+  // shards are aligned to query boundaries
+  shard_offsets_.push_back(0);
+  for (size_t q = 1; q <= dataset->num_queries(); ++q) {
+    if (dataset->offset(q) - shard_offsets_.back() >= shard_size
+        || q == dataset->num_queries())
+      shard_offsets_.push_back(dataset->offset(q));
+  }
+
+  for (size_t s = 0; s + 1 < shard_offsets_.size(); ++s) {
+    const size_t bytes = shard_length(s) * num_features_ * bin_width_;
+    if (directory_.empty()) {
+      // in-memory store
+      void *shard = mmap(NULL, std::max<size_t>(bytes, 1),
+                         PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (shard == MAP_FAILED) {
+        std::cerr << "!!! Impossible to allocate memory for binned features: "
+                  << strerror(errno) << std::endl;
+        exit(EXIT_FAILURE);
+      }
+      shards_.push_back(shard);
+      shard_bytes_.push_back(std::max<size_t>(bytes, 1));
+      fill_shard(s, dataset);
+      continue;
+    }
+
+    std::stringstream filename;
+    filename << directory_ << "/quickrank-" << getpid() << "-shard" << s
+             << ".bin";
+
+    int fd = open(filename.str().c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd == -1 || ftruncate(fd, bytes) != 0) {
+      std::cerr << "!!! Impossible to create shard file " << filename.str()
+                << ": " << strerror(errno) << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    void *shard = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (shard == MAP_FAILED) {
+      std::cerr << "!!! Impossible to map shard file " << filename.str()
+                << ": " << strerror(errno) << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    // the mapping keeps the file alive, the disk space is released on unmap
+    unlink(filename.str().c_str());
+    close(fd);
+
+    shards_.push_back(shard);
+    shard_bytes_.push_back(bytes);
+    fill_shard(s, dataset);
+
+    // let the kernel write back the shard and seal it
+    msync(shard, bytes, MS_ASYNC);
+    mprotect(shard, bytes, PROT_READ);
+  }
+
+  auto chrono_end = std::chrono::high_resolution_clock::now();
+  building_time_ = std::chrono::duration_cast<std::chrono::duration<double>>(
+      chrono_end - chrono_start).count();
+}
+
+BinnedColumnStore::~BinnedColumnStore() {
+  for (size_t s = 0; s < shards_.size(); ++s)
+    munmap(shards_[s], shard_bytes_[s]);
+}
+
+void BinnedColumnStore::fill_shard(size_t shard,
+                                   std::shared_ptr<Dataset> dataset) {
+  switch (bin_width_) {
+    case 1:
+      fill_shard<uint8_t>(shard, dataset);
+      break;
+    case 2:
+      fill_shard<uint16_t>(shard, dataset);
+      break;
+    default:
+      fill_shard<uint32_t>(shard, dataset);
+  }
+}
+
+template<typename BinType>
+void BinnedColumnStore::fill_shard(size_t shard,
+                                   std::shared_ptr<Dataset> dataset) {
+  BinType *columns = (BinType *) shards_[shard];
+  const size_t begin = shard_begin(shard);
+  const size_t length = shard_length(shard);
+
+  #pragma omp parallel
+  {
+    // features not stored as floats are widened into a per-thread row
+    std::vector<Feature> row(
+        dataset->has_float_features() ? 0 : num_features_, 0.0f);
+    #pragma omp for
+    for (size_t i = 0; i < length; ++i) {
+      const Feature *d;
+      if (dataset->has_float_features()) {
+        d = dataset->at(begin + i, 0);
+      } else {
+        dataset->fill_row(begin + i, row.data());
+        d = row.data();
+      }
+      for (size_t f = 0; f < num_features_; ++f) {
+        const float *t = thresholds_[f];
+        const size_t nt = thresholds_size_[f];
+        // first threshold greater or equal than the feature value
+        size_t b = std::lower_bound(t, t + nt, d[f]) - t;
+        columns[f * length + i] = (BinType) std::min(b, nt - 1);
+      }
+      dataset->clear_row(begin + i, row.data());
+    }
+  }
+}
+
+void BinnedColumnStore::histogram(const size_t *sampleids, size_t nsampleids,
+                                  const double *labels,
+                                  double **sumlbl, size_t **count) const {
+  switch (bin_width_) {
+    case 1:
+      histogram<uint8_t>(sampleids, nsampleids, labels, sumlbl, count);
+      break;
+    case 2:
+      histogram<uint16_t>(sampleids, nsampleids, labels, sumlbl, count);
+      break;
+    default:
+      histogram<uint32_t>(sampleids, nsampleids, labels, sumlbl, count);
+  }
+}
+
+template<typename BinType>
+void BinnedColumnStore::histogram(const size_t *sampleids, size_t nsampleids,
+                                  const double *labels,
+                                  double **sumlbl, size_t **count) const {
+  const size_t *first = sampleids;
+  const size_t *end = sampleids + nsampleids;
+  for (size_t s = 0; s < shards_.size() && first != end; ++s) {
+    const size_t *last = std::lower_bound(first, end, shard_end(s));
+    if (first == last)
+      continue;
+    if (s + 1 < shards_.size())
+      prefetch(s + 1);
+
+    const BinType *columns = (const BinType *) shards_[s];
+    const size_t begin = shard_begin(s);
+    const size_t length = shard_length(s);
+
+    #pragma omp parallel for
+    for (size_t f = 0; f < num_features_; ++f) {
+      const BinType *column = columns + f * length - begin;
+      for (const size_t *p = first; p != last; ++p) {
+        const size_t t = column[*p];
+        sumlbl[f][t] += labels[*p];
+        count[f][t]++;
+      }
+    }
+    first = last;
+  }
+}
+
+void BinnedColumnStore::partition(size_t feature_id, size_t bin,
+                                  const size_t *sampleids, size_t nsampleids,
+                                  size_t *lsamples, size_t &lsize,
+                                  size_t *rsamples, size_t &rsize) const {
+  switch (bin_width_) {
+    case 1:
+      partition<uint8_t>(feature_id, bin, sampleids, nsampleids,
+                         lsamples, lsize, rsamples, rsize);
+      break;
+    case 2:
+      partition<uint16_t>(feature_id, bin, sampleids, nsampleids,
+                          lsamples, lsize, rsamples, rsize);
+      break;
+    default:
+      partition<uint32_t>(feature_id, bin, sampleids, nsampleids,
+                          lsamples, lsize, rsamples, rsize);
+  }
+}
+
+template<typename BinType>
+void BinnedColumnStore::partition(size_t feature_id, size_t bin,
+                                  const size_t *sampleids, size_t nsampleids,
+                                  size_t *lsamples, size_t &lsize,
+                                  size_t *rsamples, size_t &rsize) const {
+  lsize = rsize = 0;
+  const size_t *first = sampleids;
+  const size_t *end = sampleids + nsampleids;
+  for (size_t s = 0; s < shards_.size() && first != end; ++s) {
+    const size_t *last = std::lower_bound(first, end, shard_end(s));
+    const BinType *column = (const BinType *) shards_[s]
+        + feature_id * shard_length(s) - shard_begin(s);
+    for (const size_t *p = first; p != last; ++p) {
+      if (column[*p] <= bin)
+        lsamples[lsize++] = *p;
+      else
+        rsamples[rsize++] = *p;
+    }
+    first = last;
+  }
+}
+
+void BinnedColumnStore::prefetch(size_t shard) const {
+  madvise(shards_[shard], shard_bytes_[shard], MADV_WILLNEED);
+}
+
+std::ostream &BinnedColumnStore::put(std::ostream &os) const {
+  size_t bytes = 0;
+  for (auto b: shard_bytes_)
+    bytes += b;
+  const size_t in_memory_bytes = num_instances_ * num_features_
+      * (sizeof(Feature) + 2 * sizeof(size_t));
+  if (directory_.empty())
+    os << "#\t In-memory binned features: " << bin_width_
+       << " bytes per bin" << std::endl
+       << "#\t Bins size: " << std::setprecision(2)
+       << bytes / 1024.0 / 1024.0 << " MB (vs. "
+       << in_memory_bytes / 1024.0 / 1024.0 << " MB with sorted indices)"
+       << std::endl;
+  else
+    os << "#\t Out-of-core store: " << shards_.size() << " shards in "
+       << directory_ << " (" << bin_width_ << " bytes per bin)" << std::endl
+       << "#\t Shards size: " << std::setprecision(2)
+       << bytes / 1024.0 / 1024.0 << " MB (vs. "
+       << in_memory_bytes / 1024.0 / 1024.0 << " MB in memory)" << std::endl;
+  os << "#\t Binning time: " << building_time_ << " s." << std::endl;
+  return os;
+}
+
+}  // namespace data
+}  // namespace quickrank
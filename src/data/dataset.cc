@@ -21,26 +21,140 @@
  */
 #include "data/dataset.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
 #include <iomanip>
 #include <cstring>
+#include <new>
+#include <thread>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "utils/halffloat.h"
 
 namespace quickrank {
 namespace data {
 
-Dataset::Dataset(size_t n_instances, size_t n_features) {
+namespace {
+
+// A shared memory segment stores a SharedHeader followed by the key, padded
+// to a page, and by the query offsets, the feature ids, the labels and the
+// features of the dataset, each aligned to 64 bytes. Only the header is
+// writable once the segment has been published.
+const uint64_t SHARED_MAGIC = 0x7164617461736574;  // "qdataset"
+const uint32_t SHARED_VERSION = 1;
+
+struct SharedInfo {
+  uint64_t magic;
+  uint32_t version;
+  uint32_t storage;
+  uint64_t num_instances;
+  uint64_t num_features;
+  uint64_t num_queries;
+  uint64_t num_nonzeros;
+  uint64_t num_feature_ids;
+  uint64_t key_size;
+  int64_t publisher;
+};
+
+struct SharedHeader {
+  SharedInfo info;
+  std::atomic<uint32_t> ready;
+  std::atomic<uint64_t> references;
+};
+
+struct SharedLayout {
+  size_t payload;
+  size_t offsets;
+  size_t feature_ids;
+  size_t labels;
+  size_t features;  // dense features, or sparse row offsets
+  size_t columns;
+  size_t values;
+  size_t bytes;
+};
+
+SharedLayout shared_layout(const SharedInfo &info) {
+  const size_t page = sysconf(_SC_PAGESIZE);
+  auto align = [](size_t bytes, size_t alignment) {
+    return (bytes + alignment - 1) / alignment * alignment;
+  };
+
+  SharedLayout l;
+  l.payload = align(sizeof(SharedHeader) + info.key_size, page);
+  l.offsets = l.payload;
+  l.feature_ids = align(l.offsets + (info.num_queries + 1) * sizeof(size_t),
+                        64);
+  l.labels = align(l.feature_ids + info.num_feature_ids * sizeof(size_t), 64);
+  l.features = align(l.labels + info.num_instances * sizeof(Label), 64);
+  l.columns = l.values = l.bytes = l.features;
+  switch (info.storage) {
+    case Dataset::SPARSE:
+      l.columns = align(l.features
+                            + (info.num_instances + 1) * sizeof(size_t), 64);
+      l.values = align(l.columns + info.num_nonzeros * sizeof(uint32_t), 64);
+      l.bytes = l.values + info.num_nonzeros * sizeof(Feature);
+      break;
+    case Dataset::FLOAT16:
+    case Dataset::BFLOAT16:
+      l.bytes += info.num_instances * info.num_features * sizeof(uint16_t);
+      break;
+    default:
+      l.bytes += info.num_instances * info.num_features * sizeof(Feature);
+  }
+  return l;
+}
+
+}  // namespace
+
+Dataset::Dataset(size_t n_instances, size_t n_features, Storage storage,
+                 size_t n_nonzeros) {
   max_instances_ = n_instances;
   num_features_ = n_features;
   num_instances_ = 0;
   num_queries_ = 0;
   last_instance_id_ = 0;
+  storage_ = storage;
 
-  if (posix_memalign((void **) &data_, 16,
-                     max_instances_ * num_features_ * sizeof(Feature)) != 0) {
-    std::cerr << "!!! Impossible to allocate memory for dataset storage."
-              << std::endl;
+  if (storage_ == COLUMNS) {
+    std::cerr << "!!! Column-major datasets can only be built by wrapping "
+                 "existing buffers." << std::endl;
     exit(EXIT_FAILURE);
   }
-  std::memset(data_, 0, max_instances_ * num_features_ * sizeof(Feature));
+
+  if (storage_ == SPARSE) {
+    row_offsets_.reserve(max_instances_ + 1);
+    row_offsets_.push_back(0);
+    columns_.reserve(n_nonzeros);
+    values_.reserve(n_nonzeros);
+    update_sparse_pointers();
+  } else if (storage_ == FLOAT16 || storage_ == BFLOAT16) {
+    if (posix_memalign((void **) &data16_, 16,
+                       max_instances_ * num_features_ * sizeof(uint16_t))
+        != 0) {
+      std::cerr << "!!! Impossible to allocate memory for dataset storage."
+                << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    // zero is all zero bits in both the 16 bits formats
+    std::memset(data16_, 0, max_instances_ * num_features_ * sizeof(uint16_t));
+  } else {
+    if (posix_memalign((void **) &data_, 16,
+                       max_instances_ * num_features_ * sizeof(Feature)) != 0) {
+      std::cerr << "!!! Impossible to allocate memory for dataset storage."
+                << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    std::memset(data_, 0, max_instances_ * num_features_ * sizeof(Feature));
+  }
 
   if (posix_memalign((void **) &labels_, 16, max_instances_ * sizeof(Label))
       != 0) {
@@ -53,13 +167,126 @@ Dataset::Dataset(size_t n_instances, size_t n_features) {
   offsets_.push_back(0);
 }
 
+std::shared_ptr<Dataset> Dataset::wrap(size_t n_instances, size_t n_features,
+                                       size_t n_queries, const size_t *offsets,
+                                       Label *labels, Feature *features,
+                                       Storage storage,
+                                       std::shared_ptr<void> owner) {
+  if (storage != FLOAT32 && storage != COLUMNS) {
+    std::cerr << "!!! Only float32 and column-major buffers can be wrapped."
+              << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  bool valid_offsets = offsets[0] == 0 && offsets[n_queries] == n_instances;
+  for (size_t q = 0; q < n_queries && valid_offsets; ++q)
+    valid_offsets = offsets[q] < offsets[q + 1];
+  if (!valid_offsets) {
+    std::cerr << "!!! Invalid query offsets of the buffers to be wrapped."
+              << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  std::shared_ptr<Dataset> dataset(new Dataset());
+  dataset->storage_ = storage;
+  dataset->num_instances_ = dataset->max_instances_ = n_instances;
+  dataset->num_features_ = n_features;
+  dataset->num_queries_ = n_queries;
+  dataset->last_instance_id_ = 0;
+  dataset->offsets_.assign(offsets, offsets + n_queries + 1);
+  dataset->labels_ = labels;
+  dataset->data_ = features;
+  dataset->external_ = true;
+  dataset->external_owner_ = owner;
+  return dataset;
+}
+
+std::shared_ptr<Dataset> Dataset::with_float_rows(
+    std::shared_ptr<Dataset> dataset) {
+  if (dataset->has_float_features())
+    return dataset;
+
+  // the buffers are adopted by the copy
+  struct Buffers {
+    std::vector<Label> labels;
+    std::vector<Feature> features;
+  };
+  std::shared_ptr<Buffers> buffers = std::make_shared<Buffers>();
+  const size_t num_instances = dataset->num_instances_;
+  const size_t num_features = dataset->num_features_;
+  buffers->labels.resize(num_instances);
+  buffers->features.resize(num_instances * num_features, 0.0f);
+  #pragma omp parallel for
+  for (size_t i = 0; i < num_instances; ++i) {
+    buffers->labels[i] = dataset->labels_[i];
+    dataset->fill_row(i, buffers->features.data() + i * num_features);
+  }
+
+  std::shared_ptr<Dataset> copy = wrap(num_instances, num_features,
+                                       dataset->num_queries_,
+                                       dataset->offsets_.data(),
+                                       buffers->labels.data(),
+                                       buffers->features.data(), FLOAT32,
+                                       buffers);
+  copy->feature_ids_ = dataset->feature_ids_;
+  return copy;
+}
+
 Dataset::~Dataset() {
+  if (external_)
+    return;
+  if (segment_) {
+    SharedHeader *header = (SharedHeader *) segment_;
+    // the last dataset using the segment removes it
+    if (header->references.fetch_sub(1) == 1)
+      shm_unlink(segment_name_.c_str());
+    munmap(segment_, segment_bytes_);
+    return;
+  }
   if (data_)
     free(data_);
+  if (data16_)
+    free(data16_);
   if (labels_)
     free(labels_);
 }
 
+size_t Dataset::release_features() {
+  if (external_ || segment_ || features_released_)
+    return 0;
+
+  size_t bytes = 0;
+  if (data_) {
+    bytes += num_instances_ * num_features_ * sizeof(Feature);
+    free(data_);
+    data_ = NULL;
+  }
+  if (data16_) {
+    bytes += num_instances_ * num_features_ * sizeof(uint16_t);
+    free(data16_);
+    data16_ = NULL;
+  }
+  // the positions of the non-zeros index the bins of sparse binned features
+  bytes += values_.capacity() * sizeof(Feature);
+  std::vector<Feature>().swap(values_);
+  update_sparse_pointers();
+
+  features_released_ = true;
+  return bytes;
+}
+
+void Dataset::features_access_error() const {
+  if (features_released_)
+    std::cerr << "!!! Features of the dataset have been released."
+              << std::endl;
+  else if (has_float_features())
+    std::cerr << "!!! Features of shared datasets cannot be modified."
+              << std::endl;
+  else
+    std::cerr << "!!! Features of " << storage_name(storage_)
+              << " datasets cannot be accessed in place." << std::endl;
+  exit(EXIT_FAILURE);
+}
+
 void Dataset::addInstance(QueryID q_id, Label i_label,
                           std::vector<Feature> i_features) {
 
@@ -69,11 +296,72 @@ void Dataset::addInstance(QueryID q_id, Label i_label,
     exit(EXIT_FAILURE);
   }
 
-  // update label and features
+  // update features
+  if (storage_ == SPARSE) {
+    for (size_t i = 0; i < i_features.size(); i++) {
+      if (i_features[i] != 0.0f) {
+        columns_.push_back(i);
+        values_.push_back(i_features[i]);
+      }
+    }
+    row_offsets_.push_back(values_.size());
+    update_sparse_pointers();
+  } else if (storage_ == FLOAT16) {
+    float_to_half(data16_ + (num_instances_ * num_features_),
+                  i_features.data(), i_features.size());
+  } else if (storage_ == BFLOAT16) {
+    float_to_bfloat16(data16_ + (num_instances_ * num_features_),
+                      i_features.data(), i_features.size());
+  } else {
+    quickrank::Feature *new_instance =
+        data_ + (num_instances_ * num_features_);
+    for (size_t i = 0; i < i_features.size(); i++)
+      new_instance[i] = i_features[i];
+  }
+
+  add_label(q_id, i_label);
+}
+
+void Dataset::addInstance(QueryID q_id, Label i_label,
+                          const std::vector<uint32_t> &i_columns,
+                          const std::vector<Feature> &i_values) {
+
+  if (i_columns.size() != i_values.size()
+      || (!i_columns.empty() && i_columns.back() >= num_features_)
+      || num_instances_ == max_instances_) {
+    std::cerr << "!!! Impossible to add a new instance to the dataset."
+              << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  // update features
+  if (storage_ == SPARSE) {
+    for (size_t i = 0; i < i_columns.size(); i++) {
+      if (i_values[i] != 0.0f) {
+        columns_.push_back(i_columns[i]);
+        values_.push_back(i_values[i]);
+      }
+    }
+    row_offsets_.push_back(values_.size());
+    update_sparse_pointers();
+  } else if (storage_ == FLOAT16 || storage_ == BFLOAT16) {
+    uint16_t *new_instance = data16_ + (num_instances_ * num_features_);
+    for (size_t i = 0; i < i_columns.size(); i++)
+      new_instance[i_columns[i]] = storage_ == FLOAT16
+                                   ? float_to_half(i_values[i])
+                                   : float_to_bfloat16(i_values[i]);
+  } else {
+    quickrank::Feature *new_instance =
+        data_ + (num_instances_ * num_features_);
+    for (size_t i = 0; i < i_columns.size(); i++)
+      new_instance[i_columns[i]] = i_values[i];
+  }
+
+  add_label(q_id, i_label);
+}
+
+void Dataset::add_label(QueryID q_id, Label i_label) {
   labels_[num_instances_] = i_label;
-  quickrank::Feature *new_instance = data_ + (num_instances_ * num_features_);
-  for (size_t i = 0; i < i_features.size(); i++)
-    new_instance[i] = i_features[i];
 
   // update offset of last query result
   if (num_instances_ == 0 || last_instance_id_ != q_id) {
@@ -87,7 +375,9 @@ void Dataset::addInstance(QueryID q_id, Label i_label,
 
 std::unique_ptr<QueryResults> Dataset::getQueryResults(size_t i) const {
   size_t num_results = offsets_[i + 1] - offsets_[i];
-  quickrank::Feature *start_data = data_ + offsets_[i] * num_features_;
+  // only float datasets have dense features to be pointed to
+  quickrank::Feature *start_data =
+      storage_ != FLOAT32 ? NULL : data_ + offsets_[i] * num_features_;
   quickrank::Label *start_label = labels_ + offsets_[i];
 
   QueryResults *qr = new QueryResults(num_results, start_label, start_data);
@@ -95,9 +385,344 @@ std::unique_ptr<QueryResults> Dataset::getQueryResults(size_t i) const {
   return std::unique_ptr<QueryResults>(qr);
 }
 
+Feature Dataset::value(size_t document_id, size_t feature_id) const {
+  if (features_released_)
+    features_access_error();
+  const size_t i = document_id * num_features_ + feature_id;
+  switch (storage_) {
+    case FLOAT16:
+      return half_to_float(data16_[i]);
+    case BFLOAT16:
+      return bfloat16_to_float(data16_[i]);
+    case SPARSE: {
+      const uint32_t *begin = nonzero_columns(document_id);
+      const uint32_t *end = begin + num_nonzeros(document_id);
+      const uint32_t *c = std::lower_bound(begin, end, feature_id);
+      return c == end || *c != feature_id ? 0.0f
+                                          : values_data_[c - columns_data_];
+    }
+    case COLUMNS:
+      return data_[feature_id * num_instances_ + document_id];
+    default:
+      return data_[i];
+  }
+}
+
+Feature Dataset::split_threshold(Feature threshold) const {
+  if ((storage_ != FLOAT16 && storage_ != BFLOAT16) || threshold >= FLT_MAX)
+    return threshold;
+
+  auto narrow = [this](float v) {
+    return storage_ == FLOAT16 ? float_to_half(v) : float_to_bfloat16(v);
+  };
+  auto widen = [this](uint16_t h) {
+    return storage_ == FLOAT16 ? half_to_float(h) : bfloat16_to_float(h);
+  };
+
+  // the largest 16 bits value not greater than the threshold, and the next
+  // one (16 bits values are sign-magnitude)
+  uint16_t r = narrow(threshold);
+  if (widen(r) > threshold)
+    r = (r & 0x8000) ? r + 1 : (r == 0 ? 0x8001 : r - 1);
+  const uint16_t n = (r & 0x8000) ? (r == 0x8000 ? 0x0001 : r - 1) : r + 1;
+  const float lo = widen(r);
+  const float hi = widen(n);
+  if (std::isinf(hi))
+    return lo;
+
+  // floats up to the midpoint are rounded to r (ties to even)
+  float mid = (float) (((double) lo + hi) / 2.0);
+  if (widen(narrow(mid)) > lo)
+    mid = std::nextafter(mid, -FLT_MAX);
+  return mid;
+}
+
+const char *Dataset::storage_name(Storage storage) {
+  switch (storage) {
+    case FLOAT16:
+      return "float16";
+    case BFLOAT16:
+      return "bfloat16";
+    case SPARSE:
+      return "sparse";
+    case COLUMNS:
+      return "columns";
+    default:
+      return "float32";
+  }
+}
+
+void Dataset::fill_row(size_t document_id, Feature *row) const {
+  if (features_released_)
+    features_access_error();
+  switch (storage_) {
+    case SPARSE:
+      for (size_t k = row_offsets_data_[document_id];
+           k < row_offsets_data_[document_id + 1]; ++k)
+        row[columns_data_[k]] = values_data_[k];
+      break;
+    case FLOAT16:
+      half_to_float(row, data16_ + document_id * num_features_,
+                    num_features_);
+      break;
+    case BFLOAT16:
+      bfloat16_to_float(row, data16_ + document_id * num_features_,
+                        num_features_);
+      break;
+    case COLUMNS:
+      for (size_t f = 0; f < num_features_; ++f)
+        row[f] = data_[f * num_instances_ + document_id];
+      break;
+    default:
+      std::memcpy(row, data_ + document_id * num_features_,
+                  num_features_ * sizeof(Feature));
+  }
+}
+
+void Dataset::clear_row(size_t document_id, Feature *row) const {
+  if (storage_ == SPARSE) {
+    for (size_t k = row_offsets_data_[document_id];
+         k < row_offsets_data_[document_id + 1]; ++k)
+      row[columns_data_[k]] = 0.0f;
+  }
+}
+
+void Dataset::update_sparse_pointers() {
+  row_offsets_data_ = row_offsets_.data();
+  columns_data_ = columns_.data();
+  values_data_ = values_.data();
+  num_nonzeros_ = columns_.size();
+}
+
+bool Dataset::publish_shared(const std::string &name, const std::string &key) {
+  SharedInfo info;
+  info.magic = SHARED_MAGIC;
+  info.version = SHARED_VERSION;
+  info.storage = storage_;
+  info.num_instances = num_instances_;
+  info.num_features = num_features_;
+  info.num_queries = num_queries_;
+  info.num_nonzeros = num_nonzeros_;
+  info.num_feature_ids = feature_ids_.size();
+  info.key_size = key.size();
+  info.publisher = getpid();
+  const SharedLayout layout = shared_layout(info);
+
+  int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (fd == -1) {
+    if (errno == EEXIST)
+      return false;
+    std::cerr << "!!! Impossible to create shared memory segment " << name
+              << ": " << strerror(errno) << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  void *segment = MAP_FAILED;
+  if (ftruncate(fd, layout.bytes) == 0)
+    segment = mmap(NULL, layout.bytes, PROT_READ | PROT_WRITE, MAP_SHARED,
+                   fd, 0);
+  if (segment == MAP_FAILED) {
+    std::cerr << "!!! Impossible to map shared memory segment " << name
+              << ": " << strerror(errno) << std::endl;
+    shm_unlink(name.c_str());
+    exit(EXIT_FAILURE);
+  }
+  close(fd);
+
+  // attaching processes wait until the segment is marked as ready
+  SharedHeader *header = new(segment) SharedHeader();
+  header->info = info;
+  char *base = (char *) segment;
+  std::memcpy(base + sizeof(SharedHeader), key.data(), key.size());
+  std::memcpy(base + layout.offsets, offsets_.data(),
+              (num_queries_ + 1) * sizeof(size_t));
+  std::memcpy(base + layout.feature_ids, feature_ids_.data(),
+              feature_ids_.size() * sizeof(size_t));
+  std::memcpy(base + layout.labels, labels_, num_instances_ * sizeof(Label));
+  switch (storage_) {
+    case SPARSE:
+      std::memcpy(base + layout.features, row_offsets_data_,
+                  (num_instances_ + 1) * sizeof(size_t));
+      std::memcpy(base + layout.columns, columns_data_,
+                  num_nonzeros_ * sizeof(uint32_t));
+      std::memcpy(base + layout.values, values_data_,
+                  num_nonzeros_ * sizeof(Feature));
+      break;
+    case FLOAT16:
+    case BFLOAT16:
+      std::memcpy(base + layout.features, data16_,
+                  num_instances_ * num_features_ * sizeof(uint16_t));
+      break;
+    default:
+      std::memcpy(base + layout.features, data_,
+                  num_instances_ * num_features_ * sizeof(Feature));
+  }
+
+  // release the private copy and use the segment in its place
+  if (!external_) {
+    free(data_);
+    free(data16_);
+    free(labels_);
+  }
+  external_ = false;
+  external_owner_.reset();
+  std::vector<size_t>().swap(row_offsets_);
+  std::vector<uint32_t>().swap(columns_);
+  std::vector<Feature>().swap(values_);
+  segment_name_ = name;
+  segment_publisher_ = true;
+  map_segment(segment);
+
+  mprotect(base + layout.payload, layout.bytes - layout.payload, PROT_READ);
+  header->references.store(1);
+  header->ready.store(1);
+  return true;
+}
+
+std::shared_ptr<Dataset> Dataset::attach_shared(const std::string &name,
+                                                const std::string &key) {
+  int fd = shm_open(name.c_str(), O_RDWR, 0);
+  if (fd == -1) {
+    if (errno == ENOENT)
+      return nullptr;
+    std::cerr << "!!! Impossible to open shared memory segment " << name
+              << ": " << strerror(errno) << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  // the publisher may have not sized and filled the segment yet: wait for
+  // it, unless it terminated before completing the segment
+  const auto pause = std::chrono::milliseconds(100);
+  struct stat st;
+  for (size_t wait = 0;; ++wait) {
+    if (fstat(fd, &st) == 0 && st.st_size >= (off_t) sizeof(SharedHeader))
+      break;
+    if (wait == 100) {
+      std::cerr << "!!! Shared memory segment " << name << " is empty"
+                << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    std::this_thread::sleep_for(pause);
+  }
+  void *segment = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                       fd, 0);
+  close(fd);
+  if (segment == MAP_FAILED) {
+    std::cerr << "!!! Impossible to map shared memory segment " << name
+              << ": " << strerror(errno) << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  SharedHeader *header = (SharedHeader *) segment;
+  for (size_t wait = 0; !header->ready.load(); ++wait) {
+    const bool started = header->info.magic == SHARED_MAGIC;
+    if ((started && kill(header->info.publisher, 0) != 0 && errno == ESRCH)
+        || (!started && wait == 100)) {
+      std::cerr << "!!! Shared memory segment " << name
+                << " was not completed by its publisher (remove it from "
+                    "/dev/shm)" << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    std::this_thread::sleep_for(pause);
+  }
+
+  const SharedInfo &info = header->info;
+  const char *stored_key = (const char *) segment + sizeof(SharedHeader);
+  if (info.magic != SHARED_MAGIC || info.version != SHARED_VERSION
+      || (size_t) st.st_size != shared_layout(info).bytes) {
+    std::cerr << "!!! Shared memory segment " << name
+              << " does not store a dataset" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  if (std::string(stored_key, info.key_size) != key) {
+    std::cerr << "!!! Shared memory segment " << name
+              << " stores a different dataset: "
+              << std::string(stored_key, info.key_size) << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  // take a reference, unless the last user is removing the segment
+  uint64_t references = header->references.load();
+  do {
+    if (references == 0) {
+      munmap(segment, st.st_size);
+      return nullptr;
+    }
+  } while (!header->references.compare_exchange_weak(references,
+                                                     references + 1));
+
+  const SharedLayout layout = shared_layout(info);
+  mprotect((char *) segment + layout.payload, layout.bytes - layout.payload,
+           PROT_READ);
+
+  std::shared_ptr<Dataset> dataset(new Dataset());
+  dataset->segment_name_ = name;
+  dataset->map_segment(segment);
+  return dataset;
+}
+
+void Dataset::map_segment(void *segment) {
+  const SharedInfo &info = ((const SharedHeader *) segment)->info;
+  const SharedLayout layout = shared_layout(info);
+  char *base = (char *) segment;
+
+  storage_ = (Storage) info.storage;
+  num_instances_ = max_instances_ = info.num_instances;
+  num_features_ = info.num_features;
+  num_queries_ = info.num_queries;
+  last_instance_id_ = 0;
+
+  // query offsets and feature ids are small enough to be copied
+  const size_t *offsets = (const size_t *) (base + layout.offsets);
+  offsets_.assign(offsets, offsets + num_queries_ + 1);
+  const size_t *feature_ids = (const size_t *) (base + layout.feature_ids);
+  feature_ids_.assign(feature_ids, feature_ids + info.num_feature_ids);
+
+  labels_ = (Label *) (base + layout.labels);
+  data_ = NULL;
+  data16_ = NULL;
+  row_offsets_data_ = NULL;
+  columns_data_ = NULL;
+  values_data_ = NULL;
+  num_nonzeros_ = info.num_nonzeros;
+  switch (storage_) {
+    case SPARSE:
+      row_offsets_data_ = (const size_t *) (base + layout.features);
+      columns_data_ = (const uint32_t *) (base + layout.columns);
+      values_data_ = (const Feature *) (base + layout.values);
+      break;
+    case FLOAT16:
+    case BFLOAT16:
+      data16_ = (uint16_t *) (base + layout.features);
+      break;
+    default:
+      data_ = (Feature *) (base + layout.features);
+  }
+
+  segment_ = segment;
+  segment_bytes_ = layout.bytes;
+}
+
 std::ostream &Dataset::put(std::ostream &os) const {
   os << "#\t Dataset size: " << num_instances_ << " x " << num_features_
-     << " (instances x features)" << std::endl << "#\t Num queries: "
+     << " (instances x features)" << std::endl;
+  if (storage_ == FLOAT16 || storage_ == BFLOAT16)
+    os << "#\t Feature storage: " << storage_name(storage_)
+       << " (2 bytes per feature)" << std::endl;
+  if (storage_ == COLUMNS)
+    os << "#\t Feature storage: " << storage_name(storage_)
+       << " (column-major)" << std::endl;
+  if (external_)
+    os << "#\t External buffers (not copied)" << std::endl;
+  if (storage_ == SPARSE)
+    os << "#\t Non-zeros: " << num_nonzeros_ << " ("
+       << std::setprecision(3) << 100.0 * num_nonzeros_
+          / ((double) num_instances_ * num_features_) << "%)" << std::endl;
+  if (segment_)
+    os << "#\t Shared memory segment: " << segment_name_
+       << (segment_publisher_ ? " (published, " : " (attached, ")
+       << std::setprecision(3) << segment_bytes_ / 1024.0 / 1024.0 << " MB)"
+       << std::endl;
+  os << "#\t Num queries: "
      << num_queries_ << " | Avg. len: " << std::setprecision(3)
      << num_instances_ / (float) num_queries_ << std::endl;
   return os;
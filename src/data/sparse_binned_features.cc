@@ -0,0 +1,208 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "data/sparse_binned_features.h"
+
+#include <chrono>
+#include <iomanip>
+
+#ifdef _OPENMP
+#include <omp.h>
+#else
+#include "utils/omp-stubs.h"
+#endif
+
+namespace quickrank {
+namespace data {
+
+SparseBinnedFeatures::SparseBinnedFeatures(std::shared_ptr<Dataset> dataset)
+    : BinnedFeatures(dataset->num_features(), dataset->num_instances()),
+      dataset_(dataset) {
+
+  auto chrono_start = std::chrono::high_resolution_clock::now();
+
+  // transpose the non-zeros: rows are visited in order, thus the rows of
+  // every column are sorted
+  const size_t nnz = dataset_->num_nonzeros();
+  const uint32_t *columns = dataset_->nonzero_columns();
+  const Feature *values = dataset_->nonzero_values();
+
+  column_offsets_.assign(num_features_ + 1, 0);
+  for (size_t k = 0; k < nnz; ++k)
+    ++column_offsets_[columns[k] + 1];
+  for (size_t f = 0; f < num_features_; ++f)
+    column_offsets_[f + 1] += column_offsets_[f];
+
+  column_rows_.resize(nnz);
+  column_values_.resize(nnz);
+  std::vector<size_t> next(column_offsets_.begin(), column_offsets_.end() - 1);
+  for (size_t i = 0; i < num_instances_; ++i) {
+    const size_t begin = dataset_->nonzero_offset(i);
+    const size_t end = begin + dataset_->num_nonzeros(i);
+    for (size_t k = begin; k < end; ++k) {
+      const size_t p = next[columns[k]]++;
+      column_rows_[p] = i;
+      column_values_[p] = values[k];
+    }
+  }
+
+  auto chrono_end = std::chrono::high_resolution_clock::now();
+  building_time_ = std::chrono::duration_cast<std::chrono::duration<double>>(
+      chrono_end - chrono_start).count();
+}
+
+void SparseBinnedFeatures::discretize(float **thresholds,
+                                      size_t *thresholds_size) {
+  auto chrono_start = std::chrono::high_resolution_clock::now();
+
+  thresholds_ = thresholds;
+  thresholds_size_ = thresholds_size;
+
+  const size_t nnz = dataset_->num_nonzeros();
+  const uint32_t *columns = dataset_->nonzero_columns();
+  const Feature *values = dataset_->nonzero_values();
+
+  column_bins_.resize(nnz);
+  row_bins_.resize(nnz);
+  default_bins_.resize(num_features_);
+
+  // first threshold greater or equal than the feature value
+  #pragma omp parallel for
+  for (size_t f = 0; f < num_features_; ++f) {
+    const float *t = thresholds_[f];
+    const size_t nt = thresholds_size_[f];
+    default_bins_[f] = std::min<size_t>(
+        std::lower_bound(t, t + nt, 0.0f) - t, nt - 1);
+    for (size_t k = column_offsets_[f]; k < column_offsets_[f + 1]; ++k)
+      column_bins_[k] = std::min<size_t>(
+          std::lower_bound(t, t + nt, column_values_[k]) - t, nt - 1);
+  }
+
+  #pragma omp parallel for
+  for (size_t k = 0; k < nnz; ++k) {
+    const float *t = thresholds_[columns[k]];
+    const size_t nt = thresholds_size_[columns[k]];
+    row_bins_[k] = std::min<size_t>(
+        std::lower_bound(t, t + nt, values[k]) - t, nt - 1);
+  }
+
+  // feature values are not needed anymore
+  std::vector<Feature>().swap(column_values_);
+
+  auto chrono_end = std::chrono::high_resolution_clock::now();
+  building_time_ += std::chrono::duration_cast<std::chrono::duration<double>>(
+      chrono_end - chrono_start).count();
+}
+
+void SparseBinnedFeatures::histogram(const size_t *sampleids,
+                                     size_t nsampleids,
+                                     const double *labels,
+                                     double **sumlbl, size_t **count) const {
+  // label sums and counts of the non-zero values of every feature
+  std::vector<double> nz_sumlbl(num_features_, 0.0);
+  std::vector<size_t> nz_count(num_features_, 0);
+
+  double sum = 0.0;
+  size_t node_nnz = 0;
+  for (size_t i = 0; i < nsampleids; ++i) {
+    sum += labels[sampleids[i]];
+    node_nnz += dataset_->num_nonzeros(sampleids[i]);
+  }
+
+  const uint32_t *columns = dataset_->nonzero_columns();
+  if (node_nnz * omp_get_num_procs() < column_rows_.size()) {
+    // small nodes: only the non-zeros of their rows are visited
+    for (size_t i = 0; i < nsampleids; ++i) {
+      const size_t s = sampleids[i];
+      const size_t begin = dataset_->nonzero_offset(s);
+      const size_t end = begin + dataset_->num_nonzeros(s);
+      for (size_t k = begin; k < end; ++k) {
+        const size_t f = columns[k];
+        const size_t t = row_bins_[k];
+        sumlbl[f][t] += labels[s];
+        count[f][t]++;
+        nz_sumlbl[f] += labels[s];
+        nz_count[f]++;
+      }
+    }
+  } else {
+    // large nodes: columns are scanned in parallel, skipping the documents
+    // not in the node (unless all the documents are in the node)
+    const bool all = nsampleids == num_instances_;
+    std::vector<unsigned char> in_node(all ? 0 : num_instances_, 0);
+    for (size_t i = 0; i < nsampleids && !all; ++i)
+      in_node[sampleids[i]] = 1;
+
+    #pragma omp parallel for schedule(dynamic, 64)
+    for (size_t f = 0; f < num_features_; ++f) {
+      for (size_t k = column_offsets_[f]; k < column_offsets_[f + 1]; ++k) {
+        const size_t s = column_rows_[k];
+        if (all || in_node[s]) {
+          const size_t t = column_bins_[k];
+          sumlbl[f][t] += labels[s];
+          count[f][t]++;
+          nz_sumlbl[f] += labels[s];
+          nz_count[f]++;
+        }
+      }
+    }
+  }
+
+  // zeros fall in the default bin
+  #pragma omp parallel for
+  for (size_t f = 0; f < num_features_; ++f) {
+    sumlbl[f][default_bins_[f]] += sum - nz_sumlbl[f];
+    count[f][default_bins_[f]] += nsampleids - nz_count[f];
+  }
+}
+
+void SparseBinnedFeatures::partition(size_t feature_id, size_t bin,
+                                     const size_t *sampleids,
+                                     size_t nsampleids,
+                                     size_t *lsamples, size_t &lsize,
+                                     size_t *rsamples, size_t &rsize) const {
+  lsize = rsize = 0;
+  for (size_t i = 0; i < nsampleids; ++i) {
+    const size_t s = sampleids[i];
+    if (this->bin(0, s, feature_id) <= bin)
+      lsamples[lsize++] = s;
+    else
+      rsamples[rsize++] = s;
+  }
+}
+
+std::ostream &SparseBinnedFeatures::put(std::ostream &os) const {
+  const size_t nnz = dataset_->num_nonzeros();
+  const size_t bytes = nnz * 3 * sizeof(uint32_t)
+      + (num_features_ + 1) * sizeof(size_t)
+      + num_features_ * sizeof(uint32_t);
+  const size_t in_memory_bytes = num_instances_ * num_features_
+      * (sizeof(Feature) + 2 * sizeof(size_t));
+  os << "#\t Sparse binned features: " << nnz << " non-zeros" << std::endl
+     << "#\t Bins size: " << std::setprecision(2)
+     << bytes / 1024.0 / 1024.0 << " MB (vs. "
+     << in_memory_bytes / 1024.0 / 1024.0 << " MB dense)" << std::endl
+     << "#\t Binning time: " << building_time_ << " s." << std::endl;
+  return os;
+}
+
+}  // namespace data
+}  // namespace quickrank
@@ -23,30 +23,33 @@
 
 #include <iomanip>
 
+#include "utils/transpose.h"
+
 namespace quickrank {
 namespace data {
 
-VerticalDataset::VerticalDataset(std::shared_ptr<Dataset> h_dataset) {
+VerticalDataset::VerticalDataset(std::shared_ptr<Dataset> h_dataset,
+                                 bool copy_features) {
   num_features_ = h_dataset->num_features();
   num_instances_ = h_dataset->num_instances();
   num_queries_ = h_dataset->num_queries();
-
-  // transpose dataset
-  if (posix_memalign((void **) &data_,
-                     16,
-                     num_instances_ * num_features_ * sizeof(Feature)) != 0) {
-    std::cerr
-        << "!!! Impossible to allocate memory for transposed dataset storage."
-        << std::endl;
-    exit(EXIT_FAILURE);
-  }
-
-  quickrank::Feature *h_data = h_dataset->at(0, 0);
-  #pragma omp parallel for
-  for (size_t i = 0; i < num_instances_; ++i) {
-    for (size_t f = 0; f < num_features_; ++f) {
-      data_[f * num_instances_ + i] = h_data[i * num_features_ + f];
+  feature_ids_ = h_dataset->feature_ids();
+
+  if (copy_features && h_dataset->is_column_major()) {
+    columns_dataset_ = h_dataset;
+    data_ = h_dataset->column(0);
+  } else if (copy_features) {
+    // transpose dataset
+    if (posix_memalign((void **) &data_,
+                       16,
+                       num_instances_ * num_features_ * sizeof(Feature)) != 0) {
+      std::cerr
+          << "!!! Impossible to allocate memory for transposed dataset storage."
+          << std::endl;
+      exit(EXIT_FAILURE);
     }
+
+    transpose(data_, h_dataset->at(0, 0), num_instances_, num_features_);
   }
 
   // allocate labels
@@ -70,7 +73,7 @@ VerticalDataset::VerticalDataset(std::shared_ptr<Dataset> h_dataset) {
 }
 
 VerticalDataset::~VerticalDataset() {
-  if (data_)
+  if (data_ && !columns_dataset_)
     free(data_);
   if (labels_)
     free(labels_);
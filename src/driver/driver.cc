@@ -19,18 +19,27 @@
  * Contributor:
  *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
  */
+#include <algorithm>
+#include <chrono>
 #include <iomanip>
 #include <fstream>
+#include <future>
 #include <limits>
 #include <numeric>
+#include <sstream>
 #include <io/generate_oblivious.h>
 #include <learning/meta/meta_cleaver.h>
 
 #include "driver/driver.h"
+#include "io/binary_dataset.h"
 #include "io/svml.h"
+#include "io/svml_stream.h"
+#include "io/text_writer.h"
+#include "learning/forests/mapped_ensemble.h"
 #include "learning/ltr_algorithm_factory.h"
 #include "optimization/optimization_factory.h"
 #include "metric/metric_factory.h"
+#include "scoring/native_scorer.h"
 #include "utils/fileutils.h"
 
 namespace quickrank {
@@ -53,8 +62,30 @@ int Driver::run(ParamsMap &pmap) {
   if (pmap.isSet("train") || pmap.isSet("train-partial") ||
       pmap.isSet("test")) {
 
+    // storage format of the features of the datasets
+    data::Dataset::Storage storage = data::Dataset::FLOAT32;
+    std::string precision = pmap.get<std::string>("feature-precision");
+    std::transform(precision.begin(), precision.end(), precision.begin(),
+                   ::toupper);
+    if (precision == "FP16") {
+      storage = data::Dataset::FLOAT16;
+    } else if (precision == "BF16") {
+      storage = data::Dataset::BFLOAT16;
+    } else if (precision != "FP32") {
+      std::cerr << " !! Feature precision was not set properly" << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    if (pmap.isSet("sparse")) {
+      if (storage != data::Dataset::FLOAT32) {
+        std::cerr << " !! Sparse datasets support only FP32 features"
+                  << std::endl;
+        exit(EXIT_FAILURE);
+      }
+      storage = data::Dataset::SPARSE;
+    }
+
     std::shared_ptr<quickrank::learning::LTR_Algorithm> ranking_algorithm =
-        quickrank::learning::ltr_algorithm_factory(pmap);
+        quickrank::learning::ltr_algorithm_factory(pmap, storage);
     if (!ranking_algorithm) {
       std::cerr << " !! LTR Algorithm was not set properly" << std::endl;
       exit(EXIT_FAILURE);
@@ -62,6 +93,69 @@ int Driver::run(ParamsMap &pmap) {
 
     std::cout << std::endl << *ranking_algorithm << std::endl;
 
+    // Features not selected are skipped while loading the datasets. The
+    // model is learnt on the selected columns, thus it can not be loaded from
+    // a file (in-memory models refer to columns, saved models to feature ids)
+    std::vector<size_t> feature_ids;
+    if (pmap.isSet("features")) {
+      if (pmap.isSet("model-in")) {
+        std::cerr << " !! Feature selection is not supported with an input "
+            "model" << std::endl;
+        exit(EXIT_FAILURE);
+      }
+      std::string features_filename = pmap.get<std::string>("features");
+      feature_ids = quickrank::io::Svml::read_feature_ids(features_filename);
+      std::cout << "# Selected " << feature_ids.size()
+                << " features from file: " << features_filename << std::endl;
+    }
+
+    // format of the partial scores datasets being written
+    std::string partial_format = pmap.get<std::string>("partial-format");
+    std::transform(partial_format.begin(), partial_format.end(),
+                   partial_format.begin(), ::toupper);
+    if (partial_format != "SVML" && partial_format != "BINARY") {
+      std::cerr << " !! Partial scores format was not set properly"
+                << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    const bool binary_partial = partial_format == "BINARY";
+
+    // name of the shared memory segments where datasets are published
+    std::string shared_name;
+    if (pmap.isSet("shared-dataset")) {
+      shared_name = pmap.get<std::string>("shared-dataset");
+      if (shared_name.empty()
+          || shared_name.find('/') != std::string::npos) {
+        std::cerr << " !! Shared dataset name was not set properly"
+                  << std::endl;
+        exit(EXIT_FAILURE);
+      }
+    }
+
+    // validation and test datasets are loaded in background, while the
+    // training dataset is loaded and the training is initialized
+    BackgroundLoad validation_load, test_load;
+    if ((pmap.isSet("train") || pmap.isSet("train-partial"))
+        && !pmap.get<std::string>("valid").empty())
+      validation_load = load_dataset_async(pmap.get<std::string>("valid"),
+                                           "validation", feature_ids, storage,
+                                           shared_name);
+    // large SVML test datasets can be streamed in chunks of queries instead
+    const size_t test_chunk_size = pmap.get<size_t>("test-chunk-size");
+    const bool streaming_test = pmap.isSet("test") && test_chunk_size > 0
+        && !pmap.get<std::string>("test").empty()
+        && !quickrank::io::BinaryDataset::is_binary(
+            pmap.get<std::string>("test"));
+    if (streaming_test && pmap.isSet("detailed")) {
+      std::cerr << " !! Detailed testing does not support streaming the "
+          "test dataset" << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    if (pmap.isSet("test") && !pmap.get<std::string>("test").empty()
+        && !streaming_test)
+      test_load = load_dataset_async(pmap.get<std::string>("test"), "testing",
+                                     feature_ids, storage, shared_name);
+
     // If there is the training dataset, it means we have to execute
     // the training phase and/or the optimization phase (at least one of them)
     if (pmap.isSet("train") || pmap.isSet("train-partial")) {
@@ -78,12 +172,17 @@ int Driver::run(ParamsMap &pmap) {
           exit(EXIT_FAILURE);
         }
 
+        // optimizations access the features of the datasets in place
+        if (storage != data::Dataset::FLOAT32) {
+          std::cerr << " !! Optimization is supported only on dense FP32 "
+              "datasets" << std::endl;
+          exit(EXIT_FAILURE);
+        }
+
         std::cout << *opt_algorithm << std::endl;
       }
 
       std::string training_filename = pmap.get<std::string>("train");
-      std::string validation_filename = pmap.get<std::string>("valid");
-      std::string features_filename = pmap.get<std::string>("features");
       std::string model_filename_out = pmap.get<std::string>("model-out");
       std::string opt_model_filename = pmap.get<std::string>("opt-model");
       std::string opt_algo_model_filename =
@@ -100,14 +199,8 @@ int Driver::run(ParamsMap &pmap) {
       std::shared_ptr<quickrank::data::Dataset> validation_dataset;
 
       if (!training_filename.empty())
-        training_dataset = load_dataset(training_filename, "training");
-
-      if (!validation_filename.empty())
-        validation_dataset = load_dataset(validation_filename, "validation");
-
-      if (!features_filename.empty()) {
-        // TODO: filter features while loading dataset
-      }
+        training_dataset = load_dataset(training_filename, "training",
+                                        feature_ids, storage, shared_name);
 
       std::shared_ptr<quickrank::metric::ir::Metric> training_metric =
           quickrank::metric::ir::ir_metric_factory(
@@ -119,6 +212,7 @@ int Driver::run(ParamsMap &pmap) {
       }
 
       if (opt_algorithm && opt_algorithm->is_pre_learning()) {
+        validation_dataset = wait_dataset(validation_load);
         // We have to run the optimization process pre-training
         optimization_phase(opt_algorithm,
                            ranking_algorithm,
@@ -129,7 +223,8 @@ int Driver::run(ParamsMap &pmap) {
                            validation_partial_filename,
                            opt_model_filename,
                            opt_algo_model_filename,
-                           partial_save);
+                           partial_save,
+                           binary_partial);
       }
 
       // If the training algorithm has been created from scratch (not loaded
@@ -143,6 +238,20 @@ int Driver::run(ParamsMap &pmap) {
                   << *training_metric
                   << std::endl;
 
+        // the training features are not used after the training, unless
+        // optimized by a post-learning algorithm
+        ranking_algorithm->set_release_training_features(
+            !opt_algorithm || opt_algorithm->is_pre_learning());
+
+        // algorithms initializing the training before using the validation
+        // dataset do not wait for it to be loaded
+        if (!validation_dataset && validation_load.dataset.valid()
+            && (validation_load.dataset.wait_for(std::chrono::seconds(0))
+                == std::future_status::ready
+                || !ranking_algorithm->set_pending_validation(
+                    validation_load.dataset)))
+          validation_dataset = wait_dataset(validation_load);
+
         training_phase(ranking_algorithm,
                        training_metric,
                        training_dataset,
@@ -150,6 +259,7 @@ int Driver::run(ParamsMap &pmap) {
                        model_filename_out,
                        partial_save);
       }
+      validation_dataset = wait_dataset(validation_load);
 
       if (opt_algorithm && !opt_algorithm->is_pre_learning()) {
         // We have to run the optimization process post-training
@@ -162,19 +272,15 @@ int Driver::run(ParamsMap &pmap) {
                            validation_partial_filename,
                            opt_model_filename,
                            opt_algo_model_filename,
-                           partial_save);
+                           partial_save,
+                           binary_partial);
       }
     }
 
     if (pmap.isSet("test")) {
-      std::string test_filename = pmap.get<std::string>("test");
       std::string scores_filename = pmap.get<std::string>("scores");
       bool detailed_testing = pmap.isSet("detailed");
 
-      std::shared_ptr<quickrank::data::Dataset> test_dataset;
-      if (!test_filename.empty())
-        test_dataset = load_dataset(test_filename, "testing");
-
       std::shared_ptr<quickrank::metric::ir::Metric> testing_metric =
           quickrank::metric::ir::ir_metric_factory(
               pmap.get<std::string>("test-metric"),
@@ -186,11 +292,45 @@ int Driver::run(ParamsMap &pmap) {
 
       std::cout << "# test scorer: " << *testing_metric << std::endl << "#" <<
                 std::endl;
-      testing_phase(ranking_algorithm,
-                    testing_metric,
-                    test_dataset,
-                    scores_filename,
-                    detailed_testing);
+      const std::string scoring_engine =
+          pmap.get<std::string>("scoring-engine");
+      if (pmap.isSet("native-cache"))
+        quickrank::scoring::NativeScorer::set_cache_directory(
+            pmap.get<std::string>("native-cache"));
+      if (pmap.isSet("native-compiler"))
+        quickrank::scoring::NativeScorer::set_compiler(
+            pmap.get<std::string>("native-compiler"));
+      if (streaming_test) {
+        if (!ranking_algorithm->set_scoring_engine(scoring_engine)) {
+          std::cerr << "!!! Scoring engine " << scoring_engine
+                    << " is not available for this model." << std::endl;
+          return EXIT_FAILURE;
+        }
+        streaming_testing_phase(ranking_algorithm,
+                                testing_metric,
+                                pmap.get<std::string>("test"),
+                                scores_filename,
+                                feature_ids,
+                                storage,
+                                test_chunk_size);
+      } else {
+        std::shared_ptr<quickrank::data::Dataset> test_dataset =
+            wait_dataset(test_load);
+        // engines are timed on the first documents of the test dataset
+        if (!detailed_testing
+            && !ranking_algorithm->set_scoring_engine(scoring_engine,
+                                                      test_dataset)) {
+          std::cerr << "!!! Scoring engine " << scoring_engine
+                    << " is not available for this model." << std::endl;
+          return EXIT_FAILURE;
+        }
+        testing_phase(ranking_algorithm,
+                      testing_metric,
+                      test_dataset,
+                      scores_filename,
+                      detailed_testing,
+                      binary_partial);
+      }
     }
   }
 
@@ -200,6 +340,8 @@ int Driver::run(ParamsMap &pmap) {
     std::string xml_filename = pmap.get<std::string>("model-file");
     std::string c_filename = pmap.get<std::string>("code-file");
     std::string generator_type = pmap.get<std::string>("generator");
+    std::string code_style = pmap.get<std::string>("code-style");
+    size_t trees_per_file = pmap.get<size_t>("code-trees-per-file");
 
     if (generator_type == "condop") {
       quickrank::io::GenOpCond conditional_operator_generator;
@@ -208,12 +350,15 @@ int Driver::run(ParamsMap &pmap) {
           << xml_filename << std::endl;
       conditional_operator_generator.generate_conditional_operators_code(
           xml_filename,
-          c_filename);
+          c_filename,
+          code_style,
+          trees_per_file);
     } else if (generator_type == "oblivious") {
       quickrank::io::GenOblivious oblivious_generator;
       std::cout << "applying oblivious strategy for C code generation to: "
                 << xml_filename << std::endl;
-      oblivious_generator.generate_oblivious_code(xml_filename, c_filename);
+      oblivious_generator.generate_oblivious_code(xml_filename, c_filename,
+                                                  trees_per_file);
     } else if (generator_type == "vpred") {
       quickrank::io::GenVpred vpred_generator;
       std::cout << "generating VPred input file from: " << xml_filename
@@ -222,6 +367,39 @@ int Driver::run(ParamsMap &pmap) {
     }
   }
 
+  // Model conversion
+  // binary models are loaded by mapping them in memory, and they are
+  // converted from and to XML models of tree ensembles.
+  if (pmap.count("model-file") &&
+      (pmap.count("binary-model") || pmap.count("xml-model"))) {
+    std::string model_filename = pmap.get<std::string>("model-file");
+    if (pmap.count("binary-model")) {
+      std::string binary_filename = pmap.get<std::string>("binary-model");
+      pugi::xml_document model;
+      if (!model.load_file(model_filename.c_str())) {
+        std::cerr << " !! Model " << model_filename
+                  << " is not parsed correctly." << std::endl;
+        exit(EXIT_FAILURE);
+      }
+      quickrank::learning::forests::MappedEnsemble::write(model,
+                                                          binary_filename);
+      std::cout << "# Binary model written to file: " << binary_filename
+                << std::endl;
+    } else {
+      std::string xml_filename = pmap.get<std::string>("xml-model");
+      if (!quickrank::learning::forests::MappedEnsemble::is_binary(
+          model_filename)) {
+        std::cerr << " !! Model " << model_filename
+                  << " is not a binary model." << std::endl;
+        exit(EXIT_FAILURE);
+      }
+      quickrank::learning::forests::MappedEnsemble(model_filename).save(
+          xml_filename);
+      std::cout << "# XML model written to file: " << xml_filename
+                << std::endl;
+    }
+  }
+
   return EXIT_SUCCESS;
 }
 
@@ -255,7 +433,8 @@ void Driver::optimization_phase(
     std::string validation_partial_filename,
     const std::string output_filename,
     const std::string opt_algo_model_filename,
-    const size_t npartialsave) {
+    const size_t npartialsave,
+    const bool binary_partial) {
 
   std::shared_ptr<quickrank::data::Dataset> training_partial_dataset;
   std::shared_ptr<quickrank::data::Dataset> validation_partial_dataset;
@@ -275,7 +454,6 @@ void Driver::optimization_phase(
       validation_partial_dataset = load_dataset(validation_partial_filename,
                                                 "validation (partial)");
 
-    quickrank::io::Svml svml;
     if (!training_partial_dataset && training_dataset) {
 
       training_partial_dataset = Driver::extract_partial_scores(
@@ -284,7 +462,8 @@ void Driver::optimization_phase(
           true);
 
       if (!training_partial_filename.empty())
-        svml.write(training_partial_dataset, training_partial_filename);
+        write_partial_scores(training_partial_dataset,
+                             training_partial_filename, binary_partial);
     }
 
     if (!validation_partial_dataset && validation_dataset) {
@@ -295,7 +474,8 @@ void Driver::optimization_phase(
           true);
 
       if (!validation_partial_filename.empty())
-        svml.write(validation_partial_dataset, validation_partial_filename);
+        write_partial_scores(validation_partial_dataset,
+                             validation_partial_filename, binary_partial);
     }
   }
 
@@ -328,7 +508,8 @@ void Driver::testing_phase(
     std::shared_ptr<quickrank::metric::ir::Metric> test_metric,
     std::shared_ptr<quickrank::data::Dataset> test_dataset,
     const std::string scores_filename,
-    const bool detailed_testing) {
+    const bool detailed_testing,
+    const bool binary_partial) {
 
   if (test_metric and test_dataset) {
 
@@ -337,7 +518,7 @@ void Driver::testing_phase(
       std::shared_ptr<data::Dataset> datasetPartScores =
           Driver::extract_partial_scores(algo, test_dataset);
 
-      Feature *features = datasetPartScores->at(0, 0);
+      Feature *features = datasetPartScores->mutable_at(0, 0);
 #pragma omp parallel for
       for (unsigned int s = 0; s < datasetPartScores->num_instances(); ++s) {
         size_t offset_feature = s * datasetPartScores->num_features();
@@ -353,8 +534,8 @@ void Driver::testing_phase(
       std::cout << *test_metric << " on test data = " << std::setprecision(4)
                 << test_score << std::endl << std::endl;
 
-      quickrank::io::Svml svml;
-      svml.write(datasetPartScores, scores_filename);
+      write_partial_scores(datasetPartScores, scores_filename,
+                           binary_partial);
 
       std::cout << "# Partial Scores written to file: " << scores_filename
                 << std::endl;
@@ -369,12 +550,12 @@ void Driver::testing_phase(
                 << test_score << std::endl << std::endl;
 
       if (!scores_filename.empty()) {
-        std::ofstream os;
-        os << std::setprecision(std::numeric_limits<Score>::max_digits10);
-        os.open(scores_filename, std::fstream::out);
-        for (size_t i = 0; i < test_dataset->num_instances(); ++i)
-          os << scores[i] << std::endl;
-        os.close();
+        quickrank::io::TextWriter writer(scores_filename);
+        writer.write_lines(test_dataset->num_instances(),
+                           [&](size_t i, std::string &line) {
+                             quickrank::io::TextWriter::append(line,
+                                                               scores[i]);
+                           });
         std::cout << "# Scores written to file: " << scores_filename
                   << std::endl;
       }
@@ -384,19 +565,147 @@ void Driver::testing_phase(
   algo->print_additional_stats();
 }
 
+void Driver::streaming_testing_phase(
+    std::shared_ptr<learning::LTR_Algorithm> algo,
+    std::shared_ptr<quickrank::metric::ir::Metric> test_metric,
+    const std::string test_filename,
+    const std::string scores_filename,
+    const std::vector<size_t> &feature_ids,
+    data::Dataset::Storage storage,
+    const size_t chunk_size) {
+
+  std::cout << "# Streaming testing dataset: " << test_filename
+            << " (chunks of " << chunk_size << " instances)" << std::endl;
+
+  auto chrono_start = std::chrono::high_resolution_clock::now();
+
+  // chunks are read and parsed by the stream thread, scored and evaluated
+  // by this one, and scores are written by the writer thread; chunks are
+  // as wide as the documents read by the model, even if their features are
+  // missing from the first queries
+  quickrank::io::SvmlStream stream(test_filename, chunk_size, feature_ids,
+                                   storage, algo->num_features());
+  std::unique_ptr<quickrank::io::TextWriter> writer;
+  if (!scores_filename.empty())
+    writer.reset(new quickrank::io::TextWriter(scores_filename));
+
+  MetricScore sum_score = 0.0;
+  size_t num_queries = 0, num_instances = 0, num_chunks = 0;
+  std::vector<Score> scores;
+  while (std::shared_ptr<data::Dataset> chunk = stream.next()) {
+    scores.assign(chunk->num_instances(), 0.0);
+    algo->score_dataset(chunk, &scores[0]);
+
+    // the metric is averaged on all the queries (as by evaluate_dataset())
+    const Score *query_scores = &scores[0];
+    for (size_t q = 0; q < chunk->num_queries(); q++) {
+      auto results = chunk->getQueryResults(q);
+      sum_score += test_metric->evaluate_result_list(results.get(),
+                                                     query_scores);
+      query_scores += results->num_results();
+    }
+
+    if (writer)
+      writer->write_lines(chunk->num_instances(),
+                          [&](size_t i, std::string &line) {
+                            quickrank::io::TextWriter::append(line,
+                                                              scores[i]);
+                          });
+
+    num_queries += chunk->num_queries();
+    num_instances += chunk->num_instances();
+    num_chunks++;
+  }
+  writer.reset();
+
+  auto chrono_end = std::chrono::high_resolution_clock::now();
+  std::chrono::duration<double> elapsed = chrono_end - chrono_start;
+
+  std::cout << "#\t Streamed " << num_queries << " queries, "
+            << num_instances << " instances in " << num_chunks << " chunks ("
+            << std::setprecision(2) << elapsed.count() << " s.)"
+            << std::endl;
+
+  quickrank::MetricScore test_score =
+      num_queries ? sum_score / (MetricScore) num_queries : 0.0;
+  std::cout << std::endl;
+  std::cout << *test_metric << " on test data = " << std::setprecision(4)
+            << test_score << std::endl << std::endl;
+  if (!scores_filename.empty())
+    std::cout << "# Scores written to file: " << scores_filename
+              << std::endl;
+
+  algo->print_additional_stats();
+}
+
+void Driver::write_partial_scores(
+    std::shared_ptr<quickrank::data::Dataset> dataset,
+    const std::string filename,
+    const bool binary) {
+  if (binary) {
+    quickrank::io::BinaryDataset::write(dataset, filename);
+  } else {
+    quickrank::io::Svml svml;
+    svml.write(dataset, filename);
+  }
+}
+
 std::shared_ptr<quickrank::data::Dataset> Driver::load_dataset(
     const std::string dataset_filename,
-    const std::string dataset_label) {
-
-  // create reader: assume svml as ltr format
-  quickrank::io::Svml reader;
+    const std::string dataset_label,
+    const std::vector<size_t> &feature_ids,
+    data::Dataset::Storage storage,
+    const std::string &shared_name,
+    std::ostream &report) {
+
+  // a dataset shared by other processes is attached if the segment stores
+  // the same file, loaded with the same storage and features
+  std::string segment, key;
+  if (!shared_name.empty() && !dataset_filename.empty()) {
+    segment = "/quickrank-" + shared_name + "-" + dataset_label;
+    char *path = realpath(dataset_filename.c_str(), NULL);
+    key = path ? path : dataset_filename;
+    free(path);
+    key += std::string(" ") + data::Dataset::storage_name(storage);
+    for (auto id: feature_ids)
+      key += " " + std::to_string(id);
+
+    auto dataset = data::Dataset::attach_shared(segment, key);
+    if (dataset) {
+      report << "# Attaching " + dataset_label + " dataset: " <<
+             dataset_filename << std::endl;
+      report << *dataset << std::endl;
+      return dataset;
+    }
+  }
 
   std::shared_ptr<quickrank::data::Dataset> dataset = nullptr;
   if (!dataset_filename.empty()) {
-    std::cout << "# Reading " + dataset_label + " dataset: " <<
-              dataset_filename << std::endl;
-    dataset = reader.read_horizontal(dataset_filename);
-    std::cout << reader << *dataset << std::endl;
+    report << "# Reading " + dataset_label + " dataset: " <<
+           dataset_filename << std::endl;
+    // binary datasets are detected by their header, svml is assumed
+    // otherwise
+    if (quickrank::io::BinaryDataset::is_binary(dataset_filename)) {
+      quickrank::io::BinaryDataset reader;
+      reader.set_feature_ids(feature_ids);
+      reader.set_storage(storage);
+      dataset = reader.read_horizontal(dataset_filename);
+      report << reader;
+    } else {
+      quickrank::io::Svml reader;
+      reader.set_feature_ids(feature_ids);
+      reader.set_storage(storage);
+      dataset = reader.read_horizontal(dataset_filename);
+      report << reader;
+    }
+    // another process may have published the dataset in the meantime
+    if (dataset && !segment.empty()
+        && !dataset->publish_shared(segment, key)) {
+      auto shared = data::Dataset::attach_shared(segment, key);
+      if (shared)
+        dataset = shared;
+    }
+    report << *dataset << std::endl;
   }
 
   if (!dataset) {
@@ -408,37 +717,86 @@ std::shared_ptr<quickrank::data::Dataset> Driver::load_dataset(
   return dataset;
 }
 
+Driver::BackgroundLoad Driver::load_dataset_async(
+    const std::string dataset_filename,
+    const std::string dataset_label,
+    const std::vector<size_t> &feature_ids,
+    data::Dataset::Storage storage,
+    const std::string &shared_name) {
+  BackgroundLoad load;
+  auto report = std::make_shared<std::stringstream>();
+  report->copyfmt(std::cout);
+  load.report = report;
+  load.dataset = std::async(std::launch::async, [=]() {
+    return load_dataset(dataset_filename, dataset_label, feature_ids, storage,
+                        shared_name, *report);
+  }).share();
+  return load;
+}
+
+std::shared_ptr<data::Dataset> Driver::wait_dataset(BackgroundLoad &load) {
+  if (!load.dataset.valid())
+    return nullptr;
+  auto dataset = load.dataset.get();
+  // the report is printed once, when the dataset is used for the first time
+  if (load.report) {
+    std::cout << load.report->str();
+    load.report.reset();
+  }
+  return dataset;
+}
+
 std::shared_ptr<data::Dataset> Driver::extract_partial_scores(
     std::shared_ptr<learning::LTR_Algorithm> algo,
     std::shared_ptr<data::Dataset> dataset,
     bool ignore_weights) {
 
-  data::Dataset *datasetPartScores = nullptr;
-  for (size_t q = 0; q < dataset->num_queries(); q++) {
-    auto results = dataset->getQueryResults(q);
-    // score_query_results(r, scores, 1, test_dataset->num_features());
-    const Feature *features = results->features();
-    const Label *labels = results->labels();
-    for (size_t i = 0; i < results->num_results(); i++) {
+  if (dataset->num_instances() == 0)
+    return nullptr;
+
+  // features not stored as floats are copied into a dense row
+  std::vector<Feature> row(
+      dataset->has_float_features() ? 0 : dataset->num_features());
+  const Feature *features = dataset->has_float_features()
+                            ? dataset->at(0, 0) : row.data();
+  if (!dataset->has_float_features())
+    dataset->fill_row(0, row.data());
+  auto detailed_scores = algo->partial_scores_document(features,
+                                                       ignore_weights);
+  if (!detailed_scores) {
+    std::cerr << "# ## ERROR!! Only Ensemble methods support the "
+              << "export of detailed score tree by tree" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  if (!dataset->has_float_features())
+    dataset->clear_row(0, row.data());
+
+  // labels and queries are added first, then the partial scores of every
+  // document are computed in parallel and written in place in its row
+  const size_t num_scores = detailed_scores->size();
+  data::Dataset *datasetPartScores =
+      new data::Dataset(dataset->num_instances(), num_scores);
+  for (size_t q = 0; q < dataset->num_queries(); q++)
+    for (size_t d = dataset->offset(q); d < dataset->offset(q + 1); d++)
+      datasetPartScores->addInstance(q, dataset->getLabel(d),
+                                     std::vector<Feature>());
+
+  #pragma omp parallel firstprivate(row)
+  {
+    #pragma omp for schedule(static)
+    for (size_t d = 0; d < dataset->num_instances(); d++) {
+      const Feature *features = row.data();
+      if (dataset->has_float_features())
+        features = dataset->at(d, 0);
+      else
+        dataset->fill_row(d, row.data());
       auto detailed_scores = algo->partial_scores_document(features,
                                                            ignore_weights);
-
-      if (!detailed_scores) {
-        std::cerr << "# ## ERROR!! Only Ensemble methods support the "
-                  << "export of detailed score tree by tree" << std::endl;
-        exit(EXIT_FAILURE);
-      }
-
-      // Initilizing on the first instance of the dataset
-      if (datasetPartScores == nullptr)
-        datasetPartScores = new data::Dataset(dataset->num_instances(),
-                                              detailed_scores->size());
       // It performs a copy for casting Score to Feature (double to float)
-      std::vector<Feature> featuresScore(detailed_scores->begin(),
-                                         detailed_scores->end());
-      datasetPartScores->addInstance(q, labels[i], featuresScore);
-
-      features += dataset->num_features();
+      std::copy(detailed_scores->begin(), detailed_scores->end(),
+                datasetPartScores->mutable_at(d, 0));
+      if (!dataset->has_float_features())
+        dataset->clear_row(d, row.data());
     }
   }
 
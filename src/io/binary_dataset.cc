@@ -0,0 +1,223 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "io/binary_dataset.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+namespace quickrank {
+namespace io {
+
+namespace {
+
+const char MAGIC[8] = {'Q', 'R', 'B', 'I', 'N', 'D', 'S', '1'};
+
+struct Header {
+  char magic[8];
+  uint64_t num_instances;
+  uint64_t num_features;
+  uint64_t num_queries;
+};
+
+// number of rows read or written at once
+const size_t BLOCK_ROWS = 4096;
+
+void read_or_die(void *data, size_t size, size_t count, FILE *f,
+                 const std::string &file) {
+  if (fread(data, size, count, f) != count) {
+    std::cerr << "!!! Error while reading file " << file << ": "
+              << (ferror(f) ? strerror(errno) : "unexpected end of file")
+              << std::endl;
+    exit(EXIT_FAILURE);
+  }
+}
+
+void write_or_die(const void *data, size_t size, size_t count, FILE *f,
+                  const std::string &file) {
+  if (fwrite(data, size, count, f) != count) {
+    std::cerr << "!!! Error while writing file " << file << ": "
+              << strerror(errno) << std::endl;
+    exit(EXIT_FAILURE);
+  }
+}
+
+}  // namespace
+
+bool BinaryDataset::is_binary(const std::string &file) {
+  FILE *f = fopen(file.c_str(), "rb");
+  if (!f)
+    return false;
+  char magic[sizeof(MAGIC)];
+  bool binary = fread(magic, 1, sizeof(magic), f) == sizeof(magic)
+      && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+  fclose(f);
+  return binary;
+}
+
+std::unique_ptr<data::Dataset> BinaryDataset::read_horizontal(
+    const std::string &file) {
+
+  auto chrono_start = std::chrono::high_resolution_clock::now();
+
+  FILE *f = fopen(file.c_str(), "rb");
+  if (!f) {
+    std::cerr << "!!! Error while opening file " << file << "." << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  Header header;
+  read_or_die(&header, sizeof(header), 1, f, file);
+  if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+    std::cerr << "!!! Error while reading file " << file
+              << ": not a binary dataset." << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  const size_t num_features = header.num_features;
+
+  std::vector<uint64_t> offsets(header.num_queries + 1);
+  read_or_die(offsets.data(), sizeof(uint64_t), offsets.size(), f, file);
+  // the instances are split among the queries in order
+  bool valid_offsets = offsets[0] == 0
+      && offsets[header.num_queries] == header.num_instances;
+  for (size_t q = 0; q < header.num_queries && valid_offsets; ++q)
+    valid_offsets = offsets[q] <= offsets[q + 1];
+  if (!valid_offsets) {
+    std::cerr << "!!! Error while reading file " << file
+              << ": invalid query offsets." << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  std::vector<Label> labels(header.num_instances);
+  read_or_die(labels.data(), sizeof(Label), labels.size(), f, file);
+
+  // columns of the file stored in the dataset (features missing in the
+  // file are zero)
+  std::vector<size_t> columns;
+  for (auto id: feature_ids_)
+    columns.push_back(std::min(id - 1, num_features));
+  const size_t num_columns =
+      feature_ids_.empty() ? num_features : feature_ids_.size();
+
+  std::unique_ptr<data::Dataset> dataset(
+      new data::Dataset(header.num_instances, num_columns, storage_));
+  if (!feature_ids_.empty())
+    dataset->set_feature_ids(feature_ids_);
+
+  std::vector<Feature> block(BLOCK_ROWS * num_features);
+  std::vector<Feature> instance(num_columns);
+  size_t q = 0;
+  for (size_t begin = 0; begin < header.num_instances; begin += BLOCK_ROWS) {
+    const size_t rows = std::min<size_t>(BLOCK_ROWS,
+                                         header.num_instances - begin);
+    read_or_die(block.data(), sizeof(Feature), rows * num_features, f, file);
+    for (size_t r = 0; r < rows; ++r) {
+      const size_t d = begin + r;
+      while (offsets[q + 1] <= d)
+        ++q;
+      const Feature *row = block.data() + r * num_features;
+      if (feature_ids_.empty()) {
+        std::copy(row, row + num_features, instance.begin());
+      } else {
+        for (size_t i = 0; i < columns.size(); ++i)
+          instance[i] = columns[i] < num_features ? row[columns[i]] : 0.0f;
+      }
+      dataset->addInstance(q + 1, labels[d], instance);
+    }
+  }
+
+  file_size_ = ftell(f);
+  fclose(f);
+
+  auto chrono_end = std::chrono::high_resolution_clock::now();
+  std::chrono::duration<double> elapsed = chrono_end - chrono_start;
+  reading_time_ = elapsed.count();
+
+  return dataset;
+}
+
+void BinaryDataset::write(std::shared_ptr<data::Dataset> dataset,
+                          const std::string &file) {
+
+  FILE *f = fopen(file.c_str(), "wb");
+  if (!f) {
+    std::cerr << "!!! Error while opening file " << file << "." << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  Header header;
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.num_instances = dataset->num_instances();
+  header.num_features = dataset->num_features();
+  header.num_queries = dataset->num_queries();
+  write_or_die(&header, sizeof(header), 1, f, file);
+
+  std::vector<uint64_t> offsets(dataset->num_queries() + 1);
+  for (size_t q = 0; q < offsets.size(); ++q)
+    offsets[q] = dataset->offset(q);
+  write_or_die(offsets.data(), sizeof(uint64_t), offsets.size(), f, file);
+
+  std::vector<Label> labels(dataset->num_instances());
+  for (size_t d = 0; d < labels.size(); ++d)
+    labels[d] = dataset->getLabel(d);
+  write_or_die(labels.data(), sizeof(Label), labels.size(), f, file);
+
+  const size_t num_features = dataset->num_features();
+  if (dataset->storage() == data::Dataset::FLOAT32) {
+    write_or_die(dataset->at(0, 0), sizeof(Feature),
+                 dataset->num_instances() * num_features, f, file);
+  } else {
+    // other storages are widened into dense rows
+    std::vector<Feature> block(BLOCK_ROWS * num_features, 0.0f);
+    for (size_t begin = 0; begin < dataset->num_instances();
+         begin += BLOCK_ROWS) {
+      const size_t rows = std::min<size_t>(BLOCK_ROWS,
+                                           dataset->num_instances() - begin);
+      for (size_t r = 0; r < rows; ++r)
+        dataset->fill_row(begin + r, block.data() + r * num_features);
+      write_or_die(block.data(), sizeof(Feature), rows * num_features, f,
+                   file);
+      for (size_t r = 0; r < rows; ++r)
+        dataset->clear_row(begin + r, block.data() + r * num_features);
+    }
+  }
+
+  if (fclose(f) != 0) {
+    std::cerr << "!!! Error while writing file " << file << ": "
+              << strerror(errno) << std::endl;
+    exit(EXIT_FAILURE);
+  }
+}
+
+std::ostream &BinaryDataset::put(std::ostream &os) const {
+  os << std::setprecision(2) << "#\t Reading time: " << reading_time_
+     << " s. @ " << file_size_ / 1024.0 / 1024.0 / reading_time_
+     << " MB/s (binary)" << std::endl;
+  return os;
+}
+
+}  // namespace io
+}  // namespace quickrank
@@ -0,0 +1,232 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "io/block_reader.h"
+
+#include <cerrno>
+#include <cstring>
+#include <functional>
+#include <iostream>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef QUICKRANK_HAS_ZLIB
+#include <zlib.h>
+#endif
+#ifdef QUICKRANK_HAS_ZSTD
+#include <zstd.h>
+#endif
+
+namespace quickrank {
+namespace io {
+
+BlockReader::BlockReader(const std::string &filename, size_t block_size,
+                         size_t queue_size)
+    : filename_(filename),
+      block_size_(block_size),
+      queue_size_(queue_size) {
+
+  FILE *file = fopen(filename.c_str(), "rb");
+  if (!file) {
+    std::cerr << "!!! Error while opening file " << filename << "."
+              << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  struct stat filestatus;
+  if (fstat(fileno(file), &filestatus) == 0)
+    file_size_ = filestatus.st_size;
+
+  // detect compression from the magic number of the file
+  unsigned char magic[4] = {0, 0, 0, 0};
+  size_t nmagic = fread(magic, 1, sizeof(magic), file);
+  rewind(file);
+  if (nmagic >= 2 && magic[0] == 0x1f && magic[1] == 0x8b)
+    compression_ = GZIP;
+  else if (nmagic == 4 && magic[0] == 0x28 && magic[1] == 0xb5
+      && magic[2] == 0x2f && magic[3] == 0xfd)
+    compression_ = ZSTD;
+
+#ifndef QUICKRANK_HAS_ZLIB
+  if (compression_ == GZIP) {
+    std::cerr << "!!! Error while opening file " << filename
+              << ": gzip compressed files are not supported (zlib missing)."
+              << std::endl;
+    exit(EXIT_FAILURE);
+  }
+#endif
+#ifndef QUICKRANK_HAS_ZSTD
+  if (compression_ == ZSTD) {
+    std::cerr << "!!! Error while opening file " << filename
+              << ": zstd compressed files are not supported (libzstd "
+                  "missing)." << std::endl;
+    exit(EXIT_FAILURE);
+  }
+#endif
+
+  producer_ = std::thread(&BlockReader::produce, this, file);
+}
+
+BlockReader::~BlockReader() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+  }
+  not_full_.notify_all();
+  producer_.join();
+}
+
+const char *BlockReader::compression_name(Compression compression) {
+  switch (compression) {
+    case GZIP:
+      return "gzip";
+    case ZSTD:
+      return "zstd";
+    default:
+      return "none";
+  }
+}
+
+bool BlockReader::next(std::vector<char> &block) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (block.capacity() && buffers_.size() <= queue_size_)
+    buffers_.push_back(std::move(block));
+  block.clear();
+  not_empty_.wait(lock, [this] { return !blocks_.empty() || eof_; });
+  if (blocks_.empty())
+    return false;
+  block = std::move(blocks_.front());
+  blocks_.pop_front();
+  bytes_read_ += block.size();
+  not_full_.notify_one();
+  return true;
+}
+
+bool BlockReader::get_buffer(std::vector<char> &buffer) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (closed_)
+    return false;
+  if (!buffers_.empty()) {
+    buffer = std::move(buffers_.back());
+    buffers_.pop_back();
+  }
+  buffer.resize(block_size_);
+  return true;
+}
+
+void BlockReader::push(std::vector<char> &block) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  not_full_.wait(lock, [this] {
+    return blocks_.size() < queue_size_ || closed_;
+  });
+  blocks_.push_back(std::move(block));
+  not_empty_.notify_one();
+}
+
+void BlockReader::produce(FILE *file) {
+  auto fail = [this](const std::string &message) {
+    std::cerr << "!!! Error while reading file " << filename_ << ": "
+              << message << std::endl;
+    exit(EXIT_FAILURE);
+  };
+
+  // reads up to the given number of (decompressed) bytes, 0 at end of file
+  std::function<size_t(char *, size_t)> read = [&](char *buffer,
+                                                   size_t size) {
+    size_t n = fread(buffer, 1, size, file);
+    if (n < size && ferror(file))
+      fail(strerror(errno));
+    return n;
+  };
+
+#ifdef QUICKRANK_HAS_ZLIB
+  gzFile gz = NULL;
+  if (compression_ == GZIP) {
+    gz = gzdopen(dup(fileno(file)), "rb");
+    if (!gz)
+      fail("impossible to decompress");
+    gzbuffer(gz, 1 << 18);
+    read = [&](char *buffer, size_t size) {
+      int n = gzread(gz, buffer, size);
+      int code;
+      if (n < 0)
+        fail(gzerror(gz, &code));
+      return (size_t) n;
+    };
+  }
+#endif
+#ifdef QUICKRANK_HAS_ZSTD
+  ZSTD_DCtx *dctx = NULL;
+  std::vector<char> input;
+  ZSTD_inBuffer in = {NULL, 0, 0};
+  size_t pending = 0;  // non-zero until the current frame is completed
+  if (compression_ == ZSTD) {
+    dctx = ZSTD_createDCtx();
+    input.resize(ZSTD_DStreamInSize());
+    in.src = input.data();
+    read = [&](char *buffer, size_t size) {
+      ZSTD_outBuffer out = {buffer, size, 0};
+      while (out.pos < out.size) {
+        if (in.pos == in.size) {
+          in.size = fread(input.data(), 1, input.size(), file);
+          in.pos = 0;
+          if (in.size == 0) {
+            if (ferror(file) || pending != 0)
+              fail("truncated or unreadable file");
+            break;
+          }
+        }
+        pending = ZSTD_decompressStream(dctx, &out, &in);
+        if (ZSTD_isError(pending))
+          fail(ZSTD_getErrorName(pending));
+      }
+      return out.pos;
+    };
+  }
+#endif
+
+  std::vector<char> block;
+  while (get_buffer(block)) {
+    size_t n = read(block.data(), block.size());
+    if (n == 0)
+      break;
+    block.resize(n);
+    push(block);
+  }
+
+#ifdef QUICKRANK_HAS_ZLIB
+  if (gz)
+    gzclose(gz);
+#endif
+#ifdef QUICKRANK_HAS_ZSTD
+  if (dctx)
+    ZSTD_freeDCtx(dctx);
+#endif
+  fclose(file);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  eof_ = true;
+  not_empty_.notify_all();
+}
+
+}  // namespace io
+}  // namespace quickrank
@@ -22,33 +22,24 @@
 
 #include "io/generate_conditional_operators.h"
 
+#include <utility>
+#include <vector>
+
 namespace quickrank {
 namespace io {
 
-void model_node_to_conditional_operators(pugi::xml_node &nodes,
-                                         std::stringstream &os) {
-  unsigned int feature_id = 0;
-  std::string threshold;
-  std::string prediction;
-  bool is_leaf = false;
-  pugi::xml_node left;
-  pugi::xml_node right;
-
-  for (pugi::xml_node &node : nodes.children()) {
+// reads a split of a tree, returning whether it is a leaf
+bool model_node_read(const pugi::xml_node &nodes, unsigned int &feature_id,
+                     std::string &threshold, std::string &prediction,
+                     pugi::xml_node &left, pugi::xml_node &right) {
+  for (const pugi::xml_node &node : nodes.children()) {
     if (strcmp(node.name(), "output") == 0) {
-      prediction = node.text().as_string();
-      trim(prediction);
-      is_leaf = true;
-      break;
+      prediction = GenTreeBlocks::literal(node.text().as_string(), false);
+      return true;
     } else if (strcmp(node.name(), "feature") == 0) {
       feature_id = node.text().as_uint();
     } else if (strcmp(node.name(), "threshold") == 0) {
-      threshold = node.text().as_string();
-      trim(threshold);
-      // dealing with integer values
-      if (threshold.find(".") == std::string::npos)
-      // adding ".0" to deal with the integer found
-        threshold += ".0";
+      threshold = GenTreeBlocks::literal(node.text().as_string(), true);
     } else if (strcmp(node.name(), "split") == 0) {
       std::string pos = node.attribute("pos").as_string();
 
@@ -60,13 +51,23 @@ void model_node_to_conditional_operators(pugi::xml_node &nodes,
       }
     }
   }
+  return false;
+}
+
+void model_node_to_conditional_operators(const pugi::xml_node &nodes,
+                                         std::ostream &os) {
+  unsigned int feature_id = 0;
+  std::string threshold;
+  std::string prediction;
+  pugi::xml_node left;
+  pugi::xml_node right;
 
-  if (is_leaf)
+  if (model_node_read(nodes, feature_id, threshold, prediction, left, right))
     os << prediction;
   else {
     /// \todo TODO: this should be changed with item mapping
     os << "( v[" << feature_id - 1 << "] <= ";
-    os << threshold << "f";
+    os << threshold;
     os << " ? ";
     model_node_to_conditional_operators(left, os);
     os << " : ";
@@ -75,43 +76,127 @@ void model_node_to_conditional_operators(pugi::xml_node &nodes,
   }
 }
 
+void model_node_to_if_else(const pugi::xml_node &nodes, size_t indent,
+                           std::ostream &os) {
+  unsigned int feature_id = 0;
+  std::string threshold;
+  std::string prediction;
+  pugi::xml_node left;
+  pugi::xml_node right;
+  const std::string spaces(indent, ' ');
+
+  if (model_node_read(nodes, feature_id, threshold, prediction, left, right))
+    os << spaces << "return " << prediction << ";" << std::endl;
+  else {
+    os << spaces << "if (v[" << feature_id - 1 << "] <= " << threshold
+       << ") {" << std::endl;
+    model_node_to_if_else(left, indent + 2, os);
+    os << spaces << "} else {" << std::endl;
+    model_node_to_if_else(right, indent + 2, os);
+    os << spaces << "}" << std::endl;
+  }
+}
+
+// appends the nodes of a tree to the arrays of its visit, and returns the
+// index of the node, or the complement of the index of the leaf
+int model_node_to_arrays(const pugi::xml_node &nodes,
+                         std::vector<unsigned int> &features,
+                         std::vector<std::string> &thresholds,
+                         std::vector<std::pair<int, int>> &children,
+                         std::vector<std::string> &leaves) {
+  unsigned int feature_id = 0;
+  std::string threshold;
+  std::string prediction;
+  pugi::xml_node left;
+  pugi::xml_node right;
+
+  if (model_node_read(nodes, feature_id, threshold, prediction, left, right)) {
+    leaves.push_back(prediction);
+    return ~(int) (leaves.size() - 1);
+  }
+  int index = features.size();
+  features.push_back(feature_id - 1);
+  thresholds.push_back(threshold);
+  children.emplace_back();
+  int left_index =
+      model_node_to_arrays(left, features, thresholds, children, leaves);
+  int right_index =
+      model_node_to_arrays(right, features, thresholds, children, leaves);
+  children[index] = std::make_pair(left_index, right_index);
+  return index;
+}
+
+void model_tree_to_arrays(const pugi::xml_node &root, std::ostream &os) {
+  std::vector<unsigned int> features;
+  std::vector<std::string> thresholds;
+  std::vector<std::pair<int, int>> children;
+  std::vector<std::string> leaves;
+  model_node_to_arrays(root, features, thresholds, children, leaves);
+  if (features.empty()) {
+    os << "  return " << leaves[0] << ";" << std::endl;
+    return;
+  }
+
+  os << "  static const unsigned int feature[] = {";
+  for (size_t i = 0; i < features.size(); ++i)
+    os << (i ? ", " : "") << features[i];
+  os << "};" << std::endl << "  static const float threshold[] = {";
+  for (size_t i = 0; i < thresholds.size(); ++i)
+    os << (i ? ", " : "") << thresholds[i];
+  os << "};" << std::endl << "  static const int child[][2] = {";
+  for (size_t i = 0; i < children.size(); ++i)
+    os << (i ? ", " : "") << "{" << children[i].first << ", "
+       << children[i].second << "}";
+  os << "};" << std::endl << "  static const double leaf[] = {";
+  for (size_t i = 0; i < leaves.size(); ++i)
+    os << (i ? ", " : "") << leaves[i];
+  os << "};" << std::endl;
+  // negative children are the complement of the index of a leaf
+  os << "  int n = 0;" << std::endl
+     << "  while (n >= 0)" << std::endl
+     << "    n = child[n][!(v[feature[n]] <= threshold[n])];" << std::endl
+     << "  return leaf[~n];" << std::endl;
+}
+
 void
 GenOpCond::generate_conditional_operators_code(const std::string model_filename,
-                                               const std::string code_filename) {
+                                               const std::string code_filename,
+                                               const std::string style,
+                                               size_t trees_per_file) {
   if (model_filename.empty()) {
     std::cerr << "!!! Model filename is empty." << std::endl;
     exit(EXIT_FAILURE);
   }
+  if (style != "ternary" && style != "ifelse" && style != "array") {
+    std::cerr << "!!! Unknown code style " << style << "." << std::endl;
+    exit(EXIT_FAILURE);
+  }
 
   // loading XML
   pugi::xml_document xml_document;
   xml_document.load_file(model_filename.c_str());
 
-  // defining output string
-  std::stringstream source_code;
-  source_code.setf(std::ios::floatfield, std::ios::fixed);
-
-  // printing header
-  source_code << "double ranker(float* v) {" << std::endl;
-  source_code << "\treturn 0.0 ";
-
-  // let's navigate the ensemble, for each tree...
+  // let's navigate the ensemble, for each tree a function is generated...
   pugi::xml_node ensemble = xml_document.child("ranker").child("ensemble");
-  for (pugi::xml_node &tree : ensemble.children("tree")) {
-    float tree_weight = tree.attribute("weight").as_float();
-    pugi::xml_node tree_content = tree.child("split");
-    if (tree_content) {
-      source_code << std::endl << "\t\t + " << std::setprecision(3)
-                  << tree_weight << "f * ";
-      model_node_to_conditional_operators(tree_content, source_code);
-    }
-  }
-  source_code << ";" << std::endl << "}" << std::endl;
-
-  std::ofstream output;
-  output.open(code_filename, std::ofstream::out);
-  output << source_code.str();
-  output.close();
+  GenTreeBlocks blocks(trees_per_file);
+  blocks.write(ensemble, code_filename,
+               [&style](const pugi::xml_node &tree, const std::string &name,
+                        std::ostream &os) {
+                 os << "static double " << name << "(const float *v) {"
+                    << std::endl;
+                 pugi::xml_node root = tree.child("split");
+                 if (!root)
+                   os << "  return 0.0;" << std::endl;
+                 else if (style == "ternary") {
+                   os << "  return ";
+                   model_node_to_conditional_operators(root, os);
+                   os << ";" << std::endl;
+                 } else if (style == "ifelse")
+                   model_node_to_if_else(root, 2, os);
+                 else
+                   model_tree_to_arrays(root, os);
+                 os << "}" << std::endl;
+               });
 }
 
 }  // namespace io
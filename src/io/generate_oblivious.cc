@@ -135,7 +135,8 @@ void GenOblivious::model_tree_get_thresholds(pugi::xml_node &split_xml,
 }
 
 void GenOblivious::generate_oblivious_code(const std::string model_filename,
-                                           const std::string code_filename) {
+                                           const std::string code_filename,
+                                           size_t trees_per_file) {
   if (model_filename.empty()) {
     std::cerr << "!!! Model filename is empty." << std::endl;
     exit(EXIT_FAILURE);
@@ -145,188 +146,59 @@ void GenOblivious::generate_oblivious_code(const std::string model_filename,
   pugi::xml_document xml_document;
   xml_document.load_file(model_filename.c_str());
 
-  // defining output string
-  std::stringstream source_code;
-  source_code.setf(std::ios::floatfield, std::ios::fixed);
-
-  // let's navigate the ensemble, for each tree...
-  pugi::xml_node ranker = xml_document.child("ranker");
-  pugi::xml_node info = ranker.child("info");
-  // trees below not used as it can report a bigger number of trees
-  // in case we are using intermediate XML model dump files...
-  //unsigned int trees = info.child("trees").text().as_uint();
-  unsigned int depth = info.child("depth").text().as_uint();
-  unsigned int max_leaves = 1 << depth;
-
-  pugi::xml_node ensemble = ranker.child("ensemble");
-
-  // loading tree weights
-  std::vector<float> tree_weights;
-  for (pugi::xml_node &tree : ensemble.children("tree")) {
-    tree_weights.push_back(tree.attribute("weight").as_float());
-  }
-
-  // loading tree depths
-  std::vector<int> tree_depths;
-  for (pugi::xml_node tree : ensemble.children("tree")) {
-    int curr_depth = 0;
-    auto splits_in_tree = tree.children("split");
-    int size = std::distance(splits_in_tree.begin(), splits_in_tree.end());
-    while (size != 0) {
-      curr_depth++;
-      tree = tree.child("split");
-      splits_in_tree = tree.child("split").children("split");
-      size = std::distance(splits_in_tree.begin(), splits_in_tree.end());
-    }
-    tree_depths.push_back(curr_depth);
-  }
-
-  int actual_model_size = tree_depths.size();
-
-  // load leaf outputs
-  std::vector<std::vector<std::string>> tree_outputs(actual_model_size);
-  unsigned int curr_tree = 0;
-  for (pugi::xml_node tree : ensemble.children("tree")) {
-    pugi::xml_node root = tree.child("split");
-    model_tree_get_leaves(root, tree_outputs[curr_tree++]);
-  }
-
-  // load features ids
-  curr_tree = 0;
-  std::vector<std::vector<unsigned int>> feature_ids(actual_model_size);
-  for (pugi::xml_node tree : ensemble.children("tree")) {
-    pugi::xml_node root = tree.child("split");
-    model_tree_get_feature_ids(root, feature_ids[curr_tree++]);
-  }
-
-  // load thresholds values
-  curr_tree = 0;
-  std::vector<std::vector<std::string>> thresholds(actual_model_size);
-  for (pugi::xml_node tree : ensemble.children("tree")) {
-    pugi::xml_node root = tree.child("split");
-    model_tree_get_thresholds(root, thresholds[curr_tree++]);
-  }
-
-  // mapping of trees in sorted order by depths
-  std::vector<size_t> tree_mapping(tree_depths.size());
-  std::iota(tree_mapping.begin(), tree_mapping.end(), 0);
-  std::sort(tree_mapping.begin(), tree_mapping.end(),
-            [&tree_depths](int a, int b) {
-              return tree_depths[a] < tree_depths[b];
-            });
-
-  // number of trees for each depth
-  std::vector<size_t> depths_population;
-  int max_depth = tree_depths[tree_mapping.back()];
-
-  int curr_depth = 1;
-  size_t start_position = 0;
-  for (size_t i = 0; i < tree_mapping.size(); i++) {
-    while (tree_depths[tree_mapping[i]] > curr_depth) {
-      depths_population.push_back(i - start_position);
-      curr_depth++;
-      start_position = i;
-    }
-    if (curr_depth == max_depth)
-      break;
-  }
-  depths_population.push_back(tree_mapping.size() - start_position);
-
-  // start printing code to output stream...
-  // printing ensemble info
-  source_code << "#define N " << actual_model_size << " // no. of trees"
-              << std::endl;
-  source_code << "#define M " << depth << " // max tree depth" << std::endl;
-  source_code << "#define F " << max_leaves << " // max number of leaves"
-              << std::endl;
-  source_code << std::endl;
-
-  // print tree weights
-  source_code << std::setprecision(std::numeric_limits<float>::max_digits10);
-  source_code << "const float tree_weights[N] = { ";
-  for (size_t i = 0; i < tree_weights.size(); i++) {
-    if (i != 0)
-      source_code << ", ";
-    source_code << tree_weights[tree_mapping[i]];
-  }
-  source_code << " };" << std::endl << std::endl;
-
-  // print leaf outputs
-  source_code << "const double leaf_outputs[N][F] = { " << std::endl << '\t';
-  for (size_t i = 0; i < tree_outputs.size(); i++) {
-    if (i != 0)
-      source_code << "," << std::endl << '\t';
-    source_code << "\t{ ";
-    for (size_t j = 0; j < tree_outputs[tree_mapping[i]].size(); j++) {
-      if (j != 0)
-        source_code << ", ";
-      source_code << tree_outputs[tree_mapping[i]][j];
-    }
-    source_code << " }";
-  }
-  source_code << std::endl << "};" << std::endl << std::endl;
-
-  // pint features ids
-  source_code << "const unsigned int features_ids[N][M] = { " << std::endl
-              << '\t';
-  for (size_t i = 0; i < feature_ids.size(); i++) {
-    if (i != 0)
-      source_code << "," << std::endl << '\t';
-    source_code << "\t{ ";
-    for (size_t j = 0; j < feature_ids[tree_mapping[i]].size(); j++) {
-      if (j != 0)
-        source_code << ", ";
-      source_code << feature_ids[tree_mapping[i]][j];
-    }
-    source_code << " }";
-  }
-  source_code << std::endl << "};" << std::endl << std::endl;
-
-  // print thresholds values
-  source_code << "const float thresholds[N][M] = { " << std::endl << '\t';
-  source_code
-      << std::setprecision(
-          std::numeric_limits<quickrank::Feature>::max_digits10);
-  for (size_t i = 0; i < thresholds.size(); i++) {
-    if (i != 0)
-      source_code << "," << std::endl << '\t';
-    source_code << "\t{ ";
-    for (size_t j = 0; j < thresholds[tree_mapping[i]].size(); j++) {
-      if (j != 0)
-        source_code << ", ";
-      source_code << thresholds[tree_mapping[i]][j];
-    }
-    source_code << " }";
-  }
-  source_code << std::endl << "};" << std::endl << std::endl;
-
-  source_code << "#define SHL(n,p) ((n)<<(p))" << std::endl << std::endl;
-
-  source_code
-      << "unsigned int leaf_id(float *v, unsigned int const *fids, float const *thresh, const unsigned int m) {"
-      << std::endl << "  unsigned int leafidx=0;" << std::endl
-      << "  for (unsigned int i=0; i<m; ++i)" << std::endl
-      << "    leafidx |= SHL( v[fids[i]]>thresh[i], m-1-i);" << std::endl
-      << "  return leafidx;" << std::endl << "}" << std::endl << std::endl;
-
-  source_code << "double ranker(float *v) {" << std::endl
-              << "  double score = 0.0;" << std::endl << "  int i = 0;"
-              << std::endl;
-  for (int d = 0; d < max_depth; d++) {
-    source_code << "  for (int j = 0; j < " << depths_population[d]
-                << "; ++j) {" << std::endl;
-    source_code
-        << "    score += tree_weights[i] * leaf_outputs[i][leaf_id(v, features_ids[i], thresholds[i], "
-        << d + 1 << ")];" << std::endl;
-    source_code << "    i++;" << std::endl;
-    source_code << "  }" << std::endl;
-  }
-  source_code << "  return score;" << std::endl << "}" << std::endl;
-
-  std::ofstream output;
-  output.open(code_filename, std::ofstream::out);
-  output << source_code.str();
-  output.close();
+  // let's navigate the ensemble, for each tree a function computes the
+  // index of the exit leaf from the splits of its levels...
+  pugi::xml_node ensemble = xml_document.child("ranker").child("ensemble");
+  GenTreeBlocks blocks(trees_per_file);
+  blocks.write(ensemble, code_filename,
+               [this](const pugi::xml_node &tree, const std::string &name,
+                      std::ostream &os) {
+                 pugi::xml_node root = tree.child("split");
+                 std::vector<std::string> leaves;
+                 std::vector<unsigned int> feature_ids;
+                 std::vector<std::string> thresholds;
+                 if (root) {
+                   model_tree_get_leaves(root, leaves);
+                   model_tree_get_feature_ids(root, feature_ids);
+                   model_tree_get_thresholds(root, thresholds);
+                 }
+
+                 os << "static double " << name << "(const float *v) {"
+                    << std::endl;
+                 if (leaves.empty()) {
+                   os << "  return 0.0;" << std::endl << "}" << std::endl;
+                   return;
+                 }
+                 // the level of the first split gives the most significant
+                 // bit of the leaf index
+                 const size_t depth = feature_ids.size();
+                 if (depth > 0) {
+                   os << "  static const uint32_t features[" << depth
+                      << "] = {";
+                   for (size_t i = 0; i < depth; i++)
+                     os << (i ? ", " : "") << feature_ids[i];
+                   os << "};" << std::endl << "  static const float thresholds["
+                      << depth << "] = {";
+                   for (size_t i = 0; i < depth; i++)
+                     os << (i ? ", " : "")
+                        << GenTreeBlocks::literal(thresholds[i].c_str(), true);
+                   os << "};" << std::endl;
+                 }
+                 os << "  static const double leaves[" << leaves.size()
+                    << "] = {";
+                 for (size_t i = 0; i < leaves.size(); i++)
+                   os << (i ? ", " : "")
+                      << GenTreeBlocks::literal(leaves[i].c_str(), false);
+                 os << "};" << std::endl;
+                 if (depth > 0)
+                   os << "  return leaves[quickrank::scoring::"
+                      << "oblivious_tree_leaf<" << depth
+                      << ">(features, thresholds, v)];" << std::endl;
+                 else
+                   os << "  return leaves[0];" << std::endl;
+                 os << "}" << std::endl;
+               },
+               {"scoring/fixed_depth_tree.h"});
 }
 
 }  // namespace io
@@ -0,0 +1,261 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "io/generate_tree_blocks.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <vector>
+
+namespace quickrank {
+namespace io {
+
+const size_t GenTreeBlocks::DEFAULT_TREES_PER_FILE;
+
+namespace {
+
+// number of documents of ranker_batch() scored by a block at a time, so
+// that their features are still cached when the next block scores them
+const size_t BATCH_DOCS = 1024;
+
+const char *SIGNATURE =
+    "(const float *v, size_t num_docs, size_t num_features, double *scores)";
+
+void write_file(const std::string &filename, const std::string &code) {
+  std::ofstream output(filename, std::ofstream::out);
+  output << code;
+  output.close();
+  if (!output) {
+    std::cerr << "!!! Unable to write source file " << filename << std::endl;
+    exit(EXIT_FAILURE);
+  }
+}
+
+// ranges of the thresholds of every feature, used to draw the documents of
+// the benchmark harness
+void feature_ranges(const pugi::xml_node &split, std::vector<float> &lower,
+                    std::vector<float> &upper) {
+  pugi::xml_node feature = split.child("feature");
+  pugi::xml_node threshold = split.child("threshold");
+  if (feature && threshold) {
+    size_t f = feature.text().as_uint() - 1;
+    float value = threshold.text().as_float();
+    if (f >= lower.size()) {
+      lower.resize(f + 1, std::numeric_limits<float>::infinity());
+      upper.resize(f + 1, -std::numeric_limits<float>::infinity());
+    }
+    if (std::isfinite(value)) {
+      lower[f] = std::min(lower[f], value);
+      upper[f] = std::max(upper[f], value);
+    }
+  }
+  for (const pugi::xml_node &child: split.children("split"))
+    feature_ranges(child, lower, upper);
+}
+
+}  // namespace
+
+GenTreeBlocks::GenTreeBlocks(size_t trees_per_file)
+    : trees_per_file_(std::max<size_t>(trees_per_file, 1)) {
+}
+
+std::string GenTreeBlocks::literal(const char *value, bool single_precision) {
+  double number = strtod(value, nullptr);
+  if (single_precision)
+    number = (float) number;
+  if (std::isnan(number))
+    return "NAN";
+  if (std::isinf(number))
+    return number > 0 ? "INFINITY" : "-INFINITY";
+
+  std::ostringstream os;
+  if (single_precision)
+    os << std::setprecision(std::numeric_limits<float>::max_digits10);
+  else
+    os << std::setprecision(std::numeric_limits<double>::max_digits10);
+  os << number;
+  std::string literal = os.str();
+  if (literal.find_first_of(".e") == std::string::npos)
+    literal += ".0";
+  if (single_precision)
+    literal += "f";
+  return literal;
+}
+
+void GenTreeBlocks::write(const pugi::xml_node &ensemble,
+                          const std::string &code_filename,
+                          TreeWriter tree_writer,
+                          const std::vector<std::string> &headers) const {
+  if (code_filename.empty()) {
+    std::cerr << "!!! Code filename is empty." << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  // model.cc is split in model_block0.cc, model_block1.cc ...
+  std::string stem = code_filename;
+  std::string extension = ".cc";
+  size_t dot = code_filename.find_last_of('.');
+  size_t slash = code_filename.find_last_of('/');
+  if (dot != std::string::npos && (slash == std::string::npos || dot > slash)) {
+    stem = code_filename.substr(0, dot);
+    extension = code_filename.substr(dot);
+  }
+
+  std::vector<pugi::xml_node> trees;
+  for (const pugi::xml_node &tree: ensemble.children("tree"))
+    trees.push_back(tree);
+  size_t num_blocks = (trees.size() + trees_per_file_ - 1) / trees_per_file_;
+
+  // block files, each one scoring a batch of documents with its trees
+  for (size_t b = 0; b < num_blocks; ++b) {
+    size_t first = b * trees_per_file_;
+    size_t last = std::min(first + trees_per_file_, trees.size());
+    std::ostringstream code;
+    code << "// Trees " << first + 1 << "-" << last << " of " << trees.size()
+         << ", generated by QuickRank.\n\n"
+         << "#include <cmath>\n#include <cstddef>\n\n";
+    for (const std::string &header: headers)
+      code << "#include \"" << header << "\"\n";
+    if (!headers.empty())
+      code << "\n";
+    for (size_t t = first; t < last; ++t) {
+      tree_writer(trees[t], "tree_" + std::to_string(t + 1), code);
+      code << "\n";
+    }
+    code << "void ranker_block_" << b << SIGNATURE << " {\n"
+         << "  for (size_t i = 0; i < num_docs; ++i, v += num_features) {\n"
+         << "    double score = scores[i];\n";
+    for (size_t t = first; t < last; ++t) {
+      pugi::xml_attribute weight = trees[t].attribute("weight");
+      code << "    score += "
+           << literal(weight ? weight.value() : "1", false)
+           << " * tree_" << t + 1 << "(v);\n";
+    }
+    code << "    scores[i] = score;\n  }\n}\n";
+    write_file(stem + "_block" + std::to_string(b) + extension, code.str());
+  }
+
+  // main file, every batch of documents is scored block by block
+  std::ostringstream code;
+  code << "// Entry points of a model of " << trees.size() << " trees in "
+       << num_blocks << " block files, generated by QuickRank.\n\n"
+       << "#include <cstddef>\n\n";
+  for (size_t b = 0; b < num_blocks; ++b)
+    code << "void ranker_block_" << b << SIGNATURE << ";\n";
+  code << "\nvoid ranker_batch" << SIGNATURE << " {\n"
+       << "  for (size_t i = 0; i < num_docs; ++i)\n"
+       << "    scores[i] = 0.0;\n"
+       << "  for (size_t first = 0; first < num_docs; first += "
+       << BATCH_DOCS << ") {\n"
+       << "    size_t batch = num_docs - first < " << BATCH_DOCS
+       << " ? num_docs - first : " << BATCH_DOCS << ";\n";
+  for (size_t b = 0; b < num_blocks; ++b)
+    code << "    ranker_block_" << b << "(v + first * num_features, batch, "
+         << "num_features, scores + first);\n";
+  code << "  }\n}\n\n"
+       << "double ranker(float *v) {\n"
+       << "  double score = 0.0;\n"
+       << "  ranker_batch(v, 1, 0, &score);\n"
+       << "  return score;\n}\n";
+  write_file(code_filename, code.str());
+
+  // benchmark harness, drawing the features of the documents around the
+  // thresholds of the model
+  std::vector<float> lower, upper;
+  for (const pugi::xml_node &tree: trees)
+    feature_ranges(tree.child("split"), lower, upper);
+  if (lower.empty()) {
+    lower.push_back(0.0f);
+    upper.push_back(0.0f);
+  }
+  for (size_t f = 0; f < lower.size(); ++f) {
+    if (lower[f] > upper[f])
+      lower[f] = upper[f] = 0.0f;
+    float margin = upper[f] > lower[f] ? 0.1f * (upper[f] - lower[f]) : 1.0f;
+    lower[f] -= margin;
+    upper[f] += margin;
+  }
+  std::string model_files = code_filename + " " + stem + "_block*" + extension;
+  std::ostringstream bench;
+  bench << "// Benchmark of a model generated by QuickRank, compiled with\n"
+        << "//   c++ -O3 -march=native "
+        << (headers.empty() ? "" : "-I <quickrank>/include ")
+        << model_files << " "
+        << stem << "_bench" << extension << "\n"
+        << "// and run as: a.out [num_docs [rounds]]\n\n"
+        << "#include <chrono>\n#include <cstdio>\n#include <cstdlib>\n"
+        << "#include <random>\n#include <vector>\n\n"
+        << "void ranker_batch" << SIGNATURE << ";\n\n"
+        << "static const size_t NUM_FEATURES = " << lower.size() << ";\n";
+  for (int bound = 0; bound < 2; ++bound) {
+    const std::vector<float> &values = bound ? upper : lower;
+    bench << "static const float " << (bound ? "upper" : "lower")
+          << "[NUM_FEATURES] = {";
+    for (size_t f = 0; f < values.size(); ++f) {
+      std::ostringstream value;
+      value << std::setprecision(std::numeric_limits<float>::max_digits10)
+            << values[f];
+      bench << (f % 6 ? " " : "\n    ")
+            << literal(value.str().c_str(), true) << ",";
+    }
+    bench << "\n};\n";
+  }
+  bench << "\nint main(int argc, char *argv[]) {\n"
+        << "  size_t num_docs = argc > 1 ? strtoul(argv[1], NULL, 10) : 100000;\n"
+        << "  size_t rounds = argc > 2 ? strtoul(argv[2], NULL, 10) : 10;\n\n"
+        << "  std::mt19937 generator(1);\n"
+        << "  std::vector<float> documents(num_docs * NUM_FEATURES);\n"
+        << "  for (size_t i = 0; i < num_docs; ++i)\n"
+        << "    for (size_t f = 0; f < NUM_FEATURES; ++f)\n"
+        << "      documents[i * NUM_FEATURES + f] =\n"
+        << "          std::uniform_real_distribution<float>(lower[f], upper[f])"
+        << "(generator);\n"
+        << "  std::vector<double> scores(num_docs);\n"
+        << "  ranker_batch(documents.data(), num_docs, NUM_FEATURES, "
+        << "scores.data());\n\n"
+        << "  auto start = std::chrono::high_resolution_clock::now();\n"
+        << "  for (size_t r = 0; r < rounds; ++r)\n"
+        << "    ranker_batch(documents.data(), num_docs, NUM_FEATURES, "
+        << "scores.data());\n"
+        << "  double seconds = std::chrono::duration<double>(\n"
+        << "      std::chrono::high_resolution_clock::now() - start).count();\n\n"
+        << "  double checksum = 0.0;\n"
+        << "  for (double score: scores)\n"
+        << "    checksum += score;\n"
+        << "  printf(\"Documents: %zu x %zu, rounds: %zu\\n\", num_docs, "
+        << "NUM_FEATURES, rounds);\n"
+        << "  printf(\"       Total scoring time: %g s.\\n\", seconds);\n"
+        << "  printf(\"Avg.    Doc. scoring time: %g s.\\n\",\n"
+        << "         seconds / rounds / num_docs);\n"
+        << "  printf(\"Scores checksum: %.17g\\n\", checksum);\n"
+        << "  return 0;\n}\n";
+  write_file(stem + "_bench" + extension, bench.str());
+}
+
+}  // namespace io
+}  // namespace quickrank
@@ -23,126 +23,86 @@
 #include <iomanip>
 #include <chrono>
 #include <fstream>
-#include <sys/stat.h>
+#include <sstream>
+#include <algorithm>
 #include <list>
 
 #include "io/svml.h"
+#include "io/text_writer.h"
 #include "utils/strutils.h"
 
 
 namespace quickrank {
 namespace io {
 
+// An instance parsed from a line of the file.
+struct Svml::ParsedLine {
+  bool valid = false;  // false for empty and comment lines
+  size_t qid = 0;
+  quickrank::Label relevance = 0;
+  // the features, or the non-zero features of sparse instances
+  std::vector<quickrank::Feature> values;
+  std::vector<uint32_t> columns;
+};
+
 // TODO: save info file or use mmap
-// TODO: re-introduce multithreading
 std::unique_ptr<data::Dataset> Svml::read_horizontal(
     const std::string &filename) {
 
-  FILE *f = fopen(filename.c_str(), "r");
-  if (!f) {
-    std::cerr << "!!! Error while opening file " << filename << "."
-              << std::endl;
-    exit(EXIT_FAILURE);
-  }
-
-  struct stat filestatus;
-  stat(filename.c_str(), &filestatus);
-  file_size_ = filestatus.st_size;
-
   std::chrono::high_resolution_clock::time_point start_reading =
       std::chrono::high_resolution_clock::now();
 
+  // the file is read (and decompressed) by a producer thread, while the
+  // lines of every block are parsed in parallel
+  BlockReader reader(filename);
+  file_size_ = reader.file_size();
+  compression_ = reader.compression();
+
   size_t maxfid = 0;
 
   // temporary copy of data
   std::list<size_t> data_qids;
   std::list<quickrank::Label> data_labels;
   std::list<std::vector<quickrank::Feature>> data_instances;
+  std::list<std::vector<uint32_t>> data_columns;
+  size_t num_nonzeros = 0;
+  const bool sparse = storage_ == data::Dataset::SPARSE;
 
-  while (not feof(f)) {
-    //#pragma omp parallel for ordered reduction(max:maxfid) num_threads(4) schedule(static,1)
-    //  for (int file_i=0; file_i<file_size_; file_i++) {
-    //    if(feof(f)) {file_i = file_size_; continue; }
-    ssize_t nread;
-    size_t linelength = 0;
-    char *line = NULL;
-    //lines are read one-at-a-time by threads
-    //#pragma omp ordered
-    {
-      nread = getline(&line, &linelength, f);
-    }
-    //if something is wrong with getline() or line is empty, skip to the next
-    if (nread <= 0) {
-      free(line);
-      continue;
-    }
-    char *token = NULL, *pch = line;
-    //skip initial spaces
-    while (ISSPC(*pch) && *pch != '\0')
-      ++pch;
-    //skip comment line
-    if (*pch == '#') {
-      free(line);
-      continue;
-    }
-
-    //read label (label is a mandatory field)
-    if (ISEMPTY(token = read_token(pch)))
-      exit(2);
-
-    // read label and qid
-    quickrank::Label relevance = atof(token);
-    size_t qid = atou(read_token(pch), "qid:");
-
-    // allocate feature vector and read instance
-    std::vector<quickrank::Feature> curr_instance(maxfid);
-
-    //read a sequence of features, namely (fid,fval) pairs, then the ending description
-    while (!ISEMPTY(token = read_token(pch, '#'))) {
-      if (*token == '#') {
-//#ifndef SKIP_DPDESCRIPTION
-//        datapoint->set_description(strdup(++token));
-//#endif
-        *pch = '\0';
-      } else {
-        //read a feature (id,val) from token
-        size_t fid = 0;
-        float fval = 0.0f;
-        if (sscanf(token, "%zu:%f", &fid, &fval) != 2)
-          exit(4);
-        //add feature to the current dp
-        if (fid > maxfid) {
-          maxfid = fid;
-          curr_instance.resize(maxfid);
-        }
-        curr_instance[fid - 1] = fval;
-      }
-    }
-
+  parse_blocks(reader, maxfid, [&](std::vector<ParsedLine> &parsed) {
     // store partial data
-    //#pragma omp ordered
-    {
-      data_qids.push_back(qid);
-      data_labels.push_back(relevance);
-      data_instances.push_back(std::move(curr_instance));  // move should avoid
+    for (auto &p: parsed) {
+      if (!p.valid)
+        continue;
+      num_nonzeros += p.columns.size();
+      data_qids.push_back(p.qid);
+      data_labels.push_back(p.relevance);
+      data_instances.push_back(std::move(p.values));  // move should avoid
       // copies
+      if (sparse)
+        data_columns.push_back(std::move(p.columns));
     }
-    //free mem
-    free(line);
-  }
-  //close input file
-  fclose(f);
+    return true;
+  });
+  uncompressed_size_ = reader.bytes_read();
 
   std::chrono::high_resolution_clock::time_point start_processing =
       std::chrono::high_resolution_clock::now();
 
   // put partial data in final data structure
-  data::Dataset *dataset = new data::Dataset(data_qids.size(), maxfid);
+  data::Dataset *dataset = new data::Dataset(
+      data_qids.size(), feature_ids_.empty() ? maxfid : feature_ids_.size(),
+      storage_, num_nonzeros);
+  if (!feature_ids_.empty())
+    dataset->set_feature_ids(feature_ids_);
   auto i_q = data_qids.begin();
   auto i_l = data_labels.begin();
   auto i_x = data_instances.begin();
+  auto i_c = data_columns.begin();
   while (i_q != data_qids.end()) {
-    dataset->addInstance(*i_q, *i_l, std::move(*i_x));
+    if (sparse)
+      dataset->addInstance(*i_q, *i_l, *i_c++, *i_x);
+    else
+      dataset->addInstance(*i_q, *i_l, std::move(*i_x));
     i_q++;
     i_l++;
     i_x++;
@@ -160,38 +120,315 @@ std::unique_ptr<data::Dataset> Svml::read_horizontal(
   return std::unique_ptr<data::Dataset>(dataset);
 }
 
+void Svml::read_chunks(const std::string &filename, size_t chunk_size,
+                       ChunkConsumer consume, size_t min_features) {
+  BlockReader reader(filename);
+  file_size_ = reader.file_size();
+  compression_ = reader.compression();
+
+  // the instances of the current chunk
+  std::vector<ParsedLine> pending;
+  size_t pending_nonzeros = 0;
+  size_t maxfid = 0;
+  const bool sparse = storage_ == data::Dataset::SPARSE;
+
+  // builds a chunk with the pending instances, whose features are at least
+  // as many as those of the previous chunks
+  auto flush = [&]() {
+    std::unique_ptr<data::Dataset> chunk(new data::Dataset(
+        pending.size(),
+        std::max(feature_ids_.empty() ? maxfid : feature_ids_.size(),
+                 min_features),
+        storage_, pending_nonzeros));
+    if (!feature_ids_.empty())
+      chunk->set_feature_ids(feature_ids_);
+    for (auto &p: pending) {
+      if (sparse)
+        chunk->addInstance(p.qid, p.relevance, p.columns, p.values);
+      else
+        chunk->addInstance(p.qid, p.relevance, std::move(p.values));
+    }
+    pending.clear();
+    pending_nonzeros = 0;
+    return consume(std::move(chunk));
+  };
+
+  auto add_lines = [&](std::vector<ParsedLine> &parsed) {
+    for (auto &p: parsed) {
+      if (!p.valid)
+        continue;
+      // a chunk is complete when a new query starts
+      if (!pending.empty() && pending.size() >= chunk_size
+          && p.qid != pending.back().qid
+          && !flush())
+        return false;
+      pending_nonzeros += p.columns.size();
+      pending.push_back(std::move(p));
+    }
+    return true;
+  };
+  if (parse_blocks(reader, maxfid, add_lines) && !pending.empty())
+    flush();
+  uncompressed_size_ = reader.bytes_read();
+}
+
+bool Svml::parse_blocks(BlockReader &reader, size_t &maxfid,
+                        std::function<bool(std::vector<ParsedLine> &)>
+                        consume) const {
+  std::vector<char> block;
+  std::vector<char> text;  // the last (incomplete) line of a block, if any
+  std::vector<char *> lines;
+  std::vector<ParsedLine> parsed;
+  bool more = true;
+  while (more) {
+    more = reader.next(block);
+    text.insert(text.end(), block.begin(), block.end());
+    // complete lines are parsed, the incomplete one is kept for the next
+    // block (at end of file every line is complete)
+    size_t end = text.size();
+    if (more) {
+      while (end > 0 && text[end - 1] != '\n')
+        --end;
+    }
+    if (end == 0)
+      continue;
+    text.push_back('\0');
+
+    lines.clear();
+    char *line = text.data();
+    for (size_t k = 0; k < end; ++k) {
+      if (text[k] == '\n') {
+        text[k] = '\0';
+        lines.push_back(line);
+        line = text.data() + k + 1;
+      }
+    }
+    if (line < text.data() + end)
+      lines.push_back(line);  // last line of the file with no new line
+
+    parsed.resize(lines.size());
+    size_t block_maxfid = 0;
+    #pragma omp parallel for reduction(max:block_maxfid)
+    for (size_t k = 0; k < lines.size(); ++k)
+      block_maxfid = std::max(block_maxfid, parse_line(lines[k], parsed[k]));
+    maxfid = std::max(maxfid, block_maxfid);
+
+    if (!consume(parsed))
+      return false;
+
+    // move the incomplete line at the beginning of the buffer
+    text.erase(text.begin(), text.begin() + end);
+    text.pop_back();
+  }
+  return true;
+}
+
+size_t Svml::parse_line(char *line, ParsedLine &parsed) const {
+  parsed = ParsedLine();
+  char *token = NULL, *pch = line;
+  //skip initial spaces
+  while (ISSPC(*pch) && *pch != '\0')
+    ++pch;
+  //skip empty and comment lines
+  if (*pch == '\0' || *pch == '#')
+    return 0;
+
+  //read label (label is a mandatory field)
+  if (ISEMPTY(token = read_token(pch)))
+    exit(2);
+
+  // read label and qid
+  parsed.valid = true;
+  parsed.relevance = atof(token);
+  parsed.qid = atou(read_token(pch), "qid:");
+
+  // allocate feature vector and read instance
+  // (sparse instances store only the non-zero features)
+  const bool sparse = storage_ == data::Dataset::SPARSE;
+  size_t maxfid = 0;
+  if (!sparse && !feature_ids_.empty())
+    parsed.values.resize(feature_ids_.size());
+
+  //read a sequence of features, namely (fid,fval) pairs, then the ending description
+  while (!ISEMPTY(token = read_token(pch, '#'))) {
+    if (*token == '#') {
+      *pch = '\0';
+    } else {
+      //read a feature (id,val) from token
+      size_t fid = 0;
+      float fval = 0.0f;
+      if (sscanf(token, "%zu:%f", &fid, &fval) != 2)
+        exit(4);
+      //skip features not selected
+      size_t column = fid - 1;
+      if (!feature_ids_.empty()) {
+        if (fid == 0 || fid > feature_columns_.size()
+            || !feature_columns_[fid - 1])
+          continue;
+        column = feature_columns_[fid - 1] - 1;
+      } else if (fid > maxfid) {
+        maxfid = fid;
+        if (!sparse && parsed.values.size() < maxfid)
+          parsed.values.resize(maxfid);
+      }
+      //add feature to the current dp
+      if (!sparse) {
+        parsed.values[column] = fval;
+      } else if (fval != 0.0f) {
+        parsed.columns.push_back(column);
+        parsed.values.push_back(fval);
+      }
+    }
+  }
+  if (sparse)
+    sort_sparse_instance(parsed.columns, parsed.values);
+  return maxfid;
+}
+
+void Svml::sort_sparse_instance(std::vector<uint32_t> &columns,
+                                std::vector<Feature> &values) {
+  bool sorted = true;
+  for (size_t i = 1; i < columns.size() && sorted; ++i)
+    sorted = columns[i - 1] < columns[i];
+  if (sorted)
+    return;
+
+  // features are usually listed in order, this is the unlikely case
+  std::vector<std::pair<uint32_t, Feature>> pairs(columns.size());
+  for (size_t i = 0; i < columns.size(); ++i)
+    pairs[i] = std::make_pair(columns[i], values[i]);
+  std::stable_sort(pairs.begin(), pairs.end(),
+                   [](const std::pair<uint32_t, Feature> &a,
+                      const std::pair<uint32_t, Feature> &b) {
+                     return a.first < b.first;
+                   });
+  // as for dense instances, the last value of a repeated feature is kept
+  columns.clear();
+  values.clear();
+  for (size_t i = 0; i < pairs.size(); ++i) {
+    if (!columns.empty() && columns.back() == pairs[i].first)
+      values.back() = pairs[i].second;
+    else {
+      columns.push_back(pairs[i].first);
+      values.push_back(pairs[i].second);
+    }
+  }
+}
+
+void Svml::set_feature_ids(const std::vector<size_t> &feature_ids) {
+  feature_ids_ = feature_ids;
+  feature_columns_.clear();
+  if (!feature_ids_.empty())
+    feature_columns_.resize(feature_ids_.back(), 0);
+  for (size_t i = 0; i < feature_ids_.size(); ++i)
+    feature_columns_[feature_ids_[i] - 1] = i + 1;
+}
+
+std::vector<size_t> Svml::read_feature_ids(const std::string &file) {
+  std::ifstream in(file);
+  if (!in) {
+    std::cerr << "!!! Error while opening features file " << file << "."
+              << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  std::vector<size_t> feature_ids;
+  std::string line;
+  while (std::getline(in, line)) {
+    // strip comments
+    line = line.substr(0, line.find('#'));
+    std::replace(line.begin(), line.end(), ',', ' ');
+    std::stringstream tokens(line);
+    std::string token;
+    while (tokens >> token) {
+      size_t first = 0, last = 0;
+      char dash;
+      std::stringstream range(token);
+      if (!(range >> first) || first == 0) {
+        std::cerr << "!!! Invalid feature id " << token << " in features file "
+                  << file << "." << std::endl;
+        exit(EXIT_FAILURE);
+      }
+      last = first;
+      if (range >> dash && (dash != '-' || !(range >> last) || last < first)) {
+        std::cerr << "!!! Invalid feature range " << token
+                  << " in features file " << file << "." << std::endl;
+        exit(EXIT_FAILURE);
+      }
+      for (size_t fid = first; fid <= last; ++fid)
+        feature_ids.push_back(fid);
+    }
+  }
+
+  std::sort(feature_ids.begin(), feature_ids.end());
+  feature_ids.erase(std::unique(feature_ids.begin(), feature_ids.end()),
+                    feature_ids.end());
+
+  if (feature_ids.empty()) {
+    std::cerr << "!!! No feature selected in features file " << file << "."
+              << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  return feature_ids;
+}
+
 void Svml::write(std::shared_ptr<data::Dataset> dataset,
                  const std::string &file) {
 
-  std::ofstream outFile(file, std::ofstream::out | std::ofstream::trunc);
-
-  for (size_t q = 0; q < dataset->num_queries(); q++) {
-    std::shared_ptr<data::QueryResults> results = dataset->getQueryResults(q);
-    const Feature *features = results->features();
-    const Label *labels = results->labels();
-
-    for (size_t r = 0; r < results->num_results(); r++) {
-      outFile << std::setprecision(0) << labels[r] << " qid:" << q + 1;
-      for (size_t f = 0; f < dataset->num_features(); f++) {
-        outFile << " " << f + 1 << ":"
-                << std::fixed
-                << std::setprecision(
-                    std::numeric_limits<quickrank::Feature>::max_digits10)
-                << features[f];
+  // query of every instance
+  std::vector<size_t> queries(dataset->num_instances());
+  for (size_t q = 0; q < dataset->num_queries(); q++)
+    std::fill(queries.begin() + dataset->offset(q),
+              queries.begin() + dataset->offset(q + 1), q + 1);
+
+  TextWriter writer(file);
+  writer.write_lines(dataset->num_instances(), [&](size_t d,
+                                                   std::string &line) {
+    TextWriter::append(line, dataset->getLabel(d));
+    line += " qid:";
+    TextWriter::append(line, queries[d]);
+
+    if (dataset->is_sparse()) {
+      // sparse datasets are written with their non-zero features only
+      const uint32_t *columns = dataset->nonzero_columns(d);
+      const Feature *values = dataset->nonzero_values(d);
+      for (size_t k = 0; k < dataset->num_nonzeros(d); k++) {
+        line += ' ';
+        TextWriter::append(line, (size_t) columns[k] + 1);
+        line += ':';
+        TextWriter::append(line, values[k]);
       }
-      outFile << std::endl;
-      features += dataset->num_features();
+      return;
     }
-  }
 
-  outFile.close();
+    // 16 bits features are widened into a dense row
+    std::vector<Feature> row;
+    const Feature *features;
+    if (dataset->has_float_features()) {
+      features = dataset->at(d, 0);
+    } else {
+      row.resize(dataset->num_features());
+      dataset->fill_row(d, row.data());
+      features = row.data();
+    }
+    for (size_t f = 0; f < dataset->num_features(); f++) {
+      line += ' ';
+      TextWriter::append(line, f + 1);
+      line += ':';
+      TextWriter::append(line, features[f]);
+    }
+  });
 }
 
 std::ostream &Svml::put(std::ostream &os) const {
   // num threads is not reported here.
   os << std::setprecision(2) << "#\t Reading time: " << reading_time_
-     << " s. @ " << file_size_ / 1024 / 1024 / reading_time_ << " MB/s "
-     << " (post-proc.: " << processing_time_ << " s.)" << std::endl;
+     << " s. @ " << uncompressed_size_ / 1024.0 / 1024.0 / reading_time_
+     << " MB/s ";
+  if (compression_ != BlockReader::NONE)
+    os << "(" << BlockReader::compression_name(compression_) << ": "
+       << file_size_ / 1024.0 / 1024.0 / reading_time_ << " MB/s) ";
+  os << " (post-proc.: " << processing_time_ << " s.)" << std::endl;
   return os;
 }
 
@@ -0,0 +1,79 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "io/svml_stream.h"
+
+namespace quickrank {
+namespace io {
+
+SvmlStream::SvmlStream(const std::string &filename, size_t chunk_size,
+                       const std::vector<size_t> &feature_ids,
+                       data::Dataset::Storage storage, size_t min_features,
+                       size_t queue_size)
+    : queue_size_(queue_size) {
+  reader_.set_feature_ids(feature_ids);
+  reader_.set_storage(storage);
+  producer_ = std::thread([this, filename, chunk_size, min_features]() {
+    reader_.read_chunks(filename, chunk_size,
+                        [this](std::unique_ptr<data::Dataset> chunk) {
+                          return push(std::move(chunk));
+                        },
+                        min_features);
+    std::lock_guard<std::mutex> lock(mutex_);
+    eof_ = true;
+    not_empty_.notify_all();
+  });
+}
+
+SvmlStream::~SvmlStream() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+  }
+  not_full_.notify_all();
+  producer_.join();
+}
+
+std::unique_ptr<data::Dataset> SvmlStream::next() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  not_empty_.wait(lock, [this] { return !chunks_.empty() || eof_; });
+  if (chunks_.empty())
+    return nullptr;
+  std::unique_ptr<data::Dataset> chunk = std::move(chunks_.front());
+  chunks_.pop_front();
+  not_full_.notify_one();
+  return chunk;
+}
+
+bool SvmlStream::push(std::unique_ptr<data::Dataset> chunk) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  not_full_.wait(lock, [this] {
+    return chunks_.size() < queue_size_ || closed_;
+  });
+  if (closed_)
+    return false;
+  chunks_.push_back(std::move(chunk));
+  not_empty_.notify_one();
+  return true;
+}
+
+}  // namespace io
+}  // namespace quickrank
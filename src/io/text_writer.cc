@@ -0,0 +1,109 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "io/text_writer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include <omp.h>
+
+namespace quickrank {
+namespace io {
+
+TextWriter::TextWriter(const std::string &filename, size_t batch_size)
+    : filename_(filename), batch_size_(batch_size) {
+  file_ = fopen(filename.c_str(), "w");
+  if (!file_) {
+    std::cerr << "!!! Error while opening file " << filename << "."
+              << std::endl;
+    exit(EXIT_FAILURE);
+  }
+}
+
+TextWriter::~TextWriter() {
+  wait_pending();
+  if (fclose(file_) != 0) {
+    std::cerr << "!!! Error while writing file " << filename_ << ": "
+              << strerror(errno) << std::endl;
+    exit(EXIT_FAILURE);
+  }
+}
+
+void TextWriter::write_lines(size_t num_lines, LineFormatter format) {
+  // the number of lines per batch is adjusted to the length of the lines
+  // formatted so far, starting from a few lines per thread
+  const size_t num_threads = omp_get_max_threads();
+  size_t batch_lines = 16 * num_threads;
+  size_t formatted_lines = 0;
+  size_t formatted_bytes = 0;
+
+  for (size_t begin = 0; begin < num_lines;) {
+    const size_t end = std::min(num_lines, begin + batch_lines);
+    if (lines_.size() < end - begin)
+      lines_.resize(end - begin);
+
+    size_t batch_bytes = 0;
+    #pragma omp parallel for schedule(dynamic, 16) reduction(+:batch_bytes)
+    for (size_t i = begin; i < end; ++i) {
+      std::string &line = lines_[i - begin];
+      line.clear();
+      format(i, line);
+      line.push_back('\n');
+      batch_bytes += line.size();
+    }
+
+    // the previous batch must be written before this one
+    wait_pending();
+    std::swap(lines_, pending_lines_);
+    num_pending_lines_ = end - begin;
+    write_thread_ = std::thread(&TextWriter::write_pending, this);
+
+    formatted_lines += end - begin;
+    formatted_bytes += batch_bytes;
+    batch_lines = std::max(num_threads,
+                           batch_size_ * formatted_lines
+                               / std::max<size_t>(formatted_bytes, 1));
+    begin = end;
+  }
+}
+
+void TextWriter::wait_pending() {
+  if (write_thread_.joinable())
+    write_thread_.join();
+}
+
+void TextWriter::write_pending() {
+  for (size_t i = 0; i < num_pending_lines_; ++i) {
+    const std::string &line = pending_lines_[i];
+    if (fwrite(line.data(), 1, line.size(), file_) != line.size()) {
+      std::cerr << "!!! Error while writing file " << filename_ << ": "
+                << strerror(errno) << std::endl;
+      exit(EXIT_FAILURE);
+    }
+  }
+}
+
+}  // namespace io
+}  // namespace quickrank
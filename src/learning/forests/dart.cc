@@ -106,6 +106,7 @@ void Dart::clear(size_t num_features) {
   LambdaMart::clear(num_features);
   if (scores_contribution_)
     delete[] scores_contribution_;
+  leaf_caches_.clear();
 
   // Reset pointers to internal data structures
   scores_contribution_ = NULL;
@@ -166,6 +167,10 @@ std::ostream &Dart::put(std::ostream &os) const {
   os << "# best on train = " << best_on_train << std::endl;
   os << "# keep dropout at random = " << random_keep << std::endl;
   os << "# keep dropout based on best = " << drop_on_best << std::endl;
+  os << "# leaf cache = " << leaf_cache_mb_ << " MB";
+  if (leaf_cache_spill_)
+    os << " (spilled to disk when full)";
+  os << std::endl;
   return os;
 }
 
@@ -183,6 +188,10 @@ void Dart::learn(std::shared_ptr<quickrank::data::Dataset> training_dataset,
   std::chrono::high_resolution_clock::time_point chrono_init_start =
       std::chrono::high_resolution_clock::now();
 
+  // dropped trees are re-scored on the features accessed in place
+  training_dataset = quickrank::data::Dataset::with_float_rows(
+      training_dataset);
+
   // create a copy of the training datasets and put it in vertical format
   std::shared_ptr<quickrank::data::VerticalDataset> vertical_training(
       new quickrank::data::VerticalDataset(training_dataset));
@@ -198,7 +207,10 @@ void Dart::learn(std::shared_ptr<quickrank::data::Dataset> training_dataset,
   init(vertical_training);
   memset(scores_on_training_, 0, vertical_training->num_instances());
 
+  validation_dataset = wait_validation(validation_dataset);
   if (validation_dataset) {
+    validation_dataset = quickrank::data::Dataset::with_float_rows(
+        validation_dataset);
     scores_on_validation_ = new Score[validation_dataset->num_instances()]();
     memset(scores_on_validation_, 0, validation_dataset->num_instances());
   }
@@ -386,7 +398,8 @@ void Dart::learn(std::shared_ptr<quickrank::data::Dataset> training_dataset,
                                               tree);
 
     // add this tree to the ensemble (our model)
-    ensemble_model_.push(tree->get_proot(), tree_weight, 0);
+    ensemble_model_.push(tree->get_proot(), tree->release_nodes(),
+                         tree_weight, 0);
 
     // Init the counter of the last added tree
     counts.push_back(0);
@@ -504,9 +517,12 @@ void Dart::learn(std::shared_ptr<quickrank::data::Dataset> training_dataset,
       std::cout << " *";
 
       // Removes trees with 0-weight from the ensemble
+      std::vector<double> weights = ensemble_model_.get_weights();
       ensemble_model_.filter_out_zero_weighted_trees();
-      // Removes also the contributions from the scores array
-      filter_out_zero_weighted_contributions(ensemble_model_.get_weights());
+      // Removes also the contributions from the scores array and the caches
+      filter_out_zero_weighted_contributions(weights);
+      for (auto &cache: leaf_caches_)
+        cache.second->filter_out_zero_weighted_trees(weights);
 
       // Update the best weights vector with remaining trees
       best_weights = ensemble_model_.get_weights();
@@ -594,11 +610,22 @@ void Dart::learn(std::shared_ptr<quickrank::data::Dataset> training_dataset,
               << best_metric_on_validation_ << std::endl;
   }
 
+  size_t cache_bytes = 0;
+  size_t spilled_bytes = 0;
+  for (auto &cache: leaf_caches_) {
+    cache_bytes += cache.second->memory_bytes();
+    spilled_bytes += cache.second->spilled_bytes();
+  }
+
   clear(vertical_training->num_features());
 
   std::cout << std::endl;
   std::cout << "#\t Training Time: " << std::setprecision(2) << train_time
             << " s." << std::endl;
+  if (leaf_cache_mb_)
+    std::cout << "#\t Leaf Cache: " << std::setprecision(1)
+              << cache_bytes / 1048576.0 << " MB in memory, "
+              << spilled_bytes / 1048576.0 << " MB on disk." << std::endl;
 }
 
 bool Dart::import_model_state(LTR_Algorithm &other) {
@@ -640,7 +667,15 @@ void Dart::update_modelscores(std::shared_ptr<data::Dataset> dataset,
   const size_t num_features = dataset->num_features();
   const double sign = add ? 1.0 : -1.0;
 
+  LeafCache *cache = leaf_cache(dataset.get());
   for (int t: trees_to_update) {
+    if (cache) {
+      cache->add_scores(t, ensemble_model_.getTree(t),
+                        sign * ensemble_model_.getWeight(t), d,
+                        dataset->num_instances(), num_features, offset,
+                        scores);
+      continue;
+    }
     #pragma omp parallel for
     for (size_t i = 0; i < dataset->num_instances(); ++i) {
       scores[i] += sign * ensemble_model_.getWeight(t) *
@@ -677,7 +712,14 @@ void Dart::update_modelscores(std::shared_ptr<data::VerticalDataset> dataset,
   const quickrank::Feature *d = dataset->at(0, 0);
   const size_t offset = dataset->num_instances();
   const double sign = add ? 1.0f : -1.0f;
+  LeafCache *cache = leaf_cache(dataset.get());
   for (int t: trees_to_update) {
+    if (cache) {
+      cache->add_scores(t, ensemble_model_.getTree(t),
+                        sign * ensemble_model_.getWeight(t), d,
+                        dataset->num_instances(), 1, offset, scores);
+      continue;
+    }
     #pragma omp parallel for
     for (size_t i = 0; i < dataset->num_instances(); ++i) {
       scores[i] += sign * ensemble_model_.getWeight(t) *
@@ -686,6 +728,15 @@ void Dart::update_modelscores(std::shared_ptr<data::VerticalDataset> dataset,
   }
 }
 
+LeafCache *Dart::leaf_cache(const void *dataset) {
+  if (leaf_cache_mb_ == 0)
+    return NULL;
+  std::unique_ptr<LeafCache> &cache = leaf_caches_[dataset];
+  if (!cache)
+    cache.reset(new LeafCache(leaf_cache_mb_ << 20, leaf_cache_spill_));
+  return cache.get();
+}
+
 void Dart::update_contribution_scores(std::shared_ptr<data::Dataset> dataset,
                                       std::shared_ptr<RegressionTree> tree,
                                       int new_index) {
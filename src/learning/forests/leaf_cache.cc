@@ -0,0 +1,170 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include <cstdlib>
+#include <iostream>
+
+#include "learning/forests/leaf_cache.h"
+
+namespace quickrank {
+namespace learning {
+namespace forests {
+
+LeafCache::~LeafCache() {
+  if (file_)
+    std::fclose(file_);
+}
+
+void LeafCache::add_scores(size_t t, const RTNode *root, double weight,
+                           const quickrank::Feature *d, size_t num_docs,
+                           size_t doc_offset, size_t fx_offset,
+                           quickrank::Score *scores) {
+  if (t >= entries_.size())
+    entries_.resize(t + 1);
+  Entry &entry = entries_[t];
+  if (entry.root != root) {
+    if (entry.file_offset < 0)
+      memory_bytes_ -= entry.leaves.size();
+    entry = Entry();
+    entry.root = root;
+    cache_leaves(entry, d, num_docs, doc_offset, fx_offset);
+  }
+
+  if (entry.width == 0) {
+    #pragma omp parallel for
+    for (size_t i = 0; i < num_docs; ++i)
+      scores[i] += weight * root->score_instance(d + i * doc_offset, fx_offset);
+    return;
+  }
+
+  const quickrank::Score *outputs = entry.outputs.data();
+  const uint8_t *leaves8 = leaves(entry, num_docs);
+  if (entry.width == 1) {
+    #pragma omp parallel for
+    for (size_t i = 0; i < num_docs; ++i)
+      scores[i] += weight * outputs[leaves8[i]];
+  } else {
+    const uint16_t *leaves16 = reinterpret_cast<const uint16_t *>(leaves8);
+    #pragma omp parallel for
+    for (size_t i = 0; i < num_docs; ++i)
+      scores[i] += weight * outputs[leaves16[i]];
+  }
+}
+
+void LeafCache::filter_out_zero_weighted_trees(
+    const std::vector<double> &weights) {
+  size_t idx_curr = 0;
+  for (size_t i = 0; i < entries_.size(); ++i) {
+    if (i < weights.size() && weights[i] != 0) {
+      if (idx_curr < i)
+        entries_[idx_curr] = std::move(entries_[i]);
+      ++idx_curr;
+    } else if (entries_[i].file_offset < 0) {
+      memory_bytes_ -= entries_[i].leaves.size();
+    }
+  }
+  entries_.resize(idx_curr);
+}
+
+int32_t LeafCache::flatten(const RTNode *node, std::vector<Node> &nodes,
+                           std::vector<quickrank::Score> &outputs) const {
+  if (node->is_leaf()) {
+    outputs.push_back(node->avglabel);
+    return ~(int32_t) (outputs.size() - 1);
+  }
+  const int32_t idx = (int32_t) nodes.size();
+  nodes.push_back({(uint32_t) node->get_feature_idx(), node->threshold, 0, 0});
+  const int32_t left = flatten(node->left, nodes, outputs);
+  const int32_t right = flatten(node->right, nodes, outputs);
+  nodes[idx].left = left;
+  nodes[idx].right = right;
+  return idx;
+}
+
+bool LeafCache::cache_leaves(Entry &entry, const quickrank::Feature *d,
+                             size_t num_docs, size_t doc_offset,
+                             size_t fx_offset) {
+  std::vector<Node> nodes;
+  const int32_t root = flatten(entry.root, nodes, entry.outputs);
+  const size_t width = entry.outputs.size() <= 256 ? 1 :
+                       entry.outputs.size() <= 65536 ? 2 : 0;
+  const size_t bytes = num_docs * width;
+  const bool in_memory = memory_bytes_ + bytes <= max_bytes_;
+  if (width == 0 || (!in_memory && !spill_)) {
+    entry.outputs.clear();
+    return false;
+  }
+
+  entry.leaves.resize(bytes);
+  uint8_t *leaves8 = entry.leaves.data();
+  uint16_t *leaves16 = reinterpret_cast<uint16_t *>(leaves8);
+  const Node *n = nodes.data();
+  #pragma omp parallel for
+  for (size_t i = 0; i < num_docs; ++i) {
+    const quickrank::Feature *v = d + i * doc_offset;
+    int32_t node = root;
+    while (node >= 0)
+      node = v[n[node].feature * fx_offset] <= n[node].threshold ?
+             n[node].left : n[node].right;
+    if (width == 1)
+      leaves8[i] = (uint8_t) ~node;
+    else
+      leaves16[i] = (uint16_t) ~node;
+  }
+  entry.width = width;
+
+  if (in_memory) {
+    memory_bytes_ += bytes;
+    return true;
+  }
+
+  if (!file_)
+    file_ = std::tmpfile();
+  if (!file_ || std::fseek(file_, 0, SEEK_END)
+      || (entry.file_offset = std::ftell(file_)) < 0
+      || std::fwrite(leaves8, 1, bytes, file_) != bytes) {
+    std::cerr << "!!! Error while spilling the leaf cache to disk."
+              << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  spilled_bytes_ += bytes;
+  std::vector<uint8_t>().swap(entry.leaves);
+  return true;
+}
+
+const uint8_t *LeafCache::leaves(const Entry &entry, size_t num_docs) {
+  if (entry.file_offset < 0)
+    return entry.leaves.data();
+
+  const size_t bytes = num_docs * entry.width;
+  buffer_.resize(bytes);
+  if (std::fseek(file_, entry.file_offset, SEEK_SET)
+      || std::fread(buffer_.data(), 1, bytes, file_) != bytes) {
+    std::cerr << "!!! Error while reading the leaf cache from disk."
+              << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  return buffer_.data();
+}
+
+}  // namespace forests
+}  // namespace learning
+}  // namespace quickrank
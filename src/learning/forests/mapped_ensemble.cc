@@ -0,0 +1,362 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "learning/forests/mapped_ensemble.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace quickrank {
+namespace learning {
+namespace forests {
+
+namespace {
+
+const char MAGIC[8] = {'Q', 'R', 'B', 'I', 'N', 'M', 'D', '1'};
+
+struct Header {
+  char magic[8];
+  uint64_t num_trees;
+  uint64_t num_nodes;
+  uint64_t num_leaves;
+  uint64_t num_features;
+  uint64_t info_size;
+};
+
+size_t padded(size_t bytes) {
+  return (bytes + 7) & ~(size_t) 7;
+}
+
+// size of the file of a model, the sections being 8-bytes aligned
+size_t model_size(const Header &header) {
+  return sizeof(Header) + padded(header.info_size)
+      + header.num_trees * sizeof(double)
+      + padded(header.num_trees * sizeof(uint32_t))
+      + header.num_nodes * sizeof(MappedEnsemble::Node)
+      + header.num_leaves * sizeof(double);
+}
+
+// flattens a XML subtree in pre-order and returns the reference to its root
+uint32_t flatten_split(const pugi::xml_node &split_xml,
+                       std::vector<MappedEnsemble::Node> &nodes,
+                       std::vector<double> &leaves) {
+  pugi::xml_node output = split_xml.child("output");
+  if (output) {
+    leaves.push_back(output.text().as_double());
+    return (uint32_t) (leaves.size() - 1) | MappedEnsemble::LEAF;
+  }
+
+  pugi::xml_node left, right;
+  for (const pugi::xml_node &child: split_xml.children("split")) {
+    if (std::string(child.attribute("pos").value()) == "left")
+      left = child;
+    else
+      right = child;
+  }
+  if (!left || !right || !split_xml.child("feature")
+      || split_xml.child("feature").text().as_uint() == 0) {
+    std::cerr << "!!! Unable to parse tree from XML model." << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  size_t index = nodes.size();
+  MappedEnsemble::Node node;
+  node.feature = split_xml.child("feature").text().as_uint() - 1;
+  node.threshold = split_xml.child("threshold").text().as_float();
+  nodes.push_back(node);
+  uint32_t left_ref = flatten_split(left, nodes, leaves);
+  uint32_t right_ref = flatten_split(right, nodes, leaves);
+  nodes[index].left = left_ref;
+  nodes[index].right = right_ref;
+  return (uint32_t) index;
+}
+
+void write_or_die(const void *data, size_t size, FILE *f,
+                  const std::string &file) {
+  static const char zeros[8] = {0};
+  if (fwrite(data, 1, size, f) != size
+      || fwrite(zeros, 1, padded(size) - size, f) != padded(size) - size) {
+    std::cerr << "!!! Error while writing file " << file << ": "
+              << strerror(errno) << std::endl;
+    exit(EXIT_FAILURE);
+  }
+}
+
+}  // namespace
+
+MappedEnsemble::MappedEnsemble(const std::string &model_filename)
+    : filename_(model_filename) {
+  int fd = open(model_filename.c_str(), O_RDONLY);
+  struct stat st;
+  if (fd == -1 || fstat(fd, &st) == -1) {
+    std::cerr << "!!! Impossible to open model file " << model_filename
+              << ": " << strerror(errno) << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  // the model is read-only and shared: pages are loaded on demand, and they
+  // are in common with any other process mapping the same file
+  mapping_size_ = st.st_size;
+  if (mapping_size_ >= sizeof(Header))
+    mapping_ = mmap(NULL, mapping_size_, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapping_ == MAP_FAILED || mapping_ == nullptr) {
+    std::cerr << "!!! Impossible to map model file " << model_filename
+              << ": " << (mapping_ ? strerror(errno) : "file too short")
+              << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  // counts larger than the file would overflow the size of the model
+  const Header &header = *(const Header *) mapping_;
+  if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0
+      || header.num_trees > mapping_size_ || header.info_size > mapping_size_
+      || header.num_nodes >= LEAF || header.num_leaves >= LEAF
+      || model_size(header) != mapping_size_) {
+    std::cerr << "!!! Model " << model_filename
+              << " is not a valid binary model." << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  num_trees_ = header.num_trees;
+  num_nodes_ = header.num_nodes;
+  num_leaves_ = header.num_leaves;
+  num_features_ = header.num_features;
+  info_size_ = header.info_size;
+
+  const char *section = (const char *) mapping_ + sizeof(Header);
+  info_ = section;
+  section += padded(info_size_);
+  weights_ = (const double *) section;
+  section += num_trees_ * sizeof(double);
+  roots_ = (const uint32_t *) section;
+  section += padded(num_trees_ * sizeof(uint32_t));
+  nodes_ = (const Node *) section;
+  section += num_nodes_ * sizeof(Node);
+  leaves_ = (const double *) section;
+
+  // references must fall within the nodes and the leaves, and children
+  // follow their parent (pre-order), so that every visit ends in a leaf;
+  // the features of the splits are those of the header
+  auto valid_reference = [this](uint32_t ref, size_t first_node) {
+    return ref & LEAF ? (ref & ~LEAF) < num_leaves_
+                      : ref >= first_node && ref < num_nodes_;
+  };
+  bool valid = true;
+  size_t split_features = 0;
+  for (size_t t = 0; t < num_trees_ && valid; ++t)
+    valid = valid_reference(roots_[t], 0);
+  for (size_t n = 0; n < num_nodes_ && valid; ++n) {
+    valid = valid_reference(nodes_[n].left, n + 1)
+        && valid_reference(nodes_[n].right, n + 1);
+    split_features = std::max(split_features,
+                              (size_t) nodes_[n].feature + 1);
+  }
+  if (!valid || split_features != num_features_) {
+    std::cerr << "!!! Model " << model_filename
+              << " has invalid trees." << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  pugi::xml_document info;
+  info.load_buffer(info_, info_size_);
+  type_ = info.child("info").child("type").child_value();
+}
+
+MappedEnsemble::~MappedEnsemble() {
+  if (mapping_)
+    munmap(mapping_, mapping_size_);
+}
+
+void MappedEnsemble::learn(std::shared_ptr<data::Dataset> training_dataset,
+                           std::shared_ptr<data::Dataset> validation_dataset,
+                           std::shared_ptr<metric::ir::Metric> training_metric,
+                           size_t partial_save,
+                           const std::string model_filename) {
+  std::cerr << "!!! Binary models can not be trained: convert " << filename_
+            << " to XML first." << std::endl;
+  exit(EXIT_FAILURE);
+}
+
+std::shared_ptr<std::vector<Score>> MappedEnsemble::partial_scores_document(
+    const Feature *d, bool ignore_weights) const {
+  std::vector<Score> scores(num_trees_);
+  for (size_t t = 0; t < num_trees_; ++t) {
+    scores[t] = leaves_[leaf_index(t, d)];
+    if (!ignore_weights)
+      scores[t] *= weights_[t];
+  }
+  return std::make_shared<std::vector<Score>>(std::move(scores));
+}
+
+void MappedEnsemble::append_xml_split(pugi::xml_node parent, uint32_t ref,
+                                      const std::string &pos) const {
+  std::stringstream ss;
+
+  pugi::xml_node split = parent.append_child("split");
+
+  if (!pos.empty())
+    split.append_attribute("pos") = pos.c_str();
+
+  if (ref & LEAF) {
+
+    ss << std::setprecision(std::numeric_limits<double>::max_digits10);
+    ss << leaves_[ref & ~LEAF];
+    split.append_child("output").text() = ss.str().c_str();
+
+  } else {
+
+    const Node &node = nodes_[ref];
+    split.append_child("feature").text() = (size_t) node.feature + 1;
+
+    ss << std::setprecision(std::numeric_limits<float>::max_digits10);
+    ss << node.threshold;
+    split.append_child("threshold").text() = ss.str().c_str();
+
+    append_xml_split(split, node.left, "left");
+    append_xml_split(split, node.right, "right");
+  }
+}
+
+pugi::xml_document *MappedEnsemble::get_xml_model() const {
+
+  pugi::xml_document *doc = new pugi::xml_document();
+  pugi::xml_node root = doc->append_child("ranker");
+
+  pugi::xml_document info;
+  info.load_buffer(info_, info_size_);
+  for (const pugi::xml_node &child: info.children())
+    root.append_copy(child);
+
+  pugi::xml_node ensemble = root.append_child("ensemble");
+  for (size_t t = 0; t < num_trees_; ++t) {
+    pugi::xml_node tree = ensemble.append_child("tree");
+    tree.append_attribute("id") = t + 1;
+    tree.append_attribute("weight") = weights_[t];
+    append_xml_split(tree, roots_[t], "");
+  }
+
+  return doc;
+}
+
+bool MappedEnsemble::is_binary(const std::string &file) {
+  char magic[sizeof(MAGIC)];
+  FILE *f = fopen(file.c_str(), "rb");
+  if (!f)
+    return false;
+  bool binary = fread(magic, 1, sizeof(magic), f) == sizeof(magic)
+      && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+  fclose(f);
+  return binary;
+}
+
+void MappedEnsemble::write(const pugi::xml_document &model,
+                           const std::string &file) {
+  pugi::xml_node ranker = model.child("ranker");
+  pugi::xml_node ensemble = ranker.child("ensemble");
+  if (!ensemble) {
+    std::cerr << "!!! Only tree ensembles can be converted to binary models."
+              << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  // everything but the ensemble is kept as XML
+  pugi::xml_document info;
+  for (const pugi::xml_node &child: ranker.children())
+    if (child != ensemble)
+      info.append_copy(child);
+  std::ostringstream info_xml;
+  info.save(info_xml, "\t", pugi::format_default | pugi::format_no_declaration);
+  const std::string info_str = info_xml.str();
+
+  std::vector<double> weights;
+  std::vector<uint32_t> roots;
+  std::vector<Node> nodes;
+  std::vector<double> leaves;
+  for (const pugi::xml_node &tree: ensemble.children()) {
+    if (std::string(tree.name()) != "tree" || !tree.child("split")) {
+      std::cerr << "!!! Only tree ensembles can be converted to binary "
+          "models." << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    weights.push_back(tree.attribute("weight").as_double());
+    roots.push_back(flatten_split(tree.child("split"), nodes, leaves));
+    if (nodes.size() >= LEAF || leaves.size() >= LEAF) {
+      std::cerr << "!!! The model is too large for a binary model."
+                << std::endl;
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  Header header;
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.num_trees = weights.size();
+  header.num_nodes = nodes.size();
+  header.num_leaves = leaves.size();
+  header.num_features = 0;
+  for (const Node &node: nodes)
+    header.num_features = std::max(header.num_features,
+                                   (uint64_t) node.feature + 1);
+  header.info_size = info_str.size();
+
+  FILE *f = fopen(file.c_str(), "wb");
+  if (!f) {
+    std::cerr << "!!! Impossible to write file " << file << ": "
+              << strerror(errno) << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  write_or_die(&header, sizeof(header), f, file);
+  write_or_die(info_str.data(), info_str.size(), f, file);
+  write_or_die(weights.data(), weights.size() * sizeof(double), f, file);
+  write_or_die(roots.data(), roots.size() * sizeof(uint32_t), f, file);
+  write_or_die(nodes.data(), nodes.size() * sizeof(Node), f, file);
+  write_or_die(leaves.data(), leaves.size() * sizeof(double), f, file);
+  if (fclose(f) != 0) {
+    std::cerr << "!!! Error while writing file " << file << ": "
+              << strerror(errno) << std::endl;
+    exit(EXIT_FAILURE);
+  }
+}
+
+std::ostream &MappedEnsemble::put(std::ostream &os) const {
+  os << "# Ranker: " << name() << " (binary model)" << std::endl
+     << "# no. of trees = " << num_trees_ << std::endl
+     << "# no. of internal nodes = " << num_nodes_ << std::endl
+     << "# no. of leaves = " << num_leaves_ << std::endl
+     << "# no. of features = " << num_features_ << std::endl;
+  return os;
+}
+
+}  // namespace forests
+}  // namespace learning
+}  // namespace quickrank
@@ -21,6 +21,7 @@
  */
 #include "learning/forests/mart.h"
 
+#include <algorithm>
 #include <fstream>
 #include <iomanip>
 #include <chrono>
@@ -70,21 +71,31 @@ Mart::Mart(const pugi::xml_document &model) {
   // read ensemble
   ensemble_model_.set_capacity(ntrees_);
 
-  // loop over trees
-  for (const auto &tree: model_tree.children()) {
-    RTNode *root = NULL;
-    double tree_weight = tree.attribute("weight").as_double();
-
-    const auto &root_split = tree.child("split");
-    if (root_split)
-      root = RTNode::parse_xml(root_split);
+  // trees are parsed in parallel from the (read-only) XML document, and
+  // they are added to the ensemble in order
+  std::vector<pugi::xml_node> trees;
+  for (const auto &tree: model_tree.children())
+    trees.push_back(tree);
+  std::vector<RTNode *> roots(trees.size(), NULL);
+  std::vector<std::unique_ptr<RTNodeArena>> nodes(trees.size());
+  #pragma omp parallel for schedule(dynamic, 16)
+  for (size_t i = 0; i < trees.size(); ++i) {
+    const auto &root_split = trees[i].child("split");
+    if (root_split) {
+      // the nodes of a tree are allocated at once
+      nodes[i].reset(new RTNodeArena(RTNode::count_xml_nodes(root_split)));
+      roots[i] = RTNode::parse_xml(root_split, *nodes[i]);
+    }
+  }
 
-    if (root == NULL) {
+  for (size_t i = 0; i < trees.size(); ++i) {
+    if (roots[i] == NULL) {
       std::cerr << "!!! Unable to parse tree from XML model." << std::endl;
       exit(EXIT_FAILURE);
     }
 
-    ensemble_model_.push(root, tree_weight, -1);
+    double tree_weight = trees[i].attribute("weight").as_double();
+    ensemble_model_.push(roots[i], std::move(nodes[i]), tree_weight, -1);
   }
 }
 
@@ -111,6 +122,9 @@ std::ostream &Mart::put(std::ostream &os) const {
   if (valid_iterations_)
     os << "# no. of no gain rounds before early stop = " << valid_iterations_
        << std::endl;
+  if (!out_of_core_directory_.empty())
+    os << "# out-of-core directory = " << out_of_core_directory_
+       << " (shard size = " << shard_size_ << ")" << std::endl;
   return os;
 }
 
@@ -120,6 +134,11 @@ void Mart::init(
   const size_t nentries = training_dataset->num_instances();
   scores_on_training_ = new double[nentries]();  //0.0f initialized
   pseudoresponses_ = new double[nentries]();  //0.0f initialized
+
+  // out-of-core and sparse training have already discretized the features
+  if (store_)
+    return;
+
   const size_t nfeatures = training_dataset->num_features();
   sortedsid_ = new size_t * [nfeatures];
   sortedsize_ = nentries;
@@ -137,36 +156,8 @@ void Mart::init(
   for (size_t i = 0; i < nfeatures; ++i) {
     //select feature array related to the current feature index
     float const *features = training_dataset->at(0, i);  // ->get_fvector(i);
-    //init with values with the 1st sample
-    size_t *idx = sortedsid_[i];
-    //get_ sample indexes sorted by the fid-th feature
-    size_t uniqs_size = 0;
-    float *uniqs = (float *) malloc(sizeof(float) *
-        (nthresholds_ == 0 ? sortedsize_ + 1 : nthresholds_ + 1));
-    //skip samples with the same feature value. early stop for if nthresholds!=size_max
-    uniqs[uniqs_size++] = features[idx[0]];
-    for (size_t j = 1; j < sortedsize_ && (nthresholds_ == 0 || uniqs_size != nthresholds_ + 1); ++j) {
-      const float fval = features[idx[j]];
-      if (uniqs[uniqs_size - 1] < fval)
-        uniqs[uniqs_size++] = fval;
-    }
-
-    //define thresholds
-    if (uniqs_size <= nthresholds_ || nthresholds_ == 0) {
-      uniqs[uniqs_size++] = FLT_MAX;
-      thresholds_size_[i] = uniqs_size;
-      thresholds_[i] =(float *) realloc(uniqs, sizeof(float) * uniqs_size);
-    } else {
-      free(uniqs);
-      thresholds_size_[i] = nthresholds_ + 1;
-      thresholds_[i] = (float *) malloc(sizeof(float) * (nthresholds_ + 1));
-      float t = features[idx[0]];  //equals fmin
-      const float step =
-          (float) fabs(features[idx[sortedsize_ - 1]] - t) / nthresholds_;  //(fmax-fmin)/nthresholds
-      for (size_t j = 0; j != nthresholds_; t += step)
-        thresholds_[i][j++] = t;
-      thresholds_[i][nthresholds_] = FLT_MAX;
-    }
+    compute_thresholds(features, sortedsid_[i], sortedsize_,
+                       thresholds_[i], thresholds_size_[i]);
   }
 
   // here, pseudo responses is empty !
@@ -175,6 +166,116 @@ void Mart::init(
                               thresholds_, thresholds_size_);
 }
 
+void Mart::init_out_of_core(
+    std::shared_ptr<quickrank::data::Dataset> training_dataset) {
+
+  const size_t nentries = training_dataset->num_instances();
+  const size_t nfeatures = training_dataset->num_features();
+  thresholds_ = new float *[nfeatures];
+  thresholds_size_ = new size_t[nfeatures];
+
+  // features are sorted one at a time: no vertical copy nor sorted index
+  // arrays are kept in memory
+  #pragma omp parallel for
+  for (size_t i = 0; i < nfeatures; ++i) {
+    float *features = new float[nentries];
+    for (size_t j = 0; j < nentries; ++j)
+      features[j] = training_dataset->value(j, i);
+    std::unique_ptr<size_t[]> idx = idx_radixsort(features, nentries);
+    compute_thresholds(features, idx.get(), nentries,
+                       thresholds_[i], thresholds_size_[i]);
+    // thresholds of 16 bits features hold for their float originals too
+    for (size_t t = 0; t + 1 < thresholds_size_[i]; ++t)
+      thresholds_[i][t] = training_dataset->split_threshold(thresholds_[i][t]);
+    delete[] features;
+  }
+
+  // without an out-of-core directory, the store is a single in-memory shard
+  store_ = std::make_shared<quickrank::data::BinnedColumnStore>(
+      out_of_core_directory_, training_dataset,
+      out_of_core_directory_.empty() ? nentries : shard_size_,
+      thresholds_, thresholds_size_);
+
+  hist_ = new RTRootHistogram(store_.get(), thresholds_, thresholds_size_);
+}
+
+void Mart::init_sparse(
+    std::shared_ptr<quickrank::data::Dataset> training_dataset) {
+
+  const size_t nentries = training_dataset->num_instances();
+  const size_t nfeatures = training_dataset->num_features();
+  thresholds_ = new float *[nfeatures];
+  thresholds_size_ = new size_t[nfeatures];
+
+  std::shared_ptr<quickrank::data::SparseBinnedFeatures> sparse =
+      std::make_shared<quickrank::data::SparseBinnedFeatures>(
+          training_dataset);
+
+  // thresholds are computed on the non-zero values, plus a single zero if
+  // the feature is not dense
+  #pragma omp parallel for schedule(dynamic, 64)
+  for (size_t i = 0; i < nfeatures; ++i) {
+    const size_t nnz = sparse->column_size(i);
+    const size_t nvalues = nnz < nentries ? nnz + 1 : nnz;
+    float *features = new float[nvalues];
+    std::copy(sparse->column_values(i), sparse->column_values(i) + nnz,
+              features);
+    if (nvalues > nnz)
+      features[nnz] = 0.0f;
+    std::unique_ptr<size_t[]> idx = idx_radixsort(features, nvalues);
+    compute_thresholds(features, idx.get(), nvalues,
+                       thresholds_[i], thresholds_size_[i]);
+    delete[] features;
+  }
+
+  sparse->discretize(thresholds_, thresholds_size_);
+  store_ = sparse;
+
+  hist_ = new RTRootHistogram(store_.get(), thresholds_, thresholds_size_);
+}
+
+std::shared_ptr<data::Dataset> Mart::wait_validation(
+    std::shared_ptr<data::Dataset> validation_dataset) {
+  if (!validation_dataset && pending_validation_.valid()) {
+    validation_dataset = pending_validation_.get();
+    pending_validation_ = {};
+  }
+  return validation_dataset;
+}
+
+void Mart::compute_thresholds(const Feature *features, const size_t *idx,
+                              size_t nentries, float *&thresholds,
+                              size_t &thresholds_size) const {
+  //get_ sample indexes sorted by the fid-th feature
+  size_t uniqs_size = 0;
+  float *uniqs = (float *) malloc(sizeof(float) *
+      (nthresholds_ == 0 ? nentries + 1 : nthresholds_ + 1));
+  //skip samples with the same feature value. early stop for if nthresholds!=size_max
+  uniqs[uniqs_size++] = features[idx[0]];
+  for (size_t j = 1; j < nentries && (nthresholds_ == 0 || uniqs_size != nthresholds_ + 1); ++j) {
+    const float fval = features[idx[j]];
+    if (uniqs[uniqs_size - 1] < fval)
+      uniqs[uniqs_size++] = fval;
+  }
+
+  //define thresholds
+  if (uniqs_size <= nthresholds_ || nthresholds_ == 0) {
+    uniqs[uniqs_size++] = FLT_MAX;
+    thresholds_size = uniqs_size;
+    thresholds = (float *) realloc(uniqs, sizeof(float) * uniqs_size);
+  } else {
+    free(uniqs);
+    thresholds_size = nthresholds_ + 1;
+    thresholds = (float *) malloc(sizeof(float) * (nthresholds_ + 1));
+    float t = features[idx[0]];  //equals fmin
+    const float step =
+        (float) fabs(features[idx[nentries - 1]] - t) / nthresholds_;  //(fmax-fmin)/nthresholds
+    for (size_t j = 0; j != nthresholds_; t += step)
+      thresholds[j++] = t;
+    thresholds[nthresholds_] = FLT_MAX;
+  }
+}
+
 void Mart::clear(size_t num_features) {
   if (scores_on_training_)
     delete[] scores_on_training_;
@@ -184,14 +285,17 @@ void Mart::clear(size_t num_features) {
     delete[] pseudoresponses_;
   if (hist_)
     delete hist_;
+  store_.reset();
   if (thresholds_size_)
     delete[] thresholds_size_;
   if (sortedsid_) {
-    for (size_t i = 0; i < num_features; ++i) {
+    for (size_t i = 0; i < num_features; ++i)
       delete[] sortedsid_[i];
-      free(thresholds_[i]);
-    }
     delete[] sortedsid_;
+  }
+  if (thresholds_) {
+    for (size_t i = 0; i < num_features; ++i)
+      free(thresholds_[i]);
     delete[] thresholds_;
   }
 
@@ -205,10 +309,10 @@ void Mart::clear(size_t num_features) {
   hist_ = NULL;
 }
 
-void Mart::learn(std::shared_ptr<quickrank::data::Dataset> training_dataset,
-                 std::shared_ptr<quickrank::data::Dataset> validation_dataset,
-                 std::shared_ptr<quickrank::metric::ir::Metric> scorer,
-                 size_t partial_save, const std::string output_basename) {
+std::shared_ptr<quickrank::data::VerticalDataset> Mart::init_learning(
+    std::shared_ptr<quickrank::data::Dataset> training_dataset,
+    std::shared_ptr<quickrank::data::Dataset> &validation_dataset,
+    quickrank::metric::ir::Metric *scorer) {
   // ---------- Initialization ----------
   std::cout << "# Initialization";
   std::cout.flush();
@@ -217,8 +321,14 @@ void Mart::learn(std::shared_ptr<quickrank::data::Dataset> training_dataset,
       std::chrono::high_resolution_clock::now();
 
   // create a copy of the training datasets and put it in vertical format
+  // (out-of-core, sparse and 16 bits training only need labels, features
+  // are binned; column-major features are used in place)
+  const bool out_of_core = !out_of_core_directory_.empty();
+  const bool sparse = training_dataset->is_sparse();
+  const bool binned = out_of_core || !(training_dataset->has_float_features()
+      || training_dataset->is_column_major());
   std::shared_ptr<quickrank::data::VerticalDataset> vertical_training(
-      new quickrank::data::VerticalDataset(training_dataset));
+      new quickrank::data::VerticalDataset(training_dataset, !binned));
 
   best_metric_on_validation_ = std::numeric_limits<double>::lowest();
   best_metric_on_training_ = std::numeric_limits<double>::lowest();
@@ -226,8 +336,14 @@ void Mart::learn(std::shared_ptr<quickrank::data::Dataset> training_dataset,
 
   ensemble_model_.set_capacity(ntrees_);
 
+  if (sparse && !out_of_core)
+    init_sparse(training_dataset);
+  else if (binned)
+    init_out_of_core(training_dataset);
+
   init(vertical_training);
 
+  validation_dataset = wait_validation(validation_dataset);
   if (validation_dataset) {
     scores_on_validation_ = new Score[validation_dataset->num_instances()]();
   }
@@ -252,10 +368,20 @@ void Mart::learn(std::shared_ptr<quickrank::data::Dataset> training_dataset,
     }
   }
 
+  // binned training only needs the labels and queries from now on
+  size_t released_bytes = 0;
+  if (store_ && release_training_features_)
+    released_bytes = training_dataset->release_features();
+
   auto chrono_init_end = std::chrono::high_resolution_clock::now();
   double init_time = std::chrono::duration_cast<std::chrono::duration<double>>(
       chrono_init_end - chrono_init_start).count();
   std::cout << ": " << std::setprecision(2) << init_time << " s." << std::endl;
+  if (store_)
+    std::cout << *store_;
+  if (released_bytes)
+    std::cout << "#\t Training features released: " << std::setprecision(2)
+              << released_bytes / 1024.0 / 1024.0 << " MB" << std::endl;
 
   // ---------- Training ----------
   std::cout << std::fixed << std::setprecision(4);
@@ -276,7 +402,124 @@ void Mart::learn(std::shared_ptr<quickrank::data::Dataset> training_dataset,
     std::cout << " *" << std::endl;
   }
 
+  return vertical_training;
+}
+
+bool Mart::stop_early(size_t m, bool validation) const {
+  return validation && valid_iterations_
+      && m > best_model_ + valid_iterations_;
+}
+
+void Mart::add_tree(
+    RegressionTree *tree, size_t m,
+    std::shared_ptr<quickrank::data::VerticalDataset> training_dataset,
+    std::shared_ptr<quickrank::data::Dataset> validation_dataset,
+    quickrank::metric::ir::Metric *scorer,
+    size_t partial_save, const std::string &output_basename) {
+  //add this tree to the ensemble (our model)
+  ensemble_model_.push(tree->get_proot(), tree->release_nodes(),
+                       shrinkage_, 0);  // maxlabel);
+
+  //Update the model's outputs on all training samples
+  if (store_)
+    update_modelscores(store_, scores_on_training_, tree);
+  else
+    update_modelscores(training_dataset, scores_on_training_, tree);
+  // run metric
+  quickrank::MetricScore metric_on_training = scorer->evaluate_dataset(
+      training_dataset, scores_on_training_);
+
+  //show results
+  std::cout << std::setw(7) << m + 1 << std::setw(9) << metric_on_training;
+
+  //Evaluate the current model on the validation data (if available)
+  if (validation_dataset) {
+    // update validation scores
+    update_modelscores(validation_dataset, scores_on_validation_, tree);
+
+    // run metric
+    quickrank::MetricScore metric_on_validation = scorer->evaluate_dataset(
+        validation_dataset, scores_on_validation_);
+    std::cout << std::setw(9) << metric_on_validation;
+
+    if (metric_on_validation > best_metric_on_validation_) {
+      best_metric_on_training_ = metric_on_training;
+      best_metric_on_validation_ = metric_on_validation;
+      best_model_ = ensemble_model_.get_size() - 1;
+      std::cout << " *";
+    }
+  } else {
+    if (metric_on_training > best_metric_on_training_) {
+      best_metric_on_training_ = metric_on_training;
+      best_model_ = ensemble_model_.get_size() - 1;
+      std::cout << " *";
+    }
+  }
+  std::cout << std::endl;
+
+  if (partial_save != 0 and !output_basename.empty()
+      and (m + 1) % partial_save == 0) {
+    save(output_basename, m + 1);
+  }
+}
+
+void Mart::finish_learning(
+    std::shared_ptr<quickrank::data::Dataset> training_dataset,
+    bool validation, quickrank::metric::ir::Metric *scorer,
+    std::chrono::high_resolution_clock::time_point chrono_train_start,
+    size_t ntrees_start, size_t nsamples_per_tree,
+    const std::string &details) {
+  const size_t ntrees_learnt = ensemble_model_.get_size();
+
+  //Rollback to the best model observed on the validation data
+  if (validation) {
+    while (ensemble_model_.is_notempty()
+        && ensemble_model_.get_size() > best_model_ + 1) {
+      ensemble_model_.pop();
+    }
+  }
+
+  auto chrono_train_end = std::chrono::high_resolution_clock::now();
+  double train_time = std::chrono::duration_cast<std::chrono::duration<double>>(
+      chrono_train_end - chrono_train_start).count();
+  // number of instances processed by the histogram construction
+  double train_throughput = (double) nsamples_per_tree
+      * (ntrees_learnt - ntrees_start) / train_time;
+
+  //Finishing up
+  std::cout << std::endl;
+  std::cout << *scorer << " on training data = " << best_metric_on_training_
+            << std::endl;
+
+  if (validation) {
+    std::cout << *scorer << " on validation data = "
+              << best_metric_on_validation_ << std::endl;
+  }
+
+  clear(training_dataset->num_features());
+
+  std::cout << std::endl;
+  std::cout << "#\t Training Time: " << std::setprecision(2) << train_time
+            << " s." << std::endl;
+  std::cout << "#\t Training Throughput: " << train_throughput / 1e6
+            << " M instances x trees / s ("
+            << (!out_of_core_directory_.empty() ? "out-of-core"
+                : training_dataset->has_float_features() ? "in-memory"
+                : quickrank::data::Dataset::storage_name(
+                    training_dataset->storage()))
+            << details << ")"
+            << std::endl;
+}
+
+void Mart::learn(std::shared_ptr<quickrank::data::Dataset> training_dataset,
+                 std::shared_ptr<quickrank::data::Dataset> validation_dataset,
+                 std::shared_ptr<quickrank::metric::ir::Metric> scorer,
+                 size_t partial_save, const std::string output_basename) {
+  std::shared_ptr<quickrank::data::VerticalDataset> vertical_training =
+      init_learning(training_dataset, validation_dataset, scorer.get());
+
   auto chrono_train_start = std::chrono::high_resolution_clock::now();
+  const size_t ntrees_start = ensemble_model_.get_size();
 
   // Used for document sampling and node splitting
   size_t nsampleids = training_dataset->num_instances();
@@ -305,8 +548,7 @@ void Mart::learn(std::shared_ptr<quickrank::data::Dataset> training_dataset,
 
   // start iterations from 0 or (ensemble_size - 1)
   for (size_t m = ensemble_model_.get_size(); m < ntrees_; ++m) {
-    if (validation_dataset
-        && (valid_iterations_ && m > best_model_ + valid_iterations_))
+    if (stop_early(m, validation_dataset != nullptr))
       break;
 
     if (subsample_ != 1.0f) {
@@ -317,6 +559,10 @@ void Mart::learn(std::shared_ptr<quickrank::data::Dataset> training_dataset,
       std::shuffle(&sampleids[0],
                    &sampleids[nsampleids],
                    rng);
+
+      // binned features are visited in order of sample id
+      if (store_)
+        std::sort(&sampleids[0], &sampleids[nsampleids_iter]);
     }
 
     // If we are training on a sample of the full dataset, we need to update
@@ -338,81 +584,17 @@ void Mart::learn(std::shared_ptr<quickrank::data::Dataset> training_dataset,
     std::unique_ptr<RegressionTree> tree =
         fit_regressor_on_gradient(vertical_training, sampleids);
 
-    //add this tree to the ensemble (our model)
-    ensemble_model_.push(tree->get_proot(), shrinkage_, 0);  // maxlabel);
-
-    //Update the model's outputs on all training samples
-    update_modelscores(vertical_training, scores_on_training_, tree.get());
-    // run metric
-    quickrank::MetricScore metric_on_training = scorer->evaluate_dataset(
-        vertical_training, scores_on_training_);
-
-    //show results
-    std::cout << std::setw(7) << m + 1 << std::setw(9) << metric_on_training;
-
-    //Evaluate the current model on the validation data (if available)
-    if (validation_dataset) {
-      // update validation scores
-      update_modelscores(validation_dataset, scores_on_validation_, tree.get());
-
-      // run metric
-      quickrank::MetricScore metric_on_validation = scorer->evaluate_dataset(
-          validation_dataset, scores_on_validation_);
-      std::cout << std::setw(9) << metric_on_validation;
-
-      if (metric_on_validation > best_metric_on_validation_) {
-        best_metric_on_training_ = metric_on_training;
-        best_metric_on_validation_ = metric_on_validation;
-        best_model_ = ensemble_model_.get_size() - 1;
-        std::cout << " *";
-      }
-    } else {
-      if (metric_on_training > best_metric_on_training_) {
-        best_metric_on_training_ = metric_on_training;
-        best_model_ = ensemble_model_.get_size() - 1;
-        std::cout << " *";
-      }
-    }
-    std::cout << std::endl;
-
-    if (partial_save != 0 and !output_basename.empty()
-        and (m + 1) % partial_save == 0) {
-      save(output_basename, m + 1);
-    }
-
+    add_tree(tree.get(), m, vertical_training, validation_dataset,
+             scorer.get(), partial_save, output_basename);
   }
 
   delete(sampleids);
   if (sample_presence)
     delete[] sample_presence;
 
-  //Rollback to the best model observed on the validation data
-  if (validation_dataset) {
-    while (ensemble_model_.is_notempty()
-        && ensemble_model_.get_size() > best_model_ + 1) {
-      ensemble_model_.pop();
-    }
-  }
-
-  auto chrono_train_end = std::chrono::high_resolution_clock::now();
-  double train_time = std::chrono::duration_cast<std::chrono::duration<double>>(
-      chrono_train_end - chrono_train_start).count();
-
-  //Finishing up
-  std::cout << std::endl;
-  std::cout << *scorer << " on training data = " << best_metric_on_training_
-            << std::endl;
-
-  if (validation_dataset) {
-    std::cout << *scorer << " on validation data = "
-              << best_metric_on_validation_ << std::endl;
-  }
-
-  clear(vertical_training->num_features());
-
-  std::cout << std::endl;
-  std::cout << "#\t Training Time: " << std::setprecision(2) << train_time
-            << " s." << std::endl;
+  finish_learning(training_dataset, validation_dataset != nullptr,
+                  scorer.get(), chrono_train_start, ntrees_start,
+                  nsampleids_iter);
 }
 
 void Mart::compute_pseudoresponses(
@@ -444,16 +626,52 @@ std::unique_ptr<RegressionTree> Mart::fit_regressor_on_gradient(
   return std::unique_ptr<RegressionTree>(tree);
 }
 
+bool Mart::set_scoring_engine(const std::string &name,
+                              std::shared_ptr<data::Dataset> sample) {
+  if (sample && sample->has_float_features() && sample->num_instances())
+    return ensemble_model_.set_scoring_engine(name, sample->at(0, 0),
+                                              sample->num_instances(),
+                                              sample->num_features());
+  return ensemble_model_.set_scoring_engine(name);
+}
+
+void Mart::score_dataset(std::shared_ptr<data::Dataset> dataset,
+                         Score *scores) const {
+  if (!dataset->has_float_features()) {
+    LTR_Algorithm::score_dataset(dataset, scores);
+    return;
+  }
+
+  if (dataset->num_instances())
+    ensemble_model_.score_instances(dataset->at(0, 0),
+                                    dataset->num_instances(),
+                                    dataset->num_features(), scores);
+}
+
 void Mart::update_modelscores(std::shared_ptr<data::Dataset> dataset,
                               Score *scores, RegressionTree *tree) {
-  const quickrank::Feature *d = dataset->at(0, 0);
-  const size_t offset = 1;
-  const size_t num_features = dataset->num_features();
-  #pragma omp parallel for
-  for (size_t i = 0; i < dataset->num_instances(); ++i) {
-    scores[i] += shrinkage_ * tree->get_proot()->score_instance(
-        d + i * num_features, offset);
+  if (!dataset->has_float_features()) {
+    #pragma omp parallel
+    {
+      // features are widened (or scattered) into a dense per-thread row
+      std::vector<quickrank::Feature> row(dataset->num_features(), 0.0f);
+      #pragma omp for
+      for (size_t i = 0; i < dataset->num_instances(); ++i) {
+        dataset->fill_row(i, row.data());
+        scores[i] += shrinkage_ * tree->get_proot()->score_instance(
+            row.data(), 1);
+        dataset->clear_row(i, row.data());
+      }
+    }
+    return;
   }
+
+  // the last tree moves several documents at once
+  scoring::VPred vpred;
+  vpred.add_tree(tree->get_proot(), shrinkage_);
+  if (dataset->num_instances())
+    vpred.add_scores(dataset->at(0, 0), dataset->num_instances(),
+                     dataset->num_features(), scores);
 }
 
 void Mart::update_modelscores(std::shared_ptr<data::VerticalDataset> dataset,
@@ -467,6 +685,25 @@ void Mart::update_modelscores(std::shared_ptr<data::VerticalDataset> dataset,
   }
 }
 
+void Mart::update_modelscores(std::shared_ptr<data::BinnedFeatures> store,
+                              Score *scores, RegressionTree *tree) {
+  // a document goes left iff its bin is not greater than the threshold bin
+  for (size_t s = 0; s < store->num_shards(); ++s) {
+    if (s + 1 < store->num_shards())
+      store->prefetch(s + 1);
+    #pragma omp parallel for
+    for (size_t i = store->shard_begin(s); i < store->shard_end(s); ++i) {
+      RTNode *node = tree->get_proot();
+      while (!node->is_leaf()) {
+        const size_t f = node->get_feature_idx();
+        node = store->bin(s, i, f) <= store->threshold_bin(f, node->threshold)
+               ? node->left : node->right;
+      }
+      scores[i] += shrinkage_ * node->avglabel;
+    }
+  }
+}
+
 pugi::xml_document *Mart::get_xml_model() const {
 
   pugi::xml_document *doc = new pugi::xml_document();
@@ -34,6 +34,7 @@ ObliviousMart::ObliviousMart(const pugi::xml_document &model) : Mart(model) {
 
   treedepth_ = model.child("ranker").child("info").child("depth").text()
       .as_int();
+  ensemble_model_.set_default_scoring_engine(scoring::ObliviousScorer::NAME_);
 }
 
 std::ostream &ObliviousMart::put(std::ostream &os) const {
@@ -64,6 +65,32 @@ std::unique_ptr<RegressionTree> ObliviousMart::fit_regressor_on_gradient(
   return std::unique_ptr<RegressionTree>(tree);
 }
 
+void ObliviousMart::update_modelscores(std::shared_ptr<data::Dataset> dataset,
+                                       Score *scores, RegressionTree *tree) {
+  scoring::ObliviousScorer scorer;
+  if (!dataset->has_float_features()
+      || !scorer.add_tree(tree->get_proot(), shrinkage_)) {
+    Mart::update_modelscores(dataset, scores, tree);
+    return;
+  }
+  if (dataset->num_instances())
+    scorer.add_scores(dataset->at(0, 0), dataset->num_instances(),
+                      dataset->num_features(), scores);
+}
+
+void ObliviousMart::update_modelscores(
+    std::shared_ptr<data::VerticalDataset> dataset, Score *scores,
+    RegressionTree *tree) {
+  scoring::ObliviousScorer scorer;
+  if (!scorer.add_tree(tree->get_proot(), shrinkage_)) {
+    Mart::update_modelscores(dataset, scores, tree);
+    return;
+  }
+  // documents are stored by column, as the scorer transposes them
+  scorer.add_column_scores(dataset->at(0, 0), dataset->num_instances(),
+                           dataset->num_instances(), scores);
+}
+
 pugi::xml_document *ObliviousMart::get_xml_model() const {
 
   pugi::xml_document *doc = new pugi::xml_document();
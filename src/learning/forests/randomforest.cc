@@ -21,8 +21,18 @@
  */
 #include "learning/forests/randomforest.h"
 
-#include <fstream>
-#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <string>
+
+#ifdef _OPENMP
+#include <omp.h>
+#else
+#include "utils/omp-stubs.h"
+#endif
 
 namespace quickrank {
 namespace learning {
@@ -30,10 +40,30 @@ namespace forests {
 
 const std::string RandomForest::NAME_ = "RANDOMFOREST";
 
+RandomForest::RandomForest(const pugi::xml_document &model) : Mart(model) {
+  pugi::xml_node model_info = model.child("ranker").child("info");
+  if (model_info.child("bootstrap"))
+    bootstrap_ = model_info.child("bootstrap").text().as_bool();
+}
+
+std::ostream &RandomForest::put(std::ostream &os) const {
+  Mart::put(os);
+  os << "# bootstrap = " << (bootstrap_ ? "true" : "false") << std::endl;
+  return os;
+}
 
 void RandomForest::init(
     std::shared_ptr<quickrank::data::VerticalDataset> training_dataset) {
 
+  // bags with repeated samples are counted once by the histograms of
+  // binned features
+  if (bootstrap_ && store_) {
+    std::cerr << "!!! Bootstrap is not supported by binned (sparse, "
+              << "out-of-core or 16 bits) training, disable it with "
+              << "no-bootstrap." << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
   Mart::init(training_dataset);
 
   const size_t nentries = training_dataset->num_instances();
@@ -45,12 +75,127 @@ void RandomForest::init(
 
 void RandomForest::compute_pseudoresponses(
     std::shared_ptr<quickrank::data::VerticalDataset> training_dataset,
-    quickrank::metric::ir::Metric *scorer) {
+    quickrank::metric::ir::Metric *scorer,
+    bool *sample_presence) {
 
   // Do Nothing here, pseudoresponses_ does not change among iterations!
   return;
 }
 
+std::vector<size_t> RandomForest::draw_bag(size_t tree, size_t seed,
+                                           size_t nsamples,
+                                           size_t nbag) const {
+  std::mt19937_64 rng(seed + tree);
+  std::vector<size_t> bag;
+  if (bootstrap_) {
+    std::uniform_int_distribution<size_t> distribution(0, nsamples - 1);
+    bag.resize(nbag);
+    for (size_t i = 0; i < nbag; ++i)
+      bag[i] = distribution(rng);
+  } else {
+    // partial shuffle of the samples
+    bag.resize(nsamples);
+    std::iota(bag.begin(), bag.end(), 0);
+    for (size_t i = 0; i < nbag; ++i) {
+      std::uniform_int_distribution<size_t> distribution(i, nsamples - 1);
+      std::swap(bag[i], bag[distribution(rng)]);
+    }
+    bag.resize(nbag);
+  }
+  // binned features are visited in order of sample id
+  std::sort(bag.begin(), bag.end());
+  return bag;
+}
+
+void RandomForest::learn(
+    std::shared_ptr<quickrank::data::Dataset> training_dataset,
+    std::shared_ptr<quickrank::data::Dataset> validation_dataset,
+    std::shared_ptr<quickrank::metric::ir::Metric> scorer,
+    size_t partial_save, const std::string output_basename) {
+  // number of samples of every tree
+  const size_t nsamples = training_dataset->num_instances();
+  size_t nbag = nsamples;
+  if (subsample_ > 1.0f)
+    nbag = std::min((size_t) subsample_, nsamples);
+  else if (subsample_ != 1.0f)
+    nbag = (size_t) std::floor(subsample_ * nsamples);
+
+  // a bag made of all the samples shares the root histogram, which trees
+  // only read
+  const bool full_bag = !bootstrap_ && nbag == nsamples;
+  const bool all_features = max_features_ == 1.0f
+      || max_features_ >= training_dataset->num_features();
+  if (full_bag && all_features && ntrees_ > 1) {
+    std::cerr << "!!! Without bootstrap, trees grown on all the samples and "
+              << "features would be identical: set subsample or max-features "
+              << "below 1." << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  std::shared_ptr<quickrank::data::VerticalDataset> vertical_training =
+      init_learning(training_dataset, validation_dataset, scorer.get());
+
+  auto chrono_train_start = std::chrono::high_resolution_clock::now();
+  const size_t ntrees_start = ensemble_model_.get_size();
+
+  std::vector<size_t> all_samples(nsamples);
+  std::iota(all_samples.begin(), all_samples.end(), 0);
+  if (full_bag)
+    hist_->update(pseudoresponses_, nsamples, all_samples.data());
+
+  const size_t seed =
+      std::chrono::system_clock::now().time_since_epoch().count();
+  const size_t ntrees_at_once = std::max(omp_get_max_threads(), 1);
+
+  bool early_stop = false;
+  size_t m = ensemble_model_.get_size();
+  while (m < ntrees_ && !early_stop) {
+    // grow a tree per thread, inner loops of the trees being sequential
+    const size_t ntrees_batch = std::min(ntrees_at_once, ntrees_ - m);
+    std::vector<std::vector<size_t>> bags(ntrees_batch);
+    std::vector<std::unique_ptr<RTNodeHistogram>> hists(ntrees_batch);
+    std::vector<std::unique_ptr<RegressionTree>> trees(ntrees_batch);
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (size_t b = 0; b < ntrees_batch; ++b) {
+      RTNodeHistogram *hist = hist_;
+      size_t *sampleids = all_samples.data();
+      if (!full_bag) {
+        bags[b] = draw_bag(m + b, seed, nsamples, nbag);
+        sampleids = bags[b].data();
+        hists[b].reset(new RTNodeHistogram(hist_, sampleids, nbag,
+                                           pseudoresponses_));
+        hist = hists[b].get();
+      }
+      trees[b].reset(new RegressionTree(nleaves_, vertical_training.get(),
+                                        pseudoresponses_, minleafsupport_,
+                                        collapse_leaves_factor_));
+      trees[b]->fit(hist, sampleids, max_features_);
+      trees[b]->update_output(pseudoresponses_);
+    }
+
+    // trees are added to the ensemble in order
+    for (size_t b = 0; b < ntrees_batch; ++b, ++m) {
+      if (stop_early(m, validation_dataset != nullptr)) {
+        early_stop = true;
+        break;
+      }
+      add_tree(trees[b].get(), m, vertical_training, validation_dataset,
+               scorer.get(), partial_save, output_basename);
+    }
+  }
+
+  finish_learning(training_dataset, validation_dataset != nullptr,
+                  scorer.get(), chrono_train_start, ntrees_start, nbag,
+                  ", " + std::to_string(ntrees_at_once) + " trees at once");
+}
+
+pugi::xml_document *RandomForest::get_xml_model() const {
+  pugi::xml_document *doc = Mart::get_xml_model();
+  doc->child("ranker").child("info").append_child("bootstrap").text() =
+      bootstrap_;
+  return doc;
+}
+
 }  // namespace forests
 }  // namespace learning
 }  // namespace quickrank
@@ -23,6 +23,7 @@
  */
 #include "learning/forests/rankboost.h"
 
+#include <algorithm>
 #include <fstream>
 #include <iomanip>
 #include <cmath>
@@ -83,16 +84,6 @@ Rankboost::~Rankboost() {
   }
 }
 
-struct external_sort_op_t {
-  const Feature *values_;
-  external_sort_op_t(const Feature *values) {
-    values_ = values;
-  }
-  bool operator()(int i, int j) {
-    return (values_[i] > values_[j]);
-  }
-};
-
 std::ostream &Rankboost::put(std::ostream &os) const {
   os << "# Ranker: " << name() << std::endl;
   os << "# Weak Rankers: " << T << std::endl;
@@ -111,8 +102,14 @@ void Rankboost::learn(
   const char *on_off[2] = {"OFF", "ON"};
   std::cout << "# Parallel: " << on_off[go_parallel] << std::endl;
 
-  // initialization
+  // initialization, the weak rankers access the features in place
+  training_dataset = quickrank::data::Dataset::with_float_rows(
+      training_dataset);
+  if (validation_dataset)
+    validation_dataset = quickrank::data::Dataset::with_float_rows(
+        validation_dataset);
   init(training_dataset, validation_dataset);
+  feature_ids = training_dataset->feature_ids();
   best_T = 0;
   MetricScore best_metric_on_training = 0;
   MetricScore best_metric_on_validation = 0;
@@ -258,83 +255,55 @@ void Rankboost::init(std::shared_ptr<data::Dataset> training_dataset,
   weak_rankers = new WeakRanker *[T];
   alphas = new float[T]();
 
-  // calculate N (number of correctly ranked document pairs)
-  unsigned int N = 0;
-#pragma omp parallel for if(go_parallel) schedule(runtime) reduction(+:N)
-  for (unsigned int q = 0; q < nq; q++) {
-    std::shared_ptr<data::QueryResults> qr =
-        training_dataset->getQueryResults(q);
-    const quickrank::Label *l = qr->labels();
-    for (unsigned int i = 0; i < qr->num_results() - 1; i++)
-      for (unsigned int j = i + 1; j < qr->num_results(); j++)
-        if (l[j] > l[i])
-          N++;
-  }
-
-  // allocate matrices D (document pair weights) and PI (potential)
-  // D_ij = 1/N if j more relevant than i, 0 otherwise
-  D = new float **[nq];
-  PI = new float *[nq];
+  // sort the documents of every query by decreasing label
+  ranked_docs.resize(ni);
+  pair_offsets.assign(nq + 1, 0);
 #pragma omp parallel for if(go_parallel) schedule(runtime)
   for (unsigned int q = 0; q < nq; q++) {
-    std::shared_ptr<data::QueryResults>
-        qr = training_dataset->getQueryResults(q);
-    const quickrank::Label *l = qr->labels();
-    D[q] = new float *[qr->num_results()];
-    PI[q] = new float[qr->num_results()]();
-    for (unsigned int i = 0; i < qr->num_results() - 1; i++) {
-      D[q][i] = new float[qr->num_results()]();
-      for (unsigned int j = i + 1; j < qr->num_results(); j++) {
-        if (l[j] > l[i])
-          D[q][i][j] = (float) (1.0 / N);
-      }
+    const size_t begin = training_dataset->offset(q);
+    const size_t end = training_dataset->offset(q + 1);
+    uint32_t *docs = ranked_docs.data() + begin;
+    for (size_t i = begin; i < end; i++)
+      docs[i - begin] = (uint32_t) i;
+    std::stable_sort(docs, docs + (end - begin),
+                     [&](uint32_t i, uint32_t j) {
+                       return training_dataset->getLabel(i)
+                           > training_dataset->getLabel(j);
+                     });
+    // count the pairs of the query
+    size_t pairs = 0;
+    size_t lower = begin;
+    for (size_t a = begin; a < end; a++) {
+      const Label label = training_dataset->getLabel(ranked_docs[a]);
+      while (lower < end
+          && training_dataset->getLabel(ranked_docs[lower]) >= label)
+        lower++;
+      pairs += end - lower;
     }
+    pair_offsets[q + 1] = pairs;
   }
+  for (unsigned int q = 0; q < nq; q++)
+    pair_offsets[q + 1] += pair_offsets[q];
 
-  // allocate matrix THETA (feature thresholds) and calculates n_theta (number of thresholds for each feature)
-  THETA = new Feature *[nf];
-  n_theta = new unsigned int[nf]();
-#pragma omp parallel for if(go_parallel) schedule(runtime)
-  for (unsigned int f = 0; f < nf; f++) {
-    Feature *tmp_theta = new Feature[ni];
-    for (unsigned int k = 0; k < ni; k++)
-      tmp_theta[k] = *training_dataset->at(k, f);
-    std::sort(tmp_theta, tmp_theta + ni);
-    std::reverse(tmp_theta, tmp_theta + ni);
-    n_theta[f] = 1;
-    for (unsigned int k = 1; k < ni; k++)
-      if (tmp_theta[k] != tmp_theta[k - 1])
-        tmp_theta[n_theta[f]++] = tmp_theta[k];
-    THETA[f] = new Feature[n_theta[f]];
-    for (unsigned int k = 0; k < n_theta[f]; k++)
-      THETA[f][k] = tmp_theta[k];
-    delete[] tmp_theta;
-  }
+  // N is the number of document pairs, D_ij = 1/N for all of them
+  const size_t N = pair_offsets[nq];
+  D.assign(N, (float) (1.0 / N));
+  PI.assign(ni, 0.0f);
 
-  // Sorted Document Features
-  SDF = new unsigned int **[training_dataset->num_features()];
+  // sort the documents by decreasing value of every feature
+  sorted_docs.resize((size_t) nf * ni);
+  sorted_values.resize((size_t) nf * ni);
 #pragma omp parallel for if(go_parallel) schedule(runtime)
   for (unsigned int f = 0; f < nf; f++) {
-    SDF[f] = new unsigned int *[training_dataset->num_queries()]();
-    for (unsigned int q = 0; q < nq; q++) {
-      std::shared_ptr<data::QueryResults>
-          r = training_dataset->getQueryResults(q);
-      unsigned int nr = r->num_results();
-      SDF[f][q] = new unsigned int[nr]();
-      Feature *feature_values = new Feature[nr];
-      for (unsigned int i = 0; i < nr; i++) {
-        feature_values[i] =
-            *training_dataset->at(training_dataset->offset(q) + i, f);
-      }
-      unsigned int *sorted_indices = new unsigned int[nr];
-      external_sort_op_t comp(feature_values);
-      for (unsigned int i = 0; i < nr; ++i) {
-        sorted_indices[i] = i;
-      }
-      std::sort(sorted_indices, sorted_indices + nr, comp);
-      SDF[f][q] = sorted_indices;
-      delete[] feature_values;
-    }
+    uint32_t *docs = sorted_docs.data() + (size_t) f * ni;
+    Feature *values = sorted_values.data() + (size_t) f * ni;
+    for (unsigned int k = 0; k < ni; k++)
+      docs[k] = k;
+    std::stable_sort(docs, docs + ni, [&](uint32_t i, uint32_t j) {
+      return *training_dataset->at(i, f) > *training_dataset->at(j, f);
+    });
+    for (unsigned int k = 0; k < ni; k++)
+      values[k] = *training_dataset->at(docs[k], f);
   }
 
   auto init_end = std::chrono::high_resolution_clock::now();
@@ -344,18 +313,30 @@ void Rankboost::init(std::shared_ptr<data::Dataset> training_dataset,
             << std::endl;
 } // init
 
-// Compute potential matrix PI
+// Compute the potential PI of the documents
 
 void Rankboost::compute_pi(std::shared_ptr<data::Dataset> dataset) {
 
-  for (unsigned int q = 0; q < dataset->num_queries(); q++) {
-    std::shared_ptr<data::QueryResults> qr = dataset->getQueryResults(q);
-    for (unsigned int i = 0; i < qr->num_results(); i++) {
-      PI[q][i] = 0.0;
-      for (unsigned int k = 0; k < i; k++)
-        PI[q][i] += D[q][k][i];
-      for (unsigned int k = i + 1; k < qr->num_results(); k++)
-        PI[q][i] -= D[q][i][k];
+  const unsigned int nq = dataset->num_queries();
+
+#pragma omp parallel for if(go_parallel) schedule(runtime)
+  for (unsigned int q = 0; q < nq; q++) {
+    const size_t begin = dataset->offset(q);
+    const size_t end = dataset->offset(q + 1);
+    for (size_t i = begin; i < end; i++)
+      PI[i] = 0.0;
+    // documents are preferred to the ones with a lower label
+    const float *d = D.data() + pair_offsets[q];
+    size_t lower = begin;
+    for (size_t a = begin; a < end; a++) {
+      const Label label = dataset->getLabel(ranked_docs[a]);
+      while (lower < end && dataset->getLabel(ranked_docs[lower]) >= label)
+        lower++;
+      float &pi = PI[ranked_docs[a]];
+      for (size_t b = lower; b < end; b++, d++) {
+        pi += *d;
+        PI[ranked_docs[b]] -= *d;
+      }
     }
   }
 }
@@ -365,46 +346,38 @@ void Rankboost::compute_pi(std::shared_ptr<data::Dataset> dataset) {
 WeakRanker *Rankboost::compute_weak_ranker(
     std::shared_ptr<data::Dataset> dataset) {
 
+  const unsigned int nf = dataset->num_features();
+  const unsigned int ni = dataset->num_instances();
+
+  // the best threshold of every feature is the value of a document such
+  // that the sum of the potentials of the documents with greater values is
+  // the highest
+  std::vector<float> feature_r(nf, 0.0);
+  std::vector<Feature> feature_theta(nf, -1);
+#pragma omp parallel for if(go_parallel) schedule(runtime)
+  for (unsigned int f = 0; f < nf; f++) {
+    const uint32_t *docs = sorted_docs.data() + (size_t) f * ni;
+    const Feature *values = sorted_values.data() + (size_t) f * ni;
+    double r = 0.0;
+    for (unsigned int k = 0; k < ni; k++) {
+      if ((k == 0 || values[k] != values[k - 1]) && r > feature_r[f]) {
+        feature_r[f] = (float) r;
+        feature_theta[f] = values[k];
+      }
+      r += PI[docs[k]];
+    }
+  }
+
   best_r = 0.0;
   int best_feature_id = -1;
   Feature best_theta = -1;
   int sign = 1;
-  const unsigned int nq = dataset->num_queries();
-
-#pragma omp parallel for if(go_parallel) schedule(runtime) shared(best_feature_id, best_theta, sign)
-  for (unsigned int f = 0; f < dataset->num_features(); f++) {
-    unsigned int *last = new unsigned int[nq];
-    for (unsigned int q = 0; q < nq; q++)
-      last[q] = -1;
-    float r = 0.0;
-    for (unsigned int j = 0; j < n_theta[f]; j++) {
-      Feature feat = THETA[f][j];
-      for (unsigned int q = 0; q < nq; q++) {
-        std::shared_ptr<data::QueryResults> qr = dataset->getQueryResults(q);
-        for (unsigned int l = last[q] + 1; l < qr->num_results(); l++) {
-          unsigned int id_doc = dataset->offset(q) + SDF[f][q][l];
-          if (*dataset->at(id_doc, f) > feat) {
-            r += PI[q][SDF[f][q][l]];
-            last[q] = l;
-          } else
-            break;
-        }
-      }
-      // sign = 1;
-      // if (r < 0) {
-      //     sign = -1;
-      //     r = -r;
-      // }
-#pragma omp critical
-      {
-        if (r > best_r) {
-          best_r = r;
-          best_theta = feat;
-          best_feature_id = f;
-        }
-      }
+  for (unsigned int f = 0; f < nf; f++) {
+    if (feature_r[f] > best_r) {
+      best_r = feature_r[f];
+      best_theta = feature_theta[f];
+      best_feature_id = f;
     }
-    delete[] last;
   }
 
   r_t = z_t * best_r;
@@ -414,34 +387,47 @@ WeakRanker *Rankboost::compute_weak_ranker(
   return new WeakRanker(best_feature_id, best_theta, sign);
 } // compute_weak_ranker
 
-// Update matrix D (document pair weights)
+// Update the document pair weights D
 
 void Rankboost::update_d(std::shared_ptr<data::Dataset> dataset, WeakRanker *wr,
                          float alpha) {
 
-  z_t = 0.0;
   const unsigned int nq = dataset->num_queries();
+  const unsigned int ni = dataset->num_instances();
 
-  // update matrix D
+  std::vector<int> h(ni);
+#pragma omp parallel for if(go_parallel) schedule(runtime)
+  for (unsigned int i = 0; i < ni; i++)
+    h[i] = wr->score_document(dataset->at(i, 0));
+
+  // update the weights of the pairs, by a factor exp(alpha * (h_b - h_a))
+  // where h_b - h_a is -1, 0 or 1
+  const double factors[3] = {exp(-alpha), 1.0, exp(alpha)};
+  double z = 0.0;
+#pragma omp parallel for if(go_parallel) schedule(runtime) reduction(+:z)
   for (unsigned int q = 0; q < nq; q++) {
-    std::shared_ptr<data::QueryResults> qr = dataset->getQueryResults(q);
-    for (unsigned int j = 0; j < qr->num_results() - 1; j++) {
-      for (unsigned int k = j + 1; k < qr->num_results(); k++) {
-        D[q][j][k] = (float) (D[q][j][k] * exp(alpha * (int) (
-            wr->score_document(dataset->at(dataset->offset(q) + j, 0))
-                - wr->score_document(dataset->at(dataset->offset(q) + k, 0)))));
-        z_t += D[q][j][k];
+    const size_t begin = dataset->offset(q);
+    const size_t end = dataset->offset(q + 1);
+    float *d = D.data() + pair_offsets[q];
+    size_t lower = begin;
+    for (size_t a = begin; a < end; a++) {
+      const Label label = dataset->getLabel(ranked_docs[a]);
+      while (lower < end && dataset->getLabel(ranked_docs[lower]) >= label)
+        lower++;
+      const int h_a = h[ranked_docs[a]];
+      for (size_t b = lower; b < end; b++, d++) {
+        *d = (float) (*d * factors[h[ranked_docs[b]] - h_a + 1]);
+        z += *d;
       }
     }
   }
+  z_t = (float) z;
 
   // normalize
-  for (unsigned int q = 0; q < nq; q++) {
-    std::shared_ptr<data::QueryResults> qr = dataset->getQueryResults(q);
-    for (unsigned int j = 0; j < qr->num_results() - 1; j++)
-      for (unsigned int k = j + 1; k < qr->num_results(); k++)
-        D[q][j][k] /= z_t;
-  }
+  const size_t N = D.size();
+#pragma omp parallel for if(go_parallel) schedule(runtime)
+  for (size_t p = 0; p < N; p++)
+    D[p] /= z_t;
 } // update_d
 
 // Clean up some space
@@ -457,47 +443,13 @@ void Rankboost::clean(std::shared_ptr<data::Dataset> dataset) {
             delete weak_rankers[t];
     }
 */
-  const unsigned int nq = dataset->num_queries();
-  const unsigned int nf = dataset->num_features();
-
-  if (D) {
-#pragma omp parallel for if(go_parallel) schedule(runtime)
-    for (unsigned int q = 0; q < nq; q++) {
-      std::shared_ptr<data::QueryResults> qr = dataset->getQueryResults(q);
-      for (unsigned int i = 0; i < qr->num_results() - 1; i++)
-        delete[] D[q][i];
-      delete[] D[q];
-    }
-    delete[] D;
-  }
-
-  if (PI) {
-#pragma omp parallel for if(go_parallel) schedule(runtime)
-    for (unsigned int q = 0; q < nq; q++)
-      delete[] PI[q];
-    delete[] PI;
-  }
-
-  if (THETA) {
-#pragma omp parallel for if(go_parallel) schedule(runtime)
-    for (unsigned int f = 0; f < nf; f++)
-      delete[] THETA[f];
-    delete[] THETA;
-  }
-
-  if (SDF) {
-#pragma omp parallel for if(go_parallel) schedule(runtime)
-    for (unsigned int f = 0; f < nf; f++) {
-      for (unsigned int q = 0; q < nq; q++)
-        delete[] SDF[f][q];
-      delete[] SDF[f];
-    }
-    delete[] SDF;
-  }
-
-  if (n_theta) {
-    delete[] n_theta;
-  }
+  // release the memory of the pairs and of the sorted features
+  std::vector<float>().swap(D);
+  std::vector<float>().swap(PI);
+  std::vector<uint32_t>().swap(ranked_docs);
+  std::vector<size_t>().swap(pair_offsets);
+  std::vector<uint32_t>().swap(sorted_docs);
+  std::vector<Feature>().swap(sorted_values);
 
   if (training_scores) {
     delete[] training_scores;
@@ -517,6 +469,14 @@ void Rankboost::clean(std::shared_ptr<data::Dataset> dataset) {
 }
 
 
+size_t Rankboost::num_features() const {
+  size_t num_features = 0;
+  for (unsigned int t = 0; t < best_T; t++)
+    num_features = std::max<size_t>(num_features,
+                                    weak_rankers[t]->get_feature_id() + 1);
+  return num_features;
+}
+
 Score Rankboost::score_document(const quickrank::Feature *d) const {
 
   Score doc_score = 0.0;
@@ -552,7 +512,10 @@ pugi::xml_document *Rankboost::get_xml_model() const {
 
     pugi::xml_node wr = ensemble.append_child("weakranker");
     wr.append_child("id").text() = t;
-    wr.append_child("featureid").text() = weak_rankers[t]->get_feature_id();
+    // weak rankers store the 0-based column of the feature
+    const unsigned int column = weak_rankers[t]->get_feature_id();
+    wr.append_child("featureid").text() =
+        feature_ids.empty() ? column : (unsigned int) feature_ids[column] - 1;
     wr.append_child("theta").text() = weak_rankers[t]->get_theta();
     wr.append_child("sign").text() = weak_rankers[t]->get_sign();
     wr.append_child("alpha").text() = alphas[t];
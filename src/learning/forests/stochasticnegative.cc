@@ -66,6 +66,7 @@ void StochasticNegative::learn(std::shared_ptr<quickrank::data::Dataset> trainin
 
   init(vertical_training);
 
+  validation_dataset = wait_validation(validation_dataset);
   if (validation_dataset) {
     scores_on_validation_ = new Score[validation_dataset->num_instances()]();
   }
@@ -205,7 +206,8 @@ void StochasticNegative::learn(std::shared_ptr<quickrank::data::Dataset> trainin
         fit_regressor_on_gradient(vertical_training, sampleids);
 
     //add this tree to the ensemble (our model)
-    ensemble_model_.push(tree->get_proot(), shrinkage_, 0);  // maxlabel);
+    ensemble_model_.push(tree->get_proot(), tree->release_nodes(),
+                         shrinkage_, 0);  // maxlabel);
 
     //Update the model's outputs on all training samples
     update_modelscores(vertical_training, scores_on_training_, tree.get());
@@ -34,7 +34,7 @@ namespace quickrank {
 namespace learning {
 namespace linear {
 
-void preCompute(Feature *training_dataset, size_t num_docs,
+void preCompute(const Feature *training_dataset, size_t num_docs,
                 size_t num_fx, Score *PreSum, double *weights,
                 Score *MyTrainingScore, size_t i) {
 
@@ -120,6 +120,13 @@ void CoordinateAscent::learn(
     size_t partial_save, const std::string output_basename) {
 
   auto begin = std::chrono::steady_clock::now();
+
+  // the weights are evaluated on the features accessed in place
+  training_dataset = quickrank::data::Dataset::with_float_rows(
+      training_dataset);
+  if (validation_dataset)
+    validation_dataset = quickrank::data::Dataset::with_float_rows(
+        validation_dataset);
   double window_size = window_size_
       / training_dataset->num_features();  //preserve original value of the window
 
@@ -131,6 +138,7 @@ void CoordinateAscent::learn(
 
   // initialize weights and best_weights a 1/n
   const auto num_features = training_dataset->num_features();
+  feature_ids_ = training_dataset->feature_ids();
   const auto n_train_instances = training_dataset->num_instances();
 
   std::vector<double> weights(num_features, 1.0 / num_features);
@@ -291,7 +299,8 @@ pugi::xml_document *CoordinateAscent::get_xml_model() const {
 
     pugi::xml_node feature = model.append_child("feature");
 
-    feature.append_attribute("id") = i + 1;
+    feature.append_attribute("id") =
+        feature_ids_.empty() ? i + 1 : feature_ids_[i];
     feature.append_attribute("weight") = ss.str().c_str();
 
     // reset ss
@@ -124,7 +124,8 @@ pugi::xml_document *LineSearch::get_xml_model() const {
     ss << best_weights_[i];
 
     pugi::xml_node couple = ensemble.append_child("tree");
-    couple.append_child("index").text() = i + 1;
+    couple.append_child("index").text() =
+        feature_ids_.empty() ? i + 1 : feature_ids_[i];
     couple.append_child("weight").text() = ss.str().c_str();
 
     // reset ss
@@ -158,6 +159,13 @@ void LineSearch::learn(
 
   auto begin = std::chrono::steady_clock::now();
 
+  // the weights are evaluated on the features accessed in place
+  training_dataset = quickrank::data::Dataset::with_float_rows(
+      training_dataset);
+  if (validation_dataset)
+    validation_dataset = quickrank::data::Dataset::with_float_rows(
+        validation_dataset);
+
   // We force num_points to be odd, so that the central point in step 1 is
   // included by default in searching the best weight for each feature
   unsigned int num_points = num_points_;
@@ -174,6 +182,7 @@ void LineSearch::learn(
   std::cout << std::endl;
 
   const auto num_features = training_dataset->num_features();
+  feature_ids_ = training_dataset->feature_ids();
   const auto num_train_instances = training_dataset->num_instances();
 
   std::vector<double> weights(num_features);
@@ -443,7 +452,8 @@ bool LineSearch::update_weights(std::vector<double>& weights) {
   return true;
 }
 
-void LineSearch::preCompute(Feature *training_dataset, unsigned int num_samples,
+void LineSearch::preCompute(const Feature *training_dataset,
+                            unsigned int num_samples,
                             unsigned int num_features, Score *pre_sum,
                             double *weights, Score *training_score,
                             unsigned int feature_exclude) {
@@ -462,7 +472,7 @@ void LineSearch::preCompute(Feature *training_dataset, unsigned int num_samples,
   }
 }
 
-void LineSearch::score(Feature *dataset, unsigned int num_samples,
+void LineSearch::score(const Feature *dataset, unsigned int num_samples,
                        unsigned int num_features, double *weights,
                        Score *scores) {
 
@@ -30,6 +30,7 @@
 #include "learning/forests/lambdamartselective.h"
 #include "learning/forests/obliviouslambdamart.h"
 #include "learning/forests/obliviousmart.h"
+#include "learning/forests/mapped_ensemble.h"
 // Added by Chiara Pierucci Andrea Battistini
 #include "learning/linear/coordinate_ascent.h"
 // Added by Tommaso Papini and Gabriele Bani
@@ -43,6 +44,21 @@ namespace learning {
 
 void LTR_Algorithm::score_dataset(std::shared_ptr<data::Dataset> dataset,
                                   Score *scores) const {
+  if (!dataset->has_float_features()) {
+    #pragma omp parallel
+    {
+      // features are widened (or scattered) into a dense per-thread row
+      std::vector<quickrank::Feature> row(dataset->num_features(), 0.0f);
+      #pragma omp for
+      for (size_t i = 0; i < dataset->num_instances(); i++) {
+        dataset->fill_row(i, row.data());
+        scores[i] = score_document(row.data());
+        dataset->clear_row(i, row.data());
+      }
+    }
+    return;
+  }
+
   const quickrank::Feature *d = dataset->at(0, 0);
   #pragma omp parallel for
   for (size_t i = 0; i < dataset->num_instances(); i++) {
@@ -71,6 +87,11 @@ std::shared_ptr<LTR_Algorithm> LTR_Algorithm::load_model_from_file(
     exit(EXIT_FAILURE);
   }
 
+  // binary models are mapped in memory instead of being parsed
+  if (forests::MappedEnsemble::is_binary(model_filename))
+    return std::shared_ptr<LTR_Algorithm>(
+        new forests::MappedEnsemble(model_filename));
+
   pugi::xml_document model;
   pugi::xml_parse_result result = model.load_file(model_filename.c_str());
   if (!result) {
@@ -39,7 +39,7 @@ namespace quickrank {
 namespace learning {
 
 std::shared_ptr<quickrank::learning::LTR_Algorithm> ltr_algorithm_factory(
-    ParamsMap &pmap) {
+    ParamsMap &pmap, data::Dataset::Storage storage) {
 
   std::shared_ptr<quickrank::learning::LTR_Algorithm> ltr_algo_model = nullptr;
   std::shared_ptr<quickrank::learning::LTR_Algorithm> ltr_algo = nullptr;
@@ -63,6 +63,9 @@ std::shared_ptr<quickrank::learning::LTR_Algorithm> ltr_algorithm_factory(
     std::string algo_name = pmap.get<std::string>("algo");
     std::transform(algo_name.begin(), algo_name.end(),
                    algo_name.begin(), ::toupper);
+    // features not stored as dense floats are binned
+    const bool binned = pmap.isSet("out-of-core")
+        || storage != data::Dataset::FLOAT32;
 
     if (algo_name == quickrank::learning::forests::LambdaMart::NAME_) {
       ltr_algo = std::shared_ptr<quickrank::learning::LTR_Algorithm>(
@@ -123,6 +126,18 @@ std::shared_ptr<quickrank::learning::LTR_Algorithm> ltr_algorithm_factory(
               pmap.get<float>("collapse-leaves-factor")
           ));
     } else if (algo_name == quickrank::learning::forests::RandomForest::NAME_) {
+        bool bootstrap = !pmap.isSet("no-bootstrap");
+        float subsample = pmap.get<float>("subsample");
+        // binned training does not support bags with repeated samples: they
+        // are drawn without replacement, by default as many as the distinct
+        // samples expected in a bootstrap bag (1 - 1/e)
+        if (binned && bootstrap) {
+          bootstrap = false;
+          if (subsample == 1.0f && pmap.get<float>("max-features") == 1.0f)
+            subsample = 0.632f;
+          std::cout << "# Binned training draws bags without replacement"
+                    << std::endl;
+        }
         ltr_algo = std::shared_ptr<quickrank::learning::LTR_Algorithm>(
             new quickrank::learning::forests::RandomForest(
                 pmap.get<size_t>("num-trees"),
@@ -130,10 +145,11 @@ std::shared_ptr<quickrank::learning::LTR_Algorithm> ltr_algorithm_factory(
                 pmap.get<size_t>("num-thresholds"),
                 pmap.get<size_t>("num-leaves"),
                 pmap.get<size_t>("min-leaf-support"),
-                pmap.get<float>("subsample"),
+                subsample,
                 pmap.get<float>("max-features"),
                 pmap.get<size_t>("end-after-rounds"),
-                pmap.get<float>("collapse-leaves-factor")
+                pmap.get<float>("collapse-leaves-factor"),
+                bootstrap
             ));
     } else if (algo_name == quickrank::learning::forests::Dart::NAME_) {
       ltr_algo = std::shared_ptr<quickrank::learning::LTR_Algorithm>(
@@ -158,7 +174,9 @@ std::shared_ptr<quickrank::learning::LTR_Algorithm> ltr_algorithm_factory(
               pmap.isSet("keep-drop"),
               pmap.isSet("best-on-train"),
               pmap.get<double>("random-keep"),
-              pmap.isSet("drop-on-best")
+              pmap.isSet("drop-on-best"),
+              pmap.get<size_t>("leaf-cache-mb"),
+              pmap.isSet("leaf-cache-spill")
           ));
     } else if (algo_name
         == quickrank::learning::forests::ObliviousMart::NAME_) {
@@ -217,6 +235,34 @@ std::shared_ptr<quickrank::learning::LTR_Algorithm> ltr_algorithm_factory(
       ltr_algo = std::shared_ptr<quickrank::learning::LTR_Algorithm>(
           new quickrank::learning::CustomLTR());
     }
+
+    if (binned) {
+      const std::string mode = pmap.isSet("out-of-core") ? "Out-of-core"
+          : storage == data::Dataset::SPARSE ? "Sparse"
+          : storage == data::Dataset::FLOAT16 ? "FP16" : "BF16";
+      auto mart = std::dynamic_pointer_cast<
+          quickrank::learning::forests::Mart>(ltr_algo);
+      // algorithms with their own learning loop do not support binned
+      // features
+      if (!mart
+          || algo_name == quickrank::learning::forests::Dart::NAME_
+          || algo_name
+              == quickrank::learning::forests::LambdaMartSelective::NAME_
+          || algo_name
+              == quickrank::learning::forests::StochasticNegative::NAME_) {
+        std::cerr << " !! " << mode << " training is not supported by "
+                  << algo_name << std::endl;
+        exit(EXIT_FAILURE);
+      }
+      if (pmap.isSet("out-of-core") && storage == data::Dataset::SPARSE) {
+        std::cerr << " !! Out-of-core training is not supported on sparse "
+            "datasets" << std::endl;
+        exit(EXIT_FAILURE);
+      }
+      if (pmap.isSet("out-of-core"))
+        mart->set_out_of_core(pmap.get<std::string>("out-of-core"),
+                              pmap.get<size_t>("shard-size"));
+    }
   }
 
   if (pmap.isSet("meta-algo")) {
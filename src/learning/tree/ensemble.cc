@@ -21,8 +21,19 @@
  */
 #include <fstream>
 #include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <sstream>
 
 #include "learning/tree/ensemble.h"
+#include "scoring/scoring_engine_factory.h"
+
+const size_t Ensemble::CALIBRATION_DOCS;
+const size_t Ensemble::CALIBRATION_RUNS;
+const double Ensemble::CALIBRATION_SECONDS = 0.05;
 
 Ensemble::Ensemble(Ensemble&& other) {
   size = other.size;
@@ -32,6 +43,8 @@ Ensemble::Ensemble(Ensemble&& other) {
   other.arr = nullptr;
   other.size = 0;
   other.capacity = 0;
+  engine_name_ = other.engine_name_;
+  other.engine_.reset();
 }
 
 Ensemble::~Ensemble() {
@@ -40,9 +53,10 @@ Ensemble::~Ensemble() {
 }
 
 void Ensemble::reset_state() {
+  engine_.reset();
   if (arr) {
     for (size_t i = 0; i < size; ++i)
-      delete arr[i].root;
+      delete arr[i].nodes;
     free(arr);
     arr = nullptr;
   }
@@ -54,6 +68,9 @@ Ensemble& Ensemble::operator=(Ensemble&& other) {
   if(this != &other) {
     if(arr)
       reset_state();
+    engine_name_ = other.engine_name_;
+    engine_.reset();
+    other.engine_.reset();
 
     size = other.size;
     capacity = other.capacity;
@@ -68,13 +85,14 @@ Ensemble& Ensemble::operator=(Ensemble&& other) {
 }
 
 void Ensemble::set_capacity(const size_t n) {
+  engine_.reset();
 
   if (arr) {
 
     if (n < size) {
-      // We need to call the destructor for the RTNode exceeding the new size
+      // We need to release the trees exceeding the new size
       for (size_t i = n; i < size; ++i)
-        delete arr[i].root;
+        delete arr[i].nodes;
       size = n;
     }
 
@@ -94,17 +112,20 @@ void Ensemble::set_capacity(const size_t n) {
   capacity = n;
 }
 
-void Ensemble::push(RTNode *root, const double weight, const float maxlabel) {
+void Ensemble::push(RTNode *root, std::unique_ptr<RTNodeArena> nodes,
+                    const double weight, const float maxlabel) {
   if (size >= capacity) {
     std::cerr << "Error adding a new tree into the ensemble, capacity reached!";
     exit(1);
   }
 
-  arr[size++] = weighted_tree(root, weight, maxlabel);
+  arr[size++] = weighted_tree(root, nodes.release(), weight, maxlabel);
+  engine_.reset();
 }
 
 void Ensemble::pop() {
-  delete arr[--size].root;
+  engine_.reset();
+  delete arr[--size].nodes;
 }
 
 // assumes vertical dataset
@@ -117,6 +138,157 @@ quickrank::Score Ensemble::score_instance(const quickrank::Feature *d,
   return sum;
 }
 
+std::shared_ptr<quickrank::scoring::ScoringEngine> Ensemble::build_engine(
+    const std::string &name) const {
+  auto engine = quickrank::scoring::scoring_engine_factory(name);
+  for (size_t i = 0; engine && i < size; ++i)
+    if (!engine->add_tree(arr[i].root, arr[i].weight))
+      engine.reset();
+  if (engine && !engine->prepare())
+    engine.reset();
+  return engine;
+}
+
+size_t Ensemble::num_features() const {
+  size_t num_features = 0;
+  std::vector<const RTNode *> stack;
+  for (size_t i = 0; i < size; ++i) {
+    stack.push_back(arr[i].root);
+    while (!stack.empty()) {
+      const RTNode *node = stack.back();
+      stack.pop_back();
+      if (node->is_leaf())
+        continue;
+      num_features = std::max(num_features, node->get_feature_idx() + 1);
+      stack.push_back(node->left);
+      stack.push_back(node->right);
+    }
+  }
+  return num_features;
+}
+
+std::vector<quickrank::Feature> Ensemble::synthetic_documents(
+    size_t num_docs, size_t &num_features) const {
+  // thresholds of every feature
+  std::vector<std::vector<float>> thresholds;
+  std::vector<const RTNode *> stack;
+  for (size_t i = 0; i < size; ++i) {
+    stack.push_back(arr[i].root);
+    while (!stack.empty()) {
+      const RTNode *node = stack.back();
+      stack.pop_back();
+      if (node->is_leaf())
+        continue;
+      if (node->get_feature_idx() >= thresholds.size())
+        thresholds.resize(node->get_feature_idx() + 1);
+      thresholds[node->get_feature_idx()].push_back(node->threshold);
+      stack.push_back(node->left);
+      stack.push_back(node->right);
+    }
+  }
+
+  num_features = std::max<size_t>(thresholds.size(), 1);
+  std::vector<quickrank::Feature> documents(num_docs * num_features, 0.0f);
+  std::mt19937 generator(num_docs);
+  for (size_t i = 0; i < num_docs; ++i) {
+    for (size_t f = 0; f < thresholds.size(); ++f) {
+      if (thresholds[f].empty())
+        continue;
+      // just above or just below a threshold of the feature
+      const float threshold =
+          thresholds[f][generator() % thresholds[f].size()];
+      documents[i * num_features + f] = generator() % 2 ? threshold :
+          std::nextafter(threshold, std::numeric_limits<float>::max());
+    }
+  }
+  return documents;
+}
+
+bool Ensemble::set_scoring_engine(const std::string &name,
+                                  const quickrank::Feature *sample,
+                                  size_t num_docs, size_t num_features) {
+  std::string engine_name(name);
+  std::transform(engine_name.begin(), engine_name.end(), engine_name.begin(),
+                 ::toupper);
+
+  std::shared_ptr<quickrank::scoring::ScoringEngine> engine;
+  if (engine_name == "AUTO") {
+    std::vector<quickrank::Feature> synthetic;
+    if (!sample || !num_docs) {
+      synthetic = synthetic_documents(CALIBRATION_DOCS, num_features);
+      sample = synthetic.data();
+    }
+    num_docs = std::min<size_t>(num_docs ? num_docs : CALIBRATION_DOCS,
+                                CALIBRATION_DOCS);
+
+    std::cout << "# Scoring engine calibration on " << num_docs
+              << (synthetic.empty() ? " sample" : " synthetic")
+              << " documents:" << std::endl;
+    std::vector<quickrank::Score> scores(num_docs);
+    double best_time = 0.0;
+    for (const auto &candidate: quickrank::scoring::scoring_engine_names()) {
+      auto candidate_engine = build_engine(candidate);
+      if (!candidate_engine)
+        continue;
+      // best of a few runs (a single one for slow engines)
+      double time = 0.0, total_time = 0.0;
+      for (size_t run = 0; run < CALIBRATION_RUNS
+          && total_time < CALIBRATION_SECONDS; ++run) {
+        auto chrono_start = std::chrono::high_resolution_clock::now();
+        candidate_engine->add_scores(sample, num_docs, num_features,
+                                     scores.data());
+        std::chrono::duration<double> elapsed =
+            std::chrono::high_resolution_clock::now() - chrono_start;
+        time = run ? std::min(time, elapsed.count()) : elapsed.count();
+        total_time += elapsed.count();
+      }
+      // formatted aside, not to change the precision of std::cout
+      std::ostringstream timing;
+      timing << std::setprecision(3) << time * 1000.0;
+      std::cout << "#\t " << candidate << ": " << timing.str() << " ms."
+                << std::endl;
+      if (!engine || time < best_time) {
+        engine = candidate_engine;
+        best_time = time;
+      }
+    }
+  } else {
+    engine = build_engine(engine_name);
+  }
+
+  if (!engine)
+    return false;
+  std::cout << "# Scoring engine: " << engine->name() << std::endl;
+
+  std::lock_guard<std::mutex> lock(engine_mutex_);
+  engine_name_ = engine->name();
+  engine_ = engine;
+  return true;
+}
+
+void Ensemble::set_default_scoring_engine(const std::string &name) {
+  std::lock_guard<std::mutex> lock(engine_mutex_);
+  engine_name_ = name;
+  engine_.reset();
+}
+
+void Ensemble::score_instances(const quickrank::Feature *d, size_t num_docs,
+                               size_t num_features,
+                               quickrank::Score *scores) const {
+  std::shared_ptr<const quickrank::scoring::ScoringEngine> engine;
+  {
+    std::lock_guard<std::mutex> lock(engine_mutex_);
+    if (!engine_)
+      engine_ = build_engine(engine_name_);
+    if (!engine_)
+      engine_ = build_engine(quickrank::scoring::VPred::NAME_);
+    engine = engine_;
+  }
+
+  std::fill(scores, scores + num_docs, 0.0);
+  engine->add_scores(d, num_docs, num_features, scores);
+}
+
 std::shared_ptr<std::vector<quickrank::Score>>
 Ensemble::partial_scores_instance(const quickrank::Feature *d,
                                   bool ignore_weights,
@@ -147,12 +319,13 @@ pugi::xml_node Ensemble::append_xml_model(pugi::xml_node parent) const {
 }
 
 bool Ensemble::filter_out_zero_weighted_trees() {
+  engine_.reset();
 
   size_t idx_curr = 0;
   for (size_t i = 0; i < size; ++i) {
     if (arr[i].weight == 0) {
       // Remove 0-weight tree
-      delete arr[i].root;
+      delete arr[i].nodes;
     } else {
       // Check if we need to move back the tree in the array of root trees
       if (idx_curr < i)
@@ -180,6 +353,7 @@ bool Ensemble::update_ensemble_weights(
 
   for (size_t i = 0; i < size; ++i)
     arr[i].weight = weights[i];
+  engine_.reset();
 
   if (remove)
     return filter_out_zero_weighted_trees();
@@ -21,6 +21,10 @@
  */
 #include "learning/tree/ot.h"
 
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
 #ifdef _OPENMP
 #include <omp.h>
 #else
@@ -31,52 +35,96 @@
 
 void ObliviousRT::fit(RTNodeHistogram *hist,
                       size_t *sampleids) {
+  if (treedepth > 16) {
+    std::cerr << "!!! Oblivious trees deeper than 16 levels are not supported."
+              << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  const size_t nfeatures = training_dataset->num_features();
+  sampleids_ = sampleids;
+  nsampleids_ = hist->count[0][hist->thresholds_size[0] - 1];
+
+  // bins of all the features, one after the other, in a histogram row
+  bin_offsets_.assign(nfeatures + 1, 0);
+  for (size_t f = 0; f < nfeatures; ++f)
+    bin_offsets_[f + 1] = bin_offsets_[f] + hist->thresholds_size[f];
+
+  nodes.reset(new RTNodeArena(POWTWO(treedepth + 1) - 1));
+  root = nodes->create(0.0);
+  leaf_nodes_.assign(1, root);
+
+  if (treedepth <= 8) {
+    leaf_ids_.assign(training_dataset->num_instances(), 0);
+    fit_levels(hist, leaf_ids_);
+  } else {
+    wide_leaf_ids_.assign(training_dataset->num_instances(), 0);
+    fit_levels(hist, wide_leaf_ids_);
+  }
+}
+
+template<typename LeafId>
+void ObliviousRT::fit_levels(RTNodeHistogram *hist,
+                             std::vector<LeafId> &leaf_ids) {
+  const size_t nfeatures = training_dataset->num_features();
+  const size_t nbins = bin_offsets_.back();
 
-  size_t nfeaturesamples = training_dataset->num_features();
-  //histarray and nodearray store histograms and treenodes used in the entire procedure (i.e. the entire tree)
-  RTNode **nodearray = new RTNode *[POWTWO(treedepth + 1)](); //initialized NULL
-  //init tree root
-  nodearray[0] = root = new RTNode(sampleids, hist);
-  //allocate a matrix for each (feature,threshold)
-  double **sum_scores = new double *[nfeaturesamples];
-  for (size_t i = 0; i < nfeaturesamples; ++i)
-    sum_scores[i] = new double[hist->thresholds_size[i]];
-  //tree computation
+  // the histogram of the root is the one of the samples, the largest
+  // histogram has a row for every leaf of the last but one level
+  const size_t max_rows = treedepth > 1 ? POWTWO(treedepth - 1) : 1;
+  LevelHistogram level;
+  level.sumlbl.reserve(max_rows * nbins);
+  level.count.reserve(max_rows * nbins);
+  level.sumlbl.resize(nbins);
+  level.count.resize(nbins);
+  level.rows.assign(1, 0);
+  for (size_t f = 0; f < nfeatures; ++f) {
+    std::copy(hist->sumlbl[f], hist->sumlbl[f] + hist->thresholds_size[f],
+              level.sumlbl.begin() + bin_offsets_[f]);
+    std::copy(hist->count[f], hist->count[f] + hist->thresholds_size[f],
+              level.count.begin() + bin_offsets_[f]);
+  }
+
+  const int nth = omp_get_num_procs();
+  std::vector<double> thread_maxscore(nth);
+  std::vector<size_t> thread_best_featureidx(nth);
+  std::vector<size_t> thread_best_thresholdid(nth);
   for (size_t depth = 0; depth < treedepth; ++depth) {
-    const size_t lbegin = POWTWO(depth)
-        - 1;  //index of first histogram belonging to the current level
-    const size_t lend = POWTWO(depth + 1)
-        - 1;  //index of first histogram belonging to the next level
-    //init matrix to zero
-#pragma omp parallel for
-    for (size_t i = 0; i < nfeaturesamples; ++i) {
-      const size_t thresholds_size = hist->thresholds_size[i];
-      for (size_t j = 0; j < thresholds_size; ++j)
-        sum_scores[i][j] = 0.0;
-    }
-    //for each histogram on the current depth (i.e. fringe) add variance of each (feature,threshold) in sumvar matrix
-    for (size_t i = lbegin; i < lend; ++i)
-      fill(sum_scores, nfeaturesamples, nodearray[i]->hist);
-    //find best split in the matrix
-    const int nth = omp_get_num_procs();
-    double *thread_maxscore = new double[nth];  // double thread_minvar[nth];
-    size_t *thread_best_featureidx =
-        new size_t[nth];  // size_t thread_best_featureidx[nth];
-    size_t *thread_best_thresholdid =
-        new size_t[nth];  // size_t thread_best_thresholdid[nth];
-    for (int i = 0; i < nth; ++i) {
-      thread_maxscore[i] = 0.0;
-      thread_best_featureidx[i] = uint_max;
-      thread_best_thresholdid[i] = uint_max;
-    }
+    const size_t nleaves = POWTWO(depth);
+    std::fill(thread_maxscore.begin(), thread_maxscore.end(), 0.0);
+    std::fill(thread_best_featureidx.begin(), thread_best_featureidx.end(),
+              uint_max);
+    std::fill(thread_best_thresholdid.begin(), thread_best_thresholdid.end(),
+              uint_max);
+
+    //find the split maximizing the sum over the leaves of lvar+rvar
 #pragma omp parallel for
-    for (size_t f = 0; f < nfeaturesamples; ++f) {
+    for (size_t f = 0; f < nfeatures; ++f) {
       const int ith = omp_get_thread_num();
       const size_t threshold_size = hist->thresholds_size[f];
+      std::vector<double> sum_scores(threshold_size, 0.0);
+      for (size_t leaf = 0; leaf < nleaves; ++leaf) {
+        const size_t row = level.rows[leaf] * nbins + bin_offsets_[f];
+        const double *sumlabels = &level.sumlbl[row];
+        const size_t *samplecount = &level.count[row];
+        const double s = sumlabels[threshold_size - 1];
+        const size_t c = samplecount[threshold_size - 1];
+        for (size_t t = 0; t < threshold_size; ++t)
+          if (sum_scores[t] != invalid) {
+            const size_t lcount = samplecount[t];
+            const size_t rcount = c - lcount;
+            if (lcount >= minls && rcount >= minls) {
+              const double lsum = sumlabels[t];
+              const double rsum = s - lsum;
+              sum_scores[t] += lsum * lsum / lcount + rsum * rsum / rcount;
+            } else
+              sum_scores[t] = invalid;
+          }
+      }
       for (size_t t = 0; t < threshold_size; ++t)
-        if (sum_scores[f][t] != invalid
-            && sum_scores[f][t] > thread_maxscore[ith]) {
-          thread_maxscore[ith] = sum_scores[f][t];
+        if (sum_scores[t] != invalid
+            && sum_scores[t] > thread_maxscore[ith]) {
+          thread_maxscore[ith] = sum_scores[t];
           thread_best_featureidx[ith] = f;
           thread_best_thresholdid[ith] = t;
         }
@@ -90,114 +138,168 @@ void ObliviousRT::fit(RTNodeHistogram *hist,
         best_featureidx = thread_best_featureidx[i];
         best_thresholdid = thread_best_thresholdid[i];
       }
-    delete[] thread_maxscore;
-    delete[] thread_best_featureidx;
-    delete[] thread_best_thresholdid;
     if (max_score == invalid || max_score == 0.0)
-      break;  //node is unsplittable
-    //init next depth
+      break;  //level is unsplittable
+
+    //every leaf of the level is split by the same feature and threshold
+    const float best_threshold =
+        hist->thresholds[best_featureidx][best_thresholdid];
+    std::vector<RTNode *> children(2 * nleaves);
+    for (size_t leaf = 0; leaf < nleaves; ++leaf) {
+      RTNode *node = leaf_nodes_[leaf];
+      node->left = children[2 * leaf] = nodes->create(0.0);
+      node->right = children[2 * leaf + 1] = nodes->create(0.0);
+      node->set_feature(best_featureidx,
+                        training_dataset->feature_id(best_featureidx));
+      node->threshold = best_threshold;
+    }
+    leaf_nodes_.swap(children);
+
+    //the leaf index of every sample gains the bit of its side
+    if (hist->store) {
+      std::vector<size_t> lsamples(nsampleids_), rsamples(nsampleids_);
+      size_t lsize = 0, rsize = 0;
+      hist->store->partition(best_featureidx, best_thresholdid, sampleids_,
+                             nsampleids_, lsamples.data(), lsize,
+                             rsamples.data(), rsize);
+#pragma omp parallel for
+      for (size_t i = 0; i < lsize; ++i)
+        leaf_ids[lsamples[i]] = 2 * leaf_ids[lsamples[i]];
 #pragma omp parallel for
-    for (size_t i = lbegin; i < lend; ++i) {
-      RTNode *node = nodearray[i];
-      //calculate some values related to best_featureidx and best_thresholdid
-      const size_t last_thresholdid =
-          node->hist->thresholds_size[best_featureidx] - 1;
-      const size_t lcount =
-          node->hist->count[best_featureidx][best_thresholdid];
-      const size_t rcount =
-          node->hist->count[best_featureidx][last_thresholdid] - lcount;
-      const float best_threshold =
-          node->hist->thresholds[best_featureidx][best_thresholdid];
-      //split samples between left and right child
-      size_t *lsamples = new size_t[lcount], lsize = 0;
-      size_t *rsamples = new size_t[rcount], rsize = 0;
-      float const *features = training_dataset->at(0,
-                                                   best_featureidx);  //training_set->get_fvector(best_featureidx);
-      for (size_t j = 0, nsampleids = node->nsampleids; j < nsampleids;
-           ++j) {
-        const size_t k = node->sampleids[j];
-        if (features[k] <= best_threshold)
-          lsamples[lsize++] = k;
-        else
-          rsamples[rsize++] = k;
+      for (size_t i = 0; i < rsize; ++i)
+        leaf_ids[rsamples[i]] = 2 * leaf_ids[rsamples[i]] + 1;
+    } else {
+      float const *features = training_dataset->at(0, best_featureidx);
+#pragma omp parallel for
+      for (size_t i = 0; i < nsampleids_; ++i) {
+        const size_t k = sampleids_[i];
+        leaf_ids[k] = 2 * leaf_ids[k] + !(features[k] <= best_threshold);
+      }
+    }
+
+    //histograms of the next level (except for the last one)
+    if (depth != treedepth - 1)
+      split_histogram(hist, nleaves, leaf_ids, level);
+  }
+}
+
+template<typename LeafId>
+void ObliviousRT::split_histogram(RTNodeHistogram const *hist,
+                                  size_t nparents,
+                                  const std::vector<LeafId> &leaf_ids,
+                                  LevelHistogram &level) const {
+  const size_t nfeatures = training_dataset->num_features();
+  const size_t nbins = bin_offsets_.back();
+
+  // right children take the rows of their parents, left ones new rows
+  std::vector<size_t> rows(2 * nparents);
+  for (size_t p = 0; p < nparents; ++p) {
+    rows[2 * p] = nparents + p;
+    rows[2 * p + 1] = level.rows[p];
+  }
+  level.rows.swap(rows);
+  level.sumlbl.resize(2 * nparents * nbins, 0.0);
+  level.count.resize(2 * nparents * nbins, 0);
+
+  // samples of the left children (even leaf indices), grouped by child and
+  // in order of sample id within a child
+  std::vector<size_t> offsets(nparents + 1, 0);
+  for (size_t i = 0; i < nsampleids_; ++i) {
+    const LeafId leaf = leaf_ids[sampleids_[i]];
+    if (!(leaf & 1))
+      ++offsets[leaf / 2 + 1];
+  }
+  for (size_t p = 0; p < nparents; ++p)
+    offsets[p + 1] += offsets[p];
+  std::vector<size_t> lsamples(offsets.back());
+  std::vector<size_t> positions(offsets.begin(), offsets.end() - 1);
+  for (size_t i = 0; i < nsampleids_; ++i) {
+    const LeafId leaf = leaf_ids[sampleids_[i]];
+    if (!(leaf & 1))
+      lsamples[positions[leaf / 2]++] = sampleids_[i];
+  }
+
+  if (hist->store) {
+    std::vector<double *> sumlbl(nfeatures);
+    std::vector<size_t *> count(nfeatures);
+    for (size_t p = 0; p < nparents; ++p) {
+      const size_t row = (nparents + p) * nbins;
+      for (size_t f = 0; f < nfeatures; ++f) {
+        sumlbl[f] = &level.sumlbl[row + bin_offsets_[f]];
+        count[f] = &level.count[row + bin_offsets_[f]];
       }
-      //create new histograms (except for the last level when nodes are leaves)
-      RTNodeHistogram *lhist = NULL;
-      RTNodeHistogram *rhist = NULL;
-      if (depth != treedepth - 1) {
-        lhist = new RTNodeHistogram(node->hist, lsamples, lsize,
-                                    training_labels);
-        if (node == root)
-          rhist = new RTNodeHistogram(node->hist, lhist);
-        else {
-          //save some new/delete by converting parent histogram into the right-child one
-          node->hist->transform_intorightchild(lhist);
-          rhist = node->hist;
-          node->hist = NULL;
+      hist->store->histogram(&lsamples[offsets[p]], offsets[p + 1] - offsets[p],
+                             training_labels, sumlbl.data(), count.data());
+    }
+  }
+
+  //cumulate the left children and subtract them from their parents
+#pragma omp parallel for
+  for (size_t f = 0; f < nfeatures; ++f) {
+    const size_t threshold_size = hist->thresholds_size[f];
+    for (size_t p = 0; p < nparents; ++p) {
+      double *lsumlbl = &level.sumlbl[(nparents + p) * nbins + bin_offsets_[f]];
+      size_t *lcount = &level.count[(nparents + p) * nbins + bin_offsets_[f]];
+      if (!hist->store) {
+        const size_t *stmap = hist->stmap[f];
+        for (size_t i = offsets[p]; i < offsets[p + 1]; ++i) {
+          const size_t s = lsamples[i];
+          lsumlbl[stmap[s]] += training_labels[s];
+          lcount[stmap[s]]++;
         }
-        //update current node
-        node->left = nodearray[2 * i + 1] = new RTNode(lsamples, lhist);
-        node->right = nodearray[2 * i + 2] = new RTNode(rsamples, rhist);
-      } else {
-        const double lsum =
-            node->hist->sumlbl[best_featureidx][best_thresholdid];
-        const double rsum =
-            node->hist->sumlbl[best_featureidx][last_thresholdid] - lsum;
-        node->left = nodearray[2 * i + 1] = new RTNode(lsamples, lsize,
-                                                       lsum / lsize);
-        node->right = nodearray[2 * i + 2] = new RTNode(rsamples, rsize,
-                                                        rsum / rsize);
       }
-      node->set_feature(
-          best_featureidx,
-          best_featureidx + 1 /*training_set->get_featureid(best_featureidx)*/);
-      node->threshold = best_threshold;
-      // node->deviance = minvar;
-      //free mem
-      if (depth) {
-        delete node->hist, delete[] node->sampleids;
-        node->hist = NULL, node->sampleids = NULL, node->nsampleids = 0;
+      for (size_t t = 1; t < threshold_size; ++t) {
+        lsumlbl[t] += lsumlbl[t - 1];
+        lcount[t] += lcount[t - 1];
+      }
+      double *rsumlbl = &level.sumlbl[level.rows[2 * p + 1] * nbins
+          + bin_offsets_[f]];
+      size_t *rcount = &level.count[level.rows[2 * p + 1] * nbins
+          + bin_offsets_[f]];
+      for (size_t t = 0; t < threshold_size; ++t) {
+        rsumlbl[t] -= lsumlbl[t];
+        rcount[t] -= lcount[t];
       }
     }
   }
-  //visit tree and save leaves in a leaves[] array
-  size_t capacity = nrequiredleaves;
-  leaves = capacity ? (RTNode **) malloc(sizeof(RTNode *) * capacity) : NULL,
-      nleaves =
-          0;
-  root->save_leaves(leaves, nleaves, capacity);
-  //free mem allocated for sumvar[][]
-  for (size_t i = 0; i < nfeaturesamples; ++i)
-    delete[] sum_scores[i];
-  delete[] sum_scores,
-      //delete temp data
-      delete[] nodearray;
 }
 
-void ObliviousRT::fill(double **sumvar, const size_t nfeaturesamples,
-                       RTNodeHistogram const *hist) {
-#pragma omp parallel for
-  for (size_t f = 0; f < nfeaturesamples; ++f) {
-    //define pointer shortcuts
-    double *sumlabels = hist->sumlbl[f];
-    size_t *samplecount = hist->count[f];
-    //get last elements
-    size_t threshold_size = hist->thresholds_size[f];
-    double s = sumlabels[threshold_size - 1];
-    size_t c = samplecount[threshold_size - 1];
-    //looking for the feature that minimizes sum of lvar+rvar
-    for (size_t t = 0; t < threshold_size; ++t)
-      if (sumvar[f][t] != invalid) {
-        size_t lcount = samplecount[t];
-        size_t rcount = c - lcount;
-        if (lcount >= minls && rcount >= minls) {
-          double lsum = sumlabels[t];
-          double rsum = s - lsum;
-          sumvar[f][t] += lsum * lsum / lcount + rsum * rsum / rcount;
-        } else
-          sumvar[f][t] = invalid;
-      }
+template<typename LeafId>
+double ObliviousRT::set_outputs(const std::vector<LeafId> &leaf_ids,
+                                double const *numerators,
+                                double const *denominators) {
+  std::vector<double> s1(leaf_nodes_.size(), 0.0);
+  std::vector<double> s2(leaf_nodes_.size(), 0.0);
+  for (size_t i = 0; i < nsampleids_; ++i) {
+    const size_t k = sampleids_[i];
+    s1[leaf_ids[k]] += numerators[k];
+    s2[leaf_ids[k]] += denominators ? denominators[k] : 1.0;
   }
+
+  double maxlabel = -DBL_MAX;
+  for (size_t leaf = 0; leaf < leaf_nodes_.size(); ++leaf) {
+    RTNode *node = leaf_nodes_[leaf];
+    if (denominators)
+      node->avglabel = s2[leaf] >= DBL_EPSILON ? s1[leaf] / s2[leaf] : 0.0;
+    else
+      node->avglabel = s1[leaf] / s2[leaf];
+    if (node->avglabel > maxlabel)
+      maxlabel = node->avglabel;
+  }
+  return maxlabel;
+}
+
+double ObliviousRT::update_output(double const *pseudoresponses) {
+  if (treedepth <= 8)
+    return set_outputs(leaf_ids_, pseudoresponses, nullptr);
+  return set_outputs(wide_leaf_ids_, pseudoresponses, nullptr);
+}
+
+double ObliviousRT::update_output(double const *pseudoresponses,
+                                  double const *cachedweights) {
+  if (treedepth <= 8)
+    return set_outputs(leaf_ids_, pseudoresponses, cachedweights);
+  return set_outputs(wide_leaf_ids_, pseudoresponses, cachedweights);
 }
 
 #undef POWTWO
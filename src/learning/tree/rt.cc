@@ -31,19 +31,27 @@
 #include "utils/omp-stubs.h"
 #endif
 
-/// \todo TODO: memory management of regression tree is wrong!!!
 RegressionTree::~RegressionTree() {
   // if leaves[0] is the root, hist cannot be deallocated and sampleids has
-  // been already deallocated
-  for (size_t i = 0; i < nleaves; ++i)
-    if (leaves[i] != root) {
-      delete[] leaves[i]->sampleids;
-      delete leaves[i]->hist;
-      leaves[i]->hist = NULL;
-      leaves[i]->sampleids = NULL;
-      leaves[i]->nsampleids = 0;
+  // been already deallocated. Nodes are released with their arena, if the
+  // tree has not been added to an ensemble.
+  for (RTNodeTraining *leaf: leaves)
+    if (leaf != training_root) {
+      delete[] leaf->sampleids;
+      delete leaf->hist;
+      leaf->hist = NULL;
+      leaf->sampleids = NULL;
+      leaf->nsampleids = 0;
     }
-  free(leaves);
+}
+
+void RegressionTree::save_leaves(RTNodeTraining *node) {
+  if (node->node->is_leaf()) {
+    leaves.push_back(node);
+  } else {
+    save_leaves(node->left);
+    save_leaves(node->right);
+  }
 }
 
 void RegressionTree::fit(RTNodeHistogram *hist,
@@ -54,17 +62,20 @@ void RegressionTree::fit(RTNodeHistogram *hist,
   size_t n_nodes = 1; // root
   double max_deviance = 0.0;
 
-  root = new RTNode(sampleids, hist);
-  if (split(root, max_features, false)) {
-    heap.push(root->left->deviance, root->left);
-    heap.push(root->right->deviance, root->right);
+  // a tree with n leaves has 2n-1 nodes
+  nodes.reset(new RTNodeArena(nrequiredleaves ? 2 * nrequiredleaves - 1 : 0));
+  training_root = create_node(0.0, sampleids, hist);
+  root = training_root->node;
+  if (split(training_root, max_features, false)) {
+    heap.push(training_root->left->deviance, training_root->left);
+    heap.push(training_root->right->deviance, training_root->right);
     n_nodes += 2;
-    max_deviance = root->deviance;
+    max_deviance = training_root->deviance;
   }
   while (heap.is_notempty() &&
       (nrequiredleaves == 0 or taken + heap.get_size() < nrequiredleaves)) {
     //get node with highest deviance from heap
-    RTNode *node = heap.top();
+    RTNodeTraining *node = heap.top();
     heap.pop();
 
     // TODO: Cla missing check non leaf size or avoid putting them into the heap
@@ -83,7 +94,8 @@ void RegressionTree::fit(RTNodeHistogram *hist,
     delete node->hist;
     node->hist = NULL;
 
-    if (!collapse_leaves_factor && node != root && !node->is_leaf()) {
+    if (!collapse_leaves_factor && node != training_root
+        && !node->node->is_leaf()) {
       delete[] node->sampleids;
       node->sampleids = NULL;
     }
@@ -94,37 +106,38 @@ void RegressionTree::fit(RTNodeHistogram *hist,
 
     rt_maxheap_enriched heap_nodes(n_nodes);
     // Add the root
-    heap_nodes.push(0, new RTNodeEnriched(root, nullptr, 0));
+    heap_nodes.push(0, new RTNodeEnriched(training_root, nullptr, 0));
     // Full the heap of nodes, navigating the tree
-    tree_heap_nodes(heap_nodes, root, 0, max_deviance);
+    tree_heap_nodes(heap_nodes, training_root, 0, max_deviance);
 
     while (heap_nodes.is_notempty()) {
 
       RTNodeEnriched* enriched_node = heap_nodes.top();
 
       // We skip leaf already merged in the parent node!
-      if (enriched_node->depth > 0 && !enriched_node->parent->is_leaf()) {
+      if (enriched_node->depth > 0
+          && !enriched_node->parent->node->is_leaf()) {
 
         auto max_n_nodes = pow(2, enriched_node->depth + 1) - 1;
 
         if (n_nodes > max_n_nodes * collapse_leaves_factor)
           break;
 
-        // lets the parent become a leaf node (and delete the two children)
-        if (enriched_node->parent->left->hist != NULL)
-          delete enriched_node->parent->left->hist;
-        delete[] enriched_node->parent->left->sampleids;
-        delete enriched_node->parent->left;
-        enriched_node->parent->left = NULL;
-
-        if (enriched_node->parent->right->hist != NULL)
-          delete enriched_node->parent->right->hist;
-        delete[] enriched_node->parent->right->sampleids;
-        delete enriched_node->parent->right;
-        enriched_node->parent->right = NULL;
+        // lets the parent become a leaf node (and drop the two children,
+        // whose nodes stay unused in the arena)
+        RTNodeTraining *parent = enriched_node->parent;
+        for (RTNodeTraining *child: {parent->left, parent->right}) {
+          delete child->hist;
+          delete[] child->sampleids;
+          child->hist = NULL;
+          child->sampleids = NULL;
+          child->nsampleids = 0;
+        }
+        parent->left = parent->right = NULL;
+        parent->node->left = parent->node->right = NULL;
 
-        enriched_node->parent->threshold = 0.0f;
-        enriched_node->parent->set_feature(uint_max, uint_max);
+        parent->node->threshold = 0.0f;
+        parent->node->set_feature(uint_max, uint_max);
 
           --n_leaves;
         n_nodes -= 2;
@@ -138,7 +151,8 @@ void RegressionTree::fit(RTNodeHistogram *hist,
     while (heap_nodes.is_notempty()) {
       RTNodeEnriched* enriched_node = heap_nodes.top();
 
-      if (enriched_node->node != root && !enriched_node->node->is_leaf()) {
+      if (enriched_node->node != training_root
+          && !enriched_node->node->node->is_leaf()) {
         // Free useless resources in RTNode
         if (enriched_node->node->sampleids != NULL)
           delete[] enriched_node->node->sampleids;
@@ -152,12 +166,9 @@ void RegressionTree::fit(RTNodeHistogram *hist,
   }
 
   //visit tree and save leaves in a leaves[] array
-  size_t capacity = nrequiredleaves > 0 ? n_leaves : 0;
-  leaves = capacity ?
-           (RTNode **) malloc(sizeof(RTNode *) * capacity) :
-           NULL;
-  nleaves = 0;
-  root->save_leaves(leaves, nleaves, capacity);
+  leaves.clear();
+  leaves.reserve(n_leaves);
+  save_leaves(training_root);
 
   // TODO: (by cla) is memory of "unpopped" de-allocated?
 }
@@ -165,7 +176,7 @@ void RegressionTree::fit(RTNodeHistogram *hist,
 double RegressionTree::update_output(double const *pseudoresponses) {
   double maxlabel = -DBL_MAX;
   #pragma omp parallel for reduction(max:maxlabel)
-  for (size_t i = 0; i < nleaves; ++i) {
+  for (size_t i = 0; i < leaves.size(); ++i) {
     double psum = 0.0f;
     const size_t nsampleids = leaves[i]->nsampleids;
     const size_t *sampleids = leaves[i]->sampleids;
@@ -175,10 +186,10 @@ double RegressionTree::update_output(double const *pseudoresponses) {
     }
     // Set the output value of the leaf to the mean pseudo-response of the
     // samples ending in it.
-    leaves[i]->avglabel = psum / nsampleids;
+    leaves[i]->node->avglabel = psum / nsampleids;
 
-    if (leaves[i]->avglabel > maxlabel)
-      maxlabel = leaves[i]->avglabel;
+    if (leaves[i]->node->avglabel > maxlabel)
+      maxlabel = leaves[i]->node->avglabel;
   }
   return maxlabel;
 }
@@ -187,7 +198,7 @@ double RegressionTree::update_output(double const *pseudoresponses,
                                      double const *cachedweights) {
   double maxlabel = -DBL_MAX;
   #pragma omp parallel for reduction(max:maxlabel)
-  for (size_t i = 0; i < nleaves; ++i) {
+  for (size_t i = 0; i < leaves.size(); ++i) {
     double s1 = 0.0;
     double s2 = 0.0;
     const size_t nsampleids = leaves[i]->nsampleids;
@@ -197,16 +208,16 @@ double RegressionTree::update_output(double const *pseudoresponses,
       s1 += pseudoresponses[k];
       s2 += cachedweights[k];
     }
-    leaves[i]->avglabel = s2 >= DBL_EPSILON ? s1 / s2 : 0.0;
+    leaves[i]->node->avglabel = s2 >= DBL_EPSILON ? s1 / s2 : 0.0;
 
-    if (leaves[i]->avglabel > maxlabel)
-      maxlabel = leaves[i]->avglabel;
+    if (leaves[i]->node->avglabel > maxlabel)
+      maxlabel = leaves[i]->node->avglabel;
   }
 
   return maxlabel;
 }
 
-bool RegressionTree::split(RTNode *node, const float max_features,
+bool RegressionTree::split(RTNodeTraining *node, const float max_features,
                            const bool require_devianceltparent) {
 
   if (node->deviance > 0.0f) {
@@ -236,8 +247,10 @@ bool RegressionTree::split(RTNode *node, const float max_features,
       for (size_t i = 0; i < nfeatures; ++i)
         featuresamples[i] = i;
 
-      // shuffle the sample idx
-      auto seed = std::chrono::system_clock::now().time_since_epoch().count();
+      // shuffle the sample idx (the node makes the seed unique among the
+      // trees grown at once by a random forest)
+      auto seed = std::chrono::system_clock::now().time_since_epoch().count()
+          + (size_t) node;
       auto rng = std::default_random_engine(seed);
       std::shuffle(&featuresamples[0], &featuresamples[nfeatures], rng);
     }
@@ -324,20 +337,26 @@ bool RegressionTree::split(RTNode *node, const float max_features,
     //split samples between left and right child
     size_t *lsamples = new size_t[lcount], lsize = 0;
     size_t *rsamples = new size_t[rcount], rsize = 0;
-    float const *features = training_dataset->at(0, best_featureidx);
-    for (size_t i = 0; i < node->nsampleids; ++i) {
-      size_t s = node->sampleids[i];
-      if (features[s] <= best_threshold)
-        lsamples[lsize++] = s;
-      else
-        rsamples[rsize++] = s;
+    if (h->store) {
+      h->store->partition(best_featureidx, best_thresholdid,
+                          node->sampleids, node->nsampleids,
+                          lsamples, lsize, rsamples, rsize);
+    } else {
+      float const *features = training_dataset->at(0, best_featureidx);
+      for (size_t i = 0; i < node->nsampleids; ++i) {
+        size_t s = node->sampleids[i];
+        if (features[s] <= best_threshold)
+          lsamples[lsize++] = s;
+        else
+          rsamples[rsize++] = s;
+      }
     }
 
     //create histograms for children
     RTNodeHistogram *lhist = new RTNodeHistogram(node->hist, lsamples, lsize,
                                                  training_labels);
     RTNodeHistogram *rhist = NULL;
-    if (node == root)
+    if (node == training_root)
       rhist = new RTNodeHistogram(node->hist, lhist);
     else {
       //save some new/delete by converting parent histogram into the right-child one
@@ -347,14 +366,16 @@ bool RegressionTree::split(RTNode *node, const float max_features,
     }
 
     //update current node
-    node->set_feature(
+    node->node->set_feature(
         best_featureidx,
-        best_featureidx + 1);
-    node->threshold = best_threshold;
+        training_dataset->feature_id(best_featureidx));
+    node->node->threshold = best_threshold;
 
     //create children
-    node->left = new RTNode(lsamples, lhist);
-    node->right = new RTNode(rsamples, rhist);
+    node->left = create_node(0.0, lsamples, lhist);
+    node->right = create_node(0.0, rsamples, rhist);
+    node->node->left = node->left->node;
+    node->node->right = node->right->node;
 
     return true;
   }
@@ -362,11 +383,12 @@ bool RegressionTree::split(RTNode *node, const float max_features,
 }
 
 size_t inline RegressionTree::tree_heap_nodes(rt_maxheap_enriched& heap,
-                                              RTNode* node, size_t depth,
+                                              RTNodeTraining* node,
+                                              size_t depth,
                                               double max_deviance) {
 
   // key of maxheap ranges in [depth, depth+1]
-  if (!node->is_leaf()) {
+  if (!node->node->is_leaf()) {
 
     heap.push(depth+1 + node->left->deviance / max_deviance,
               new RTNodeEnriched(node->left, node, depth+1));
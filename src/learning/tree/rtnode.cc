@@ -26,25 +26,13 @@
 #include <cstring>
 
 #include "learning/tree/rtnode.h"
+#include "learning/tree/rtnode_arena.h"
+#include "utils/dtoa.h"
 
 #ifdef QUICKRANK_PERF_STATS
 std::atomic<std::uint_fast64_t>RTNode::_internal_nodes_traversed = {0};
 #endif
 
-void RTNode::save_leaves(RTNode **&leaves, size_t &nleaves,
-                         size_t &capacity) {
-  if (featureidx == uint_max) {
-    if (nleaves == capacity) {
-      capacity = 2 * capacity + 1;
-      leaves = (RTNode **) realloc(leaves, sizeof(RTNode *) * capacity);
-    }
-    leaves[nleaves++] = this;
-  } else {
-    left->save_leaves(leaves, nleaves, capacity);
-    right->save_leaves(leaves, nleaves, capacity);
-  }
-}
-
 pugi::xml_node RTNode::append_xml_model(pugi::xml_node parent,
                                         const std::string &pos) const {
 
@@ -76,7 +64,8 @@ pugi::xml_node RTNode::append_xml_model(pugi::xml_node parent,
   return split;
 }
 
-RTNode *RTNode::parse_xml(const pugi::xml_node &split_xml) {
+RTNode *RTNode::parse_xml(const pugi::xml_node &split_xml,
+                          RTNodeArena &nodes) {
   RTNode *model_node = NULL;
   RTNode *left_child = NULL;
   RTNode *right_child = NULL;
@@ -90,28 +79,35 @@ RTNode *RTNode::parse_xml(const pugi::xml_node &split_xml) {
   for (const pugi::xml_node &split_child: split_xml.children()) {
 
     if (strcmp(split_child.name(), "output") == 0) {
-      prediction = split_child.text().as_double();
+      prediction = chars_to_double(split_child.child_value());
       is_leaf = true;
       break;
     } else if (strcmp(split_child.name(), "feature") == 0) {
       feature_id = split_child.text().as_uint();
     } else if (strcmp(split_child.name(), "threshold") == 0) {
-      threshold = split_child.text().as_float();
+      threshold = chars_to_float(split_child.child_value());
     } else if (strcmp(split_child.name(), "split") == 0) {
       std::string pos = split_child.attribute("pos").value();
       if (pos == "left")
-        left_child = RTNode::parse_xml(split_child);
+        left_child = RTNode::parse_xml(split_child, nodes);
       else
-        right_child = RTNode::parse_xml(split_child);
+        right_child = RTNode::parse_xml(split_child, nodes);
     }
   }
 
   if (is_leaf)
-    model_node = new RTNode(prediction);
+    model_node = nodes.create(prediction);
   else
     /// \todo TODO: this should be changed with item mapping
-    model_node = new RTNode(threshold, feature_id - 1, feature_id, left_child,
-                            right_child);
+    model_node = nodes.create(threshold, feature_id - 1, feature_id,
+                              left_child, right_child);
 
   return model_node;
 }
+
+size_t RTNode::count_xml_nodes(const pugi::xml_node &split_xml) {
+  size_t count = 1;
+  for (const pugi::xml_node &split_child: split_xml.children("split"))
+    count += count_xml_nodes(split_child);
+  return count;
+}
@@ -0,0 +1,40 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "learning/tree/rtnode_arena.h"
+
+#include <algorithm>
+
+const size_t RTNodeArena::MIN_BLOCK_NODES;
+
+RTNodeArena::~RTNodeArena() {
+  for (RTNode *block: blocks_)
+    ::operator delete(block);
+}
+
+void RTNodeArena::add_block() {
+  block_capacity_ = blocks_.empty() ?
+                    std::max(first_capacity_, MIN_BLOCK_NODES) :
+                    2 * block_capacity_;
+  block_ = (RTNode *) ::operator new(block_capacity_ * sizeof(RTNode));
+  blocks_.push_back(block_);
+  used_ = 0;
+}
@@ -47,14 +47,20 @@ RTNodeHistogram::RTNodeHistogram(RTNodeHistogram const *parent,
                       parent->nfeatures) {
 
   stmap = parent->stmap;
+  store = parent->store;
+
+  if (store)
+    store->histogram(sampleids, nsampleids, labels, sumlbl, count);
 
   #pragma omp parallel for
   for (size_t f = 0; f < nfeatures; ++f) {
-    for (size_t i = 0; i < nsampleids; ++i) {
-      const size_t s = sampleids[i];
-      const size_t t = stmap[f][s];
-      sumlbl[f][t] += labels[s];
-      count[f][t]++;
+    if (!store) {
+      for (size_t i = 0; i < nsampleids; ++i) {
+        const size_t s = sampleids[i];
+        const size_t t = stmap[f][s];
+        sumlbl[f][t] += labels[s];
+        count[f][t]++;
+      }
     }
     for (size_t t = 1; t < thresholds_size[f]; ++t) {
       sumlbl[f][t] += sumlbl[f][t - 1];
@@ -75,6 +81,7 @@ RTNodeHistogram::RTNodeHistogram(RTNodeHistogram const *parent,
                       parent->thresholds_size,
                       parent->nfeatures) {
   stmap = parent->stmap;
+  store = parent->store;
 
   #pragma omp parallel for
   for (size_t f = 0; f < nfeatures; ++f) {
@@ -89,6 +96,7 @@ RTNodeHistogram::RTNodeHistogram(RTNodeHistogram const *parent,
 RTNodeHistogram::RTNodeHistogram(const RTNodeHistogram& source)
     : nfeatures(source.nfeatures) {
   squares_sum_ = source.squares_sum_;
+  store = source.store;
 
   thresholds_size = new size_t[nfeatures];
   for (unsigned int f=0; f<nfeatures; ++f) {
@@ -103,11 +111,13 @@ RTNodeHistogram::RTNodeHistogram(const RTNodeHistogram& source)
     }
   }
 
-  stmap = new size_t*[nfeatures];
-  for (unsigned int f=0; f<nfeatures; ++f) {
-    stmap[f] = new size_t[thresholds_size[f]];
-    for (unsigned int t=0; t<thresholds_size[f]; ++t) {
-      stmap[f][t] = source.stmap[f][t];
+  if (source.stmap) {
+    stmap = new size_t*[nfeatures];
+    for (unsigned int f=0; f<nfeatures; ++f) {
+      stmap[f] = new size_t[thresholds_size[f]];
+      for (unsigned int t=0; t<thresholds_size[f]; ++t) {
+        stmap[f][t] = source.stmap[f][t];
+      }
     }
   }
 
@@ -180,14 +190,19 @@ void RTNodeHistogram::update(double *labels,
     }
   }
 
+  if (store)
+    store->histogram(sampleids, nsampleids, labels, sumlbl, count);
+
   #pragma omp parallel for
   for (size_t f = 0; f < nfeatures; ++f) {
-    for (size_t j = 0; j < nsampleids; ++j) {
-      const size_t s = sampleids[j];
-      const size_t t = stmap[f][s];
-      sumlbl[f][t] += labels[s];
-      count[f][t]++;
-      //count change, so we need to re-compute it!!
+    if (!store) {
+      for (size_t j = 0; j < nsampleids; ++j) {
+        const size_t s = sampleids[j];
+        const size_t t = stmap[f][s];
+        sumlbl[f][t] += labels[s];
+        count[f][t]++;
+        //count change, so we need to re-compute it!!
+      }
     }
 
     for (size_t t = 1; t < thresholds_size[f]; ++t) {
@@ -252,8 +267,17 @@ RTRootHistogram::RTRootHistogram(quickrank::data::VerticalDataset *dataset,
   }
 }
 
+RTRootHistogram::RTRootHistogram(
+    const quickrank::data::BinnedFeatures *store,
+    float **thresholds, size_t *thresholds_size)
+    : RTNodeHistogram(thresholds, thresholds_size, store->num_features()) {
+  this->store = store;
+}
+
 RTRootHistogram::~RTRootHistogram() {
-  for (size_t i = 0; i < nfeatures; ++i)
-    delete[] stmap[i];
-  delete[] stmap;
+  if (stmap) {
+    for (size_t i = 0; i < nfeatures; ++i)
+      delete[] stmap[i];
+    delete[] stmap;
+  }
 }
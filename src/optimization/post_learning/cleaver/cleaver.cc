@@ -419,7 +419,7 @@ void Cleaver::optimize(
 
 void Cleaver::score(data::Dataset *dataset, Score *scores) const {
 
-  Feature *features = dataset->at(0, 0);
+  const Feature *features = dataset->at(0, 0);
 #pragma omp parallel for
   for (unsigned int s = 0; s < dataset->num_instances(); ++s) {
     size_t offset_feature = s * dataset->num_features();
@@ -53,7 +53,7 @@ void QualityLossPruning::pruning(std::set<unsigned int> &pruned_estimators,
   // Score the dataset with initial weights
   score(dataset.get(), &dataset_score[0]);
 
-  Feature *features = dataset->at(0, 0);
+  const Feature *features = dataset->at(0, 0);
 
   std::vector<Score> new_dataset_score(dataset->num_instances(), 0);
 
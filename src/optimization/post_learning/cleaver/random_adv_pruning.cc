@@ -48,7 +48,7 @@ void RandomAdvPruning::pruning(std::set<unsigned int> &pruned_estimators,
   std::vector<Score> dataset_score(dataset->num_instances());
   score(dataset.get(), &dataset_score[0]);
 
-  Feature *features = dataset->at(0, 0);
+  const Feature *features = dataset->at(0, 0);
 
   /* initialize random seed: */
   srand(time(NULL));
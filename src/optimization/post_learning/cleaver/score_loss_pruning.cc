@@ -53,7 +53,7 @@ void ScoreLossPruning::pruning(std::set<unsigned int> &pruned_estimators,
   // compute the score of each instance
   this->score(dataset.get(), &instance_scores[0]);
 
-  Feature *features = dataset->at(0, 0);
+  const Feature *features = dataset->at(0, 0);
 
   #pragma omp parallel for
   for (size_t f = start_last; f < num_features; ++f) {
@@ -42,6 +42,8 @@
 
 #include "paramsmap/paramsmap.h"
 
+#include "io/generate_tree_blocks.h"
+
 #include "learning/forests/mart.h"
 #include "learning/forests/dart.h"
 #include "learning/forests/lambdamart.h"
@@ -55,6 +57,11 @@
 #include "learning/custom/custom_ltr.h"
 #include "learning/meta/meta_cleaver.h"
 #include "optimization/post_learning/cleaver/cleaver.h"
+#include "scoring/fixed_depth.h"
+#include "scoring/native_scorer.h"
+#include "scoring/oblivious.h"
+#include "scoring/tree_visit.h"
+#include "scoring/vpred.h"
 
 #include "metric/ir/tndcg.h"
 #include "metric/ir/map.h"
@@ -107,10 +114,15 @@ int main(int argc, char *argv[]) {
   size_t train_cutoff = 10;
   std::string test_metric_string = quickrank::metric::ir::Ndcg::NAME_;
   size_t test_cutoff = 10;
+  size_t test_chunk_size = 0;
+  std::string scoring_engine = "AUTO";
   size_t partial_save = 100;
+  std::string feature_precision = "FP32";
+  std::string partial_format = "SVML";
   float subsample = 1.0f;
   float max_features = 1.0f;
   float collapse_leaves_factor = 0;
+  size_t shard_size = 1 << 20;
   int sampling_iterations = 0;
   float rank_sampling_factor = 1.0;
   float random_sampling_factor = 0.0;
@@ -130,6 +142,7 @@ int main(int argc, char *argv[]) {
   double rate_drop = 0.1;
   double skip_drop = 0;
   double random_keep = 0;
+  size_t leaf_cache_mb = 1024;
 
   // ------------------------------------------
   // Coordinate ascent added by Chiara Pierucci
@@ -194,7 +207,29 @@ int main(int argc, char *argv[]) {
 
   pmap.addOptionWithArg<std::string>("valid", {"set validation file."});
 
-  pmap.addOptionWithArg<std::string>("features", {"set features file."});
+  pmap.addOptionWithArg<std::string>("features",
+                                     {"set features file, i.e., the feature",
+                                      "ids or ranges to be loaded",
+                                      "(e.g., 1 5 10-20)."});
+
+  pmap.addOption("sparse", {"load datasets in sparse format, storing only",
+                            "non-zero features [training applies only to",
+                            "MART/LambdaMART/RandomForest/ObliviousMART/",
+                            "ObliviousLambdaMART]."});
+
+  pmap.addOptionWithArg("feature-precision",
+                        {"set the precision of the features",
+                         "stored in memory: [FP32|FP16|BF16]",
+                         "[training with FP16/BF16 applies only",
+                         "to MART/LambdaMART/RandomForest/",
+                         "ObliviousMART/ObliviousLambdaMART]."},
+                        feature_precision);
+
+  pmap.addOptionWithArg<std::string>("shared-dataset",
+                                     {"share the datasets with other",
+                                      "processes through shared memory",
+                                      "segments with the given name,",
+                                      "attached if already published."});
 
   pmap.addOptionWithArg<std::string>("model-in",
                                      {"set input model file",
@@ -240,6 +275,11 @@ int main(int argc, char *argv[]) {
                          "base learners."},
                         subsample);
 
+  pmap.addOption("no-bootstrap",
+                 {"draw the samples of every tree without replacement",
+                  "(always done by binned training)",
+                  "[applies only to RandomForest]."});
+
   pmap.addOptionWithArg("max-features",
                         {"The number of features to consider when looking for",
                          "the best split."},
@@ -252,6 +292,18 @@ int main(int argc, char *argv[]) {
                          "the tree given its depth (if 0 disabled)."},
                         collapse_leaves_factor);
 
+  pmap.addOptionWithArg<std::string>("out-of-core",
+                                     {"train out-of-core, storing discretized",
+                                      "features in memory-mapped shard files",
+                                      "created in the given directory",
+                                      "[applies only to MART/LambdaMART/",
+                                      "RandomForest/ObliviousMART/",
+                                      "ObliviousLambdaMART]."});
+
+  pmap.addOptionWithArg("shard-size",
+                        {"set min. number of instances per out-of-core shard."},
+                        shard_size);
+
   pmap.addOptionWithArg("sampling-iterations",
                         {"describe the number of iterations between two ",
                          "consecutive dataset sampling operations.",
@@ -364,6 +416,15 @@ int main(int argc, char *argv[]) {
   pmap.addOption("drop-on-best",
                  {"Perform the drop-out based on best perfomance (o/w last)"});
 
+  pmap.addOptionWithArg("leaf-cache-mb",
+                        {"set memory (MB) caching the leaves of the trees "
+                             "for every dataset,",
+                         "making dropouts cheaper (if 0 disabled)."},
+                        leaf_cache_mb);
+
+  pmap.addOption("leaf-cache-spill",
+                 {"spill the leaves exceeding the leaf cache to disk."});
+
   // --------------------------------------------------------
   // CoordinateAscent and LineSearch options
   // add by Chiara Pierucci and Salvatore Trani
@@ -402,6 +463,12 @@ int main(int argc, char *argv[]) {
   pmap.addOptionWithArg<std::string>("valid-partial",
                                      {"set validation file with partial scores",
                                       "(input for loading or output for saving)."});
+  pmap.addOptionWithArg("partial-format",
+                        {"set the format of the partial scores files",
+                         "being written (also by --detailed):",
+                         "[SVML|BINARY] [binary files are",
+                         "detected and read as any input dataset]."},
+                        partial_format);
 
 
   // --------------------------------------------------------
@@ -473,9 +540,36 @@ int main(int argc, char *argv[]) {
 
   pmap.addOptionWithArg<std::string>("scores", {"set output scores file."});
 
+  pmap.addOptionWithArg("test-chunk-size",
+                        {"stream the test file in chunks of at least",
+                         "the given number of instances (0 loads",
+                         "the whole file) [not with --detailed]."},
+                        test_chunk_size);
+
   pmap.addOption("detailed",
                  {"enable detailed testing [applies only to ensemble models]."});
 
+  pmap.addOptionWithArg("scoring-engine",
+                        {"engine scoring the test data [AUTO|"
+                             + quickrank::scoring::VPred::NAME_ + "|"
+                             + quickrank::scoring::FixedDepth::NAME_ + "|"
+                             + quickrank::scoring::ObliviousScorer::NAME_ + "|"
+                             + quickrank::scoring::TreeVisit::NAME_ + "|"
+                             + quickrank::scoring::NativeScorer::NAME_ + "],",
+                         "AUTO chooses the fastest one for the model",
+                         "(NATIVE is never chosen, as it compiles the",
+                         "model) [applies only to ensemble models]."},
+                        scoring_engine);
+
+  pmap.addOptionWithArg<std::string>("native-cache",
+                                     {"set the directory where NATIVE models",
+                                      "are compiled and cached",
+                                      "[default $HOME/.cache/quickrank]."});
+
+  pmap.addOptionWithArg<std::string>("native-compiler",
+                                     {"set the command compiling NATIVE",
+                                      "models [default cc -O2 -march=native]."});
+
 
   // --------------------------------------------------------
   pmap.addMessage({"Code generation - general options:"});
@@ -491,6 +585,27 @@ int main(int argc, char *argv[]) {
                          "-  \"vpred\" (intermediate code used by VPRED)."},
                         std::string("condop"));
 
+  pmap.addOptionWithArg("code-style",
+                        {"set the code of the trees generated by condop:",
+                         "-  \"ternary\" (conditional operators),",
+                         "-  \"ifelse\" (if-else statements),",
+                         "-  \"array\" (visit of arrays of nodes)."},
+                        std::string("ternary"));
+
+  pmap.addOptionWithArg("code-trees-per-file",
+                        {"set the max number of trees of a generated",
+                         "source file (condop and oblivious)."},
+                        quickrank::io::GenTreeBlocks::DEFAULT_TREES_PER_FILE);
+
+  // --------------------------------------------------------
+  pmap.addMessage({"Model conversion - general options:"});
+  pmap.addOptionWithArg<std::string>("binary-model",
+                                     {"convert the XML model of a tree ensemble",
+                                      "given by --model-file to a binary model."});
+
+  pmap.addOptionWithArg<std::string>("xml-model",
+                                     {"convert the binary model given by",
+                                      "--model-file to a XML model."});
 
   // --------------------------------------------------------
   pmap.addMessage({"Help options:"});
@@ -24,11 +24,14 @@
 #include <iomanip>
 #include <chrono>
 #include <vector>
+#include <unistd.h>
 
 #include "paramsmap/paramsmap.h"
 
 #include "data/dataset.h"
 #include "io/svml.h"
+#include "learning/ltr_algorithm.h"
+#include "scoring/native_scorer.h"
 
 void print_logo() {
   if (isatty(fileno(stdout))) {
@@ -60,6 +63,8 @@ void print_logo() {
 }
 
 double ranker(float *v);
+void ranker_batch(const float *v, size_t num_docs, size_t num_features,
+                  double *scores);
 
 int main(int argc, char *argv[]) {
   print_logo();
@@ -74,6 +79,21 @@ int main(int argc, char *argv[]) {
   pmap.addOptionWithArg<int>("rounds", "r", {"Number of test repetitions"}, 10);
   pmap.addOptionWithArg<std::string>("scores", "s",
                                      {"File where scores are saved (Optional)."});
+  pmap.addOptionWithArg<std::string>("model", "m",
+                                     {"Model scored by the given engine",
+                                      "instead of the compiled ranker_batch()",
+                                      "(Optional)."});
+  pmap.addOptionWithArg<std::string>("engine", "e",
+                                     {"Scoring engine of the model",
+                                      "[AUTO|VPRED|UNROLLED|OBLIVIOUS|VISIT|",
+                                      "NATIVE]."},
+                                     std::string("NATIVE"));
+  pmap.addOptionWithArg<std::string>("native-cache",
+                                     {"Directory where NATIVE models are",
+                                      "compiled and cached (Optional)."});
+  pmap.addOptionWithArg<std::string>("native-compiler",
+                                     {"Command compiling NATIVE models",
+                                      "(Optional)."});
 
   bool parse_status = pmap.parse(argc, argv);
   if (!parse_status || pmap.isSet("help") || !pmap.isSet("dataset")) {
@@ -90,19 +110,45 @@ int main(int argc, char *argv[]) {
 
   // read dataset
   quickrank::io::Svml reader;
-  auto dataset = reader.read_horizontal(dataset_file);
+  std::shared_ptr<quickrank::data::Dataset> dataset(
+      reader.read_horizontal(dataset_file));
   std::cout << *dataset;
 
-  // score dataset
+  // the model is loaded and its engine prepared before timing
+  std::shared_ptr<quickrank::learning::LTR_Algorithm> model;
   std::vector<double> scores(dataset->num_instances());
+  if (pmap.isSet("model")) {
+    if (pmap.isSet("native-cache"))
+      quickrank::scoring::NativeScorer::set_cache_directory(
+          pmap.get<std::string>("native-cache"));
+    if (pmap.isSet("native-compiler"))
+      quickrank::scoring::NativeScorer::set_compiler(
+          pmap.get<std::string>("native-compiler"));
+    model = quickrank::learning::LTR_Algorithm::load_model_from_file(
+        pmap.get<std::string>("model"));
+    if (!model) {
+      std::cerr << "!!! Model type not supported." << std::endl;
+      return EXIT_FAILURE;
+    }
+    if (!model->set_scoring_engine(pmap.get<std::string>("engine"),
+                                   dataset)) {
+      std::cerr << "!!! Scoring engine " << pmap.get<std::string>("engine")
+                << " is not available for this model." << std::endl;
+      return EXIT_FAILURE;
+    }
+    model->score_dataset(dataset, &scores[0]);
+  }
+
+  // score dataset
   auto start_scoring = std::chrono::high_resolution_clock::now();
 
   for (size_t r = 0; r < rounds; r++) {
-    float *document = dataset->at(0, 0);
-    for (size_t i = 0; i < dataset->num_instances(); i++) {
-      scores[i] = ranker(document);
-      document += dataset->num_features();
+    if (model) {
+      model->score_dataset(dataset, &scores[0]);
+      continue;
     }
+    ranker_batch(dataset->at(0, 0), dataset->num_instances(),
+                 dataset->num_features(), &scores[0]);
   }
 
   auto end_scoring = std::chrono::high_resolution_clock::now();
@@ -0,0 +1,176 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "scoring/fixed_depth.h"
+
+#include <algorithm>
+
+#include "scoring/fixed_depth_tree.h"
+
+namespace quickrank {
+namespace scoring {
+
+const std::string FixedDepth::NAME_ = "UNROLLED";
+
+const unsigned int FixedDepth::MAX_DEPTH;
+const size_t FixedDepth::BATCH_DOCS;
+
+namespace fixed_depth {
+
+unsigned int tree_depth(const RTNode *node) {
+  if (node->is_leaf())
+    return 0;
+  return 1 + std::max(tree_depth(node->left), tree_depth(node->right));
+}
+
+bool read_oblivious_tree(const RTNode *root, unsigned int depth,
+                         std::vector<uint32_t> &features,
+                         std::vector<float> &thresholds,
+                         std::vector<double> &leaves) {
+  std::vector<const RTNode *> level(1, root);
+  for (unsigned int l = 0; l < depth; ++l) {
+    std::vector<const RTNode *> next;
+    for (const RTNode *node: level) {
+      if (node->is_leaf()
+          || node->get_feature_idx() != level[0]->get_feature_idx()
+          || !(node->threshold == level[0]->threshold))
+        return false;
+      next.push_back(node->left);
+      next.push_back(node->right);
+    }
+    features.push_back(level[0]->get_feature_idx());
+    thresholds.push_back(level[0]->threshold);
+    level.swap(next);
+  }
+  for (const RTNode *node: level) {
+    if (!node->is_leaf())
+      return false;
+    leaves.push_back(node->avglabel);
+  }
+  return true;
+}
+
+}  // namespace fixed_depth
+
+template<unsigned int DEPTH, bool OBLIVIOUS>
+void FixedDepth::add_tree_scores(const FixedDepth &engine, size_t tree,
+                                 const quickrank::Feature *d, size_t num_docs,
+                                 size_t num_features,
+                                 quickrank::Score *scores) {
+  const uint32_t *features =
+      engine.features_.data() + engine.node_offsets_[tree];
+  const float *thresholds =
+      engine.thresholds_.data() + engine.node_offsets_[tree];
+  const double *leaves = engine.leaves_.data() + engine.leaf_offsets_[tree];
+  const double weight = engine.weights_[tree];
+  for (size_t i = 0; i < num_docs; ++i, d += num_features) {
+    const size_t leaf = OBLIVIOUS ?
+        oblivious_tree_leaf<DEPTH>(features, thresholds, d) :
+        complete_tree_leaf<DEPTH>(features, thresholds, d);
+    scores[i] += leaves[leaf] * weight;
+  }
+}
+
+bool FixedDepth::add_tree(const RTNode *root, double weight) {
+  // evaluators of every depth, up to MAX_DEPTH
+  static const tree_scorer complete_scorers[MAX_DEPTH + 1] = {
+      &add_tree_scores<0, false>, &add_tree_scores<1, false>,
+      &add_tree_scores<2, false>, &add_tree_scores<3, false>,
+      &add_tree_scores<4, false>, &add_tree_scores<5, false>,
+      &add_tree_scores<6, false>, &add_tree_scores<7, false>,
+      &add_tree_scores<8, false>, &add_tree_scores<9, false>,
+      &add_tree_scores<10, false>};
+  static const tree_scorer oblivious_scorers[MAX_DEPTH + 1] = {
+      &add_tree_scores<0, true>, &add_tree_scores<1, true>,
+      &add_tree_scores<2, true>, &add_tree_scores<3, true>,
+      &add_tree_scores<4, true>, &add_tree_scores<5, true>,
+      &add_tree_scores<6, true>, &add_tree_scores<7, true>,
+      &add_tree_scores<8, true>, &add_tree_scores<9, true>,
+      &add_tree_scores<10, true>};
+
+  const unsigned int depth = fixed_depth::tree_depth(root);
+  if (depth > MAX_DEPTH)
+    return false;
+
+  node_offsets_.push_back(features_.size());
+  leaf_offsets_.push_back(leaves_.size());
+  weights_.push_back(weight);
+
+  std::vector<uint32_t> features;
+  std::vector<float> thresholds;
+  std::vector<double> leaves;
+  if (fixed_depth::read_oblivious_tree(root, depth, features, thresholds,
+                                       leaves)) {
+    features_.insert(features_.end(), features.begin(), features.end());
+    thresholds_.insert(thresholds_.end(), thresholds.begin(),
+                       thresholds.end());
+    leaves_.insert(leaves_.end(), leaves.begin(), leaves.end());
+    scorers_.push_back(oblivious_scorers[depth]);
+    ++num_oblivious_;
+  } else {
+    const size_t num_nodes = (size_t(1) << depth) - 1;
+    features_.resize(features_.size() + num_nodes, 0);
+    thresholds_.resize(thresholds_.size() + num_nodes, 0.0f);
+    leaves_.resize(leaves_.size() + num_nodes + 1, 0.0);
+    add_complete_node(root, 0, depth, node_offsets_.back(),
+                      leaf_offsets_.back(), num_nodes);
+    scorers_.push_back(complete_scorers[depth]);
+  }
+  return true;
+}
+
+void FixedDepth::add_complete_node(const RTNode *node, size_t index,
+                                   unsigned int levels, size_t node_offset,
+                                   size_t leaf_offset, size_t num_nodes) {
+  if (levels == 0) {
+    leaves_[leaf_offset + index - num_nodes] = node->avglabel;
+    return;
+  }
+  // a shallower leaf is replicated below a dummy split
+  const RTNode *left = node, *right = node;
+  if (!node->is_leaf()) {
+    features_[node_offset + index] = node->get_feature_idx();
+    thresholds_[node_offset + index] = node->threshold;
+    left = node->left;
+    right = node->right;
+  }
+  add_complete_node(left, 2 * index + 1, levels - 1, node_offset, leaf_offset,
+                    num_nodes);
+  add_complete_node(right, 2 * index + 2, levels - 1, node_offset,
+                    leaf_offset, num_nodes);
+}
+
+void FixedDepth::add_scores(const quickrank::Feature *d, size_t num_docs,
+                            size_t num_features,
+                            quickrank::Score *scores) const {
+  const size_t num_batches = (num_docs + BATCH_DOCS - 1) / BATCH_DOCS;
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t batch = 0; batch < num_batches; ++batch) {
+    const size_t begin = batch * BATCH_DOCS;
+    const size_t end = std::min(num_docs, begin + BATCH_DOCS);
+    for (size_t t = 0; t < scorers_.size(); ++t)
+      scorers_[t](*this, t, d + begin * num_features, end - begin,
+                  num_features, scores + begin);
+  }
+}
+
+}  // namespace scoring
+}  // namespace quickrank
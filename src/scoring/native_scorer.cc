@@ -0,0 +1,318 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "scoring/native_scorer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <dlfcn.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "utils/fileutils.h"
+
+namespace quickrank {
+namespace scoring {
+
+const std::string NativeScorer::NAME_ = "NATIVE";
+
+const size_t NativeScorer::BLOCK_NODES;
+const size_t NativeScorer::BATCH_DOCS;
+
+std::string NativeScorer::cache_directory_;
+std::string NativeScorer::compiler_ = "cc -O2 -march=native";
+
+namespace {
+
+// products and sums of the generated code are rounded as the ones of the
+// other engines, which compilers fuse when FMA instructions are available
+#ifdef __FP_FAST_FMA
+const bool FUSED_MULTIPLY_ADD = true;
+#else
+const bool FUSED_MULTIPLY_ADD = false;
+#endif
+
+// exact C literal of a double (or float) value
+std::string c_literal(double value, bool single_precision) {
+  if (std::isnan(value))
+    return "NAN";
+  if (std::isinf(value))
+    return value > 0 ? "INFINITY" : "-INFINITY";
+  char literal[64];
+  snprintf(literal, sizeof(literal), single_precision ? "%af" : "%a", value);
+  return literal;
+}
+
+void generate_node(const RTNode *node, size_t indent, std::ostream &os) {
+  const std::string spaces(indent, ' ');
+  if (node->is_leaf()) {
+    os << spaces << "return " << c_literal(node->avglabel, false) << ";\n";
+    return;
+  }
+  os << spaces << "if (v[" << node->get_feature_idx() << "] <= "
+     << c_literal(node->threshold, true) << ") {\n";
+  generate_node(node->left, indent + 2, os);
+  os << spaces << "} else {\n";
+  generate_node(node->right, indent + 2, os);
+  os << spaces << "}\n";
+}
+
+size_t count_nodes(const RTNode *node) {
+  return node->is_leaf() ? 1 :
+         1 + count_nodes(node->left) + count_nodes(node->right);
+}
+
+// 64 bits FNV-1a hash
+uint64_t fnv1a(const std::string &data, uint64_t hash) {
+  for (unsigned char c: data) {
+    hash ^= c;
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+bool make_directories(const std::string &path) {
+  for (size_t pos = path.find('/', 1); ; pos = path.find('/', pos + 1)) {
+    const std::string dir = path.substr(0, pos);
+    if (mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST) {
+      std::cerr << "!!! Error creating directory " << dir << std::endl;
+      return false;
+    }
+    if (pos == std::string::npos)
+      return true;
+  }
+}
+
+// the cache of the users without a home is a directory of their own in /tmp,
+// not to load libraries other users could have written
+bool make_private_directory(const std::string &path) {
+  struct stat info;
+  if (mkdir(path.c_str(), 0700) != 0 && errno != EEXIST) {
+    std::cerr << "!!! Error creating directory " << path << std::endl;
+    return false;
+  }
+  if (lstat(path.c_str(), &info) != 0 || !S_ISDIR(info.st_mode)
+      || info.st_uid != getuid() || (info.st_mode & 077) != 0) {
+    std::cerr << "!!! Directory " << path << " is not a private directory "
+              << "of the user, set a cache directory with --native-cache."
+              << std::endl;
+    return false;
+  }
+  return true;
+}
+
+std::string quote(const std::string &path) {
+  std::string quoted = "'";
+  for (char c: path)
+    quoted += c == '\'' ? std::string("'\\''") : std::string(1, c);
+  return quoted + "'";
+}
+
+}  // namespace
+
+NativeScorer::~NativeScorer() {
+  if (library_)
+    dlclose(library_);
+}
+
+bool NativeScorer::add_tree(const RTNode *root, double weight) {
+  roots_.push_back(root);
+  weights_.push_back(weight);
+  return true;
+}
+
+std::vector<std::string> NativeScorer::generate_sources() const {
+  std::vector<std::string> sources;
+  std::ostringstream main_source;
+  main_source << "/* QuickRank native scorer: " << roots_.size()
+              << " trees */\n#include <stddef.h>\n\n";
+  std::ostringstream calls;
+
+  size_t t = 0;
+  while (t < roots_.size()) {
+    const size_t block = sources.size();
+    std::ostringstream source;
+    source << "/* QuickRank native scorer: trees from " << t << " */\n"
+           << "#include <math.h>\n#include <stddef.h>\n\n";
+    // trees are added to the block until it is full
+    const size_t first = t;
+    size_t nodes = 0;
+    for (; t < roots_.size() && (t == first || nodes < BLOCK_NODES); ++t) {
+      nodes += count_nodes(roots_[t]);
+      source << "static double tree_" << t << "(const float *v) {\n";
+      generate_node(roots_[t], 2, source);
+      source << "}\n\n";
+    }
+
+    // trees are summed in order, as by the other engines
+    source << "void quickrank_block_" << block
+           << "(const float *d, size_t num_docs, size_t num_features,\n"
+           << "    double *scores) {\n"
+           << "  size_t i;\n"
+           << "  for (i = 0; i < num_docs; ++i) {\n"
+           << "    const float *v = d + i * num_features;\n"
+           << "    double score = scores[i];\n";
+    for (size_t i = first; i < t; ++i) {
+      if (FUSED_MULTIPLY_ADD)
+        source << "    score = fma(tree_" << i << "(v), "
+               << c_literal(weights_[i], false) << ", score);\n";
+      else
+        source << "    score += tree_" << i << "(v) * "
+               << c_literal(weights_[i], false) << ";\n";
+    }
+    source << "    scores[i] = score;\n  }\n}\n";
+    sources.push_back(source.str());
+
+    main_source << "void quickrank_block_" << block
+                << "(const float *, size_t, size_t, double *);\n";
+    calls << "  quickrank_block_" << block
+          << "(d, num_docs, num_features, scores);\n";
+  }
+
+  main_source << "\nvoid quickrank_score(const float *d, size_t num_docs,\n"
+              << "    size_t num_features, double *scores) {\n"
+              << calls.str() << "}\n";
+  sources.push_back(main_source.str());
+  return sources;
+}
+
+bool NativeScorer::prepare() {
+  if (!score_)
+    load();
+  return score_ != nullptr;
+}
+
+void NativeScorer::load() {
+  const std::vector<std::string> sources = generate_sources();
+
+  // the model is identified by its code and by the compiler
+  uint64_t hash = fnv1a(compiler_, 0xcbf29ce484222325ULL);
+  for (const auto &source: sources)
+    hash = fnv1a(source, hash);
+  char key[17];
+  snprintf(key, sizeof(key), "%016llx", (unsigned long long) hash);
+
+  std::string cache = cache_directory_;
+  if (cache.empty() && getenv("HOME")) {
+    cache = std::string(getenv("HOME")) + "/.cache/quickrank";
+    if (!make_directories(cache))
+      return;
+  } else if (cache.empty()) {
+    cache = "/tmp/quickrank-cache-" + std::to_string(getuid());
+    if (!make_private_directory(cache))
+      return;
+  } else if (!make_directories(cache)) {
+    return;
+  }
+  const std::string library = cache + "/" + key + ".so";
+
+  if (!file_exist(library)) {
+    std::cout << "# Compiling native scorer: " << sources.size()
+              << " source files" << std::endl;
+
+    // files of this process, the library is then renamed atomically
+    const std::string prefix = cache + "/" + key + "."
+        + std::to_string(getpid()) + ".";
+    std::vector<std::string> objects(sources.size());
+    bool failed = false;
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t i = 0; i < sources.size(); ++i) {
+      const std::string source_file = prefix + std::to_string(i) + ".c";
+      objects[i] = prefix + std::to_string(i) + ".o";
+      std::ofstream(source_file) << sources[i];
+      const std::string command = compiler_ + " -fPIC -c " + quote(source_file)
+          + " -o " + quote(objects[i]);
+      if (std::system(command.c_str()) != 0) {
+        #pragma omp critical(native_scorer_failure)
+        {
+          std::cerr << "!!! Error compiling native scorer: " << command
+                    << std::endl;
+          failed = true;
+        }
+      }
+      unlink(source_file.c_str());
+    }
+
+    std::string command = compiler_ + " -shared -o " + quote(prefix + "so");
+    for (const auto &object: objects)
+      command += " " + quote(object);
+    command += " -lm";
+    if (!failed && std::system(command.c_str()) != 0) {
+      std::cerr << "!!! Error building native scorer: " << command
+                << std::endl;
+      failed = true;
+    }
+    if (!failed && rename((prefix + "so").c_str(), library.c_str()) != 0) {
+      std::cerr << "!!! Error creating native scorer " << library
+                << std::endl;
+      failed = true;
+    }
+    for (const auto &object: objects)
+      unlink(object.c_str());
+    if (failed) {
+      unlink((prefix + "so").c_str());
+      return;
+    }
+  }
+
+  library_ = dlopen(library.c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (library_)
+    score_ = (score_function) dlsym(library_, "quickrank_score");
+  if (!score_) {
+    std::cerr << "!!! Error loading native scorer " << library << ": "
+              << dlerror() << std::endl;
+    return;
+  }
+  std::cout << "# Native scorer: " << library << std::endl;
+}
+
+void NativeScorer::add_scores(const quickrank::Feature *d, size_t num_docs,
+                              size_t num_features,
+                              quickrank::Score *scores) const {
+  // trees are visited if the engine could not be prepared
+  if (!score_) {
+    #pragma omp parallel for
+    for (size_t i = 0; i < num_docs; ++i)
+      for (size_t t = 0; t < roots_.size(); ++t)
+        scores[i] += roots_[t]->score_instance(d + i * num_features, 1)
+            * weights_[t];
+    return;
+  }
+
+  const size_t num_batches = (num_docs + BATCH_DOCS - 1) / BATCH_DOCS;
+  #pragma omp parallel for
+  for (size_t b = 0; b < num_batches; ++b) {
+    const size_t begin = b * BATCH_DOCS;
+    score_(d + begin * num_features,
+           std::min(num_docs, begin + BATCH_DOCS) - begin, num_features,
+           scores + begin);
+  }
+}
+
+}  // namespace scoring
+}  // namespace quickrank
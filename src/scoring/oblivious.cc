@@ -0,0 +1,170 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "scoring/oblivious.h"
+
+#include <algorithm>
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "scoring/fixed_depth.h"
+
+namespace quickrank {
+namespace scoring {
+
+#if defined(__AVX512F__)
+static const size_t OBLIVIOUS_WIDTH = 16;
+#elif defined(__AVX2__)
+static const size_t OBLIVIOUS_WIDTH = 8;
+#else
+static const size_t OBLIVIOUS_WIDTH = 1;
+#endif
+
+const std::string ObliviousScorer::NAME_ = "OBLIVIOUS";
+
+const unsigned int ObliviousScorer::MAX_DEPTH;
+const size_t ObliviousScorer::TILE_DOCS;
+
+size_t ObliviousScorer::width() {
+  return OBLIVIOUS_WIDTH;
+}
+
+bool ObliviousScorer::add_tree(const RTNode *root, double weight) {
+  const unsigned int depth = fixed_depth::tree_depth(root);
+  if (depth > MAX_DEPTH)
+    return false;
+
+  std::vector<uint32_t> features;
+  std::vector<float> thresholds;
+  std::vector<double> leaves;
+  if (!fixed_depth::read_oblivious_tree(root, depth, features, thresholds,
+                                        leaves))
+    return false;
+
+  level_offsets_.push_back(features_.size());
+  leaf_offsets_.push_back(leaves_.size());
+  depths_.push_back(depth);
+  weights_.push_back(weight);
+  features_.insert(features_.end(), features.begin(), features.end());
+  thresholds_.insert(thresholds_.end(), thresholds.begin(), thresholds.end());
+  leaves_.insert(leaves_.end(), leaves.begin(), leaves.end());
+  for (uint32_t f: features) {
+    auto column = std::find(used_features_.begin(), used_features_.end(), f);
+    columns_.push_back((uint32_t) (column - used_features_.begin()));
+    if (column == used_features_.end())
+      used_features_.push_back(f);
+  }
+  return true;
+}
+
+void ObliviousScorer::add_tile_scores(const quickrank::Feature *d,
+                                      size_t num_docs, size_t stride,
+                                      const uint32_t *columns,
+                                      quickrank::Score *scores) const {
+  for (size_t t = 0; t < weights_.size(); ++t) {
+    const uint32_t *levels = columns + level_offsets_[t];
+    const float *thresholds = thresholds_.data() + level_offsets_[t];
+    const double *leaves = leaves_.data() + leaf_offsets_[t];
+    const unsigned int depth = depths_[t];
+    const double weight = weights_[t];
+    size_t i = 0;
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+    alignas(64) int32_t ids[OBLIVIOUS_WIDTH];
+    for (; i + OBLIVIOUS_WIDTH <= num_docs; i += OBLIVIOUS_WIDTH) {
+#if defined(__AVX512F__)
+      const __m512i one = _mm512_set1_epi32(1);
+      __m512i id = _mm512_setzero_si512();
+      for (unsigned int l = 0; l < depth; ++l) {
+        const __m512 x = _mm512_loadu_ps(d + levels[l] * stride + i);
+        // documents go right if not (x <= th), NaNs included
+        const __mmask16 right = _mm512_cmp_ps_mask(
+            x, _mm512_set1_ps(thresholds[l]), _CMP_NLE_UQ);
+        id = _mm512_add_epi32(id, id);
+        id = _mm512_mask_add_epi32(id, right, id, one);
+      }
+      _mm512_store_si512((__m512i *) ids, id);
+#else
+      __m256i id = _mm256_setzero_si256();
+      for (unsigned int l = 0; l < depth; ++l) {
+        const __m256 x = _mm256_loadu_ps(d + levels[l] * stride + i);
+        // documents go right if not (x <= th), NaNs included
+        const __m256i right = _mm256_srli_epi32(_mm256_castps_si256(
+            _mm256_cmp_ps(x, _mm256_set1_ps(thresholds[l]), _CMP_NLE_UQ)),
+                                                31);
+        id = _mm256_add_epi32(_mm256_add_epi32(id, id), right);
+      }
+      _mm256_store_si256((__m256i *) ids, id);
+#endif
+      for (size_t k = 0; k < OBLIVIOUS_WIDTH; ++k)
+        scores[i + k] += leaves[ids[k]] * weight;
+    }
+#endif
+
+    for (; i < num_docs; ++i) {
+      size_t leaf = 0;
+      for (unsigned int l = 0; l < depth; ++l)
+        leaf = 2 * leaf + !(d[levels[l] * stride + i] <= thresholds[l]);
+      scores[i] += leaves[leaf] * weight;
+    }
+  }
+}
+
+void ObliviousScorer::add_scores(const quickrank::Feature *d, size_t num_docs,
+                                 size_t num_features,
+                                 quickrank::Score *scores) const {
+  const size_t num_tiles = (num_docs + TILE_DOCS - 1) / TILE_DOCS;
+  #pragma omp parallel
+  {
+    // the used features of a tile, by column
+    std::vector<quickrank::Feature> tile(used_features_.size() * TILE_DOCS);
+    #pragma omp for schedule(dynamic)
+    for (size_t t = 0; t < num_tiles; ++t) {
+      const size_t begin = t * TILE_DOCS;
+      const size_t end = std::min(num_docs, begin + TILE_DOCS);
+      for (size_t i = begin; i < end; ++i) {
+        const quickrank::Feature *doc = d + i * num_features;
+        for (size_t c = 0; c < used_features_.size(); ++c)
+          tile[c * TILE_DOCS + i - begin] = doc[used_features_[c]];
+      }
+      add_tile_scores(tile.data(), end - begin, TILE_DOCS, columns_.data(),
+                      scores + begin);
+    }
+  }
+}
+
+void ObliviousScorer::add_column_scores(const quickrank::Feature *d,
+                                        size_t num_docs, size_t stride,
+                                        quickrank::Score *scores) const {
+  const size_t num_tiles = (num_docs + TILE_DOCS - 1) / TILE_DOCS;
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t t = 0; t < num_tiles; ++t) {
+    const size_t begin = t * TILE_DOCS;
+    const size_t end = std::min(num_docs, begin + TILE_DOCS);
+    add_tile_scores(d + begin, end - begin, stride, features_.data(),
+                    scores + begin);
+  }
+}
+
+}  // namespace scoring
+}  // namespace quickrank
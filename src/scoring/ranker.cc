@@ -20,6 +20,14 @@
  *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
  */
 
+#include <cstddef>
+
 double ranker(float *v) {
   return 0;
+}
+
+void ranker_batch(const float *v, size_t num_docs, size_t num_features,
+                  double *scores) {
+  for (size_t i = 0; i < num_docs; ++i)
+    scores[i] = 0;
 }
\ No newline at end of file
@@ -0,0 +1,57 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "scoring/scoring_engine_factory.h"
+
+#include <algorithm>
+
+#include "scoring/fixed_depth.h"
+#include "scoring/native_scorer.h"
+#include "scoring/oblivious.h"
+#include "scoring/tree_visit.h"
+#include "scoring/vpred.h"
+
+namespace quickrank {
+namespace scoring {
+
+std::vector<std::string> scoring_engine_names() {
+  return {VPred::NAME_, FixedDepth::NAME_, ObliviousScorer::NAME_,
+          TreeVisit::NAME_};
+}
+
+std::shared_ptr<ScoringEngine> scoring_engine_factory(std::string name) {
+  std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+  if (name == VPred::NAME_)
+    return std::shared_ptr<ScoringEngine>(new VPred());
+  else if (name == FixedDepth::NAME_)
+    return std::shared_ptr<ScoringEngine>(new FixedDepth());
+  else if (name == ObliviousScorer::NAME_)
+    return std::shared_ptr<ScoringEngine>(new ObliviousScorer());
+  else if (name == TreeVisit::NAME_)
+    return std::shared_ptr<ScoringEngine>(new TreeVisit());
+  else if (name == NativeScorer::NAME_)
+    return std::shared_ptr<ScoringEngine>(new NativeScorer());
+  else
+    return std::shared_ptr<ScoringEngine>();
+}
+
+}  // namespace scoring
+}  // namespace quickrank
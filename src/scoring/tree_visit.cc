@@ -0,0 +1,49 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "scoring/tree_visit.h"
+
+namespace quickrank {
+namespace scoring {
+
+const std::string TreeVisit::NAME_ = "VISIT";
+
+bool TreeVisit::add_tree(const RTNode *root, double weight) {
+  roots_.push_back(root);
+  weights_.push_back(weight);
+  return true;
+}
+
+void TreeVisit::add_scores(const quickrank::Feature *d, size_t num_docs,
+                           size_t num_features,
+                           quickrank::Score *scores) const {
+  #pragma omp parallel for
+  for (size_t i = 0; i < num_docs; ++i) {
+    double score = scores[i];
+    for (size_t t = 0; t < roots_.size(); ++t)
+      score += roots_[t]->score_instance(d + i * num_features, 1)
+          * weights_[t];
+    scores[i] = score;
+  }
+}
+
+}  // namespace scoring
+}  // namespace quickrank
@@ -0,0 +1,237 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "scoring/vpred.h"
+
+#include <algorithm>
+#include <climits>
+#include <queue>
+#include <utility>
+#include <unistd.h>
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace quickrank {
+namespace scoring {
+
+#if defined(__AVX512F__)
+static const size_t VPRED_WIDTH = 16;
+#elif defined(__AVX2__)
+static const size_t VPRED_WIDTH = 8;
+#else
+static const size_t VPRED_WIDTH = 1;
+#endif
+
+const std::string VPred::NAME_ = "VPRED";
+
+const size_t VPred::DEFAULT_CACHE_SIZE;
+const size_t VPred::NODE_BYTES;
+
+size_t VPred::width() {
+  return VPRED_WIDTH;
+}
+
+bool VPred::add_tree(const RTNode *root, double weight) {
+  // breadth first visit, so that the top levels of a tree are contiguous
+  const int32_t first = (int32_t) features_.size();
+  uint32_t depth = 0;
+  std::queue<std::pair<const RTNode *, uint32_t>> queue;
+  queue.push(std::make_pair(root, 0));
+  int32_t next = first + 1;  // id of the next node to be enqueued
+  while (!queue.empty()) {
+    const RTNode *node = queue.front().first;
+    const uint32_t level = queue.front().second;
+    const int32_t id = (int32_t) features_.size();
+    queue.pop();
+    depth = std::max(depth, level);
+    if (node->is_leaf()) {
+      features_.push_back(0);
+      thresholds_.push_back(0.0f);
+      children_.push_back(id);
+      children_.push_back(id);
+      values_.push_back(node->avglabel);
+    } else {
+      features_.push_back((int32_t) node->get_feature_idx());
+      thresholds_.push_back(node->threshold);
+      children_.push_back(next++);
+      children_.push_back(next++);
+      values_.push_back(0.0);
+      queue.push(std::make_pair(node->left, level + 1));
+      queue.push(std::make_pair(node->right, level + 1));
+    }
+  }
+  roots_.push_back(first);
+  depths_.push_back(depth);
+  weights_.push_back(weight);
+  return true;
+}
+
+size_t VPred::cache_size() const {
+  if (cache_size_)
+    return cache_size_;
+  long size = 0;
+#ifdef _SC_LEVEL2_CACHE_SIZE
+  size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+#endif
+  return size > 0 ? (size_t) size : DEFAULT_CACHE_SIZE;
+}
+
+void VPred::add_scores_scalar(const quickrank::Feature *d, size_t num_docs,
+                              size_t num_features, size_t first_tree,
+                              size_t last_tree,
+                              quickrank::Score *scores) const {
+  for (size_t i = 0; i < num_docs; ++i) {
+    const quickrank::Feature *doc = d + i * num_features;
+    double score = scores[i];
+    for (size_t t = first_tree; t < last_tree; ++t) {
+      int32_t id = roots_[t];
+      for (uint32_t l = 0; l < depths_[t]; ++l)
+        id = children_[2 * id + !(doc[features_[id]] <= thresholds_[id])];
+      score += values_[id] * weights_[t];
+    }
+    scores[i] = score;
+  }
+}
+
+void VPred::add_block_scores(const quickrank::Feature *block,
+                             size_t num_features, size_t first_tree,
+                             size_t last_tree,
+                             quickrank::Score *scores) const {
+#if defined(__AVX512F__) || defined(__AVX2__)
+  const int32_t *features = features_.data();
+  const float *thresholds = thresholds_.data();
+  const int32_t *children = children_.data();
+  alignas(64) int32_t leaves[VPRED_WIDTH];
+  double acc[VPRED_WIDTH];
+  std::copy(scores, scores + VPRED_WIDTH, acc);
+
+#if defined(__AVX512F__)
+  const __m512i offsets = _mm512_mullo_epi32(
+      _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7,
+                        8, 9, 10, 11, 12, 13, 14, 15),
+      _mm512_set1_epi32((int) num_features));
+  const __m512i one = _mm512_set1_epi32(1);
+  // masked gathers with an explicit source, all lanes enabled
+  const __mmask16 all = 0xFFFF;
+  const __m512i zero = _mm512_setzero_si512();
+  const __m512 zero_ps = _mm512_setzero_ps();
+  for (size_t t = first_tree; t < last_tree; ++t) {
+    __m512i id = _mm512_set1_epi32(roots_[t]);
+    for (uint32_t l = 0; l < depths_[t]; ++l) {
+      const __m512i f = _mm512_mask_i32gather_epi32(zero, all, id, features,
+                                                    4);
+      const __m512 th = _mm512_mask_i32gather_ps(zero_ps, all, id,
+                                                 thresholds, 4);
+      const __m512 x = _mm512_mask_i32gather_ps(
+          zero_ps, all, _mm512_add_epi32(offsets, f), block, 4);
+      // documents go right if not (x <= th), NaNs included
+      const __mmask16 right = _mm512_cmp_ps_mask(x, th, _CMP_NLE_UQ);
+      const __m512i child = _mm512_mask_add_epi32(
+          _mm512_add_epi32(id, id), right, _mm512_add_epi32(id, id), one);
+      id = _mm512_mask_i32gather_epi32(zero, all, child, children, 4);
+    }
+    _mm512_store_si512((__m512i *) leaves, id);
+#else
+  const __m256i offsets = _mm256_mullo_epi32(
+      _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+      _mm256_set1_epi32((int) num_features));
+  // masked gathers with an explicit source, all lanes enabled
+  const __m256i all = _mm256_set1_epi32(-1);
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256 zero_ps = _mm256_setzero_ps();
+  for (size_t t = first_tree; t < last_tree; ++t) {
+    __m256i id = _mm256_set1_epi32(roots_[t]);
+    for (uint32_t l = 0; l < depths_[t]; ++l) {
+      const __m256i f = _mm256_mask_i32gather_epi32(zero, features, id, all,
+                                                    4);
+      const __m256 th = _mm256_mask_i32gather_ps(zero_ps, thresholds, id,
+                                                 _mm256_castsi256_ps(all), 4);
+      const __m256 x = _mm256_mask_i32gather_ps(
+          zero_ps, block, _mm256_add_epi32(offsets, f),
+          _mm256_castsi256_ps(all), 4);
+      // documents go right if not (x <= th), NaNs included
+      const __m256i right = _mm256_srli_epi32(
+          _mm256_castps_si256(_mm256_cmp_ps(x, th, _CMP_NLE_UQ)), 31);
+      const __m256i child = _mm256_add_epi32(_mm256_add_epi32(id, id),
+                                             right);
+      id = _mm256_mask_i32gather_epi32(zero, children, child, all, 4);
+    }
+    _mm256_store_si256((__m256i *) leaves, id);
+#endif
+    const double weight = weights_[t];
+    for (size_t i = 0; i < VPRED_WIDTH; ++i)
+      acc[i] += values_[leaves[i]] * weight;
+  }
+
+  std::copy(acc, acc + VPRED_WIDTH, scores);
+#else
+  add_scores_scalar(block, VPRED_WIDTH, num_features, first_tree, last_tree,
+                    scores);
+#endif
+}
+
+void VPred::add_scores(const quickrank::Feature *d, size_t num_docs,
+                       size_t num_features, quickrank::Score *scores) const {
+  // offsets of the features of a block must fit the 32 bits gather indices
+  const size_t width =
+      VPRED_WIDTH * num_features < INT32_MAX ? VPRED_WIDTH : 1;
+
+  // half of the cache holds a block of trees, half the features of a tile
+  // of documents, which is pushed through a block of trees before the next
+  const size_t half_cache = cache_size() / 2;
+  std::vector<size_t> tree_blocks(1, 0);
+  size_t block_nodes = 0;
+  for (size_t t = 0; t < roots_.size(); ++t) {
+    const size_t nodes = (t + 1 < roots_.size() ? roots_[t + 1] :
+                          features_.size()) - roots_[t];
+    if (block_nodes && (block_nodes + nodes) * NODE_BYTES > half_cache) {
+      tree_blocks.push_back(t);
+      block_nodes = 0;
+    }
+    block_nodes += nodes;
+  }
+  tree_blocks.push_back(roots_.size());
+  const size_t doc_bytes =
+      std::max<size_t>(num_features, 1) * sizeof(quickrank::Feature);
+  const size_t tile_docs =
+      std::max(width, half_cache / doc_bytes / width * width);
+  const size_t num_tiles = (num_docs + tile_docs - 1) / tile_docs;
+
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t tile = 0; tile < num_tiles; ++tile) {
+    const size_t begin = tile * tile_docs;
+    const size_t end = std::min(num_docs, begin + tile_docs);
+    const size_t full_end = width > 1 ? end - (end - begin) % width : begin;
+    for (size_t b = 0; b + 1 < tree_blocks.size(); ++b) {
+      for (size_t i = begin; i < full_end; i += width)
+        add_block_scores(d + i * num_features, num_features, tree_blocks[b],
+                         tree_blocks[b + 1], scores + i);
+      add_scores_scalar(d + full_end * num_features, end - full_end,
+                        num_features, tree_blocks[b], tree_blocks[b + 1],
+                        scores + full_end);
+    }
+  }
+}
+
+}  // namespace scoring
+}  // namespace quickrank
@@ -0,0 +1,494 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "utils/dtoa.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+// Grisu2 (F. Loitsch, "Printing Floating-Point Numbers Quickly and Accurately
+// with Integers", PLDI 2010): the boundaries of the rounding interval of the
+// value are scaled by a cached power of ten so that the digits can be
+// generated with 64 bits integers. The output is always read back as the
+// same value, and it is the shortest one for about 99.9% of the values.
+
+namespace {
+
+// A floating point number f * 2^e with a 64 bits significand.
+struct DiyFp {
+  uint64_t f;
+  int e;
+
+  DiyFp(uint64_t f, int e) : f(f), e(e) {}
+
+  DiyFp operator-(const DiyFp &y) const {
+    return DiyFp(f - y.f, e);
+  }
+
+  // product rounded to 64 bits
+  DiyFp operator*(const DiyFp &y) const {
+    const uint64_t a = f >> 32, b = f & 0xFFFFFFFFu;
+    const uint64_t c = y.f >> 32, d = y.f & 0xFFFFFFFFu;
+    const uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+    uint64_t tmp = (bd >> 32) + (ad & 0xFFFFFFFFu) + (bc & 0xFFFFFFFFu);
+    tmp += 1u << 31;  // round
+    return DiyFp(ac + (ad >> 32) + (bc >> 32) + (tmp >> 32), e + y.e + 64);
+  }
+
+  DiyFp normalize() const {
+    DiyFp x = *this;
+    while (!(x.f >> 63)) {
+      x.f <<= 1;
+      x.e--;
+    }
+    return x;
+  }
+};
+
+// The value and the boundaries of its rounding interval, normalized to the
+// same exponent.
+struct Boundaries {
+  DiyFp w;
+  DiyFp minus;
+  DiyFp plus;
+};
+
+template<typename FloatType, typename BitsType>
+Boundaries compute_boundaries(FloatType value) {
+  // precision (with the hidden bit) and exponent bias
+  const int precision = std::numeric_limits<FloatType>::digits;
+  const int bias = std::numeric_limits<FloatType>::max_exponent - 1
+      + (precision - 1);
+  const BitsType hidden_bit = BitsType(1) << (precision - 1);
+
+  BitsType bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  const BitsType biased_e = bits >> (precision - 1);
+  const BitsType mantissa = bits & (hidden_bit - 1);
+
+  const DiyFp v = biased_e == 0
+                  ? DiyFp(mantissa, 1 - bias)
+                  : DiyFp(mantissa + hidden_bit, (int) biased_e - bias);
+  // the lower boundary is closer for powers of two (but the smallest normal)
+  const bool lower_closer = mantissa == 0 && biased_e > 1;
+
+  const DiyFp plus = DiyFp(2 * v.f + 1, v.e - 1).normalize();
+  DiyFp minus = lower_closer ? DiyFp(4 * v.f - 1, v.e - 2)
+                             : DiyFp(2 * v.f - 1, v.e - 1);
+  minus.f <<= minus.e - plus.e;
+  minus.e = plus.e;
+
+  return {v.normalize(), minus, plus};
+}
+
+// Cached powers of ten c = f * 2^e ~= 10^k for k = -300, -292, ..., 324.
+struct CachedPower {
+  uint64_t f;
+  int e;
+  int k;
+};
+
+const CachedPower CACHED_POWERS[] = {
+    {0xAB70FE17C79AC6CAULL, -1060, -300},
+    {0xFF77B1FCBEBCDC4FULL, -1034, -292},
+    {0xBE5691EF416BD60CULL, -1007, -284},
+    {0x8DD01FAD907FFC3CULL, -980, -276},
+    {0xD3515C2831559A83ULL, -954, -268},
+    {0x9D71AC8FADA6C9B5ULL, -927, -260},
+    {0xEA9C227723EE8BCBULL, -901, -252},
+    {0xAECC49914078536DULL, -874, -244},
+    {0x823C12795DB6CE57ULL, -847, -236},
+    {0xC21094364DFB5637ULL, -821, -228},
+    {0x9096EA6F3848984FULL, -794, -220},
+    {0xD77485CB25823AC7ULL, -768, -212},
+    {0xA086CFCD97BF97F4ULL, -741, -204},
+    {0xEF340A98172AACE5ULL, -715, -196},
+    {0xB23867FB2A35B28EULL, -688, -188},
+    {0x84C8D4DFD2C63F3BULL, -661, -180},
+    {0xC5DD44271AD3CDBAULL, -635, -172},
+    {0x936B9FCEBB25C996ULL, -608, -164},
+    {0xDBAC6C247D62A584ULL, -582, -156},
+    {0xA3AB66580D5FDAF6ULL, -555, -148},
+    {0xF3E2F893DEC3F126ULL, -529, -140},
+    {0xB5B5ADA8AAFF80B8ULL, -502, -132},
+    {0x87625F056C7C4A8BULL, -475, -124},
+    {0xC9BCFF6034C13053ULL, -449, -116},
+    {0x964E858C91BA2655ULL, -422, -108},
+    {0xDFF9772470297EBDULL, -396, -100},
+    {0xA6DFBD9FB8E5B88FULL, -369, -92},
+    {0xF8A95FCF88747D94ULL, -343, -84},
+    {0xB94470938FA89BCFULL, -316, -76},
+    {0x8A08F0F8BF0F156BULL, -289, -68},
+    {0xCDB02555653131B6ULL, -263, -60},
+    {0x993FE2C6D07B7FACULL, -236, -52},
+    {0xE45C10C42A2B3B06ULL, -210, -44},
+    {0xAA242499697392D3ULL, -183, -36},
+    {0xFD87B5F28300CA0EULL, -157, -28},
+    {0xBCE5086492111AEBULL, -130, -20},
+    {0x8CBCCC096F5088CCULL, -103, -12},
+    {0xD1B71758E219652CULL, -77, -4},
+    {0x9C40000000000000ULL, -50, 4},
+    {0xE8D4A51000000000ULL, -24, 12},
+    {0xAD78EBC5AC620000ULL, 3, 20},
+    {0x813F3978F8940984ULL, 30, 28},
+    {0xC097CE7BC90715B3ULL, 56, 36},
+    {0x8F7E32CE7BEA5C70ULL, 83, 44},
+    {0xD5D238A4ABE98068ULL, 109, 52},
+    {0x9F4F2726179A2245ULL, 136, 60},
+    {0xED63A231D4C4FB27ULL, 162, 68},
+    {0xB0DE65388CC8ADA8ULL, 189, 76},
+    {0x83C7088E1AAB65DBULL, 216, 84},
+    {0xC45D1DF942711D9AULL, 242, 92},
+    {0x924D692CA61BE758ULL, 269, 100},
+    {0xDA01EE641A708DEAULL, 295, 108},
+    {0xA26DA3999AEF774AULL, 322, 116},
+    {0xF209787BB47D6B85ULL, 348, 124},
+    {0xB454E4A179DD1877ULL, 375, 132},
+    {0x865B86925B9BC5C2ULL, 402, 140},
+    {0xC83553C5C8965D3DULL, 428, 148},
+    {0x952AB45CFA97A0B3ULL, 455, 156},
+    {0xDE469FBD99A05FE3ULL, 481, 164},
+    {0xA59BC234DB398C25ULL, 508, 172},
+    {0xF6C69A72A3989F5CULL, 534, 180},
+    {0xB7DCBF5354E9BECEULL, 561, 188},
+    {0x88FCF317F22241E2ULL, 588, 196},
+    {0xCC20CE9BD35C78A5ULL, 614, 204},
+    {0x98165AF37B2153DFULL, 641, 212},
+    {0xE2A0B5DC971F303AULL, 667, 220},
+    {0xA8D9D1535CE3B396ULL, 694, 228},
+    {0xFB9B7CD9A4A7443CULL, 720, 236},
+    {0xBB764C4CA7A44410ULL, 747, 244},
+    {0x8BAB8EEFB6409C1AULL, 774, 252},
+    {0xD01FEF10A657842CULL, 800, 260},
+    {0x9B10A4E5E9913129ULL, 827, 268},
+    {0xE7109BFBA19C0C9DULL, 853, 276},
+    {0xAC2820D9623BF429ULL, 880, 284},
+    {0x80444B5E7AA7CF85ULL, 907, 292},
+    {0xBF21E44003ACDD2DULL, 933, 300},
+    {0x8E679C2F5E44FF8FULL, 960, 308},
+    {0xD433179D9C8CB841ULL, 986, 316},
+    {0x9E19DB92B4E31BA9ULL, 1013, 324},
+};
+
+const int CACHED_POWERS_MIN_DEC_EXP = -300;
+const int CACHED_POWERS_DEC_STEP = 8;
+
+// the exponent of the scaled boundaries lies in [ALPHA, GAMMA]
+const int ALPHA = -60;
+const int GAMMA = -32;
+
+CachedPower cached_power_for_binary_exponent(int e) {
+  // k = ceil((ALPHA - e - 1) * log10(2))
+  const int f = ALPHA - e - 1;
+  const int k = (f * 78913) / (1 << 18) + (f > 0);
+  const int index = (-CACHED_POWERS_MIN_DEC_EXP + k
+      + (CACHED_POWERS_DEC_STEP - 1)) / CACHED_POWERS_DEC_STEP;
+  return CACHED_POWERS[index];
+}
+
+// returns the number of digits of n, and the largest power of ten <= n
+int find_largest_pow10(uint32_t n, uint32_t &pow10) {
+  int digits = 1;
+  pow10 = 1;
+  while (digits < 10 && n >= pow10 * 10) {
+    pow10 *= 10;
+    digits++;
+  }
+  return digits;
+}
+
+// moves the last digit towards w as long as it stays within the interval
+void grisu2_round(char *buffer, int length, uint64_t dist, uint64_t delta,
+                  uint64_t rest, uint64_t ten_k) {
+  while (rest < dist && delta - rest >= ten_k
+      && (rest + ten_k < dist || dist - rest > rest + ten_k - dist)) {
+    buffer[length - 1]--;
+    rest += ten_k;
+  }
+}
+
+// generates the digits of the shortest number in [M-, M+] close to w
+void grisu2_digit_gen(char *buffer, int &length, int &decimal_exponent,
+                      DiyFp M_minus, DiyFp w, DiyFp M_plus) {
+  uint64_t delta = (M_plus - M_minus).f;
+  uint64_t dist = (M_plus - w).f;
+
+  const DiyFp one(uint64_t(1) << -M_plus.e, M_plus.e);
+  uint32_t p1 = (uint32_t) (M_plus.f >> -one.e);  // integral part
+  uint64_t p2 = M_plus.f & (one.f - 1);  // fractional part
+
+  // digits of the integral part
+  uint32_t pow10;
+  int n = find_largest_pow10(p1, pow10);
+  while (n > 0) {
+    buffer[length++] = (char) ('0' + p1 / pow10);
+    p1 %= pow10;
+    n--;
+    const uint64_t rest = (uint64_t(p1) << -one.e) + p2;
+    if (rest <= delta) {
+      decimal_exponent += n;
+      grisu2_round(buffer, length, dist, delta, rest,
+                   uint64_t(pow10) << -one.e);
+      return;
+    }
+    pow10 /= 10;
+  }
+
+  // digits of the fractional part
+  int m = 0;
+  for (;;) {
+    p2 *= 10;
+    buffer[length++] = (char) ('0' + (p2 >> -one.e));
+    p2 &= one.f - 1;
+    m++;
+    delta *= 10;
+    dist *= 10;
+    if (p2 <= delta)
+      break;
+  }
+  decimal_exponent -= m;
+  grisu2_round(buffer, length, dist, delta, p2, one.f);
+}
+
+// the value is buffer[0..length) * 10^decimal_exponent
+void grisu2(char *buffer, int &length, int &decimal_exponent,
+            const Boundaries &b) {
+  const CachedPower cached = cached_power_for_binary_exponent(b.plus.e);
+  const DiyFp c_minus_k(cached.f, cached.e);
+
+  const DiyFp w = b.w * c_minus_k;
+  const DiyFp w_minus = b.minus * c_minus_k;
+  const DiyFp w_plus = b.plus * c_minus_k;
+
+  // the scaled boundaries are approximated: shrink the interval by 1 ulp
+  const DiyFp M_minus(w_minus.f + 1, w_minus.e);
+  const DiyFp M_plus(w_plus.f - 1, w_plus.e);
+
+  length = 0;
+  decimal_exponent = -cached.k;
+  grisu2_digit_gen(buffer, length, decimal_exponent, M_minus, w, M_plus);
+}
+
+// formats the digits in fixed or scientific notation
+size_t format_digits(char *buffer, int length, int decimal_exponent) {
+  const int min_exp = -4;
+  const int max_exp = 15;
+
+  const int k = length;
+  const int n = length + decimal_exponent;  // position of the decimal point
+
+  if (k <= n && n <= max_exp) {
+    // digits[000]
+    std::memset(buffer + k, '0', n - k);
+    return n;
+  }
+  if (0 < n && n <= max_exp) {
+    // dig.its
+    std::memmove(buffer + n + 1, buffer + n, k - n);
+    buffer[n] = '.';
+    return k + 1;
+  }
+  if (min_exp < n && n <= 0) {
+    // 0.[000]digits
+    std::memmove(buffer + 2 - n, buffer, k);
+    buffer[0] = '0';
+    buffer[1] = '.';
+    std::memset(buffer + 2, '0', -n);
+    return 2 - n + k;
+  }
+
+  // d[.igits]e[+-]exponent
+  size_t pos = 1;
+  if (k > 1) {
+    std::memmove(buffer + 2, buffer + 1, k - 1);
+    buffer[1] = '.';
+    pos = k + 1;
+  }
+  int e = n - 1;
+  buffer[pos++] = 'e';
+  buffer[pos++] = e < 0 ? '-' : '+';
+  if (e < 0)
+    e = -e;
+  char exponent[4];
+  int digits = 0;
+  do {
+    exponent[digits++] = (char) ('0' + e % 10);
+    e /= 10;
+  } while (e);
+  while (digits)
+    buffer[pos++] = exponent[--digits];
+  return pos;
+}
+
+template<typename FloatType, typename BitsType>
+size_t to_chars(char *buffer, FloatType value) {
+  size_t pos = 0;
+  if (std::signbit(value)) {
+    buffer[pos++] = '-';
+    value = -value;
+  }
+  if (std::isnan(value)) {
+    std::memcpy(buffer, "nan", 3);
+    return 3;
+  }
+  if (std::isinf(value)) {
+    std::memcpy(buffer + pos, "inf", 3);
+    return pos + 3;
+  }
+  if (value == 0) {
+    buffer[pos++] = '0';
+    return pos;
+  }
+
+  int length, decimal_exponent;
+  grisu2(buffer + pos, length, decimal_exponent,
+         compute_boundaries<FloatType, BitsType>(value));
+  return pos + format_digits(buffer + pos, length, decimal_exponent);
+}
+
+}  // namespace
+
+size_t float_to_chars(char *buffer, float value) {
+  return to_chars<float, uint32_t>(buffer, value);
+}
+
+size_t double_to_chars(char *buffer, double value) {
+  return to_chars<double, uint64_t>(buffer, value);
+}
+
+#ifdef __SIZEOF_INT128__
+
+namespace {
+
+typedef unsigned __int128 uint128_t;
+
+const uint64_t POW10[20] = {
+    1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull,
+    10000000ull, 100000000ull, 1000000000ull, 10000000000ull,
+    100000000000ull, 1000000000000ull, 10000000000000ull,
+    100000000000000ull, 1000000000000000ull, 10000000000000000ull,
+    100000000000000000ull, 1000000000000000000ull, 10000000000000000000ull};
+
+int bit_length(uint128_t x) {
+  const uint64_t high = (uint64_t) (x >> 64);
+  if (high)
+    return 128 - __builtin_clzll(high);
+  const uint64_t low = (uint64_t) x;
+  return low ? 64 - __builtin_clzll(low) : 0;
+}
+
+// rounds x * 2^e to the nearest double (ties to even), where sticky tells
+// whether x is truncated, i.e., the exact significand is in (x, x + 1)
+double round_to_double(uint128_t x, int e, bool sticky) {
+  const int shift = bit_length(x) - 53;
+  if (shift <= 0)
+    return std::ldexp((double) (uint64_t) x, e);
+  uint64_t significand = (uint64_t) (x >> shift);
+  const uint128_t rest = x & (((uint128_t) 1 << shift) - 1);
+  const uint128_t half = (uint128_t) 1 << (shift - 1);
+  if (rest > half || (rest == half && (sticky || (significand & 1))))
+    ++significand;  // may become 2^53, which is still exact
+  return std::ldexp((double) significand, e + shift);
+}
+
+}  // namespace
+
+double chars_to_double(const char *str) {
+  const char *p = str;
+  while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')
+    ++p;
+  const bool negative = *p == '-';
+  if (*p == '-' || *p == '+')
+    ++p;
+
+  // significant digits, and the decimal exponent of the last one
+  uint64_t digits = 0;
+  int num_digits = 0, exponent = 0;
+  bool any_digit = false;
+  for (; *p >= '0' && *p <= '9'; ++p, any_digit = true) {
+    if (num_digits == 19)
+      return strtod(str, NULL);
+    if (digits || *p != '0')
+      digits = digits * 10 + (*p - '0'), ++num_digits;
+  }
+  if (*p == '.') {
+    for (++p; *p >= '0' && *p <= '9'; ++p, any_digit = true) {
+      if (num_digits == 19)
+        return strtod(str, NULL);
+      if (digits || *p != '0')
+        digits = digits * 10 + (*p - '0'), ++num_digits;
+      --exponent;
+    }
+  }
+  if (!any_digit)
+    return strtod(str, NULL);  // nan, inf, hex or not a number
+  if (*p == 'e' || *p == 'E') {
+    const char *e = p + 1;
+    const bool negative_exponent = *e == '-';
+    if (*e == '-' || *e == '+')
+      ++e;
+    if (*e < '0' || *e > '9')
+      return strtod(str, NULL);
+    int value = 0;
+    for (; *e >= '0' && *e <= '9' && value < 10000; ++e)
+      value = value * 10 + (*e - '0');
+    exponent += negative_exponent ? -value : value;
+    p = e;
+  }
+  if (*p != '\0' && *p != ' ' && *p != '\t' && *p != '\n' && *p != '\r')
+    return strtod(str, NULL);  // e.g., hex numbers
+
+  static const double EXACT_POW10[] = {
+      1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12,
+      1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+  double value;
+  if (digits == 0)
+    value = 0.0;
+  else if (digits < (1ull << 53) && exponent >= -22 && exponent <= 22)
+    // both operands are exact, and the result is rounded once (Clinger)
+    value = exponent >= 0 ? (double) digits * EXACT_POW10[exponent]
+                          : (double) digits / EXACT_POW10[-exponent];
+  else if (exponent < -19 || exponent > 19)
+    return strtod(str, NULL);
+  else if (exponent >= 0)
+    value = round_to_double((uint128_t) digits * POW10[exponent], 0, false);
+  else {
+    // digits / 10^-exponent, with at least 64 significant bits
+    const int shift = 128 - bit_length(digits);
+    const uint128_t numerator = (uint128_t) digits << shift;
+    const uint64_t divisor = POW10[-exponent];
+    value = round_to_double(numerator / divisor, -shift,
+                            numerator % divisor != 0);
+  }
+  return negative ? -value : value;
+}
+
+#else
+
+double chars_to_double(const char *str) {
+  return strtod(str, NULL);
+}
+
+#endif
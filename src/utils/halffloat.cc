@@ -0,0 +1,61 @@
+/*
+ * QuickRank - A C++ suite of Learning to Rank algorithms
+ * Webpage: http://quickrank.isti.cnr.it/
+ * Contact: quickrank@isti.cnr.it
+ *
+ * Unless explicitly acquired and licensed from Licensor under another
+ * license, the contents of this file are subject to the Reciprocal Public
+ * License ("RPL") Version 1.5, or subsequent versions as allowed by the RPL,
+ * and You may not copy or use this file in either source code or executable
+ * form, except in compliance with the terms and conditions of the RPL.
+ *
+ * All software distributed under the RPL is provided strictly on an "AS
+ * IS" basis, WITHOUT WARRANTY OF ANY KIND, EITHER EXPRESS OR IMPLIED, AND
+ * LICENSOR HEREBY DISCLAIMS ALL SUCH WARRANTIES, INCLUDING WITHOUT
+ * LIMITATION, ANY WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+ * PURPOSE, QUIET ENJOYMENT, OR NON-INFRINGEMENT. See the RPL for specific
+ * language governing rights and limitations under the RPL.
+ *
+ * Contributor:
+ *   HPC. Laboratory - ISTI - CNR - http://hpc.isti.cnr.it/
+ */
+#include "utils/halffloat.h"
+
+#ifdef __F16C__
+#include <immintrin.h>
+#endif
+
+void half_to_float(float *output, const uint16_t *input, const size_t n) {
+  size_t i = 0;
+#ifdef __F16C__
+  for (; i + 8 <= n; i += 8) {
+    __m128i h = _mm_loadu_si128((const __m128i *) (input + i));
+    _mm256_storeu_ps(output + i, _mm256_cvtph_ps(h));
+  }
+#endif
+  for (; i < n; ++i)
+    output[i] = half_to_float(input[i]);
+}
+
+void float_to_half(uint16_t *output, const float *input, const size_t n) {
+  size_t i = 0;
+#ifdef __F16C__
+  for (; i + 8 <= n; i += 8) {
+    __m256 f = _mm256_loadu_ps(input + i);
+    _mm_storeu_si128((__m128i *) (output + i),
+                     _mm256_cvtps_ph(f, _MM_FROUND_TO_NEAREST_INT));
+  }
+#endif
+  for (; i < n; ++i)
+    output[i] = float_to_half(input[i]);
+}
+
+void bfloat16_to_float(float *output, const uint16_t *input, const size_t n) {
+  for (size_t i = 0; i < n; ++i)
+    output[i] = bfloat16_to_float(input[i]);
+}
+
+void float_to_bfloat16(uint16_t *output, const float *input, const size_t n) {
+  for (size_t i = 0; i < n; ++i)
+    output[i] = float_to_bfloat16(input[i]);
+}
@@ -24,6 +24,9 @@
 const int omp_get_num_procs() {
   return 1;
 }
+const int omp_get_max_threads() {
+  return 1;
+}
 const int omp_get_thread_num() {
   return 0;
 }
@@ -22,43 +22,65 @@
 
 #include "utils/transpose.h"
 
-/*! \def TRNSP_BLOCKSIZE
- *  \brief size of a square block of elements to traspose
+#include <algorithm>
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+/*! \def TRNSP_TILESIZE
+ *  \brief size of a square tile of elements transposed by a thread
  */
-#define TRNSP_BLOCKSIZE 64
+#define TRNSP_TILESIZE 64
 
-/*! traspose \a input float matrix made up of \a n rows and \a m columns block by block
- *  @param input matrix to transpose
- *  @param output trasposed matrix
- *  @param n number of rows of input matrix
- *  @param m number of columns of input matrix
+/*! transpose the tile [\a rbegin, \a rend) x [\a cbegin, \a cend) of \a input
+ *  matrix with \a n rows and \a m columns, writing runs of consecutive
+ *  elements of the output rows
  */
-void transpose(float **output, float **input, const size_t n,
-               const size_t m) {
-#pragma omp parallel for
-  for (size_t rbegin = 0; rbegin < n; rbegin += TRNSP_BLOCKSIZE) {
-    if (rbegin + TRNSP_BLOCKSIZE < n) {
-      for (size_t cbegin = 0; cbegin < m; cbegin += TRNSP_BLOCKSIZE)
-        if (cbegin + TRNSP_BLOCKSIZE < m) {
-          for (size_t r = 0; r < TRNSP_BLOCKSIZE; ++r)
-            for (size_t c = 0; c < TRNSP_BLOCKSIZE; ++c)
-              output[cbegin + c][rbegin + r] = input[rbegin + r][cbegin + c];
-        } else {
-          for (size_t r = 0; r < TRNSP_BLOCKSIZE; ++r)
-            for (size_t c = cbegin; c < m; ++c)
-              output[c][rbegin + r] = input[rbegin + r][c];
-        }
-    } else {
-      for (size_t cbegin = 0; cbegin < m; cbegin += TRNSP_BLOCKSIZE) {
-        size_t cend =
-            cbegin + TRNSP_BLOCKSIZE < m ? cbegin + TRNSP_BLOCKSIZE : m;
-        for (size_t r = rbegin; r < n; ++r)
-          for (size_t c = cbegin; c < cend; ++c)
-            output[c][r] = input[r][c];
-      }
+static void transpose_tile(float *output, const float *input, const size_t n,
+                           const size_t m, const size_t rbegin,
+                           const size_t rend, const size_t cbegin,
+                           const size_t cend) {
+  size_t c = cbegin;
+#ifdef __SSE__
+  // blocks of 4x4 elements are transposed in registers
+  for (; c + 4 <= cend; c += 4) {
+    size_t r = rbegin;
+    for (; r + 4 <= rend; r += 4) {
+      __m128 row0 = _mm_loadu_ps(input + r * m + c);
+      __m128 row1 = _mm_loadu_ps(input + (r + 1) * m + c);
+      __m128 row2 = _mm_loadu_ps(input + (r + 2) * m + c);
+      __m128 row3 = _mm_loadu_ps(input + (r + 3) * m + c);
+      _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+      _mm_storeu_ps(output + c * n + r, row0);
+      _mm_storeu_ps(output + (c + 1) * n + r, row1);
+      _mm_storeu_ps(output + (c + 2) * n + r, row2);
+      _mm_storeu_ps(output + (c + 3) * n + r, row3);
     }
+    for (; r < rend; ++r)
+      for (size_t j = c; j < c + 4; ++j)
+        output[j * n + r] = input[r * m + j];
   }
+#endif
+  for (; c < cend; ++c)
+    for (size_t r = rbegin; r < rend; ++r)
+      output[c * n + r] = input[r * m + c];
 }
 
-#undef TRNSP_BLOCKSIZE
+void transpose(float *output, const float *input, const size_t n,
+               const size_t m) {
+  const size_t row_tiles = (n + TRNSP_TILESIZE - 1) / TRNSP_TILESIZE;
+  const size_t col_tiles = (m + TRNSP_TILESIZE - 1) / TRNSP_TILESIZE;
+  // consecutive tiles of a thread write adjacent elements of the same
+  // output rows
+  #pragma omp parallel for schedule(static)
+  for (size_t t = 0; t < row_tiles * col_tiles; ++t) {
+    const size_t rbegin = (t % row_tiles) * TRNSP_TILESIZE;
+    const size_t cbegin = (t / row_tiles) * TRNSP_TILESIZE;
+    transpose_tile(output, input, n, m,
+                   rbegin, std::min(n, rbegin + TRNSP_TILESIZE),
+                   cbegin, std::min(m, cbegin + TRNSP_TILESIZE));
+  }
+}
 
+#undef TRNSP_TILESIZE